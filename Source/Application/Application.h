@@ -27,7 +27,7 @@
 #include <windows.h>
 #include <string>
 
-namespace Settings { struct Window; }
+namespace Settings { struct Window; struct Headless; }
 
 class Application
 {
@@ -53,6 +53,7 @@ public:
 
 	static std::string s_WorkspaceDirectory;
 	static std::string s_ShaderCacheDirectory;
+	static std::string s_ModelCacheDirectory;
 
 public:
 	Application(const char* psAppName);
@@ -62,6 +63,15 @@ public:
 	void Run();
 	void Exit();
 
+	// Headless mode: no window, the engine renders on the null renderer backend, see Engine::RunHeadless().
+	// The command line is parsed as: -headless <scene.scn> [-frames N] [-output file.json] [-modelcachebenchmark]
+	static bool ParseHeadlessCommandLine(const char* pCmdLine, Settings::Headless& headlessSettings);
+	bool RunHeadless(const Settings::Headless& headlessSettings);
+
+	// Benchmark mode: -benchmark on the command line, configured in EngineSettings.ini, see Engine::RunBenchmark().
+	static bool ParseBenchmarkCommandLine(const char* pCmdLine);
+	bool RunBenchmark();
+
 	LRESULT CALLBACK MessageHandler(HWND, UINT, WPARAM, LPARAM);
 	void UpdateWindowDimensions(int w, int h);
 
@@ -31,6 +31,7 @@
 
 #include <strsafe.h>
 #include <vector>
+#include <algorithm>
 #include <new>
 
 #ifdef _DEBUG
@@ -41,6 +42,7 @@
 
 std::string Application::s_WorkspaceDirectory = "";
 std::string Application::s_ShaderCacheDirectory = "";
+std::string Application::s_ModelCacheDirectory = "";
 
 // TODO:
 static Application::WorkspaceDirectories DefaultWorkspaceDirectorie = 
@@ -81,6 +83,7 @@ Application::WorkspaceDirectories Application::s_WorkspaceDirectories = Applicat
 Application::Application(const char* psAppName)
 	:
 	m_appName(psAppName),
+	m_hwnd(NULL),
 	m_bMouseCaptured(false),
 	m_bAppWantsExit(false),
 	m_threadPool(VQEngine::ThreadPool::sHardwareThreadCount - 2)
@@ -94,7 +97,10 @@ Application::~Application(){}
 void Application::Exit()
 {
 	ENGINE->Exit();
-	ShutdownWindows();
+	if (m_hwnd)	// no window in headless mode
+	{
+		ShutdownWindows();
+	}
 }
 
 bool Application::Init()
@@ -137,6 +143,70 @@ bool Application::Init()
 	return true;
 }	
 
+bool Application::ParseHeadlessCommandLine(const char* pCmdLine, Settings::Headless& headlessSettings)
+{
+	if (!pCmdLine)
+		return false;
+
+	const std::vector<std::string> tokens = StrUtil::split(pCmdLine, ' ');
+	bool bHeadless = false;
+	for (size_t i = 0; i < tokens.size(); ++i)
+	{
+		const std::string& token = tokens[i];
+		const bool bHasValue = i + 1 < tokens.size();
+		if      (token == "-headless" && bHasValue) { bHeadless = true; headlessSettings.sceneName = tokens[++i]; }
+		else if (token == "-frames"   && bHasValue) { headlessSettings.numFrames = std::atoi(tokens[++i].c_str()); }
+		else if (token == "-output"   && bHasValue) { headlessSettings.outputFile = tokens[++i]; }
+		else if (token == "-modelcachebenchmark")   { headlessSettings.bBenchmarkModelCache = true; }
+	}
+	return bHeadless && !headlessSettings.sceneName.empty();
+}
+
+bool Application::RunHeadless(const Settings::Headless& headlessSettings)
+{
+	// SETTINGS & LOG
+	//
+	s_WorkspaceDirectory = DirectoryUtil::GetSpecialFolderPath(DirectoryUtil::ESpecialFolder::LOCALAPPDATA) + "/VQEngine";
+	Settings::Engine& settings = const_cast<Settings::Engine&>(Engine::ReadSettingsFromFile());
+	Log::Initialize(settings.logger);
+
+	// ENGINE
+	//
+	if (!ENGINE->Initialize(nullptr))
+	{
+		Log::Error("Could not initialize VQEngine. Exiting...");
+		return false;
+	}
+	return ENGINE->RunHeadless(&m_threadPool, headlessSettings);
+}
+
+bool Application::ParseBenchmarkCommandLine(const char* pCmdLine)
+{
+	if (!pCmdLine)
+		return false;
+
+	const std::vector<std::string> tokens = StrUtil::split(pCmdLine, ' ');
+	return std::find(RANGE(tokens), "-benchmark") != tokens.end();
+}
+
+bool Application::RunBenchmark()
+{
+	// SETTINGS & LOG
+	//
+	s_WorkspaceDirectory = DirectoryUtil::GetSpecialFolderPath(DirectoryUtil::ESpecialFolder::LOCALAPPDATA) + "/VQEngine";
+	Settings::Engine& settings = const_cast<Settings::Engine&>(Engine::ReadSettingsFromFile());
+	Log::Initialize(settings.logger);
+
+	// ENGINE
+	//
+	if (!ENGINE->Initialize(nullptr))
+	{
+		Log::Error("Could not initialize VQEngine. Exiting...");
+		return false;
+	}
+	return ENGINE->RunBenchmark(&m_threadPool, settings.benchmark);
+}
+
 void Application::Run()
 {
 	ENGINE->mpTimer->Reset();
@@ -17,6 +17,7 @@
 //	Contact: volkanilbeyli@gmail.com
 
 #include "../Application/Application.h"
+#include "../Engine/Settings.h"
 
 #include <ctime>
 #include <cstdlib>
@@ -26,6 +27,22 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE hPrevInst, PSTR pScmdl, int iCmdSh
 	srand(static_cast<unsigned>(time(NULL)));
 	
 	Application VQDemo("VQEngine Demo");
+
+	if (Application::ParseBenchmarkCommandLine(pScmdl))
+	{	// nonzero exit code on regressions for automated runs
+		const bool bSuccess = VQDemo.RunBenchmark();
+		VQDemo.Exit();
+		return bSuccess ? 0 : 1;
+	}
+
+	Settings::Headless headlessSettings;
+	if (Application::ParseHeadlessCommandLine(pScmdl, headlessSettings))
+	{
+		const bool bSuccess = VQDemo.RunHeadless(headlessSettings);
+		VQDemo.Exit();
+		return bSuccess ? 0 : 1;
+	}
+
 	if (VQDemo.Init())
 	{
 		VQDemo.Run();
@@ -0,0 +1,101 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "TaskGraph.h"
+
+#include <cassert>
+
+using namespace VQEngine;
+
+TaskGraph::Task& TaskGraph::AllocateTask(CPUProfiler::EntryID profilerEntry, std::initializer_list<TaskID> dependencies)
+{
+	const TaskID taskID = static_cast<TaskID>(mNumTasks);
+	if (mNumTasks == mTasks.size())
+		mTasks.emplace_back();
+	++mNumTasks;
+
+	// reused tasks keep the capacity of their successor list
+	Task& task = mTasks[taskID];
+	task.profilerEntry = profilerEntry;
+	task.successors.clear();
+	task.numDependencies = 0;
+	for (TaskID dependency : dependencies)
+	{
+		assert(dependency >= 0 && dependency < taskID);
+		mTasks[dependency].successors.push_back(taskID);
+		++task.numDependencies;
+	}
+	return task;
+}
+
+void TaskGraph::Execute(ThreadPool* pThreadPool)
+{
+	const TaskID numTasks = static_cast<TaskID>(mNumTasks);
+	if (!pThreadPool)
+	{
+		for (TaskID taskID = 0; taskID < numTasks; ++taskID)
+			ExecuteTask(mTasks[taskID]);
+		return;
+	}
+
+	for (TaskID taskID = 0; taskID < numTasks; ++taskID)
+		mTasks[taskID].numPendingDependencies.store(mTasks[taskID].numDependencies, std::memory_order_relaxed);
+
+	JobCounter counter;
+	for (TaskID taskID = 0; taskID < numTasks; ++taskID)
+	{
+		if (mTasks[taskID].numDependencies == 0)
+		{
+			pThreadPool->Run([this, pThreadPool, taskID, pCounter = &counter]() { RunTaskChain(pThreadPool, taskID, pCounter); }, &counter);
+		}
+	}
+	pThreadPool->Wait(counter);
+}
+
+void TaskGraph::RunTaskChain(ThreadPool* pThreadPool, TaskID taskID, JobCounter* pCounter)
+{
+	while (taskID != -1)
+	{
+		Task& task = mTasks[taskID];
+		ExecuteTask(task);
+
+		// submit the successors that became ready and continue with the first one on this thread
+		TaskID nextTaskID = -1;
+		for (TaskID successorID : task.successors)
+		{
+			if (mTasks[successorID].numPendingDependencies.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				continue;
+
+			if (nextTaskID == -1)
+				nextTaskID = successorID;
+			else
+				pThreadPool->Run([this, pThreadPool, successorID, pCounter]() { RunTaskChain(pThreadPool, successorID, pCounter); }, pCounter);
+		}
+		taskID = nextTaskID;
+	}
+}
+
+void TaskGraph::ExecuteTask(Task& task)
+{
+	const CPUProfiler::ScopedEntry profileScope(task.profilerEntry);
+	task.pfnExecute(task.storage);
+}
+
+void TaskGraph::Clear()
+{
+	mNumTasks = 0;
+}
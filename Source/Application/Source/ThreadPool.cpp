@@ -17,124 +17,247 @@
 //	Contact: volkanilbeyli@gmail.com
 
 #include "ThreadPool.h"
-#include "Utilities/Utils.h"
-#include "Utilities/Log.h"
+#include "Utilities/Profiler.h"
 
 using namespace VQEngine;
 
 const size_t ThreadPool::sHardwareThreadCount = std::thread::hardware_concurrency();
 
+// index of the calling thread in ThreadPool::mThreadData, -1 for unregistered threads
+static thread_local int sThreadIndex = -1;
+
 
 ThreadPool::ThreadPool(size_t numThreads)
 {
+	// thread 0 is the thread creating the pool
+	sThreadIndex = 0;
+	for (size_t i = 0; i < numThreads + 1; ++i)
+	{
+		mThreadData.push_back(std::make_unique<ThreadData>());
+	}
 	for (auto i = 0u; i < numThreads; ++i)
 	{
-		mThreads.emplace_back(std::thread(&ThreadPool::Execute, this));
+		mThreads.emplace_back(std::thread(&ThreadPool::Execute, this, static_cast<int>(i + 1)));
+	}
+}
+ThreadPool::~ThreadPool()
+{
+	{
+		std::unique_lock<std::mutex > lock(mMutex);
+		mStopThreads = true;
+	}
+
+	mSignal.notify_all();
+
+	for (auto& thread : mThreads)
+	{
+		thread.join();
 	}
+}
+
+void ThreadPool::Execute(int threadIndex)
+{
+	sThreadIndex = threadIndex;
+	CPUProfiler::SetThreadName("Worker " + std::to_string(threadIndex));
 
-	// Thread Pool Unit Test ------------------------------------------------
-	if (false)
+	constexpr int NUM_SPINS_BEFORE_SLEEP = 64;
+	int numSpins = 0;
+	while (!mStopThreads)
 	{
-		constexpr long long sz = 40000000;
-		auto sumRnd = [&]()
+		// fine grained jobs first
+		if (Job* pJob = GetJob(threadIndex))
 		{
-			std::vector<long long> nums(sz, 0);
-			for (int i = 0; i < sz; ++i)
-			{
-				nums[i] = MathUtil::RandI(0, 5000);
-			}
-			unsigned long long result = 0;
-			for (int i = 0; i < sz; ++i)
-			{
-				if (nums[i] > 3000)
-					result += nums[i];
-			}
-			return result;
-		};
-		auto sum = [&]()
+			--mNumQueuedJobs;
+			ExecuteJob(pJob);
+			numSpins = 0;
+			continue;
+		}
+
+		// then the background tasks
+		Task task;
 		{
-			std::vector<long long> nums(sz, 0);
-			for (int i = 0; i < sz; ++i)
+			std::unique_lock<std::mutex> lock(mTaskQueue.mutex);
+			if (!mTaskQueue.queue.empty())
 			{
-				nums[i] = MathUtil::RandI(0, 5000);
+				task = std::move(mTaskQueue.queue.front());
+				mTaskQueue.queue.pop();
 			}
-			unsigned long long result = 0;
-			for (int i = 0; i < sz; ++i)
-			{
-				result += nums[i];
-			}
-			return result;
-		};
+		}
+		if (task)
+		{
+			--mNumQueuedJobs;
+			PROFILE_SCOPE("ThreadPool_Task");
+			task();
+			numSpins = 0;
+			continue;
+		}
 
-		constexpr int threadCount = 16;
-		std::future<unsigned long long> futures[threadCount] =
+		// spin for a while before sleeping as the jobs of a frame are submitted in bursts
+		if (++numSpins < NUM_SPINS_BEFORE_SLEEP)
 		{
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-			this->AddTask(sumRnd),
-
-			this->AddTask(sum),
-			this->AddTask(sum),
-			this->AddTask(sum),
-			this->AddTask(sum),
-			this->AddTask(sum),
-			this->AddTask(sum),
-			this->AddTask(sum),
-			this->AddTask(sum),
-		};
-
-		std::vector<unsigned long long> results;
-		unsigned long long total = 0;
-		std::for_each(std::begin(futures), std::end(futures), [&](decltype(futures[0]) f)
+			std::this_thread::yield();
+			continue;
+		}
+
 		{
-			results.push_back(f.get());
-			total += results.back();
-		});
+			std::unique_lock<std::mutex > lock(mMutex);
+			++mNumSleepingWorkers;
+			mSignal.wait(lock, [=] { return mStopThreads || mNumQueuedJobs > 0; });
+			--mNumSleepingWorkers;
+		}
+		numSpins = 0;
+	}
+}
 
-		std::string strResult = "total (" + std::to_string(total) + ") = ";
-		for (int i = 0; i < threadCount; ++i)
+void ThreadPool::Wait(const JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		// help executing the jobs instead of blocking. background tasks
+		// are not picked up here as they can take arbitrarily long.
+		if (Job* pJob = GetJob(sThreadIndex))
 		{
-			strResult += "(" + std::to_string(results[i]) + ") " + (i == threadCount - 1 ? "" : " + ");
+			--mNumQueuedJobs;
+			ExecuteJob(pJob);
+		}
+		else
+		{
+			std::this_thread::yield();
 		}
-		Log::Info(strResult);
 	}
-	// Thread Pool Unit Test ------------------------------------------------
 }
-ThreadPool::~ThreadPool()
+
+Job* ThreadPool::AllocateJob()
+{
+	if (sThreadIndex < 0 || sThreadIndex >= static_cast<int>(mThreadData.size()))
+		return nullptr;
+
+	ThreadData& threadData = *mThreadData[sThreadIndex];
+	Job& job = threadData.jobs[threadData.nextJobIndex++ & (MAX_JOBS_PER_THREAD - 1)];
+	if (job.bPending.load(std::memory_order_acquire))
+		return nullptr; // the slot is still used by a job submitted MAX_JOBS_PER_THREAD jobs ago
+
+	job.bPending.store(true, std::memory_order_relaxed);
+	return &job;
+}
+
+void ThreadPool::SubmitJob(Job* pJob)
 {
+	if (!mThreadData[sThreadIndex]->deque.Push(pJob))
 	{
-		std::unique_lock<std::mutex > lock(mMutex);
-		mStopThreads = true;
+		ExecuteJob(pJob); // deque is full
+		return;
 	}
+	++mNumQueuedJobs;
+	WakeUpWorker();
+}
 
-	mSignal.notify_all();
+void ThreadPool::ExecuteJob(Job* pJob)
+{
+	pJob->pfnExecute(pJob->storage);
 
-	for (auto& thread : mThreads)
+	JobCounter* pCounter = pJob->pCounter;
+	pJob->pfnExecute = nullptr;
+	pJob->pCounter = nullptr;
+	pJob->bPending.store(false, std::memory_order_release);
+	
+	if (pCounter)
+		pCounter->count.fetch_sub(1, std::memory_order_release);
+}
+
+Job* ThreadPool::GetJob(int threadIndex)
+{
+	const int numThreads = static_cast<int>(mThreadData.size());
+	const bool bRegisteredThread = threadIndex >= 0 && threadIndex < numThreads;
+	if (bRegisteredThread)
 	{
-		thread.join();
+		if (Job* pJob = mThreadData[threadIndex]->deque.Pop())
+			return pJob;
 	}
+
+	const int firstVictim = bRegisteredThread ? threadIndex + 1 : 0;
+	for (int i = 0; i < numThreads; ++i)
+	{
+		const int victim = (firstVictim + i) % numThreads;
+		if (victim == threadIndex)
+			continue;
+		if (Job* pJob = mThreadData[victim]->deque.Steal())
+			return pJob;
+	}
+	return nullptr;
 }
 
-void ThreadPool::Execute()
+void ThreadPool::AddBackgroundTask(Task&& task)
 {
-	while (true)
 	{
-		Task task;
-		{
-			std::unique_lock<std::mutex > lock(mMutex);
-			mSignal.wait(lock, [=] { return mStopThreads || !mTaskQueue.queue.empty(); });
+		std::unique_lock<std::mutex> lock(mTaskQueue.mutex);
+		mTaskQueue.queue.emplace(std::move(task));
+	}
+	++mNumQueuedJobs;
+	WakeUpWorker();
+}
 
-			if (mStopThreads)
-				break;
+void ThreadPool::WakeUpWorker()
+{
+	// mNumQueuedJobs is incremented before the check and a worker increments mNumSleepingWorkers 
+	// under the lock before checking mNumQueuedJobs, so one of the two threads will see the other's
+	// write. Locking the mutex here ensures a worker about to sleep is waiting when notified.
+	if (mNumSleepingWorkers > 0)
+	{
+		{ std::unique_lock<std::mutex> lock(mMutex); }
+		mSignal.notify_one();
+	}
+}
 
-			task = std::move(mTaskQueue.queue.front());
-			mTaskQueue.queue.pop();
-		}
-		task();
+
+//----------------------------------------------------------------------------------------------------------------
+// JOB DEQUE
+//----------------------------------------------------------------------------------------------------------------
+bool JobDeque::Push(Job* pJob)
+{
+	const int64_t b = mBottom.load(std::memory_order_relaxed);
+	const int64_t t = mTop.load(std::memory_order_acquire);
+	if (b - t >= CAPACITY)
+		return false;
+
+	mJobs[b & MASK].store(pJob, std::memory_order_relaxed);
+	mBottom.store(b + 1, std::memory_order_release); // publishes the job to the thieves
+	return true;
+}
+
+Job* JobDeque::Pop()
+{
+	const int64_t b = mBottom.load(std::memory_order_relaxed) - 1;
+	mBottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = mTop.load(std::memory_order_relaxed);
+
+	if (t > b)
+	{	// empty
+		mBottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* pJob = mJobs[b & MASK].load(std::memory_order_relaxed);
+	if (t == b)
+	{	// last job: race against the thieves
+		if (!mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			pJob = nullptr;
+		mBottom.store(b + 1, std::memory_order_relaxed);
 	}
+	return pJob;
+}
+
+Job* JobDeque::Steal()
+{
+	int64_t t = mTop.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t b = mBottom.load(std::memory_order_acquire);
+	if (t >= b)
+		return nullptr;
+
+	Job* pJob = mJobs[t & MASK].load(std::memory_order_relaxed);
+	if (!mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr; // lost the race against the owner or another thief
+	return pJob;
 }
@@ -0,0 +1,92 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include "ThreadPool.h"
+#include "Utilities/Profiler.h"
+
+#include <deque>
+#include <new>
+#include <type_traits>
+
+namespace VQEngine
+{
+	// Dependency graph of tasks executed on the ThreadPool.
+	//
+	// Tasks can only depend on the tasks added before them, so the insertion order is a
+	// valid serial execution order. When a task finishes, its successors with no pending
+	// dependencies left are submitted as jobs; one of them is continued on the same thread.
+	//
+	// Tasks are recorded as CPUProfiler entries on the executing threads, under the 
+	// profiler entry that is open on the thread calling Execute().
+	//
+	// A graph that is rebuilt every frame should be kept alive and Clear()ed instead of
+	// being recreated: Clear() keeps the task storage and the successor lists, so the
+	// graph stops allocating once it has been built with the same shape. Task callables
+	// are stored in-place in the task, like the callables of the ThreadPool jobs.
+	//
+	class TaskGraph
+	{
+	public:
+		using TaskID = int;
+
+		// @profilerEntry: taskGraph.AddTask(PROFILER_ENTRY("TaskName"), ...)
+		template<class TFn>
+		TaskID AddTask(CPUProfiler::EntryID profilerEntry, TFn&& fnTask, std::initializer_list<TaskID> dependencies = {})
+		{
+			using TCallable = typename std::decay<TFn>::type;
+			static_assert(sizeof(TCallable) <= Task::STORAGE_SIZE, "Task callable doesn't fit the task storage: capture by reference or pointer.");
+			static_assert(alignof(TCallable) <= Task::STORAGE_ALIGNMENT, "Task callable alignment exceeds the task storage alignment.");
+			static_assert(std::is_trivially_destructible<TCallable>::value, "Task callables are never destroyed: capture by reference or pointer.");
+
+			Task& task = AllocateTask(profilerEntry, dependencies);
+			new (task.storage) TCallable(std::forward<TFn>(fnTask));
+			task.pfnExecute = [](void* pStorage) { (*reinterpret_cast<TCallable*>(pStorage))(); };
+			return static_cast<TaskID>(mNumTasks - 1);
+		}
+		
+		// Executes all the tasks and returns when they're finished. 
+		// Tasks are executed serially on the calling thread if @pThreadPool is nullptr.
+		void Execute(ThreadPool* pThreadPool);
+
+		// Removes all the tasks, keeps their memory for the next use.
+		void Clear();
+
+	private:
+		struct Task
+		{
+			static constexpr size_t STORAGE_SIZE = 64;
+			static constexpr size_t STORAGE_ALIGNMENT = 16;
+			using FnExecute = void(*)(void* pStorage);
+
+			alignas(STORAGE_ALIGNMENT) unsigned char storage[STORAGE_SIZE];
+			FnExecute             pfnExecute = nullptr;
+			CPUProfiler::EntryID  profilerEntry = CPUProfiler::INVALID_ENTRY_ID;
+			std::vector<TaskID>   successors;
+			int                   numDependencies = 0;
+			std::atomic<int>      numPendingDependencies { 0 };
+		};
+
+		Task& AllocateTask(CPUProfiler::EntryID profilerEntry, std::initializer_list<TaskID> dependencies);
+		void ExecuteTask(Task& task);
+		void RunTaskChain(ThreadPool* pThreadPool, TaskID taskID, JobCounter* pCounter);
+
+		std::deque<Task> mTasks;   // deque: Task isn't movable (atomic). [mNumTasks, size) are kept for reuse.
+		size_t           mNumTasks = 0;
+	};
+}
@@ -22,13 +22,17 @@
 #include <thread>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <queue>
+#include <functional>
 #include <future>
 #include <condition_variable>
 
 // http://www.cplusplus.com/reference/thread/thread/
 // https://stackoverflow.com/a/32593825/2034041
 // todo: finish implementation for shader hotswapping
+// https://blog.molecular-matters.com/2015/08/24/job-system-2-0-lock-free-work-stealing-part-1-basics/
 
 using Task = std::function<void()>;
 
@@ -92,8 +96,64 @@ private:
 
 namespace VQEngine
 {
-	// src: https://www.youtube.com/watch?v=eWTGtp3HXiw
+	// Wait handle of a group of jobs: incremented when a job is submitted
+	// and decremented when the job finishes executing.
+	//
+	struct JobCounter
+	{
+		std::atomic<int> count { 0 };
+		inline bool IsDone() const { return count.load(std::memory_order_acquire) == 0; }
+	};
+
+	// A job stores its callable in a fixed size buffer (small-buffer storage) so that
+	// submitting a job doesn't allocate. Jobs are allocated from a ring buffer of the 
+	// submitting thread and released once they finish executing.
+	//
+	struct Job
+	{
+		static constexpr size_t STORAGE_SIZE = 64;
+		static constexpr size_t STORAGE_ALIGNMENT = 16;
+		using FnExecute = void(*)(void* pStorage); // invokes & destroys the callable in storage
+
+		alignas(STORAGE_ALIGNMENT) unsigned char storage[STORAGE_SIZE];
+		FnExecute         pfnExecute = nullptr;
+		JobCounter*       pCounter = nullptr;
+		std::atomic<bool> bPending { false };
+	};
+
+	// Fixed capacity work-stealing deque (Chase & Lev 2005, with the C11 memory orderings 
+	// from Le et al. 2013). The owner thread pushes & pops at the bottom (LIFO) and the
+	// other threads steal from the top (FIFO) without taking any locks.
+	//
+	class JobDeque
+	{
+	public:
+		static constexpr int64_t CAPACITY = 1024; // power of 2
 
+		bool Push(Job* pJob);	// owner thread only, returns false if the deque is full
+		Job* Pop();				// owner thread only
+		Job* Steal();			// any thread
+
+	private:
+		static constexpr int64_t MASK = CAPACITY - 1;
+
+		alignas(64) std::atomic<int64_t> mTop    { 0 };
+		alignas(64) std::atomic<int64_t> mBottom { 0 };
+		std::atomic<Job*>                mJobs[CAPACITY];
+	};
+
+	// Job system with per-thread work-stealing deques.
+	//
+	// - Run()         : submits a fine-grained job, e.g. per-frame culling or LOD work.
+	// - ParallelFor() : runs fn(i) for i in [begin, end) in chunks of @grain indices.
+	// - Wait()        : the waiting thread executes queued jobs until the counter reaches zero.
+	// - AddTask()     : coarse, long-running work (asset loading) returning a std::future<>.
+	//                   These tasks are only executed by the workers and never by a thread 
+	//                   that is waiting on a JobCounter, so a frame doesn't stall on a load.
+	//
+	// The thread that constructs the ThreadPool (main thread) is registered as thread 0 and
+	// can submit & wait on jobs. Jobs submitted from unregistered threads are run inline.
+	//
 	class ThreadPool
 	{
 	public:
@@ -145,27 +205,111 @@ namespace VQEngine
 			// as accesing its get_future() on the thread that calls this AddTask() function.
 			using typename task_return_t = decltype(task());
 			auto pTask = std::make_shared< std::packaged_task<task_return_t()>>(std::move(task));
-			{
-				std::unique_lock<std::mutex> lock(mMutex);
-				mTaskQueue.queue.emplace([=]
-				{					// Add a lambda function to the task queue which 
-					(*pTask)();		// calls the packaged_task<>'s callable object -> T task 
-				});
+			std::future<task_return_t> result = pTask->get_future();
+			AddBackgroundTask([=]
+			{					// Add a lambda function to the task queue which 
+				(*pTask)();		// calls the packaged_task<>'s callable object -> T task 
+			});
+			return result;
+		}
+
+		// Submits @fn as a job. If @pCounter is provided, it is incremented here and 
+		// decremented when the job finishes.
+		//
+		template<class TFn>
+		void Run(TFn&& fn, JobCounter* pCounter = nullptr)
+		{
+			using TCallable = typename std::decay<TFn>::type;
+			static_assert(sizeof(TCallable) <= Job::STORAGE_SIZE, "Job callable doesn't fit the job storage: capture by reference or pointer.");
+			static_assert(alignof(TCallable) <= Job::STORAGE_ALIGNMENT, "Job callable alignment exceeds the job storage alignment.");
+
+			Job* pJob = AllocateJob();
+			if (!pJob)
+			{	// unregistered thread or all the job slots are in use
+				fn();
+				return;
 			}
 
-			mSignal.notify_one();
-			return pTask->get_future();
+			new (pJob->storage) TCallable(std::forward<TFn>(fn));
+			pJob->pfnExecute = [](void* pStorage)
+			{
+				TCallable* pCallable = reinterpret_cast<TCallable*>(pStorage);
+				(*pCallable)();
+				pCallable->~TCallable();
+			};
+			pJob->pCounter = pCounter;
+			if (pCounter)
+				pCounter->count.fetch_add(1, std::memory_order_relaxed);
+
+			SubmitJob(pJob);
+		}
+
+		// Executes the queued jobs on the calling thread until @counter reaches zero.
+		void Wait(const JobCounter& counter);
+
+		// Calls fn(i) for each i in [begin, end). The range is split into chunks of @grain 
+		// indices which are pulled by at most (#workers + 1) jobs, including the calling 
+		// thread. Returns when all the indices are processed.
+		//
+		template<class TFn>
+		void ParallelFor(size_t begin, size_t end, size_t grain, TFn&& fn)
+		{
+			if (begin >= end)
+				return;
+
+			grain = grain == 0 ? 1 : grain;
+			const size_t numChunks = (end - begin + grain - 1) / grain;
+			const size_t numJobs = (std::min)(numChunks, mThreads.size() + 1);
+
+			std::atomic<size_t> nextChunk { 0 };
+			auto fnProcessChunks = [&]()
+			{
+				for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+				{
+					const size_t chunkBegin = begin + chunk * grain;
+					const size_t chunkEnd = (std::min)(chunkBegin + grain, end);
+					for (size_t i = chunkBegin; i < chunkEnd; ++i)
+						fn(i);
+				}
+			};
+
+			JobCounter counter;
+			for (size_t i = 1; i < numJobs; ++i)
+				Run(fnProcessChunks, &counter);
+			fnProcessChunks();
+			Wait(counter);
 		}
 
+		inline size_t GetThreadPoolSize() const { return mThreads.size(); }
+
 	private:
-		void Execute();
+		static constexpr size_t MAX_JOBS_PER_THREAD = 1024; // power of 2
+
+		struct ThreadData
+		{
+			JobDeque deque;
+			Job      jobs[MAX_JOBS_PER_THREAD];
+			size_t   nextJobIndex = 0;
+		};
+
+		void Execute(int threadIndex);
+
+		Job* AllocateJob();
+		void SubmitJob(Job* pJob);
+		void ExecuteJob(Job* pJob);
+		Job* GetJob(int threadIndex);	// pops from the own deque first, then tries stealing
+		void AddBackgroundTask(Task&& task);
+		void WakeUpWorker();
 
-		std::vector<std::thread>	mThreads;
+		std::vector<std::thread>					mThreads;
+		std::vector<std::unique_ptr<ThreadData>>	mThreadData; // [0]: main thread, [1..N]: workers
 		std::condition_variable		mSignal;
 		std::mutex					mMutex;
-		bool						mStopThreads = false;
+		std::atomic<bool>			mStopThreads { false };
+		std::atomic<int>			mNumQueuedJobs { 0 };		// jobs + background tasks
+		std::atomic<int>			mNumSleepingWorkers { 0 };
 
-		TaskQueue					mTaskQueue;
+		TaskQueue					mTaskQueue;	// background tasks (AddTask)
 	};
 
 
@@ -0,0 +1,84 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+// SIMD batch frustum culling on plain floats. This header and BatchCulling.cpp must
+// not depend on DirectXMath or D3D so that Utilities/Benchmarks/FrustumCullingBenchmark.cpp
+// builds with g++. ObjectCullingSystem.h wraps these functions for FrustumPlaneset.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BoundingBox;
+struct vec3;
+
+// Plain float copy of the 6 plane equations of FrustumPlaneset:
+// plane p is abcd[p][0] * X + abcd[p][1] * Y + abcd[p][2] * Z + abcd[p][3] = 0
+//
+struct CullingPlanes
+{
+	float abcd[6][4];
+};
+
+// Structure-of-arrays layout of world space bounding boxes for the batch culling
+// functions. Boxes are stored as center and extent (half diagonal) lanes which
+// are padded to a multiple of the SIMD width so that the culling loop never
+// has to deal with a remainder.
+//
+struct BoundingBoxSoA
+{
+	static constexpr size_t SIMD_WIDTH = 8; // max(SSE=4, AVX=8)
+
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+	size_t numBoxes = 0;
+
+	void Clear();
+	void Reserve(size_t numBoxesToReserve);
+	void AddBoundingBox(float cx, float cy, float cz, float ex, float ey, float ez);
+	void AddBoundingBox(const BoundingBox& aabb);                 // ObjectCullingSystem.cpp
+	void AddBoundingBox(const vec3& center, const vec3& extent);  // ObjectCullingSystem.cpp
+	inline size_t GetPaddedSize() const { return centerX.size(); }
+};
+
+namespace VQEngine
+{
+	// Scalar reference for the batch functions below: tests the 8 corner points of
+	// box @i of @aabbs against each plane, same as IsBoundingBoxVisibleFromFrustum().
+	//
+	bool IsBoundingBoxVisibleFromFrustum(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, size_t i);
+
+	// Tests the boxes in @aabbs against the 6 planes of @frustum, 4 (SSE) or 8 (AVX)
+	// boxes at a time using the center/extent form of the p-vertex test. Writes
+	// one bit per box into @outVisibilityMask (set bit = visible) and returns
+	// the number of visible boxes.
+	//
+	size_t CullBoundingBoxes_VisibilityMask(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, std::vector<uint32_t>& outVisibilityMask);
+
+	// Same as above, but writes the indices of the visible boxes into @outVisibleIndices
+	// in ascending order. Returns the number of culled boxes.
+	//
+	size_t CullBoundingBoxes(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, std::vector<int>& outVisibleIndices);
+
+	// Tests the boxes [@first, @first + @count) of @aabbs and appends the indices of the
+	// visible ones to @outVisibleIndices in ascending order. Returns the number of
+	// indices appended. Used for testing the objects of BVH leaves in batches.
+	//
+	size_t CullBoundingBoxRange(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, size_t first, size_t count, std::vector<int>& outVisibleIndices);
+}
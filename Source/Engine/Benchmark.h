@@ -0,0 +1,159 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include "Settings.h"
+#include "DataStructures.h"
+#include "Renderer/RenderCommands.h"
+#include "Utilities/vectormath.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+class Camera;
+class CPUProfiler;
+class Renderer;
+
+// Benchmark
+//
+// Deterministic performance runs on the null renderer backend, see Engine::RunHeadless() and 
+// Engine::RunBenchmark(). The camera follows a CameraPath evaluated at fixed time steps, so each 
+// run of a scene renders the same sequence of views and the culling & batching results of two runs
+// can be compared exactly. SceneRun collects the CPU profiler samples, the recorded renderer 
+// commands and the scene stats of each frame and reduces them into named metrics.
+//
+// Results File: JSON, written by both RunHeadless() and RunBenchmark() and used as the baseline.
+// Times are in milliseconds and the counts are averages per frame:
+//
+//   {
+//   "backend":"null", "timings":"...",
+//   "scenes":[ { "scene", "cameraPath", "frames", "timeStep", "runTime",
+//                "stages":{ "<stage>":{ "avg", "min", "max", "p50", "p95", "p99", "frames" }, ... },
+//                "renderer":{ "drawCalls", "stateChanges", <RendererStats>, "commands":{ ... } },
+//                "sceneStats":{ <SceneStats> } }, ... ]
+//   }
+//
+// The metrics are the numbers of a scene object named by their path, e.g. "stages.CPU.p95" or
+// "renderer.drawCalls". Compare() checks the metrics of a run against a baseline results file and
+// reports the ones that regressed more than the thresholds of Settings::Benchmark. The stage times
+// are CPU timings on the null renderer backend: no GPU work is submitted, hence none is timed.
+//
+namespace Benchmark
+{
+	// CPU profiler entries of the frame, the scene update & pre-render and the render passes
+	constexpr const char* PROFILED_STAGES[] =
+	{
+		"CPU", "Update()", "PreRender()", "Render()", "Present",
+		"Scene::Update()", "LODManager::Update()", "UpdateWorldTransformCache", "GatherSceneObjects",
+		"Cull_Lights", "Gather_FlattenedLightList", "Cull_MainView", "Batch_MainView", "DrawItems_MainView",
+		"Cull_ShadowViews", "Cull_Directional_Occl", "Batch_ShadowViews", "DrawItems_ShadowViews",
+		"GatherLightData", "PreRender_TaskGraph",
+		"Shadow Pass", "Geometry Pass", "AO Pass", "Lighting Pass", "Skybox & Lights", "Post Process", "Resolve AA", "UI"
+	};
+	constexpr size_t NUM_PROFILED_STAGES = sizeof(PROFILED_STAGES) / sizeof(PROFILED_STAGES[0]);
+	constexpr size_t NUM_SCENE_STATS = sizeof(SceneStats) / sizeof(int);
+
+
+	//
+	// CAMERA PATH
+	//
+	struct CameraPath
+	{
+		struct Keyframe
+		{
+			float time;			// seconds
+			vec3  position;
+			float yaw, pitch;	// radians
+		};
+
+		// Closed loop through the cameras of a scene file in @duration seconds. 
+		// A scene with a single camera gets a full turn around its position instead.
+		static CameraPath CreateFromSceneCameras(const std::vector<Settings::Camera>& cameras, float duration);
+
+		static std::string GetRecordedFilePath(const std::string& sceneName);	// Data/CameraPaths/<scene>.campath
+
+		// one keyframe per line: time x y z yaw pitch (angles in degrees)
+		bool LoadFromFile(const std::string& filePath);
+		bool SaveToFile(const std::string& filePath) const;
+
+		void AddKeyframe(float time, const Camera& camera);
+		Keyframe Evaluate(float time) const;	// Catmull-Rom spline through the keyframes
+
+		inline bool  IsEmpty() const { return keyframes.empty(); }
+		inline float GetDuration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+
+		std::vector<Keyframe> keyframes;	// sorted by time
+		bool bLoop = false;					// the last keyframe is the first one again, the path continues smoothly
+	};
+
+
+	//
+	// METRICS
+	//
+	enum EMetricType
+	{
+		FRAME_TIME = 0,
+		STAGE_TIME,
+		COUNT_LOWER_IS_BETTER,	// draw calls, state changes, heap allocations, ...
+		COUNT_HIGHER_IS_BETTER,	// culled objects & lights
+		INFO,					// not compared
+
+		METRIC_TYPE_COUNT
+	};
+
+	struct Metric
+	{
+		std::string scene;
+		std::string name;
+		float value;
+		EMetricType type;
+	};
+
+	// Per-frame data of a scene run
+	struct SceneRun
+	{
+		void AddFrame(const CPUProfiler& profiler, const Renderer& renderer, const SceneStats& sceneStats);
+
+		// scene object of the results file, @pCameraPath describes how the camera moved
+		std::string ToJSON(const std::string& sceneName, const char* pCameraPath, float timeStep, float runTime) const;
+
+		int numFrames = 0;
+		std::array<std::vector<float>, NUM_PROFILED_STAGES> stageTimes;	// ms, of the frames the stage was recorded in
+
+		// sums over the frames
+		std::array<double, RECORDED_COMMAND_COUNT> commandCounts = {};
+		double numStateChanges = 0.0;
+		std::array<double, DENDER_STATS_STRUCT_ELEM_COUNT> renderStats = {};
+		std::array<double, NUM_SCENE_STATS> sceneStats = {};
+	};
+
+	// nearest-rank percentile, @percentile in [0, 100]
+	float GetPercentile(std::vector<float> samples, float percentile);
+
+	// results file from the SceneRun::ToJSON() objects of the scenes
+	std::string GetResultsJSON(const std::vector<std::string>& sceneRunsJSON);
+
+	bool WriteResults(const std::string& filePath, const std::string& resultsJSON);
+	bool ParseResults(const char* pJSON, size_t sizeInBytes, std::vector<Metric>& metrics);
+	bool ReadResults(const std::string& filePath, std::vector<Metric>& metrics);
+
+	// Logs the metrics of @results that regressed against @baseline more than the thresholds 
+	// in @settings and returns the number of regressions.
+	int Compare(const std::vector<Metric>& results, const std::vector<Metric>& baseline, const Settings::Benchmark& settings);
+}
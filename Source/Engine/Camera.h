@@ -54,8 +54,12 @@ public:
 	FrustumPlaneset GetViewFrustumPlanes() const;
 	
 	void SetPosition(float x, float y, float z);
+	void SetTransform(const vec3& position, float yaw, float pitch);	// radians, stops the camera movement
 	void Rotate(float yaw, float pitch, const float dt);
 
+	inline float GetYaw() const { return mYaw; }
+	inline float GetPitch() const { return mPitch; }
+
 	void Reset();	// resets camera transform to initial position & orientation
 public:
 	float Drag;				// 15.0f
@@ -70,8 +74,8 @@ private:
 	XMMATRIX RotMatrix() const;
 
 private:
-	// lod manager stores vec3* mPosition and no need
-	// for an interface function to return position pointer.
+	// lod manager reads mPosition and the projection matrix
+	// of the viewer camera each update.
 	friend class LODManager; 
 
 	vec3		mPosition;
@@ -162,6 +162,10 @@ struct SceneStats
 	int numCulledShadowingSpotLights;
 	//int numCulledAreaLights;
 
+	int numPreRenderHeapAllocations; // should be 0 once the frame memory is warmed up. frame memory overflows + operator new calls
+	                                 // during PreRender() if COUNT_HEAP_ALLOCATIONS, otherwise frame memory (arena) overflows only.
+	int frameMemoryUsageKB;
+
 	// a few more meaningful stats to keep:
 	//
 	// - numCulledTrianglesMainView
@@ -173,9 +177,19 @@ struct SceneStats
 	// - ...
 
 };
+struct MemoryStats
+{
+	// GPU memory & resident CPU copies of the buffers, per buffer category
+	int vertexBufferKB;
+	int vertexBufferCPUKB;
+	int indexBufferKB;
+	int indexBufferCPUKB;
+	int computeBufferKB;
+	int computeBufferCPUKB;
+};
 struct FrameStats
 {
-	static const size_t numStat = (sizeof(int) + sizeof(RendererStats) + sizeof(SceneStats)) / sizeof(int);
+	static const size_t numStat = (sizeof(int) + sizeof(RendererStats) + sizeof(SceneStats) + sizeof(MemoryStats)) / sizeof(int);
 	union 
 	{
 		struct
@@ -183,12 +197,14 @@ struct FrameStats
 			int fps;
 			DEFINE_RENDER_STATS_STRUCT_MEMBERS;
 			SceneStats scene;
+			MemoryStats memory;
 		};
 		struct
 		{
 			int fps;
 			RendererStats rstats;
 			SceneStats scene;
+			MemoryStats memory;
 		};
 		int stats[numStat];
 	};
@@ -0,0 +1,82 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include "Application/HandleTypedefs.h"
+#include "Utilities/FrameAllocator.h"
+
+#include <vector>
+#include <cstdint>
+
+class GameObject;
+namespace VQEngine { class ThreadPool; }
+
+// Draw Item
+//
+// A visible (object, mesh) pair with a 64-bit sort key that packs the state the draw
+// needs. Sorting the keys groups the draws by state so that consecutive draws share the
+// rasterizer state, material and vertex/index buffers and Renderer::Apply() skips the
+// redundant API calls. Within a group, the draws are ordered front to back.
+//
+//  63       56 55              40 39              24 23  20 19               0
+//  | pipeline |     material     |       mesh      | LOD |      depth       |
+//
+// - pipeline : rasterizer bucket of the draw (fill/wireframe, 2D geometry). The pass selects the shader.
+// - material : material ID, items without a material are sorted last.
+// - mesh/LOD : the vertex & index buffers of the draw.
+// - depth    : quantized distance to the view, sorted near to far.
+//
+struct DrawItem
+{
+	uint64_t          key;
+	const GameObject* pObject;
+	MeshID            meshID;
+	int               lod;
+};
+using DrawItemList = FrameVector<DrawItem>;
+
+namespace DrawItemKey
+{
+	constexpr int DEPTH_BITS    = 20;
+	constexpr int LOD_BITS      = 4;
+	constexpr int MESH_BITS     = 16;
+	constexpr int MATERIAL_BITS = 16;
+	constexpr int PIPELINE_BITS = 8;
+	static_assert(DEPTH_BITS + LOD_BITS + MESH_BITS + MATERIAL_BITS + PIPELINE_BITS == 64, "Draw item key should be 64 bits");
+
+	constexpr int DEPTH_SHIFT    = 0;
+	constexpr int LOD_SHIFT      = DEPTH_SHIFT + DEPTH_BITS;
+	constexpr int MESH_SHIFT     = LOD_SHIFT + LOD_BITS;
+	constexpr int MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+	constexpr int PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+
+	constexpr unsigned PIPELINE_WIREFRAME   = 1 << 0;
+	constexpr unsigned PIPELINE_2D_GEOMETRY = 1 << 1;
+
+	// @materialID < 0 for the meshes without material. 
+	// @normalizedDepth is the distance to the view in [0, 1], clamped.
+	uint64_t Make(unsigned pipeline, int materialID, MeshID meshID, int lod, float normalizedDepth);
+}
+
+// Stable LSD radix sort of the draw items by their keys, 8 bits per pass. The passes
+// in which all the keys share the same digit (e.g. unused material bits) are skipped.
+// Histogram and scatter steps are distributed to the thread pool workers over contiguous
+// chunks of items if @pThreadPool is not nullptr. @scratch is resized to items.size(); 
+// it and the per-chunk histograms are allocated with the allocator of @scratch.
+//
+void RadixSortDrawItems(DrawItemList& items, DrawItemList& scratch, VQEngine::ThreadPool* pThreadPool);
@@ -27,6 +27,7 @@
 
 #include "Utilities/PerfTimer.h"
 #include "Utilities/Profiler.h"
+#include "Utilities/FrameAllocator.h"
 
 #include "RenderPasses/RenderPasses.h"
 
@@ -35,6 +36,7 @@
 #include "DataStructures.h"
 #include "Skybox.h"
 #include "Settings.h"
+#include "Benchmark.h"
 #include "UI.h"
 
 #include <memory>
@@ -92,12 +94,25 @@ public:
 	//----------------------------------------------------------------------------------------------------------------
 	// CORE INTERFACE
 	//----------------------------------------------------------------------------------------------------------------
-	bool			Initialize(HWND hwnd);
+	bool			Initialize(HWND hwnd);	// hwnd == nullptr initializes the null renderer backend for RunHeadless()
 	void			Exit();
 	
 	bool			Load(VQEngine::ThreadPool* pThreadPool);
 	void			SimulateAndRenderFrame();
 
+	// Loads the scene in @settings synchronously and simulates & renders @settings.numFrames frames with a 
+	// fixed time step on the null renderer backend (no window / GPU). The per-stage CPU timings, the recorded
+	// render commands and the scene stats are written into a JSON file. Requires Initialize(nullptr).
+	//
+	bool			RunHeadless(VQEngine::ThreadPool* pThreadPool, const Settings::Headless& settings);
+
+	// Renders @settings.numFrames frames of each benchmark scene on the null renderer backend with the camera
+	// following a deterministic path (see Benchmark::CameraPath). The metrics are written into the Logs folder
+	// and compared against the baseline file, which is created from the results if it doesn't exist.
+	// Returns false if the run failed or any metric regressed. Requires Initialize(nullptr).
+	//
+	bool			RunBenchmark(VQEngine::ThreadPool* pThreadPool, const Settings::Benchmark& settings);
+
 	void			SendLightData() const;
 	inline void		Pause()  { mbIsPaused = true; }
 	inline void		Unpause(){ mbIsPaused = false; }
@@ -133,11 +148,24 @@ private:
 	bool LoadSceneFromFile();
 	bool LoadScene(int level);
 	bool LoadShaders();
+	void InitializeRenderPasses();
 	bool ReloadScene();
 
+	// RunHeadless() & RunBenchmark(): synchronous loading and fixed time step frames without input handling
+	bool InitializeHeadless(VQEngine::ThreadPool* pThreadPool);
+	bool LoadSceneHeadless(int level);
+	void SimulateAndRenderFrameHeadless(float dt);
+
 	void CalcFrameStats(float dt);
 	void HandleInput();
 
+	// F9: records the active camera into Data/CameraPaths/<scene>.campath for the benchmark mode
+	void ToggleCameraPathRecording();
+	void RecordCameraPath(float dt);
+
+	// Captures the CPU profiler events of the next @numFrames frames (or until EndCapture() if @numFrames <= 0) into the Logs folder
+	void BeginProfilerCapture(int numFrames);
+
 	// prepares rendering context: gets data from scene and sets up data structures ready to be sent to GPU
 	void PreRender();
 	void Render();
@@ -215,6 +243,7 @@ private:
 	// ENGINE STATE
 	//----------------------------------------------------------------------------------------------------------------
 	FrameStats			mFrameStats;
+	FrameAllocator		mFrameAllocator;	// memory of the per-frame data: render lists, draw items, ...
 	bool				mbIsPaused;
 	bool				mbOutputDebugTexture;
 
@@ -222,6 +251,10 @@ private:
 
 	unsigned long long	mFrameCount;
 
+	bool					mbRecordingCameraPath = false;
+	float					mCameraPathRecordingTime = 0.0f;
+	Benchmark::CameraPath	mRecordedCameraPath;
+
 	//----------------------------------------------------------------------------------------------------------------
 	// THREADED LOADING
 	//---------------------------------------------------------------------------------------------------------------- 
@@ -246,6 +279,10 @@ private:
 	std::condition_variable mSignalRender;
 public:
 	static std::mutex	mLoadRenderingMutex;
+
+	// Locks mLoadRenderingMutex, waiting for it shows up as "Wait_LoadRenderingMutex" in the CPU profiler captures
+	//
+	static inline std::unique_lock<std::mutex> LockLoadRenderingMutex() { return LockAndProfileWait(mLoadRenderingMutex, PROFILER_ENTRY("Wait_LoadRenderingMutex")); }
 };
 
 #define ENGINE Engine::GetEngine()
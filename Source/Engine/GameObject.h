@@ -50,7 +50,7 @@ public:
 	inline void SetTransform(const Transform& transform) { mTransform = transform; }
 	
 	inline const Transform& GetTransform() const { return mTransform; }
-	inline const vec3& GetPosition() const { return mTransform._position; }
+	inline const vec3& GetPosition() const { return mTransform.GetPosition(); }
 	inline const ModelData& GetModelData() const { return mModel.mData; }
 	inline const std::string& GetModelName() const { return mModel.mModelName; }
 	
@@ -87,7 +87,7 @@ public:
 private:
 	// friend std::shared_ptr<GameObject> Scene::CreateNewGameObject();					// #TODO: clean up: use either friend functions or ...
 	// friend std::shared_ptr<GameObject> SerializedScene::CreateNewGameObject();
-	// friend void Parser::ParseScene(Renderer*, const std::vector<std::string>&, SerializedScene&);
+	// friend void Parser::ParseScene(ParseContext&, SerializedScene&);
 	friend class Scene;
 	friend struct SerializedScene;
 	friend class Parser;
@@ -21,10 +21,14 @@
 #include "Renderer/BufferObject.h"
 
 #include "Utilities/utils.h"
+#include "Utilities/vectormath.h"
 
 #include <vector>
+#include <cstddef>
 
 
+struct DefaultVertexBufferData;
+
 struct LODLevel
 {
 	BufferID  mVertexBufferID = -1;
@@ -45,9 +49,22 @@ struct MeshLODData
 	
 	std::vector<std::vector<VertexBufferType>> LODVertices;
 	std::vector<std::vector<unsigned>> LODIndices ;
+	std::vector<float> LODErrors; // geometric error of each level relative to the bounding sphere radius (optional)
 	std::string meshName;
 };
 
+// Non-owning view of the vertex & index data of an LOD level, e.g. in a memory mapped file
+struct LODLevelData
+{
+	const void* pVertices = nullptr;
+	const void* pIndices = nullptr;
+	unsigned    numVertices = 0;
+	unsigned    numIndices = 0;
+	unsigned    vertexStride = 0;
+	unsigned    indexStride = sizeof(unsigned);
+	float       error = 0.0f; // relative to the bounding sphere radius
+};
+
 struct Mesh
 {
 public:
@@ -71,6 +88,11 @@ public:
 	template<class VertexBufferType>
 	Mesh(const MeshLODData<VertexBufferType>& meshLODData);
 
+	// creates the buffers from the memory @pLODLevels point to, converting the DefaultVertexBufferData
+	// vertices and 32-bit indices the same way the other constructors do. The bounding box is
+	// calculated from the LOD 0 vertices unless it's provided with @pAABBMin & @pAABBMax.
+	Mesh(const LODLevelData* pLODLevels, size_t numLODLevels, const std::string& name, const float* pAABBMin = nullptr, const float* pAABBMax = nullptr);
+
 	Mesh() = default;
 	// Mesh() = delete;
 	// Mesh(const Mesh&) = delete; // Model.cpp uses copy
@@ -83,10 +105,32 @@ public:
 	// Interface
 	//
 	std::pair<BufferID, BufferID> GetIABuffers(int lod = 0) const;
+	inline int GetNumLODs() const { return static_cast<int>(mLODs.size()); }
+	inline const std::vector<float>& GetLODErrors() const { return mLODErrors; }
+
+	// local space bounding box of LOD 0, calculated once when the mesh is created
+	inline const vec3& GetAABBMin() const { return mAABBMin; }
+	inline const vec3& GetAABBMax() const { return mAABBMax; }
 
 	
+private:
+	// the vertex position is expected as the first (float3) member of the vertex
+	void CalculateAABB(const void* pVertices, size_t numVertices, size_t vertexStride);
+
+	template<class VertexBufferType>
+	static BufferID CreateVertexBuffer(const VertexBufferType* pVertices, size_t numVertices, const std::string& name);
+
+	// converts the vertices to PackedVertexBufferData if PACKED_VERTEX_FORMAT is enabled
+	static BufferID CreateVertexBuffer(const DefaultVertexBufferData* pVertices, size_t numVertices, const std::string& name);
+
+	// the index buffer uses 16-bit indices if all the vertices of the mesh can be addressed with them
+	static BufferID CreateIndexBuffer(const unsigned* pIndices, size_t numIndices, size_t numVertices, const std::string& name);
+
 private:
 	std::vector<LODLevel> mLODs;
+	std::vector<float>    mLODErrors; // empty if the LOD levels don't report their errors
+	vec3                  mAABBMin;
+	vec3                  mAABBMax;
 
 
 	// Note:
@@ -115,25 +159,17 @@ Mesh::Mesh(
 	const std::string& name
 )
 {
-	BufferDesc bufferDesc = {};
-
 	const std::string VBName = name + "_LOD[0]_VB";
 	const std::string IBName = name + "_LOD[0]_IB";
 
-	bufferDesc.mType = VERTEX_BUFFER;
-	bufferDesc.mUsage = GPU_READ_WRITE;
-	bufferDesc.mElementCount = static_cast<unsigned>(vertices.size());
-	bufferDesc.mStride = sizeof(vertices[0]);
-	BufferID vertexBufferID = spRenderer->CreateBuffer(bufferDesc, vertices.data(), VBName.c_str());
-
-	bufferDesc.mType = INDEX_BUFFER;
-	bufferDesc.mUsage = GPU_READ_WRITE;
-	bufferDesc.mElementCount = static_cast<unsigned>(indices.size());
-	bufferDesc.mStride = sizeof(unsigned);
-	BufferID indexBufferID = spRenderer->CreateBuffer(bufferDesc, indices.data(), IBName.c_str());
+	BufferID vertexBufferID = CreateVertexBuffer(vertices.data(), vertices.size(), VBName);
+	BufferID indexBufferID = CreateIndexBuffer(indices.data(), indices.size(), vertices.size(), IBName);
 
 	mLODs.push_back({ vertexBufferID, indexBufferID }); // LOD Level 0
 	mMeshName = name;
+
+	static_assert(offsetof(VertexBufferType, position) == 0, "CalculateAABB() expects the position at the beginning of the vertex");
+	CalculateAABB(vertices.data(), vertices.size(), sizeof(VertexBufferType));
 }
 
 template<class VertexBufferType>
@@ -141,24 +177,32 @@ Mesh::Mesh(const MeshLODData<VertexBufferType>& meshLODData)
 {
 	for (size_t LOD = 0; LOD < meshLODData.LODVertices.size(); ++LOD)
 	{
-		BufferDesc bufferDesc = {};
-
 		const std::string VBName = meshLODData.meshName + "_LOD[" + std::to_string(LOD) + "]_VB";
 		const std::string IBName = meshLODData.meshName + "_LOD[" + std::to_string(LOD) + "]_IB";
 
-		bufferDesc.mType = VERTEX_BUFFER;
-		bufferDesc.mUsage = GPU_READ_WRITE;
-		bufferDesc.mElementCount = static_cast<unsigned>(meshLODData.LODVertices[LOD].size());
-		bufferDesc.mStride = sizeof(meshLODData.LODVertices[LOD][0]);
-		BufferID vertexBufferID = spRenderer->CreateBuffer(bufferDesc, meshLODData.LODVertices[LOD].data(), VBName.c_str());
-
-		bufferDesc.mType = INDEX_BUFFER;
-		bufferDesc.mUsage = GPU_READ_WRITE;
-		bufferDesc.mElementCount = static_cast<unsigned>(meshLODData.LODIndices[LOD].size());
-		bufferDesc.mStride = sizeof(unsigned);
-		BufferID indexBufferID = spRenderer->CreateBuffer(bufferDesc, meshLODData.LODIndices[LOD].data(), IBName.c_str());
+		const std::vector<VertexBufferType>& vertices = meshLODData.LODVertices[LOD];
+		const std::vector<unsigned>& indices = meshLODData.LODIndices[LOD];
+		BufferID vertexBufferID = CreateVertexBuffer(vertices.data(), vertices.size(), VBName);
+		BufferID indexBufferID = CreateIndexBuffer(indices.data(), indices.size(), vertices.size(), IBName);
 
 		mLODs.push_back({ vertexBufferID, indexBufferID });
 	}
+	if (meshLODData.LODErrors.size() == meshLODData.LODVertices.size())
+		mLODErrors = meshLODData.LODErrors;
 	mMeshName = meshLODData.meshName;
+
+	static_assert(offsetof(VertexBufferType, position) == 0, "CalculateAABB() expects the position at the beginning of the vertex");
+	if (!meshLODData.LODVertices.empty())
+		CalculateAABB(meshLODData.LODVertices[0].data(), meshLODData.LODVertices[0].size(), sizeof(VertexBufferType));
+}
+
+template<class VertexBufferType>
+BufferID Mesh::CreateVertexBuffer(const VertexBufferType* pVertices, size_t numVertices, const std::string& name)
+{
+	BufferDesc bufferDesc = {};
+	bufferDesc.mType = VERTEX_BUFFER;
+	bufferDesc.mUsage = GPU_READ_WRITE;
+	bufferDesc.mElementCount = static_cast<unsigned>(numVertices);
+	bufferDesc.mStride = sizeof(VertexBufferType);
+	return spRenderer->CreateBuffer(bufferDesc, pVertices, name.c_str());
 }
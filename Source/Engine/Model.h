@@ -33,6 +33,7 @@ struct aiNode;
 struct aiMesh;
 struct aiMaterial;
 class Scene;
+namespace VQEngine { class ThreadPool; }
 
 struct MeshRenderSettings
 {
@@ -97,7 +98,8 @@ private:
 class ModelLoader
 {
 public:
-	inline void Initialize(Renderer* pRenderer) { mpRenderer = pRenderer; }
+	// @pThreadPool is used for processing the meshes of a model in parallel, can be nullptr.
+	inline void Initialize(Renderer* pRenderer, VQEngine::ThreadPool* pThreadPool) { mpRenderer = pRenderer; mpThreadPool = pThreadPool; }
 
 	// Loads the Model in a serial fashion - blocks thread
 	//
@@ -110,9 +112,17 @@ public:
 
 	void UnloadSceneModels(Scene* pScene);
 
+	// logs the cold (Assimp import + cook) vs. warm (cooked cache) load times of each loaded model.
+	// command line: -headless <scene.scn> -modelcachebenchmark
+	static bool sbBenchmarkModelCache;
 
 private:
 	static const char* sRootFolderModels;
+
+	// Loads the model from its cooked cache file if it's up to date, otherwise imports it 
+	// with Assimp and writes the cache file. Creates the meshes and materials of the model.
+	//
+	bool LoadModelData(const std::string& fullPath, const std::string& modelDirectory, Scene* pScene, ModelData& outModelData, bool& bOutCacheHit);
 	
 
 	// Key -> Value := model_path -> ModelData
@@ -127,6 +137,7 @@ private:
 	PerSceneModelNameLookupTable	mSceneModels;
 
 	Renderer*						mpRenderer;
+	VQEngine::ThreadPool*			mpThreadPool = nullptr;
 
 	std::mutex						mLoadedModelMutex;
 	std::mutex						mSceneModelsMutex;
@@ -0,0 +1,205 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include "Mesh.h"
+#include "Renderer/RenderingStructs.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Model Cache
+//
+// Cooked model files store the result of importing a model with Assimp: the final vertex & index
+// buffers of the meshes and their LOD levels, per-mesh AABBs, material parameters & texture paths
+// and the mesh references of the node hierarchy in the order they're visited.
+//
+// A cache file is rebuilt when the source model file or any of the files the import depends on
+// (e.g. the material library of an .obj file, the textures of the materials) is newer than the cache 
+// file or missing, or when the hash of the import settings (import flags, LOD generation settings)
+// stored in the cache file doesn't match. On a cache hit, the model loader memory maps the cache 
+// file and creates the GPU buffers directly from the mapped memory.
+//
+// File Layout: all the offsets are from the beginning of the file and the sections are 16-byte aligned.
+//
+//   FileHeader
+//   MaterialRecord[numMaterials]
+//   MeshRecord    [numMeshes]
+//   LODRecord     [numLODs]           : LOD levels of all the meshes, MeshRecord::firstLOD indexes them
+//   uint32_t      [numMeshReferences] : mesh index per node mesh reference
+//   uint32_t      [numDependencies]   : offsets of the dependency file paths in the string section
+//   char          [stringsSize]       : null-terminated texture & dependency paths
+//   vertex & index data of the LOD levels
+//
+namespace ModelCache
+{
+	constexpr uint32_t COOKED_MODEL_MAGIC = 0x434D5156; // 'VQMC'
+	constexpr uint32_t COOKED_MODEL_VERSION = 2;
+	constexpr uint32_t INVALID_STRING = 0xFFFFFFFF;
+
+	enum EMaterialTexture
+	{
+		DIFFUSE_MAP = 0,
+		SPECULAR_MAP,
+		NORMAL_MAP,
+		HEIGHT_MAP,
+		ALPHA_MAP,
+
+		NUM_MATERIAL_TEXTURES
+	};
+
+	enum EMaterialFlags : uint32_t
+	{
+		HAS_DIFFUSE_COLOR  = 1 << 0,
+		HAS_SPECULAR_COLOR = 1 << 1,
+		HAS_OPACITY        = 1 << 2,
+		HAS_ROUGHNESS      = 1 << 3,
+		IS_METALLIC        = 1 << 4,
+	};
+
+
+	//
+	// IMPORTED DATA: input to Cook()
+	//
+	struct ImportedMaterial
+	{
+		std::string textures[NUM_MATERIAL_TEXTURES]; // empty if the material doesn't have the texture
+		vec3        diffuse;
+		vec3        specular;
+		float       opacity = 1.0f;
+		float       roughness = 0.0f;
+		uint32_t    flags = 0;
+	};
+
+	struct ImportedMesh
+	{
+		ImportedMesh() : LODData(0, "") {}
+		uint32_t materialIndex = 0;
+		float    aabbMin[3] = { 0.0f, 0.0f, 0.0f }; // of LOD 0
+		float    aabbMax[3] = { 0.0f, 0.0f, 0.0f };
+		MeshLODData<DefaultVertexBufferData> LODData;
+	};
+
+	struct ImportedModel
+	{
+		std::vector<ImportedMaterial> materials;
+		std::vector<ImportedMesh>     meshes;
+		std::vector<uint32_t>         meshReferences;
+		std::vector<std::string>      dependencies; // material libraries, textures, ... : the files the cooked model depends on besides the model file
+	};
+
+
+	//
+	// COOKED DATA
+	//
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t importSettingsHash;
+		uint64_t fileSize;
+
+		uint32_t numMaterials;
+		uint32_t numMeshes;
+		uint32_t numLODs;
+		uint32_t numMeshReferences;
+		uint32_t numDependencies;
+		uint32_t padding;
+
+		uint64_t materialsOffset;
+		uint64_t meshesOffset;
+		uint64_t LODsOffset;
+		uint64_t meshReferencesOffset;
+		uint64_t dependenciesOffset;
+		uint64_t stringsOffset;
+		uint64_t stringsSize;
+	};
+
+	struct MaterialRecord
+	{
+		uint32_t textures[NUM_MATERIAL_TEXTURES]; // offsets in the string section or INVALID_STRING
+		float    diffuse[3];
+		float    specular[3];
+		float    opacity;
+		float    roughness;
+		uint32_t flags;
+	};
+
+	struct MeshRecord
+	{
+		uint32_t materialIndex;
+		uint32_t firstLOD;
+		uint32_t numLODs;
+		float    aabbMin[3];
+		float    aabbMax[3];
+	};
+
+	struct LODRecord
+	{
+		uint64_t verticesOffset;
+		uint64_t indicesOffset;
+		uint32_t numVertices;
+		uint32_t numIndices;
+		uint32_t vertexStride;
+		uint32_t indexStride;
+		float    error;
+		uint32_t padding;
+	};
+
+
+	// Read-only view of a cooked model in memory: a memory mapped cache file or a freshly cooked blob.
+	//
+	class CookedModel
+	{
+	public:
+		// returns false if @pData isn't a valid cooked model for @importSettingsHash
+		bool Initialize(const void* pData, size_t sizeInBytes, uint64_t importSettingsHash);
+
+		inline size_t                GetNumMaterials() const                 { return mpHeader->numMaterials; }
+		inline size_t                GetNumMeshes() const                    { return mpHeader->numMeshes; }
+		inline size_t                GetNumMeshReferences() const            { return mpHeader->numMeshReferences; }
+		inline size_t                GetNumDependencies() const              { return mpHeader->numDependencies; }
+		inline const MaterialRecord& GetMaterial(size_t materialIndex) const { return mpMaterials[materialIndex]; }
+		inline const MeshRecord&     GetMesh(size_t meshIndex) const         { return mpMeshes[meshIndex]; }
+		inline uint32_t              GetMeshReference(size_t i) const        { return mpMeshReferences[i]; }
+		inline const char*           GetDependency(size_t i) const           { return mpStrings + mpDependencies[i]; }
+
+		const char*  GetMaterialTexture(size_t materialIndex, EMaterialTexture texture) const; // nullptr if there's none
+		LODLevelData GetMeshLOD(size_t meshIndex, size_t lod) const;
+
+	private:
+		const char*           mpData = nullptr;
+		const FileHeader*     mpHeader = nullptr;
+		const MaterialRecord* mpMaterials = nullptr;
+		const MeshRecord*     mpMeshes = nullptr;
+		const LODRecord*      mpLODs = nullptr;
+		const uint32_t*       mpMeshReferences = nullptr;
+		const uint32_t*       mpDependencies = nullptr;
+		const char*           mpStrings = nullptr;
+	};
+
+
+	// returns the cooked model in the file layout above
+	std::vector<char> Cook(const ImportedModel& model, uint64_t importSettingsHash);
+
+	// <ModelCacheDirectory>/<ModelName>_<ModelPathHash>.vqmodel
+	std::string GetCacheFilePath(const std::string& modelPath);
+	bool        IsCacheDirty(const std::string& modelPath, const std::string& cachePath, const CookedModel& cookedModel);
+	bool        WriteCacheFile(const std::string& cachePath, const std::vector<char>& cookedModel);
+}
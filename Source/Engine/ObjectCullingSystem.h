@@ -19,9 +19,12 @@
 
 #include <vector>
 
+#include "BatchCulling.h"
+
 #include "Application/HandleTypedefs.h"
 
 #include "Utilities/vectormath.h"
+#include "Utilities/FrameAllocator.h"
 
 struct FrustumPlaneset;
 struct vec3;
@@ -35,6 +38,12 @@ struct BoundingBox
 	vec3 low = vec3::Zero;
 	vec3 hi = vec3::Zero;
 	DirectX::XMMATRIX GetWorldTransformationMatrix() const;
+
+	// returns the AABB enclosing this box transformed by @matTransform.
+	// handles rotation by transforming the extent with the absolute values
+	// of the rotation/scale part of the matrix (Arvo, Graphics Gems 1990).
+	BoundingBox GetTransformedAABB(const XMMATRIX& matTransform) const;
+
 	std::array<vec4, 8> GetCornerPointsV4() const;
 	std::array<vec3, 8> GetCornerPointsV3() const;
 };
@@ -57,6 +66,60 @@ struct Sphere
 	};
 };
 
+struct Cone
+{
+	Cone(const vec3& _apex, const vec3& _direction, float _halfAngleRadians, float _range) 
+		: apex(_apex), direction(_direction.normalized()), halfAngle(_halfAngleRadians), range(_range) {}
+	vec3  apex;
+	vec3  direction; // normalized
+	float halfAngle; // radians
+	float range;
+};
+
+enum ECullResult
+{
+	CULL_RESULT_OUTSIDE = 0,
+	CULL_RESULT_INTERSECTING,
+	CULL_RESULT_INSIDE,
+};
+
+// Scene-owned cache of the world transformation matrices and the world space 
+// bounding boxes of the GameObjects. An entry is recalculated only when the 
+// Transform::GetVersion() of its object changes, hence static objects cost 
+// nothing after load. Entries are indexed by the object's slot in the 
+// GameObjectPool, which doesn't move its objects once initialized.
+//
+class WorldTransformCache
+{
+public:
+	void Initialize(const std::vector<GameObject>& objectPool);
+	void Clear();
+
+	// Forces recalculation of all the entries on the next Update(). Should be called
+	// when bounding boxes of the objects change, e.g. CalculateSceneBoundingBox().
+	//
+	void Invalidate();
+
+	// Recalculates the entries of the objects with modified transforms.
+	// Returns the number of entries recalculated.
+	//
+	size_t Update(const std::vector<GameObject*>& pObjects);
+
+	inline const XMMATRIX&                 GetWorldMatrix(const GameObject* pObj)    const { return mWorldMatrices[GetIndex(pObj)]; }
+	inline const BoundingBox&              GetWorldAABB(const GameObject* pObj)      const { return mWorldAABBs[GetIndex(pObj)]; }
+	inline const std::vector<BoundingBox>& GetWorldMeshAABBs(const GameObject* pObj) const { return mWorldMeshAABBs[GetIndex(pObj)]; }
+
+private:
+	static constexpr unsigned INVALID_VERSION = 0xFFFFFFFF;
+	inline size_t GetIndex(const GameObject* pObj) const { return static_cast<size_t>(pObj - mpObjectPoolBegin); }
+
+	const GameObject*                     mpObjectPoolBegin = nullptr;
+	std::vector<unsigned>                 mTransformVersions;
+	std::vector<XMMATRIX>                 mWorldMatrices;
+	std::vector<BoundingBox>              mWorldAABBs;
+	std::vector<std::vector<BoundingBox>> mWorldMeshAABBs;
+};
+
 struct CullMeshData
 {
 	FrustumPlaneset frustumPlanes;
@@ -77,18 +140,33 @@ namespace VQEngine
 
 	bool IsIntersecting(const Sphere& s1, const Sphere& s2);
 
+	// Classifies @aabb as outside, intersecting or fully inside of the given volume.
+	// Used by hierarchical culling to reject or accept whole subtrees at once.
+	// ClassifyBoundingBoxAgainstCone() is conservative as it tests the bounding sphere of @aabb.
+	//
+	ECullResult ClassifyBoundingBoxAgainstFrustum(const FrustumPlaneset& frustum, const BoundingBox& aabb);
+	ECullResult ClassifyBoundingBoxAgainstSphere(const BoundingBox& aabb, const Sphere& sphere);
+	ECullResult ClassifyBoundingBoxAgainstCone(const BoundingBox& aabb, const Cone& cone);
+
 	// deprecated
-	size_t CullMeshes(const FrustumPlaneset& frustumPlanes, const GameObject* pObj, MeshDrawData& meshDrawData);
+	size_t CullMeshes(const FrustumPlaneset& frustumPlanes, const GameObject* pObj, const WorldTransformCache& worldCache, MeshDrawData& meshDrawData);
 
 
 	// returns the indices of visible bounding boxes
 	//
 	std::vector<int> CullMeshes(CullMeshData& data);
 
+	// FrustumPlaneset overloads of the batch culling functions in BatchCulling.h
+	//
+	CullingPlanes ToCullingPlanes(const FrustumPlaneset& frustum);
+	size_t CullBoundingBoxes_VisibilityMask(const FrustumPlaneset& frustum, const BoundingBoxSoA& aabbs, std::vector<uint32_t>& outVisibilityMask);
+	size_t CullBoundingBoxes(const FrustumPlaneset& frustum, const BoundingBoxSoA& aabbs, std::vector<int>& outVisibleIndices);
+
 	size_t CullGameObjects
 	(
 		const FrustumPlaneset&                  frustumPlanes
-		, const std::vector<const GameObject*>& pObjs
-		, std::vector<const GameObject*>&       pCulledObjs
+		, const FrameVector<const GameObject*>& pObjs
+		, const WorldTransformCache&            worldCache
+		, FrameVector<const GameObject*>&       pCulledObjs
 	);
 }
\ No newline at end of file
@@ -26,6 +26,9 @@
 #include "Camera.h"
 #include "SceneView.h"
 #include "SceneLODManager.h"
+#include "SceneBVH.h"
+
+#include "Application/TaskGraph.h"
 
 #include <memory>
 #include <mutex>
@@ -242,6 +245,7 @@ protected:
 	Renderer*					mpRenderer;
 	TextRenderer*				mpTextRenderer;
 	VQEngine::ThreadPool*		mpThreadPool;	// initialized by the Engine
+	FrameAllocator*				mpFrameAllocator = nullptr;	// initialized by the Engine
 	LODManager					mLODManager;
 
 private:
@@ -253,12 +257,14 @@ private:
 	//
 	struct ShadowingLightIndexCollection
 	{
+		ShadowingLightIndexCollection(LinearAllocator* pFrameMemory = nullptr) : spotLightIndices(pFrameMemory), pointLightIndices(pFrameMemory) {}
 		inline void Clear() { spotLightIndices.clear(); pointLightIndices.clear(); }
-		std::vector<int> spotLightIndices;
-		std::vector<int> pointLightIndices;
+		FrameVector<int> spotLightIndices;
+		FrameVector<int> pointLightIndices;
 	};
 	struct SceneShadowingLightIndexCollection
 	{
+		SceneShadowingLightIndexCollection(LinearAllocator* pFrameMemory = nullptr) : mStaticLights(pFrameMemory), mDynamicLights(pFrameMemory) {}
 		inline void Clear() { mStaticLights.Clear(); mDynamicLights.Clear(); }
 		inline size_t GetLightCount(Light::ELightType type) const
 		{
@@ -269,9 +275,10 @@ private:
 			default: return 0;
 			}
 		}
-		inline std::vector<const Light*> GetFlattenedListOfLights(const std::vector<Light>& staticLights, const std::vector<Light>& dynamicLights) const
+		inline FrameVector<const Light*> GetFlattenedListOfLights(const std::vector<Light>& staticLights, const std::vector<Light>& dynamicLights, LinearAllocator* pFrameMemory) const
 		{
-			std::vector<const Light*> pLights;
+			FrameVector<const Light*> pLights(pFrameMemory);
+			pLights.reserve(GetLightCount(Light::SPOT) + GetLightCount(Light::POINT));
 			for (const int& i : mStaticLights.spotLightIndices)   pLights.push_back(&staticLights[i]);
 			for (const int& i : mStaticLights.pointLightIndices)  pLights.push_back(&staticLights[i]);
 			for (const int& i : mDynamicLights.spotLightIndices)  pLights.push_back(&dynamicLights[i]);
@@ -294,6 +301,17 @@ private:
 
 	StaticLightCache			mStaticLightCache;
 
+	// World matrices and world space AABBs of the scene objects, 
+	// updated only when the transform of an object changes.
+	//
+	WorldTransformCache			mWorldTransformCache;
+
+	// AABB tree of the scene objects used for culling the main & shadow views.
+	// Refitted when objects move, rebuilt when objects are added.
+	//
+	SceneBVH					mBVH;
+	size_t						mNumBVHSceneObjects = 0;
+
 	friend class Engine;
 
 	GameObjectPool	mObjectPool;
@@ -310,6 +328,13 @@ private:
 	SceneView		mSceneView;
 	ShadowView		mShadowView;
 
+	// memory of the current frame's render lists, set at the beginning of PreRender().
+	// nullptr if mpFrameAllocator isn't set, in which case the lists use the heap.
+	LinearAllocator* mpFrameMemory = nullptr;
+
+	// stages of PreRender(), rebuilt every frame into the storage of the previous frame
+	VQEngine::TaskGraph mPreRenderTaskGraph;
+
 	CPUProfiler*	mpCPUProfiler;
 
 
@@ -325,19 +350,25 @@ private:
 	// PreRender() ROUTINES
 	//-------------------------------
 	void SetSceneViewData();
+	void UpdateWorldTransformCache();
+	void BuildSceneBVH();
 
-	void GatherSceneObjects(std::vector <const GameObject*>& mainViewShadowCasterRenderList, int& outNumSceneObjects);
-	void GatherLightData(SceneLightingConstantBuffer& outLightingData, const std::vector<const Light*>& pLightList);
+	void GatherSceneObjects(RenderList& mainViewShadowCasterRenderList, int& outNumSceneObjects);
+	void GatherLightData(SceneLightingConstantBuffer& outLightingData, const FrameVector<const Light*>& pLightList);
 
-	void SortRenderLists(std::vector <const GameObject*>& mainViewShadowCasterRenderList, std::vector<const Light*>& pShadowingLights);
+	// appends a draw item for each mesh of the objects in @renderList. Draw item depth is the 
+	// distance to @viewPosition normalized by @viewRange (0 for no depth sorting).
+	void BuildDrawItems(const RenderList& renderList, const vec3& viewPosition, float viewRange, bool bSortByMaterial, DrawItemList& outDrawItems) const;
+	void BuildMainViewDrawItems(bool bSortDrawItems);
+	void BuildShadowViewDrawItems(const FrameVector<const Light*>& pShadowingLights, bool bSortDrawItems);
 
 	SceneShadowingLightIndexCollection CullShadowingLights(int& outNumCulledPoints, int& outNumCulledSpots); // culls lights against main view
-	std::vector<const GameObject*> FrustumCullMainView(int& outNumCulledObjects);
-	void FrustumCullPointAndSpotShadowViews(const std::vector <const GameObject*>& mainViewShadowCasterRenderList, const SceneShadowingLightIndexCollection& shadowingLightIndices, FrameStats& stats);
+	RenderList FrustumCullMainView(int& outNumCulledObjects);
+	void FrustumCullPointAndSpotShadowViews(const RenderList& mainViewShadowCasterRenderList, const SceneShadowingLightIndexCollection& shadowingLightIndices, FrameStats& stats);
 	void OcclusionCullDirectionalLightView();
 
-	void BatchMainViewRenderList(const std::vector<const GameObject*> mainViewRenderList);
-	void BatchShadowViewRenderLists(const std::vector <const GameObject*>& mainViewShadowCasterRenderList);
+	void BatchMainViewRenderList(const RenderList& mainViewRenderList);
+	void BatchShadowViewRenderLists(const RenderList& mainViewShadowCasterRenderList);
 	//-------------------------------
 
 	void SetLightCache();
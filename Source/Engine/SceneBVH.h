@@ -0,0 +1,95 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#pragma once
+
+#include "ObjectCullingSystem.h"
+
+#include <vector>
+
+class GameObject;
+
+// Scene Bounding Volume Hierarchy
+//
+// Binary AABB tree over the world space bounding boxes of the scene objects which makes
+// the culling queries of the views (main view, spot & point light views) scale with the
+// number of visible objects rather than the total number of objects in the scene.
+//
+// - Build() is a top-down median split along the longest axis of the centroid bounds.
+//   Nodes are stored in pre-order and every node references a contiguous range of the
+//   object array, hence a node that is fully inside the query volume is accepted with
+//   a single range copy, without visiting its children.
+//
+// - QueryFrustum() tests the objects of runs of consecutive intersecting leaves in
+//   batches with the SIMD culler of BatchCulling.h, using the SoA copy of the object AABBs.
+//
+// - Refit() updates the node bounds bottom-up using the WorldTransformCache without 
+//   changing the tree topology. This is cheap but the tree quality degrades as dynamic
+//   objects move away from their initial positions; Build() can be called to restore it.
+//
+class SceneBVH
+{
+public:
+	// returns false for the objects that should be excluded from the query results
+	using ObjectFilterFn = bool(*)(const GameObject*);
+
+	void Build(const std::vector<const GameObject*>& pObjects, const WorldTransformCache& worldCache);
+	void Refit(const WorldTransformCache& worldCache);
+	void Clear();
+
+	// Query functions append the objects intersecting the query volume to @outObjects
+	// and return the number of objects appended.
+	//
+	size_t QueryFrustum(const FrustumPlaneset& frustum, FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter = nullptr) const;
+	size_t QuerySphere (const Sphere& sphere          , FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter = nullptr) const;
+	size_t QueryCone   (const Cone& cone              , FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter = nullptr) const;
+
+	inline size_t GetNumObjects() const { return mpObjects.size(); }
+	inline size_t GetNumNodes() const { return mNodes.size(); }
+	inline const BoundingBox& GetRootAABB() const { return mNodes.front().aabb; }
+
+private:
+	static constexpr int MAX_OBJECTS_PER_LEAF = 4;
+	static constexpr int MAX_TREE_DEPTH = 64;
+
+	struct Node
+	{
+		BoundingBox aabb;
+		int leftChild = -1;   // -1 for leaf nodes. right child is stored separately as
+		int rightChild = -1;  // the left subtree is in between the node and its right child.
+		int firstObject = 0;  // range in mpObjects covered by the subtree
+		int numObjects = 0;
+		inline bool IsLeaf() const { return leftChild == -1; }
+	};
+
+	// partitions [firstObject, firstObject + numObjects) of @objectOrder, the indices of the
+	// objects passed to Build(), without allocating and returns the index of the new node.
+	int BuildRecursive(int firstObject, int numObjects, std::vector<int>& objectOrder, const std::vector<vec3>& centroids);
+
+	// Traverses the tree with @fnClassifyAABB(aabb) -> ECullResult and appends 
+	// the objects in the nodes that are classified as INSIDE. The objects of the 
+	// INTERSECTING leaves are tested with @fnCullObjects(first, count, outVisibleIndices),
+	// which is called once for every run of consecutive intersecting leaves.
+	template<class TFnClassifyAABB, class TFnCullObjects>
+	size_t Query(TFnClassifyAABB&& fnClassifyAABB, TFnCullObjects&& fnCullObjects, FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter) const;
+
+	std::vector<Node>              mNodes;
+	std::vector<const GameObject*> mpObjects;        // ordered by leaves
+	std::vector<BoundingBox>       mObjectAABBs;     // world space AABBs in the same order as mpObjects
+	BoundingBoxSoA                 mObjectAABBsSoA;  // same as above, for the SIMD frustum test of the leaves
+};
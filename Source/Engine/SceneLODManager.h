@@ -30,34 +30,56 @@
 class Camera;
 class GameObject;
 class Renderer;
+class WorldTransformCache;
+namespace VQEngine { class ThreadPool; }
 
 // Scene LOD Manager
 //
 // Supports Level of Detail functionality for a limited number of meshes, where 
-// the  detail mesh to render is selected based on viewer distance.
+// the detail mesh to render is selected based on the screen-space error of the 
+// LOD levels (LOD_SELECTION_SCREEN_SPACE_ERROR) or on the viewer distance.
+//
+// Screen-space error selection:
+//
+//  Each LOD level has a geometric error relative to the bounding sphere radius of the mesh,
+//  either provided with the LODSettings or estimated from the triangle count of the level.
+//  The error projected to the screen is  error * radius * screenHeight / (2 * tan(fovY/2) * distance),
+//  and the coarsest level whose projected error stays under the pixel error budget is selected.
+//  Since the error is monotonic in the distance, this resolves to a switch distance per entry 
+//  and level, which is recalculated only when the projection or the budget changes.
+//
+//  - Hysteresis   : an entry switches to a coarser level only after its switch distance is exceeded
+//                   by the hysteresis band, and to a finer level only after the distance drops below 
+//                   the band, so the LOD levels don't flicker at the switch distances.
+//  - Triangle budget : when set, the farthest entries are degraded first until the total triangle count
+//                   of the selected levels fits in the budget.
 //
 // Limitations:
 //
-//  - LOD is implemented only for the following meshes: Cylinder, Sphere, Cone & Tessellated Grid.
-//    Mesh struct has the LOD support in it so the functionality can be extended to any mesh if needed.
+//  - LOD is implemented for the following built-in meshes: Cylinder, Sphere, Cone & Tessellated Grid,
+//    and for the imported meshes the model loader generates LOD chains for (see MeshSimplifier). 
+//    Imported meshes have no distance thresholds and stay at LOD 0 with distance based selection.
 //
-//  - LOD distances are calculated based on points, and not using bounds for the LOD object.
-//    This makes the LOD distance thresholds (at which distance LOD level changes) not very generic.
-//    This can be improved by using bounds for each LOD object during the distance
-//    calculation instead of a single point (game objects transform.position).
+//  - LOD distances are measured to the bounding sphere of the mesh, centered at the object's world
+//    position in the WorldTransformCache, hence the cache has to be updated before Update().
+//    The radius is calculated once in Initialize(). Scaling an object after the LOD manager is initialized isn't reflected 
+//    in the LOD distances. Entries without a bounding radius fall back to the distance thresholds.
 //
 //  - GetLODValue() requires GameObject* to access the LOD level of the mesh as LOD meshes are
 //    registered with a game object pointer. GBuffer pass does only have MeshID -> material info
 //    and by default uses LOD level 0 for meshes that has support of LOD functionality.
 //
-//  - Update() is single threaded and the LOD distance calculation loop is not cache friendly
-//    due to how transform.position is stored and read. This can be fixed by the following:
-//      - Differentiate between dynamic and static objects (moving / non-moving) and store their Transforms
-//        in different containers so iterating over them doesn't waste cache like iterating over GameObjects
-//        and accessing their transforms individually. 
-//      - Static Transforms can be cached but dynamic transforms will still require a read from game objects,
-//        unless GameObject class is refactored to have TransformIDs instead of Transforms, and all Transforms
-//        are stored in elsewhere in a consecutive manner and accessed as such.
+// Data Layout:
+//
+//  The LOD state is stored in structure-of-arrays layout, one entry per registered (GameObject, Mesh) 
+//  pair, with the entries of an object stored consecutively. Update() refreshes the entry positions 
+//  from the world matrices of the WorldTransformCache, which are only recalculated for the objects
+//  with modified transforms, and selects the LOD levels 4 entries at a time (SSE) by comparing the squared 
+//  viewer distance against the flattened, squared switch distances of the entries. The entries are 
+//  split between the thread pool workers when there are enough of them. The triangle budget pass 
+//  runs on the calling thread afterwards. GetLODValue() is O(1): the object's slot in the 
+//  GameObjectPool indexes its first entry, hence the pool storage must not be reallocated
+//  while the LOD manager is initialized (asserted in Update()).
 //
 constexpr size_t NUM_MAX_LOD_LEVELS = 6;
 class LODManager
@@ -67,80 +89,111 @@ public:
 
 	LODManager() = delete;
 	LODManager(std::vector<Mesh>& meshes, Renderer* pRenderer) : mMeshContainer(meshes), mpRenderer(pRenderer) {}
-	void Initialize(const Camera& camera, const std::vector<GameObject*>& pObjects);
+
+	// @objectPool is the GameObjectPool storage of @pObjects, used for the O(1) LOD lookup.
+	// Bounding boxes of the objects should be calculated before the initialization.
+	void Initialize(const Camera& camera, const std::vector<GameObject*>& pObjects, const std::vector<GameObject>& objectPool);
 
 	void Reset();
-	void Update();
-	void LateUpdate();
 
-	inline void SetViewer(const vec3* pViewerPos) { mpViewerPosition = pViewerPos; }
+	// Updates the LOD levels of the registered meshes using the thread pool workers
+	// and the calling thread, or serially on the calling thread if @pThreadPool is nullptr.
+	// @worldCache has to be up to date with the transforms of this frame.
+	void Update(VQEngine::ThreadPool* pThreadPool, const WorldTransformCache& worldCache);
+
 	void SetViewer(const Camera& camera);
+
+	// @pixelError: max. screen-space error of the selected LOD levels in pixels.
+	// @hysteresis : relative band around the switch distances, e.g. 0.1 for +/-10%.
+	// @numMaxTriangles: triangle budget of the LOD meshes, 0 disables the budget.
+	void SetPixelErrorBudget(float pixelError);
+	void SetHysteresis(float hysteresis);
+	inline void SetTriangleBudget(size_t numMaxTriangles) { mTriangleBudget = numMaxTriangles; }
+	inline size_t GetNumTriangles() const { return mNumTriangles; } // of the levels selected in the last update
 	
 	const LODSettings& GetMeshLODSettings(const GameObject* pObj, MeshID meshID) const;
 	int GetLODValue(const GameObject* pObj, MeshID meshID) const;
 
-	void RegisterMeshLOD(const GameObject* pObj, MeshID meshID, const LODSettings& _LODSettings);
+	// returns the viewer distance at which the mesh switches from its active LOD level to the next one.
+	float GetLODSwitchDistance(const GameObject* pObj, MeshID meshID) const;
+
+	// Entries of an object have to be registered consecutively.
+	void RegisterMeshLOD(const GameObject* pObj, MeshID meshID, const LODSettings& _LODSettings, float boundingRadius = 0.0f);
 
 
-	// Holds distance thresholds in world units for each LOD level.
-	// LODSettings should exist per gameobject-meshID combination.
+	// Holds distance thresholds in world units and geometric errors relative to the
+	// bounding sphere radius for each LOD level. Meshes sharing the same thresholds 
+	// and errors share the same LODSettings.
 	//
 	struct LODSettings	
 	{
-		int   activeLOD = 0;
 		std::vector<float> distanceThresholds;
+		std::vector<float> geometricErrors;     // estimated from the triangle counts if empty
 		//------------------------------------------------------------------------------------------------------------
 		static int CalculateLODValueFromSquareDistance(float sqDistance, const std::vector<float>& distanceThresholds);
 		static int CalculateLODValueFromDistance(float distance, const std::vector<float>& distanceThresholds);
-	};
-
-private:
-	// GameObjects can contain many meshes, and not all of them have the guarantee
-	// for having LOD levels. Hence we only map the necessary IDs per game object.
-	struct GameObjectLODSettings
-	{
-		std::vector<MeshID>                     LODMeshes; // duplicates keys of meshLODSettingsLookup, consider iterating over keys?
-		std::unordered_map<MeshID, LODSettings> meshLODSettingsLookup;
-		const LODSettings& GetLODSettings(MeshID meshID) const;
-	};
 
-	// Threaded update parameters
-	struct MeshLODUpdateParams
-	{
-		const GameObject* pObj;
-		MeshID meshID;
-		int newLOD;
+		// error of a curved surface approximated by @numTriangles evenly sized triangles, relative to its radius
+		static float EstimateGeometricError(size_t numTriangles);
 	};
 
+private:
+	static constexpr int    INVALID_ENTRY = -1;
+	static constexpr size_t SIMD_WIDTH = 4;
+
+	int  GetEntryIndex(const GameObject* pObj, MeshID meshID) const;
+	int  GetOrAddLODSettingsIndex(const LODSettings& lodSettings);
+	float CalculateProjectionScale() const;
+	void CalculateSwitchDistances(size_t entry);
+	void UpdateLODs(size_t firstEntry, size_t lastEntry, const vec3& viewPos, const WorldTransformCache& worldCache); // [firstEntry, lastEntry)
+	void ApplyTriangleBudget();
+	void HandleInput();
 
 
 	//
 	// DATA
 	//
-	const vec3* mpViewerPosition = nullptr;
+	const Camera* mpViewer = nullptr;
 	bool mbEnableForceLODLevels = false;
 	int  mForcedLODValue = 0;
 
-
-	// Scene will have a container of GameObjects, but not all will have LOD settings
-	// so LOD manager will only track what's necessary, stored in this container.
-	// TODO: [PERF] static vs dynamic mesh lookup (should save a transform read cache miss for static object traversal)
-	std::vector<const GameObject*>                                mLODObjects;
-	std::unordered_map <const GameObject*, GameObjectLODSettings> mSceneObjectLODSettingsLookup;
-
-	std::vector<MeshLODUpdateParams>                              mMeshLODUpdateList;
+	// selection policy
+	float  mPixelErrorBudget = 1.0f;
+	float  mHysteresis = 0.1f;
+	float  mProjectionScale = 0.0f; // screenHeight / (2 * tan(fovY/2) * pixelErrorBudget)
+	size_t mTriangleBudget = 0;
+	size_t mNumTriangles = 0;
+
+	// LOD entries (SoA), padded to a multiple of SIMD_WIDTH
+	size_t                         mNumEntries = 0;
+	std::vector<float>             mPositionX, mPositionY, mPositionZ;
+	std::vector<float>             mBoundingRadius;
+	std::vector<int>               mLODSettingsIndex;
+	std::vector<int>               mNumLODs;
+	std::vector<int>               mSelectedLOD;    // screen-space error / distance based selection with hysteresis
+	std::vector<int>               mActiveLOD;      // selected LOD after the triangle budget
+	std::vector<float>             mSqDistance;     // squared viewer distance of the last update
+	std::vector<const GameObject*> mEntryObjects;
+	std::vector<MeshID>            mEntryMeshIDs;
+
+	// squared switch distances of the entries, level-major: [lod * paddedEntryCount + entry].
+	// A level is selected when the squared viewer distance is below its switch distance; 
+	// the switch distances of the last and the unused levels are FLT_MAX so that the LOD 
+	// value never exceeds the last level of an entry.
+	std::vector<float>             mSqDistanceThresholds;
+	std::vector<unsigned>          mNumLODTriangles; // level-major: [lod * paddedEntryCount + entry]
+	std::vector<int>               mBudgetOrder;     // scratch: entries sorted by distance, farthest first
+
+	std::vector<LODSettings>       mLODSettings; // unique distance threshold sets
+
+	// first entry of the objects indexed by their slot in the GameObjectPool
+	const std::vector<GameObject>* mpObjectPool = nullptr;
+	const GameObject*              mpObjectPoolBegin = nullptr;
+	std::vector<int>               mFirstEntryPerObject;
 
 	// used to access LOD info for reporting.
-	std::vector<Mesh>&                                            mMeshContainer;
-	Renderer*                                                     mpRenderer;
-private:
-
-	const LODSettings& GetLODSettings(const GameObject* pObj, MeshID meshID) const;
-	void HandleInput();
-
-	void UpdateLODs_SingleThread();
-	void UpdateLODs_MultiThreaded_Begin();
-	void UpdateLODs_MultiThreaded_End();
+	std::vector<Mesh>&             mMeshContainer;
+	Renderer*                      mpRenderer;
 
 	//
 	// STATICS
@@ -149,4 +202,4 @@ public:
 	static void InitializeBuiltinMeshLODSettings();
 private:
 	static std::unordered_map<EGeometry, LODSettings> sBuiltinMeshLODSettings;
-};
\ No newline at end of file
+};
@@ -27,6 +27,7 @@
 
 class Scene;
 class GameObject;
+struct DrawItem;
 
 // https://en.wikibooks.org/wiki/More_C++_Idioms/Friendship_and_the_Attorney-Client
 class SceneResourceView
@@ -34,6 +35,7 @@ class SceneResourceView
 #if 1
 public:
 	static std::pair<BufferID, BufferID> GetVertexAndIndexBufferIDsOfMesh(const Scene* pScene, MeshID meshID, const GameObject* pObj = nullptr);
+	static std::pair<BufferID, BufferID> GetVertexAndIndexBufferIDsOfMesh(const Scene* pScene, const DrawItem& drawItem); // uses the LOD resolved for the draw item
 	static std::pair<BufferID, BufferID> GetBuiltinMeshVertexAndIndexBufferID(EGeometry builtInGeometry, int lod = 0);
 	static const Material* GetMaterial(const Scene* pScene, MaterialID materialID);
 	static const MeshRenderSettings::EMeshRenderMode GetMeshRenderMode(const Scene* pScene, const GameObject* pObj, MeshID meshID);
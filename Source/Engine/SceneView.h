@@ -27,22 +27,29 @@ struct DirectionalLight;
 class GameObject;
 
 #include "RenderPasses/RenderPasses.h"
+#include "Utilities/FrameAllocator.h"
+#include "DrawItem.h"
 
 // TODO: consistent & clear naming...
-using RenderList = std::vector<const GameObject*>;
+//
+// The render lists and their lookups are rebuilt every frame from the frame memory 
+// (see FrameAllocator): they have to be rebound with an allocator of the current 
+// frame, e.g. list = RenderList(pFrameMemory), before they're populated again.
+using RenderList = FrameVector<const GameObject*>;
 #if !SHADOW_PASS_USE_INSTANCED_DRAW_DATA
 using MeshDrawList = std::vector<MeshDrawData>;
 #endif
 
-using RenderListLookup                = std::unordered_map<MeshID, RenderList>;
-using LightRenderListLookup           = std::unordered_map<const Light*, RenderList>;
+using RenderListLookup                = FrameUnorderedMap<MeshID, RenderList>;
+using LightRenderListLookup           = FrameUnorderedMap<const Light*, RenderList>;
 using PointLightRenderListLookup      = std::unordered_map<const Light*, std::array<RenderList, 6>>;
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-using PointLightMeshDrawListLookup    = std::unordered_map < const Light*, std::array<MeshDrawData, 6>>;
+using PointLightMeshDrawListLookup    = FrameUnorderedMap<const Light*, std::array<MeshDrawData, 6>>;
 #else
 using PointLightMeshDrawListLookup    = std::unordered_map<const Light*, std::array<MeshDrawList, 6>>;
 #endif
-using LightInstancedRenderListLookup   = std::unordered_map<const Light*, RenderListLookup>;
+using LightInstancedRenderListLookup   = FrameUnorderedMap<const Light*, RenderListLookup>;
+using LightDrawItemListLookup          = FrameUnorderedMap<const Light*, DrawItemList>;
 
 using RenderListLookupEntry = std::pair<MeshID, RenderList>;
 
@@ -56,20 +63,34 @@ struct ShadowView
 
 	// game obj casting shadows (=render list of directional light)
 	RenderList casters;
-	RenderListLookup RenderListsPerMeshType;
+	DirectionalMeshDrawData casterInstancedDrawData; // casters w/ built-in meshes, drawn instanced
 
 	// culled render lists per shadowing light
 	LightRenderListLookup shadowMapRenderListLookUp;
 	LightInstancedRenderListLookup shadowMapInstancedRenderListLookUp;
 
+	// sorted mesh-level draws of the non-instanced casters (directional) and the spot light render lists
+	DrawItemList casterDrawItems;
+	LightDrawItemListLookup shadowMapDrawItemListLookUp;
+
 	// mesh render list (to replace other render lists which are in object-level)
 	PointLightMeshDrawListLookup shadowCubeMapMeshDrawListLookup;
 
-	void Clear()
+	void Clear(LinearAllocator* pFrameMemory)
 	{
 		spots.clear();
 		points.clear();
-		casters.clear();
+		casters                            = RenderList(pFrameMemory);
+		casterDrawItems                    = DrawItemList(pFrameMemory);
+		shadowMapRenderListLookUp          = LightRenderListLookup(pFrameMemory);
+		shadowMapInstancedRenderListLookUp = LightInstancedRenderListLookup(pFrameMemory);
+		shadowMapDrawItemListLookUp        = LightDrawItemListLookup(pFrameMemory);
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+		casterInstancedDrawData.Clear(pFrameMemory);
+		shadowCubeMapMeshDrawListLookup    = PointLightMeshDrawListLookup(pFrameMemory);
+#else
+		shadowCubeMapMeshDrawListLookup.clear();
+#endif
 		pDirectional = nullptr;
 	}
 };
@@ -98,4 +119,16 @@ struct SceneView
 	RenderList culledOpaqueList;
 	RenderListLookup culluedOpaqueInstancedRenderListLookup;
 
+	// sorted mesh-level draws of culledOpaqueList
+	DrawItemList culledOpaqueDrawItems;
+
+	void ClearRenderLists(LinearAllocator* pFrameMemory)
+	{
+		opaqueList                             = RenderList(pFrameMemory);
+		alphaList                              = RenderList(pFrameMemory);
+		culledOpaqueList                       = RenderList(pFrameMemory);
+		culluedOpaqueInstancedRenderListLookup = RenderListLookup(pFrameMemory);
+		culledOpaqueDrawItems                  = DrawItemList(pFrameMemory);
+	}
+
 };
\ No newline at end of file
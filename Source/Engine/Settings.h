@@ -107,6 +107,11 @@ namespace Settings
 		bool bConsole;
 		bool bFile;
 	};
+	struct Profiler
+	{
+		int captureFrameCount = 300;	// number of frames recorded when a capture is started with F10
+		bool bCaptureLoading = false;	// records the engine & level loading into a capture
+	};
 	struct Window
 	{
 		int width;
@@ -127,9 +132,31 @@ namespace Settings
 		float x, y, z;
 		float yaw, pitch;
 	};
+	struct Benchmark	// command line: -benchmark
+	{
+		enum ECameraPath
+		{
+			SPLINE = 0,	// closed spline through the cameras of the scene file
+			RECORDED,	// Data/CameraPaths/<scene>.campath, recorded with F9. falls back to SPLINE if it doesn't exist
+		};
+
+		int numFrames = 600;				// per scene
+		float timeStep = 1.0f / 60.0f;		// seconds
+		ECameraPath cameraPath = SPLINE;
+
+		// allowed regression in percent before a metric is reported
+		float frameTimeThreshold = 10.0f;
+		float stageTimeThreshold = 20.0f;
+		float countThreshold = 0.0f;		// draw calls, state changes, culled objects, ...
+
+		std::string baselineFile = "Data/BenchmarkBaseline.json";	// written from the results if it doesn't exist
+		std::vector<std::string> sceneNames;							// all the sceneNames of the engine if empty
+	};
 	struct Engine 
 	{
 		Logger logger;
+		Profiler profiler;
+		Benchmark benchmark;
 		Window window;
 		Rendering rendering;
 		int levelToLoad;
@@ -139,6 +166,13 @@ namespace Settings
 		// it can be useful: environment map textures can be dumped on disk.
 		bool bCacheEnvironmentMapsOnDisk = false;
 	};
+	struct Headless	// command line: -headless <scene.scn> [-frames N] [-output file.json] [-modelcachebenchmark]
+	{
+		std::string sceneName;
+		int numFrames = 600;
+		std::string outputFile;	// Logs\<time>_Headless_<scene>.json if empty
+		bool bBenchmarkModelCache = false;	// logs the cold vs. warm load times of the models of the scene
+	};
 
 
 	//------------------------------------------------------------
@@ -0,0 +1,237 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+
+#include "BatchCulling.h"
+
+#include <cassert>
+#include <cmath>
+#include <immintrin.h>
+
+// AVX tests 8 boxes per instruction, SSE tests 4.
+#if defined(__AVX__)
+#define CULL_SIMD_WIDTH 8
+#else
+#define CULL_SIMD_WIDTH 4
+#endif
+
+namespace VQEngine
+{
+	bool IsBoundingBoxVisibleFromFrustum(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, size_t i)
+	{
+		constexpr float EPSILON = 0.000002f;
+		const float center[3] = { aabbs.centerX[i], aabbs.centerY[i], aabbs.centerZ[i] };
+		const float extent[3] = { aabbs.extentX[i], aabbs.extentY[i], aabbs.extentZ[i] };
+
+		for (int p = 0; p < 6; ++p)	// for each plane
+		{
+			bool bInside = false;
+			for (int j = 0; j < 8; ++j)	// for each corner point
+			{
+				const float x = center[0] + ((j & 1) ? extent[0] : -extent[0]);
+				const float y = center[1] + ((j & 2) ? extent[1] : -extent[1]);
+				const float z = center[2] + ((j & 4) ? extent[2] : -extent[2]);
+				if (frustum.abcd[p][0] * x + frustum.abcd[p][1] * y + frustum.abcd[p][2] * z + frustum.abcd[p][3] > EPSILON)
+				{
+					bInside = true;
+					break;
+				}
+			}
+			if (!bInside)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Runs the center/extent form of the p-vertex test on CULL_SIMD_WIDTH boxes at a time:
+	//
+	//   box is outside of plane P=(n, d)  <=>  dot(n, center) + d + dot(|n|, extent) <= EPSILON
+	//
+	// which is the same test as IsBoundingBoxVisibleFromFrustum() as dot(|n|, extent) 
+	// picks the corner (p-vertex) furthest along the plane normal. @fnOnChunk(i, mask) is 
+	// called for every chunk in [chunkBegin, chunkEnd) with a lane mask of the visible 
+	// boxes [i, i+CULL_SIMD_WIDTH).
+	//
+	template<class TFnOnChunk>
+	static void CullBoundingBoxes_Impl(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, size_t chunkBegin, size_t chunkEnd, TFnOnChunk&& fnOnChunk)
+	{
+		constexpr float EPSILON = 0.000002f;
+		assert(aabbs.GetPaddedSize() % CULL_SIMD_WIDTH == 0);
+		assert(chunkBegin % CULL_SIMD_WIDTH == 0 && chunkEnd % CULL_SIMD_WIDTH == 0);
+		assert(chunkEnd <= aabbs.GetPaddedSize());
+
+#if CULL_SIMD_WIDTH == 8
+		__m256 planeA[6], planeB[6], planeC[6], planeD[6];
+		__m256 planeAbsA[6], planeAbsB[6], planeAbsC[6];
+		for (int p = 0; p < 6; ++p)
+		{
+			planeA[p] = _mm256_set1_ps(frustum.abcd[p][0]);    planeAbsA[p] = _mm256_set1_ps(std::fabs(frustum.abcd[p][0]));
+			planeB[p] = _mm256_set1_ps(frustum.abcd[p][1]);    planeAbsB[p] = _mm256_set1_ps(std::fabs(frustum.abcd[p][1]));
+			planeC[p] = _mm256_set1_ps(frustum.abcd[p][2]);    planeAbsC[p] = _mm256_set1_ps(std::fabs(frustum.abcd[p][2]));
+			planeD[p] = _mm256_set1_ps(frustum.abcd[p][3]);
+		}
+		const __m256 vEpsilon = _mm256_set1_ps(EPSILON);
+
+		for (size_t i = chunkBegin; i < chunkEnd; i += 8)
+		{
+			const __m256 cx = _mm256_loadu_ps(&aabbs.centerX[i]);
+			const __m256 cy = _mm256_loadu_ps(&aabbs.centerY[i]);
+			const __m256 cz = _mm256_loadu_ps(&aabbs.centerZ[i]);
+			const __m256 ex = _mm256_loadu_ps(&aabbs.extentX[i]);
+			const __m256 ey = _mm256_loadu_ps(&aabbs.extentY[i]);
+			const __m256 ez = _mm256_loadu_ps(&aabbs.extentZ[i]);
+
+			__m256 vVisible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int p = 0; p < 6; ++p)
+			{
+				const __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeA[p], cx), _mm256_mul_ps(planeB[p], cy)), _mm256_add_ps(_mm256_mul_ps(planeC[p], cz), planeD[p]));
+				const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeAbsA[p], ex), _mm256_mul_ps(planeAbsB[p], ey)), _mm256_mul_ps(planeAbsC[p], ez));
+				vVisible = _mm256_and_ps(vVisible, _mm256_cmp_ps(_mm256_add_ps(dist, radius), vEpsilon, _CMP_GT_OQ));
+			}
+			fnOnChunk(i, static_cast<uint32_t>(_mm256_movemask_ps(vVisible)));
+		}
+#else
+		__m128 planeA[6], planeB[6], planeC[6], planeD[6];
+		__m128 planeAbsA[6], planeAbsB[6], planeAbsC[6];
+		for (int p = 0; p < 6; ++p)
+		{
+			planeA[p] = _mm_set1_ps(frustum.abcd[p][0]);    planeAbsA[p] = _mm_set1_ps(std::fabs(frustum.abcd[p][0]));
+			planeB[p] = _mm_set1_ps(frustum.abcd[p][1]);    planeAbsB[p] = _mm_set1_ps(std::fabs(frustum.abcd[p][1]));
+			planeC[p] = _mm_set1_ps(frustum.abcd[p][2]);    planeAbsC[p] = _mm_set1_ps(std::fabs(frustum.abcd[p][2]));
+			planeD[p] = _mm_set1_ps(frustum.abcd[p][3]);
+		}
+		const __m128 vEpsilon = _mm_set1_ps(EPSILON);
+
+		for (size_t i = chunkBegin; i < chunkEnd; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(&aabbs.centerX[i]);
+			const __m128 cy = _mm_loadu_ps(&aabbs.centerY[i]);
+			const __m128 cz = _mm_loadu_ps(&aabbs.centerZ[i]);
+			const __m128 ex = _mm_loadu_ps(&aabbs.extentX[i]);
+			const __m128 ey = _mm_loadu_ps(&aabbs.extentY[i]);
+			const __m128 ez = _mm_loadu_ps(&aabbs.extentZ[i]);
+
+			__m128 vVisible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; ++p)
+			{
+				const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeA[p], cx), _mm_mul_ps(planeB[p], cy)), _mm_add_ps(_mm_mul_ps(planeC[p], cz), planeD[p]));
+				const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeAbsA[p], ex), _mm_mul_ps(planeAbsB[p], ey)), _mm_mul_ps(planeAbsC[p], ez));
+				vVisible = _mm_and_ps(vVisible, _mm_cmpgt_ps(_mm_add_ps(dist, radius), vEpsilon));
+			}
+			fnOnChunk(i, static_cast<uint32_t>(_mm_movemask_ps(vVisible)));
+		}
+#endif
+	}
+
+	// clears the lane bits of the boxes outside of [first, last)
+	static inline uint32_t MaskOutOfRange(uint32_t laneMask, size_t chunkBeginIndex, size_t first, size_t last)
+	{
+		if (first > chunkBeginIndex)
+			laneMask &= ~((1u << (first - chunkBeginIndex)) - 1u);
+		if (last < chunkBeginIndex + CULL_SIMD_WIDTH)
+			laneMask &= (1u << (last > chunkBeginIndex ? last - chunkBeginIndex : 0)) - 1u;
+		return laneMask;
+	}
+
+	static inline size_t CountBits(uint32_t mask)
+	{
+		size_t count = 0;
+		for (; mask; mask &= mask - 1) ++count;
+		return count;
+	}
+
+	size_t CullBoundingBoxes_VisibilityMask(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, std::vector<uint32_t>& outVisibilityMask)
+	{
+		outVisibilityMask.clear();
+		outVisibilityMask.resize((aabbs.GetPaddedSize() + 31) / 32, 0u);
+
+		size_t numVisible = 0;
+		CullBoundingBoxes_Impl(frustum, aabbs, 0, aabbs.GetPaddedSize(), [&](size_t i, uint32_t laneMask)
+		{
+			laneMask = MaskOutOfRange(laneMask, i, 0, aabbs.numBoxes); // padding
+			outVisibilityMask[i / 32] |= laneMask << (i % 32); // CULL_SIMD_WIDTH divides 32: chunks never straddle words
+			numVisible += CountBits(laneMask);
+		});
+		return numVisible;
+	}
+
+	size_t CullBoundingBoxes(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, std::vector<int>& outVisibleIndices)
+	{
+		outVisibleIndices.clear();
+		CullBoundingBoxRange(frustum, aabbs, 0, aabbs.numBoxes, outVisibleIndices);
+		return aabbs.numBoxes - outVisibleIndices.size();
+	}
+
+	size_t CullBoundingBoxRange(const CullingPlanes& frustum, const BoundingBoxSoA& aabbs, size_t first, size_t count, std::vector<int>& outVisibleIndices)
+	{
+		const size_t last = first + count;
+		assert(last <= aabbs.numBoxes);
+		if (count == 0)
+			return 0;
+
+		// the SoA is padded to BoundingBoxSoA::SIMD_WIDTH which is a multiple of CULL_SIMD_WIDTH,
+		// hence the chunks covering the range never read past the end of the arrays.
+		const size_t chunkBegin = (first / CULL_SIMD_WIDTH) * CULL_SIMD_WIDTH;
+		const size_t chunkEnd = ((last + CULL_SIMD_WIDTH - 1) / CULL_SIMD_WIDTH) * CULL_SIMD_WIDTH;
+
+		const size_t numVisibleBefore = outVisibleIndices.size();
+		CullBoundingBoxes_Impl(frustum, aabbs, chunkBegin, chunkEnd, [&](size_t i, uint32_t laneMask)
+		{
+			laneMask = MaskOutOfRange(laneMask, i, first, last);
+			for (; laneMask; laneMask &= laneMask - 1)
+			{
+				int lane = 0;
+				while (!(laneMask & (1u << lane))) ++lane;
+				outVisibleIndices.push_back(static_cast<int>(i) + lane);
+			}
+		});
+		return outVisibleIndices.size() - numVisibleBefore;
+	}
+}
+
+void BoundingBoxSoA::Clear()
+{
+	centerX.clear(); centerY.clear(); centerZ.clear();
+	extentX.clear(); extentY.clear(); extentZ.clear();
+	numBoxes = 0;
+}
+
+void BoundingBoxSoA::Reserve(size_t numBoxesToReserve)
+{
+	const size_t paddedSize = ((numBoxesToReserve + SIMD_WIDTH - 1) / SIMD_WIDTH) * SIMD_WIDTH;
+	centerX.reserve(paddedSize); centerY.reserve(paddedSize); centerZ.reserve(paddedSize);
+	extentX.reserve(paddedSize); extentY.reserve(paddedSize); extentZ.reserve(paddedSize);
+}
+
+void BoundingBoxSoA::AddBoundingBox(float cx, float cy, float cz, float ex, float ey, float ez)
+{
+	// the arrays are padded: overwrite the first padding element if there's one,
+	// otherwise grow the arrays by another SIMD_WIDTH of zero-sized boxes.
+	if (numBoxes == centerX.size())
+	{
+		const size_t newSize = centerX.size() + SIMD_WIDTH;
+		centerX.resize(newSize, 0.0f); centerY.resize(newSize, 0.0f); centerZ.resize(newSize, 0.0f);
+		extentX.resize(newSize, 0.0f); extentY.resize(newSize, 0.0f); extentZ.resize(newSize, 0.0f);
+	}
+
+	centerX[numBoxes] = cx; centerY[numBoxes] = cy; centerZ[numBoxes] = cz;
+	extentX[numBoxes] = ex; extentY[numBoxes] = ey; extentZ[numBoxes] = ez;
+	++numBoxes;
+}
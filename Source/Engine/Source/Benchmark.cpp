@@ -0,0 +1,586 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Benchmark.h"
+#include "Camera.h"
+
+#include "Renderer/Renderer.h"
+#include "Utilities/Profiler.h"
+#include "Utilities/Tokenizer.h"
+#include "Utilities/MemoryMappedFile.h"
+#include "Utilities/Log.h"
+#include "Utilities/utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace Benchmark
+{
+	static const char* SCENE_STATS[] =
+	{
+		"numObjects", "numSpots", "numPoints", "numMainViewCulledObjects", "numSpotsCulledObjects", "numPointsCulledObjects",
+		"numCulledShadowingPointLights", "numCulledShadowingSpotLights", "numPreRenderHeapAllocations", "frameMemoryUsageKB"
+	};
+	static const EMetricType SCENE_STAT_TYPES[] =
+	{
+		INFO, INFO, INFO, COUNT_HIGHER_IS_BETTER, COUNT_HIGHER_IS_BETTER, COUNT_HIGHER_IS_BETTER,
+		COUNT_HIGHER_IS_BETTER, COUNT_HIGHER_IS_BETTER, COUNT_LOWER_IS_BETTER, COUNT_LOWER_IS_BETTER
+	};
+	static_assert(sizeof(SCENE_STATS) / sizeof(SCENE_STATS[0]) == NUM_SCENE_STATS, "SceneStats members changed");
+	static_assert(sizeof(SCENE_STAT_TYPES) / sizeof(SCENE_STAT_TYPES[0]) == NUM_SCENE_STATS, "SceneStats members changed");
+
+	static const char* RENDER_STATS[DENDER_STATS_STRUCT_ELEM_COUNT] = { "numVertices", "numIndices", "numDrawCalls", "numTriangles" };
+	static const EMetricType RENDER_STAT_TYPES[DENDER_STATS_STRUCT_ELEM_COUNT] = { INFO, INFO, INFO, COUNT_LOWER_IS_BETTER };
+
+	// time differences below this are timer noise and not reported, regardless of the threshold percentage
+	constexpr float MIN_TIME_REGRESSION_MS = 0.05f;
+	constexpr float MIN_COUNT_REGRESSION   = 0.01f;
+
+
+	static void CreateFolderOfFile(const std::string& filePath)
+	{
+		const std::string folderPath = DirectoryUtil::GetFolderPath(filePath);
+		if (!folderPath.empty())
+			DirectoryUtil::CreateFolderIfItDoesntExist(folderPath);
+	}
+
+
+	//----------------------------------------------------------------------------------------------------------------
+	// CAMERA PATH
+	//----------------------------------------------------------------------------------------------------------------
+	// returns @angle + k * 2PI that is closest to @reference
+	static inline float UnwrapAngle(float angle, float reference)
+	{
+		return angle - XM_2PI * std::round((angle - reference) / XM_2PI);
+	}
+
+	static inline float CatmullRom(float p0, float p1, float p2, float p3, float t)
+	{
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+		return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	}
+
+	CameraPath CameraPath::CreateFromSceneCameras(const std::vector<Settings::Camera>& cameras, float duration)
+	{
+		CameraPath path;
+		if (cameras.empty())
+			return path;
+
+		path.bLoop = true;
+		if (cameras.size() == 1)
+		{	// a full turn in quarters
+			const Settings::Camera& cam = cameras[0];
+			for (int i = 0; i <= 4; ++i)
+			{
+				const Keyframe key = { duration * i / 4.0f, vec3(cam.x, cam.y, cam.z), cam.yaw * DEG2RAD + i * XM_PIDIV2, cam.pitch * DEG2RAD };
+				path.keyframes.push_back(key);
+			}
+			return path;
+		}
+
+		const size_t numCameras = cameras.size();
+		for (size_t i = 0; i <= numCameras; ++i)
+		{
+			const Settings::Camera& cam = cameras[i % numCameras];	// back to the first camera
+			Keyframe key = { duration * i / numCameras, vec3(cam.x, cam.y, cam.z), cam.yaw * DEG2RAD, cam.pitch * DEG2RAD };
+			if (i > 0)
+			{	// turn the short way around
+				key.yaw = UnwrapAngle(key.yaw, path.keyframes.back().yaw);
+			}
+			path.keyframes.push_back(key);
+		}
+		return path;
+	}
+
+	std::string CameraPath::GetRecordedFilePath(const std::string& sceneName)
+	{
+		return "Data/CameraPaths/" + DirectoryUtil::GetFileNameWithoutExtension(sceneName) + ".campath";
+	}
+
+	bool CameraPath::LoadFromFile(const std::string& filePath)
+	{
+		MemoryMappedFile file;
+		if (!file.Open(filePath))
+			return false;
+
+		keyframes.clear();
+		bLoop = false;
+
+		Tokenizer::LineReader reader(static_cast<const char*>(file.GetData()), file.GetSize());
+		Tokenizer::Line line;
+		while (reader.ReadLine(line))
+		{
+			float values[6];
+			bool bValid = line.size() == 6;
+			for (size_t i = 0; bValid && i < 6; ++i)
+				bValid = Tokenizer::ParseFloat(line[i].text, values[i]);
+			if (!bValid)
+			{
+				Log::Error("%s(%u): expected a keyframe: time x y z yaw pitch", filePath.c_str(), line.number);
+				continue;
+			}
+			if (!keyframes.empty() && values[0] <= keyframes.back().time)
+			{
+				Log::Warning("%s(%u): keyframe time %.3f is not increasing, skipping.", filePath.c_str(), line.number, values[0]);
+				continue;
+			}
+			keyframes.push_back({ values[0], vec3(values[1], values[2], values[3]), values[4] * DEG2RAD, values[5] * DEG2RAD });
+		}
+		return !keyframes.empty();
+	}
+
+	bool CameraPath::SaveToFile(const std::string& filePath) const
+	{
+		CreateFolderOfFile(filePath);
+		std::ofstream file(filePath);
+		if (!file)
+			return false;
+
+		char buffer[128];
+		file << "// time x y z yaw pitch (seconds, degrees)\n";
+		for (const Keyframe& key : keyframes)
+		{
+			snprintf(buffer, sizeof(buffer), "%.4f %.4f %.4f %.4f %.4f %.4f\n"
+				, key.time, key.position.x(), key.position.y(), key.position.z(), key.yaw * RAD2DEG, key.pitch * RAD2DEG);
+			file << buffer;
+		}
+		return true;
+	}
+
+	void CameraPath::AddKeyframe(float time, const Camera& camera)
+	{
+		keyframes.push_back({ time, camera.GetPositionF(), camera.GetYaw(), camera.GetPitch() });
+	}
+
+	CameraPath::Keyframe CameraPath::Evaluate(float time) const
+	{
+		const int numKeys = static_cast<int>(keyframes.size());
+		if (numKeys == 0) return Keyframe{ time, vec3::ZeroF3, 0.0f, 0.0f };
+		if (numKeys == 1) return Keyframe{ time, keyframes[0].position, keyframes[0].yaw, keyframes[0].pitch };
+
+		const Keyframe& first = keyframes.front();
+		const Keyframe& last = keyframes.back();
+		const float duration = last.time - first.time;
+		if (bLoop && duration > 0.0f)
+		{
+			time = std::fmod(time - first.time, duration);
+			if (time < 0.0f) time += duration;
+			time += first.time;
+		}
+		else
+		{
+			time = (std::min)((std::max)(time, first.time), last.time);
+		}
+
+		// looping paths are extended periodically so that the spline tangents at the ends match:
+		// the keyframes before/after the path are the ones from its other end, offset by a full loop.
+		auto GetKey = [&](int i) -> Keyframe
+		{
+			if (!bLoop)
+				return keyframes[(std::min)((std::max)(i, 0), numKeys - 1)];
+
+			const int numLoopKeys = numKeys - 1;
+			const int loop = (i >= 0 ? i : i - numLoopKeys + 1) / numLoopKeys;
+			const Keyframe& key = keyframes[i - loop * numLoopKeys];
+			const vec3 positionOffset = XMVectorScale(XMVectorSubtract(last.position, first.position), static_cast<float>(loop));
+			return Keyframe{ key.time + loop * duration, XMVectorAdd(key.position, positionOffset), key.yaw + loop * (last.yaw - first.yaw), key.pitch + loop * (last.pitch - first.pitch) };
+		};
+
+		const auto itNext = std::upper_bound(RANGE(keyframes), time, [](float t, const Keyframe& key) { return t < key.time; });
+		const int i = (std::min)((std::max)(static_cast<int>(std::distance(keyframes.begin(), itNext)) - 1, 0), numKeys - 2);
+
+		const Keyframe k0 = GetKey(i - 1);
+		const Keyframe& k1 = keyframes[i];
+		const Keyframe& k2 = keyframes[i + 1];
+		const Keyframe k3 = GetKey(i + 2);
+
+		const float segmentTime = k2.time - k1.time;
+		const float t = segmentTime > 0.0f ? (time - k1.time) / segmentTime : 0.0f;
+
+		Keyframe key;
+		key.time = time;
+		key.position = vec3
+		(
+			CatmullRom(k0.position.x(), k1.position.x(), k2.position.x(), k3.position.x(), t),
+			CatmullRom(k0.position.y(), k1.position.y(), k2.position.y(), k3.position.y(), t),
+			CatmullRom(k0.position.z(), k1.position.z(), k2.position.z(), k3.position.z(), t)
+		);
+		key.yaw   = CatmullRom(k0.yaw  , k1.yaw  , k2.yaw  , k3.yaw  , t);
+		key.pitch = CatmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t);
+		return key;
+	}
+
+
+	//----------------------------------------------------------------------------------------------------------------
+	// SCENE RUN
+	//----------------------------------------------------------------------------------------------------------------
+	void SceneRun::AddFrame(const CPUProfiler& profiler, const Renderer& renderer, const SceneStats& stats)
+	{
+		for (size_t i = 0; i < NUM_PROFILED_STAGES; ++i)
+		{
+			const float sample = profiler.GetEntryLastSample(PROFILED_STAGES[i]);
+			if (sample >= 0.0f)
+				stageTimes[i].push_back(sample * 1000.0f);
+		}
+
+		const CommandLog& commandLog = renderer.GetCommandLog();
+		for (size_t i = 0; i < RECORDED_COMMAND_COUNT; ++i)
+			commandCounts[i] += commandLog.counts[i];
+		numStateChanges += commandLog.GetNumStateChanges();
+
+		const RendererStats& rstats = renderer.GetRenderStats();
+		for (size_t i = 0; i < renderStats.size(); ++i)
+			renderStats[i] += rstats.arr[i];
+
+		const int* pSceneStats = reinterpret_cast<const int*>(&stats);
+		for (size_t i = 0; i < sceneStats.size(); ++i)
+			sceneStats[i] += pSceneStats[i];
+
+		++numFrames;
+	}
+
+	static float GetAverage(const std::vector<float>& samples)
+	{
+		double sum = 0.0;
+		for (const float sample : samples)
+			sum += sample;
+		return samples.empty() ? 0.0f : static_cast<float>(sum / samples.size());
+	}
+
+	// type of the metric at @path in a scene object of the results file
+	static EMetricType GetMetricType(const std::string& path)
+	{
+		auto fnEndsWith = [&](const char* pSuffix) { const size_t n = strlen(pSuffix); return path.size() >= n && path.compare(path.size() - n, n, pSuffix) == 0; };
+		if (path.compare(0, 7, "stages.") == 0)
+		{
+			const bool bFrameTime = path.compare(0, 11, "stages.CPU.") == 0;
+			if (bFrameTime && (fnEndsWith(".avg") || fnEndsWith(".p50") || fnEndsWith(".p95") || fnEndsWith(".p99")))
+				return FRAME_TIME;
+			if (!bFrameTime && (fnEndsWith(".avg") || fnEndsWith(".p95")))
+				return STAGE_TIME;
+			return INFO;
+		}
+		if (path == "renderer.drawCalls" || path == "renderer.stateChanges")
+			return COUNT_LOWER_IS_BETTER;
+		for (size_t i = 0; i < DENDER_STATS_STRUCT_ELEM_COUNT; ++i)
+			if (path == std::string("renderer.") + RENDER_STATS[i])
+				return RENDER_STAT_TYPES[i];
+		for (size_t i = 0; i < NUM_SCENE_STATS; ++i)
+			if (path == std::string("sceneStats.") + SCENE_STATS[i])
+				return SCENE_STAT_TYPES[i];
+		return INFO;
+	}
+
+	static std::string EscapeJSON(const std::string& str)
+	{
+		std::string escaped;
+		for (const char c : str)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	std::string SceneRun::ToJSON(const std::string& sceneName, const char* pCameraPath, float timeStep, float runTime) const
+	{
+		// times are in milliseconds, the counts are averages per frame
+		const double invNumFrames = 1.0 / (std::max)(numFrames, 1);
+		std::string json;
+		char buffer[384];
+		snprintf(buffer, sizeof(buffer), "{\n\"scene\":\"%s\",\n\"cameraPath\":\"%s\",\n\"frames\":%d,\n\"timeStep\":%.6f,\n\"runTime\":%.3f,\n\"stages\":{"
+			, EscapeJSON(sceneName).c_str(), pCameraPath, numFrames, timeStep, runTime);
+		json += buffer;
+		bool bFirst = true;
+		for (size_t i = 0; i < NUM_PROFILED_STAGES; ++i)
+		{
+			const std::vector<float>& samples = stageTimes[i];
+			if (samples.empty())
+				continue;
+			const auto minmax = std::minmax_element(RANGE(samples));
+			snprintf(buffer, sizeof(buffer), "%s\n\t\"%s\":{\"avg\":%.4f,\"min\":%.4f,\"max\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"frames\":%d}"
+				, bFirst ? "" : ",", PROFILED_STAGES[i], GetAverage(samples), *minmax.first, *minmax.second
+				, GetPercentile(samples, 50.0f), GetPercentile(samples, 95.0f), GetPercentile(samples, 99.0f), static_cast<int>(samples.size()));
+			json += buffer;
+			bFirst = false;
+		}
+
+		snprintf(buffer, sizeof(buffer), "\n},\n\"renderer\":{\n\t\"drawCalls\":%.2f,\n\t\"stateChanges\":%.2f"
+			, (commandCounts[CMD_DRAW] + commandCounts[CMD_DRAW_INDEXED] + commandCounts[CMD_DRAW_INDEXED_INSTANCED] + commandCounts[CMD_DISPATCH]) * invNumFrames
+			, numStateChanges * invNumFrames);
+		json += buffer;
+		for (size_t i = 0; i < renderStats.size(); ++i)
+		{
+			snprintf(buffer, sizeof(buffer), ",\n\t\"%s\":%.2f", RENDER_STATS[i], renderStats[i] * invNumFrames);
+			json += buffer;
+		}
+		json += ",\n\t\"commands\":{";
+		for (size_t i = 0; i < RECORDED_COMMAND_COUNT; ++i)
+		{
+			snprintf(buffer, sizeof(buffer), "%s\"%s\":%.2f", i == 0 ? "" : ",", CommandLog::GetCommandName(static_cast<ERecordedCommand>(i)), commandCounts[i] * invNumFrames);
+			json += buffer;
+		}
+		json += "}\n},\n\"sceneStats\":{";
+		for (size_t i = 0; i < sceneStats.size(); ++i)
+		{
+			snprintf(buffer, sizeof(buffer), "%s\n\t\"%s\":%.2f", i == 0 ? "" : ",", SCENE_STATS[i], sceneStats[i] * invNumFrames);
+			json += buffer;
+		}
+		json += "\n}\n}";
+		return json;
+	}
+
+	float GetPercentile(std::vector<float> samples, float percentile)
+	{
+		if (samples.empty())
+			return 0.0f;
+		const size_t rank = static_cast<size_t>(std::ceil(percentile * 0.01f * samples.size()));
+		const size_t index = (std::min)(rank > 0 ? rank - 1 : 0, samples.size() - 1);
+		std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+		return samples[index];
+	}
+
+
+	//----------------------------------------------------------------------------------------------------------------
+	// RESULTS
+	//----------------------------------------------------------------------------------------------------------------
+	std::string GetResultsJSON(const std::vector<std::string>& sceneRunsJSON)
+	{
+		std::string json = "{\n\"backend\":\"null\",\n\"timings\":\"CPU timings on the null renderer backend, no GPU work is submitted or timed\",\n\"scenes\":[\n";
+		for (size_t i = 0; i < sceneRunsJSON.size(); ++i)
+		{
+			json += sceneRunsJSON[i];
+			json += i + 1 < sceneRunsJSON.size() ? ",\n" : "\n";
+		}
+		json += "]\n}\n";
+		return json;
+	}
+
+	bool WriteResults(const std::string& filePath, const std::string& resultsJSON)
+	{
+		CreateFolderOfFile(filePath);
+		std::ofstream file(filePath);
+		if (!file)
+		{
+			Log::Error("Benchmark: Cannot open %s for writing.", filePath.c_str());
+			return false;
+		}
+		file << resultsJSON;
+		return true;
+	}
+
+	// Reads the values of a JSON document as (path, value) pairs: the path joins the object keys and 
+	// the array indices with '.', e.g. "scenes.0.stages.CPU.avg". Numbers & literals are kept as text.
+	class JSONReader
+	{
+	public:
+		using Values = std::vector<std::pair<std::string, std::string>>;
+
+		JSONReader(const char* pJSON, size_t sizeInBytes) : mpCurrent(pJSON), mpEnd(pJSON + sizeInBytes) {}
+		bool Read(Values& values)
+		{
+			const bool bValid = ReadValue("", values);
+			SkipWhitespace();
+			return bValid && mpCurrent == mpEnd;
+		}
+
+	private:
+		void SkipWhitespace()
+		{
+			while (mpCurrent < mpEnd && (*mpCurrent == ' ' || *mpCurrent == '\t' || *mpCurrent == '\n' || *mpCurrent == '\r'))
+				++mpCurrent;
+		}
+		bool Consume(char c)
+		{
+			SkipWhitespace();
+			if (mpCurrent >= mpEnd || *mpCurrent != c)
+				return false;
+			++mpCurrent;
+			return true;
+		}
+		bool ReadString(std::string& str)
+		{
+			if (!Consume('"'))
+				return false;
+			while (mpCurrent < mpEnd && *mpCurrent != '"')
+			{
+				if (*mpCurrent == '\\' && ++mpCurrent == mpEnd)
+					return false;
+				str += *mpCurrent++;
+			}
+			return Consume('"');
+		}
+		bool ReadValue(const std::string& path, Values& values)
+		{
+			const std::string prefix = path.empty() ? path : path + '.';
+			SkipWhitespace();
+			if (mpCurrent >= mpEnd)
+				return false;
+			if (Consume('{'))
+			{
+				if (Consume('}'))
+					return true;
+				do
+				{
+					std::string key;
+					if (!ReadString(key) || !Consume(':') || !ReadValue(prefix + key, values))
+						return false;
+				} while (Consume(','));
+				return Consume('}');
+			}
+			if (Consume('['))
+			{
+				if (Consume(']'))
+					return true;
+				int index = 0;
+				do
+				{
+					if (!ReadValue(prefix + std::to_string(index++), values))
+						return false;
+				} while (Consume(','));
+				return Consume(']');
+			}
+			if (*mpCurrent == '"')
+			{
+				std::string str;
+				if (!ReadString(str))
+					return false;
+				values.emplace_back(path, str);
+				return true;
+			}
+
+			const char* pBegin = mpCurrent;
+			while (mpCurrent < mpEnd && !strchr(",}] \t\r\n", *mpCurrent))
+				++mpCurrent;
+			if (mpCurrent == pBegin)
+				return false;
+			values.emplace_back(path, std::string(pBegin, mpCurrent));
+			return true;
+		}
+
+		const char* mpCurrent;
+		const char* mpEnd;
+	};
+
+	bool ParseResults(const char* pJSON, size_t sizeInBytes, std::vector<Metric>& metrics)
+	{
+		JSONReader::Values values;
+		if (!JSONReader(pJSON, sizeInBytes).Read(values))
+			return false;
+
+		// scenes.<i>.<metric>: the scene names come first in the scene objects
+		std::vector<std::string> sceneNames;
+		for (const std::pair<std::string, std::string>& value : values)
+		{
+			if (value.first.compare(0, 7, "scenes.") != 0)
+				continue;
+			const size_t metricBegin = value.first.find('.', 7);
+			int sceneIndex = -1;
+			if (metricBegin == std::string::npos || !Tokenizer::ParseInt(std::string_view(value.first).substr(7, metricBegin - 7), sceneIndex) || sceneIndex < 0)
+				continue;
+
+			const std::string metric = value.first.substr(metricBegin + 1);
+			if (metric == "scene")
+			{
+				sceneNames.resize((std::max)(sceneNames.size(), size_t(sceneIndex) + 1));
+				sceneNames[sceneIndex] = value.second;
+				continue;
+			}
+
+			float number;
+			if (size_t(sceneIndex) < sceneNames.size() && Tokenizer::ParseFloat(value.second, number))
+				metrics.push_back({ sceneNames[sceneIndex], metric, number, GetMetricType(metric) });
+		}
+		return true;
+	}
+
+	bool ReadResults(const std::string& filePath, std::vector<Metric>& metrics)
+	{
+		MemoryMappedFile file;
+		if (!file.Open(filePath))
+			return false;
+
+		if (!ParseResults(static_cast<const char*>(file.GetData()), file.GetSize(), metrics))
+		{
+			Log::Error("Benchmark: %s is not a valid results file.", filePath.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	int Compare(const std::vector<Metric>& results, const std::vector<Metric>& baseline, const Settings::Benchmark& settings)
+	{
+		std::unordered_map<std::string, float> baselineValues;
+		for (const Metric& metric : baseline)
+			baselineValues[metric.scene + ' ' + metric.name] = metric.value;
+
+		int numRegressions = 0;
+		int numCompared = 0;
+		int numNewMetrics = 0;
+		for (const Metric& metric : results)
+		{
+			if (metric.type == INFO)
+				continue;
+
+			const auto it = baselineValues.find(metric.scene + ' ' + metric.name);
+			if (it == baselineValues.end())
+			{
+				++numNewMetrics;
+				continue;
+			}
+			++numCompared;
+
+			const float base = it->second;
+			const float value = metric.value;
+			float threshold = settings.countThreshold;
+			bool bRegressed = false;
+			switch (metric.type)
+			{
+			case FRAME_TIME:
+			case STAGE_TIME:
+				threshold = metric.type == FRAME_TIME ? settings.frameTimeThreshold : settings.stageTimeThreshold;
+				bRegressed = value > base * (1.0f + threshold * 0.01f) && value - base > MIN_TIME_REGRESSION_MS;
+				break;
+			case COUNT_LOWER_IS_BETTER:
+				bRegressed = value > base * (1.0f + threshold * 0.01f) + MIN_COUNT_REGRESSION;
+				break;
+			case COUNT_HIGHER_IS_BETTER:
+				bRegressed = value < base * (1.0f - threshold * 0.01f) - MIN_COUNT_REGRESSION;
+				break;
+			default:
+				break;
+			}
+
+			if (bRegressed)
+			{
+				const float change = base != 0.0f ? 100.0f * (value - base) / base : 100.0f;
+				Log::Warning("Benchmark: REGRESSION %s %s: %.3f -> %.3f (%+.1f%%, threshold %.1f%%)"
+					, metric.scene.c_str(), metric.name.c_str(), base, value, change, threshold);
+				++numRegressions;
+			}
+		}
+
+		Log::Info("Benchmark: %d of %d metrics regressed. %d metrics are not in the baseline.", numRegressions, numCompared, numNewMetrics);
+		Log::Info("Benchmark: the times are CPU timings on the null renderer backend, GPU times are not measured.");
+		return numRegressions;
+	}
+}
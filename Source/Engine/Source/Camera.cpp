@@ -258,6 +258,15 @@ void Camera::SetPosition(float x, float y, float z)
 	mPosition = vec3(x, y, z);
 }
 
+void Camera::SetTransform(const vec3& position, float yaw, float pitch)
+{
+	mPosition = position;
+	mVelocity = vec3::ZeroF3;
+	mYaw = 0.0f;
+	mPitch = 0.0f;
+	Rotate(yaw, pitch, 1.0f);
+}
+
 void Camera::Rotate(float yaw, float pitch, const float dt)
 {
 	mYaw   += yaw   * dt;
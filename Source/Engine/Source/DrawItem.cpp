@@ -0,0 +1,134 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "DrawItem.h"
+
+#include "Application/ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+
+namespace DrawItemKey
+{
+	template<int NUM_BITS>
+	static inline uint64_t ClampToBits(int value)
+	{
+		constexpr int MAX_VALUE = (1 << NUM_BITS) - 1;
+		return static_cast<uint64_t>(value < 0 ? 0 : (value > MAX_VALUE ? MAX_VALUE : value));
+	}
+
+	uint64_t Make(unsigned pipeline, int materialID, MeshID meshID, int lod, float normalizedDepth)
+	{
+		constexpr int   MAX_MATERIAL = (1 << MATERIAL_BITS) - 1;
+		constexpr float MAX_DEPTH    = static_cast<float>((1 << DEPTH_BITS) - 1);
+
+		const float depth = normalizedDepth < 0.0f ? 0.0f : (normalizedDepth > 1.0f ? 1.0f : normalizedDepth);
+		const int   material = materialID < 0 ? MAX_MATERIAL : materialID;
+
+		return (ClampToBits<PIPELINE_BITS>(static_cast<int>(pipeline)) << PIPELINE_SHIFT)
+			|  (ClampToBits<MATERIAL_BITS>(material)                    << MATERIAL_SHIFT)
+			|  (ClampToBits<MESH_BITS>    (meshID)                      << MESH_SHIFT)
+			|  (ClampToBits<LOD_BITS>     (lod)                         << LOD_SHIFT)
+			|  (static_cast<uint64_t>(depth * MAX_DEPTH)                << DEPTH_SHIFT);
+	}
+}
+
+
+void RadixSortDrawItems(DrawItemList& items, DrawItemList& scratch, VQEngine::ThreadPool* pThreadPool)
+{
+	constexpr int    RADIX_BITS = 8;
+	constexpr int    NUM_BUCKETS = 1 << RADIX_BITS;
+	constexpr int    NUM_PASSES = 64 / RADIX_BITS;
+	constexpr size_t MIN_ITEMS_PER_CHUNK = 2048; // below this, threading costs more than it saves
+
+	using Histogram = std::array<size_t, NUM_BUCKETS>;
+
+	const size_t numItems = items.size();
+	if (numItems < 2)
+		return;
+	scratch.resize(numItems);
+
+	const size_t numThreads = pThreadPool ? pThreadPool->GetThreadPoolSize() + 1 : 1;
+	const size_t numChunks = std::max<size_t>(1, std::min(numThreads, numItems / MIN_ITEMS_PER_CHUNK));
+	const size_t chunkSize = (numItems + numChunks - 1) / numChunks;
+
+	auto fnRunChunks = [&](auto&& fnChunk)
+	{
+		if (numChunks > 1)
+			pThreadPool->ParallelFor(0, numChunks, 1, fnChunk);
+		else
+			fnChunk(0);
+	};
+
+	// histogram[chunk] is the digit count of the chunk, then the write offset of the chunk per digit.
+	FrameVector<Histogram> histograms(numChunks, scratch.get_allocator());
+	DrawItem* pSrc = items.data();
+	DrawItem* pDst = scratch.data();
+
+	for (int pass = 0; pass < NUM_PASSES; ++pass)
+	{
+		const int shift = pass * RADIX_BITS;
+
+		// COUNT
+		fnRunChunks([&](size_t chunk)
+		{
+			Histogram& histogram = histograms[chunk];
+			histogram.fill(0);
+			const size_t end = std::min(numItems, (chunk + 1) * chunkSize);
+			for (size_t i = chunk * chunkSize; i < end; ++i)
+				++histogram[(pSrc[i].key >> shift) & (NUM_BUCKETS - 1)];
+		});
+
+		// PREFIX SUM: digit-major, chunk-minor to keep the sort stable
+		bool bSingleDigit = false;
+		size_t offset = 0;
+		for (int digit = 0; digit < NUM_BUCKETS; ++digit)
+		{
+			size_t digitCount = 0;
+			for (size_t chunk = 0; chunk < numChunks; ++chunk)
+			{
+				const size_t count = histograms[chunk][digit];
+				histograms[chunk][digit] = offset;
+				offset += count;
+				digitCount += count;
+			}
+			if (digitCount == numItems)
+			{
+				bSingleDigit = true;
+				break;
+			}
+		}
+		if (bSingleDigit) // all the keys have the same digit: the pass wouldn't change the order
+			continue;
+
+		// SCATTER
+		fnRunChunks([&](size_t chunk)
+		{
+			Histogram& offsets = histograms[chunk];
+			const size_t end = std::min(numItems, (chunk + 1) * chunkSize);
+			for (size_t i = chunk * chunkSize; i < end; ++i)
+				pDst[offsets[(pSrc[i].key >> shift) & (NUM_BUCKETS - 1)]++] = pSrc[i];
+		});
+
+		std::swap(pSrc, pDst);
+	}
+
+	if (pSrc != items.data())
+	{
+		items.swap(scratch);
+	}
+}
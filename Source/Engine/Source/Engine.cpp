@@ -40,9 +40,14 @@
 //
 #define LOAD_ASYNC 1
 // -------------------------------------------------------
+
+// Initial size of each of the two frame memory buffers, grows 
+// to the high-water mark if a frame needs more memory.
+constexpr size_t FRAME_MEMORY_SIZE_IN_BYTES = 4 * 1024 * 1024;
 #include "Engine.h"
 #include "Camera.h"
 #include "SceneResourceView.h"
+#include "ObjectCullingSystem.h"
 
 #include "Application/Application.h"
 #include "Application/Input.h"
@@ -52,6 +57,7 @@
 #include "Utilities/PerfTimer.h"
 #include "Utilities/CustomParser.h"
 #include "Utilities/Profiler.h"
+#include "Utilities/utils.h"
 
 #include "Renderer/Renderer.h"
 #include "Renderer/TextRenderer.h"
@@ -66,6 +72,7 @@
 #include "Scenes/LODTestScene.h"
 
 #include <sstream>
+#include <fstream>
 #include <DirectXMath.h>
 
 using namespace VQEngine;
@@ -151,6 +158,7 @@ Engine::Engine()
 	, mpTimer(new PerfTimer()) 
 	, mpCPUProfiler(new CPUProfiler())
 	, mpGPUProfiler(new GPUProfiler())
+	, mpActiveScene(nullptr)
 	, mbUsePaniniProjection(false)
 	, mFrameCount(0)
 	, mAccumulator(0.0f)
@@ -172,14 +180,19 @@ Engine::~Engine(){}
 bool Engine::Initialize(HWND hwnd)
 {
 	Log::Info("[ENGINE]: Initializing --------------------");
+	CPUProfiler::SetThreadName("Main Thread");
 	if (!mpRenderer || !mpInput || !mpTimer)
 	{
 		Log::Error("Nullptr Engine::Init()\n");
 		return false;
 	}
 
+	const bool bHeadless = hwnd == nullptr;
 	mpTimer->Start();
-	StartRenderThread();
+	if (!bHeadless)
+	{	// headless mode loads synchronously, there's no loading screen to render
+		StartRenderThread();
+	}
 
 
 	// INITIALIZE SYSTEMS
@@ -188,7 +201,10 @@ bool Engine::Initialize(HWND hwnd)
 	const Settings::Window& windowSettings = sEngineSettings.window;
 
 	mpInput->Initialize();
-	if (!mpRenderer->Initialize(hwnd, windowSettings, sEngineSettings.rendering))
+	const bool bRendererInitialized = bHeadless
+		? mpRenderer->InitializeNullBackend(windowSettings, sEngineSettings.rendering)
+		: mpRenderer->Initialize(hwnd, windowSettings, sEngineSettings.rendering);
+	if (!bRendererInitialized)
 	{
 		Log::Error("Cannot initialize Renderer.\n");
 		return false;
@@ -196,6 +212,10 @@ bool Engine::Initialize(HWND hwnd)
 
 	Scene::InitializeBuiltinMeshes();
 	LoadShaders();
+
+	// create the ModelCache folder if it doesn't exist
+	Application::s_ModelCacheDirectory = Application::s_WorkspaceDirectory + "\\ModelCache";
+	DirectoryUtil::CreateFolderIfItDoesntExist(Application::s_ModelCacheDirectory);
 	
 	if (!mpTextRenderer->Initialize(mpRenderer))
 	{
@@ -204,7 +224,10 @@ bool Engine::Initialize(HWND hwnd)
 	}
 
 	mUI.Initialize(mpRenderer, mpTextRenderer, UI::ProfilerStack{mpCPUProfiler, mpGPUProfiler});
-	mpGPUProfiler->Init(mpRenderer->m_deviceContext, mpRenderer->m_device);
+	if (!bHeadless)
+	{
+		mpGPUProfiler->Init(mpRenderer->m_deviceContext, mpRenderer->m_device);
+	}
 
 	// INITIALIZE RENDER PASSES & SCENES
 	//--------------------------------------------------------------
@@ -239,8 +262,12 @@ bool Engine::Initialize(HWND hwnd)
 bool Engine::Load(ThreadPool* pThreadPool)
 {
 	Log::Info("[ENGINE]: Loading -------------------------");
-	mpCPUProfiler->BeginProfile();
 	mpThreadPool = pThreadPool;
+	mFrameAllocator.Initialize(FRAME_MEMORY_SIZE_IN_BYTES);
+	if (sEngineSettings.profiler.bCaptureLoading)
+	{
+		BeginProfilerCapture(0);	// ends when the loading is finished
+	}
 	
 	// prepare loading screen resources
 	mLoadingScreenTextures.push_back(mpRenderer->CreateTextureFromFile("LoadingScreen/0.png"));
@@ -264,6 +291,7 @@ bool Engine::Load(ThreadPool* pThreadPool)
 	// set up a parallel task to load everything.
 	auto AsyncEngineLoad = [&]() -> bool
 	{
+		PROFILE_SCOPE("EngineLoad_Async");
 		PerfTimer timer;
 		timer.Start();
 		// LOAD ENVIRONMENT MAPS
@@ -273,7 +301,7 @@ bool Engine::Load(ThreadPool* pThreadPool)
 		Skybox::InitializePresets_Async(mpRenderer, sEngineSettings.rendering);
 #else
 		{
-			std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+			std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 			Skybox::InitializePresets(mpRenderer, sEngineSettings.rendering);
 		}
 #endif
@@ -289,7 +317,7 @@ bool Engine::Load(ThreadPool* pThreadPool)
 		sEngineSettings.levelToLoad = OVERRIDE_LEVEL_VALUE;
 #endif
 		{
-			std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
+			std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 			mShadowMapPass.Initialize(mpRenderer, sEngineSettings.rendering.shadowMap);
 		}
 		
@@ -305,41 +333,9 @@ bool Engine::Load(ThreadPool* pThreadPool)
 
 		// RENDER PASS INITIALIZATION
 		//
-		const bool bAAResolve = sEngineSettings.rendering.antiAliasing.IsAAEnabled();
 		Log::Info("\tINITIALIZE RENDER PASSES ===");
 		//mpTimer->Start();
-		{	// #AsyncLoad: Mutex DEVICE
-			//Log::Info("---------------- INITIALIZING RENDER PASSES ---------------- ");
-			//renderer->m_Direct3D->ReportLiveObjects();
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mPostProcessPass.Initialize(mpRenderer, sEngineSettings.rendering.postProcess);
-			}
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mDeferredRenderingPasses.Initialize(mpRenderer, bAAResolve);
-			}
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mDebugPass.Initialize(mpRenderer);
-			}
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mAOPass.Initialize(mpRenderer);
-			}
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mZPrePass.Initialize(mpRenderer);
-			}
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mForwardLightingPass.Initialize(mpRenderer);
-			}
-			{
-				std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
-				mAAResolvePass.Initialize(mpRenderer, mpRenderer->GetRenderTargetTexture(mDeferredRenderingPasses._shadeTarget));
-			}
-		}
+		InitializeRenderPasses();
 		//mpTimer->Stop();
 		//Log::Info("---------------- INITIALIZING RENDER PASSES DONE IN %.2fs ---------------- ", mpTimer->DeltaTime());
 		//mpCPUProfiler->EndEntry();
@@ -359,6 +355,7 @@ bool Engine::Load(ThreadPool* pThreadPool)
 	// LOAD ENVIRONMENT MAPS
 	//
 	mpTimer->Start();
+	mpCPUProfiler->BeginProfile();
 	mpCPUProfiler->BeginEntry("EngineLoad");
 	Log::Info("-------------------- LOADING ENVIRONMENT MAPS --------------------- ");
 	Skybox::InitializePresets(mpRenderer, sEngineSettings.rendering);
@@ -397,7 +394,11 @@ bool Engine::Load(ThreadPool* pThreadPool)
 	Log::Info("---------------- INITIALIZING RENDER PASSES DONE IN %.2fs ---------------- ", mpTimer->StopGetDeltaTimeAndReset());
 	mpCPUProfiler->EndEntry();
 	mpCPUProfiler->EndProfile();
-	mpCPUProfiler->BeginProfile();
+	mpCPUProfiler->Clear();	// reset the cpu profiler entries
+	if (sEngineSettings.profiler.bCaptureLoading)
+	{
+		mpCPUProfiler->EndCapture();
+	}
 	Log::Info("[ENGINE]: Loaded (Async) ------------------");
 #endif
 
@@ -406,12 +407,48 @@ bool Engine::Load(ThreadPool* pThreadPool)
 
 
 
+void Engine::InitializeRenderPasses()
+{	// #AsyncLoad: Mutex DEVICE
+	//Log::Info("---------------- INITIALIZING RENDER PASSES ---------------- ");
+	//renderer->m_Direct3D->ReportLiveObjects();
+	const bool bAAResolve = sEngineSettings.rendering.antiAliasing.IsAAEnabled();
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mPostProcessPass.Initialize(mpRenderer, sEngineSettings.rendering.postProcess);
+	}
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mDeferredRenderingPasses.Initialize(mpRenderer, bAAResolve);
+	}
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mDebugPass.Initialize(mpRenderer);
+	}
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mAOPass.Initialize(mpRenderer);
+	}
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mZPrePass.Initialize(mpRenderer);
+	}
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mForwardLightingPass.Initialize(mpRenderer);
+	}
+	{
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
+		mAAResolvePass.Initialize(mpRenderer, mpRenderer->GetRenderTargetTexture(mDeferredRenderingPasses._shadeTarget));
+	}
+}
+
 bool Engine::LoadSceneFromFile()
 {
+	PROFILE_SCOPE("LoadSceneFromFile");
 	mCurrentLevel = sEngineSettings.levelToLoad;
 	SerializedScene mSerializedScene;
 	{
-		std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		mSerializedScene = Parser::ReadScene(mpRenderer, sEngineSettings.sceneNames[mCurrentLevel]);
 	}
 	if (mSerializedScene.loadSuccess == '0')
@@ -423,6 +460,7 @@ bool Engine::LoadSceneFromFile()
 	assert(mCurrentLevel < mpScenes.size());
 	mpActiveScene = mpScenes[mCurrentLevel];
 	mpActiveScene->mpThreadPool = mpThreadPool;
+	mpActiveScene->mpFrameAllocator = &mFrameAllocator;
 
 	mpActiveScene->LoadScene(mSerializedScene, sEngineSettings.window);
 
@@ -434,7 +472,7 @@ bool Engine::LoadSceneFromFile()
 	if (mpActiveScene->mDirectionalLight.mbEnabled)
 	{
 		// #AsyncLoad: Mutex DEVICE
-		std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		mShadowMapPass.InitializeDirectionalLightShadowMap(sEngineSettings.rendering.shadowMap);
 	}
 	return true;
@@ -448,8 +486,9 @@ bool Engine::LoadScene(int level)
 	Log::Info("LoadScene: %d", level);
 	auto loadFn = [&, level]()
 	{
+		PROFILE_SCOPE("LoadScene");
 		{
-			std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
+			std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 
 			mpRenderer->UnbindDepthTarget();
 			mpRenderer->UnbindRenderTargets();
@@ -539,11 +578,11 @@ bool Engine::LoadShaders()
 
 void Engine::Exit()
 {
-	mpCPUProfiler->EndProfile();
 	mpGPUProfiler->Exit();
 	mUI.Exit();
 	mpTextRenderer->Exit();
 	mpRenderer->Exit();
+	mFrameAllocator.Exit();
 
 	Log::Exit();
 	if (sInstance)
@@ -582,20 +621,26 @@ void Engine::SimulateAndRenderFrame()
 		if (mRenderThread.joinable())
 		{	// Transition to single threaded rendering
 			StopRenderThreadAndWait();		// blocks execution
-			mpCPUProfiler->EndProfile();	// reset the cpu profiler entries
-			mpCPUProfiler->BeginProfile();
+			if (sEngineSettings.profiler.bCaptureLoading)
+			{
+				mpCPUProfiler->EndCapture();
+			}
 		}
 #endif
 
-		mpCPUProfiler->BeginEntry("CPU");
+		mpCPUProfiler->BeginProfile(mFrameCount);
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("CPU"));
 		if (!mbIsPaused)
 		{
 			CalcFrameStats(dt);
 
-			mpCPUProfiler->BeginEntry("Update()");
+			mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Update()"));
 			mpActiveScene->UpdateScene(dt);
 			mpCPUProfiler->EndEntry();	// Update
 
+			if (mbRecordingCameraPath)
+				RecordCameraPath(dt);
+
 			PreRender();
 			Render();
 		}
@@ -605,13 +650,14 @@ void Engine::SimulateAndRenderFrame()
 
 		// PRESENT THE FRAME
 		//
-		mpCPUProfiler->BeginEntry("Present");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Present"));
 		mpRenderer->EndFrame();
 		mpCPUProfiler->EndEntry();
 
 
 		mpCPUProfiler->EndEntry();	// CPU
 		mpCPUProfiler->StateCheck();
+		mpCPUProfiler->EndProfile(mFrameCount);
 
 
 		++mFrameCount;
@@ -630,6 +676,11 @@ void Engine::SimulateAndRenderFrame()
 		mLevelLoadQueue.pop();
 		mpCPUProfiler->Clear();
 		mpGPUProfiler->Clear();
+		mbRecordingCameraPath = false;	// the path belongs to the unloaded scene
+		if (sEngineSettings.profiler.bCaptureLoading)
+		{
+			BeginProfilerCapture(0);	// ends when the loading is finished
+		}
 #if LOAD_ASYNC
 		StartRenderThread();
 		mbLoading = true;
@@ -639,12 +690,229 @@ void Engine::SimulateAndRenderFrame()
 	}
 }
 
+bool Engine::InitializeHeadless(ThreadPool* pThreadPool)
+{
+	if (!mpRenderer->IsNullBackend())
+	{
+		Log::Error("Headless runs require the null renderer backend: Initialize(nullptr).");
+		return false;
+	}
+	mpThreadPool = pThreadPool;
+	mFrameAllocator.Initialize(FRAME_MEMORY_SIZE_IN_BYTES);
+	mShadowMapPass.Initialize(mpRenderer, sEngineSettings.rendering.shadowMap);
+	mbLoading = false;
+	mEngineConfig.mbShowProfiler = false;
+	mEngineConfig.mbShowControls = false;
+	return true;
+}
+
+bool Engine::LoadSceneHeadless(int level)
+{	// synchronous, no environment maps
+	const bool bFirstScene = mpActiveScene == nullptr;
+	if (!bFirstScene)
+	{
+		mpRenderer->UnbindDepthTarget();
+		mpRenderer->UnbindRenderTargets();
+		mpRenderer->Apply();
+		mpActiveScene->UnloadScene();
+	}
+
+	sEngineSettings.levelToLoad = level;
+	if (!LoadSceneFromFile())
+	{
+		Log::Error("Engine couldn't load scene.");
+		mpActiveScene = nullptr;
+		return false;
+	}
+
+	if (bFirstScene)
+	{
+		InitializeRenderPasses();
+	}
+	else
+	{
+		sEngineSettings.rendering.postProcess.bloom = mpActiveScene->mSceneRenderSettings.bloom;
+		mPostProcessPass.UpdateSettings(sEngineSettings.rendering.postProcess, mpRenderer);
+	}
+	mpCPUProfiler->Clear();
+	return true;
+}
+
+void Engine::SimulateAndRenderFrameHeadless(float dt)
+{
+	mpCPUProfiler->BeginProfile(mFrameCount);
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("CPU"));
+
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Update()"));
+	mpActiveScene->UpdateScene(dt);
+	mpCPUProfiler->EndEntry();	// Update
+
+	PreRender();
+	Render();
+
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Present"));
+	mpRenderer->EndFrame();
+	mpCPUProfiler->EndEntry();
+
+	mpCPUProfiler->EndEntry();	// CPU
+	mpCPUProfiler->EndProfile(mFrameCount);
+	++mFrameCount;
+}
+
+bool Engine::RunHeadless(ThreadPool* pThreadPool, const Settings::Headless& settings)
+{
+	Log::Info("[ENGINE]: Running headless ----------------");
+	if (!InitializeHeadless(pThreadPool))
+		return false;
+
+	const auto itScene = std::find(RANGE(sEngineSettings.sceneNames), settings.sceneName);
+	if (itScene == sEngineSettings.sceneNames.end())
+	{
+		Log::Error("RunHeadless(): Scene %s is not in the sceneNames list of EngineSettings.ini", settings.sceneName.c_str());
+		return false;
+	}
+	ModelLoader::sbBenchmarkModelCache = settings.bBenchmarkModelCache;
+	if (!LoadSceneHeadless(static_cast<int>(std::distance(sEngineSettings.sceneNames.begin(), itScene))))
+		return false;
+
+	// RUN
+	//
+	constexpr float FIXED_DT = 1.0f / 60.0f;
+	const int numFrames = (std::max)(settings.numFrames, 1);
+	Benchmark::SceneRun run;
+
+	Camera& camera = mpActiveScene->mCameras[mpActiveScene->mSelectedCamera];
+	PerfTimer timer;
+	timer.Start();
+	for (int frame = 0; frame < numFrames; ++frame)
+	{
+		// deterministic camera: a full turn around the start position over the run
+		camera.Reset();
+		camera.Rotate(XM_2PI * frame / numFrames, 0.0f, 1.0f);
+
+		SimulateAndRenderFrameHeadless(FIXED_DT);
+		run.AddFrame(*mpCPUProfiler, *mpRenderer, mFrameStats.scene);
+	}
+	const float runTime = timer.StopGetDeltaTimeAndReset();
+	Log::Info("[ENGINE]: Rendered %d frames headless in %.2fs", numFrames, runTime);
+
+	// REPORT
+	//
+	std::string filePath = settings.outputFile;
+	if (filePath.empty())
+	{
+		const std::string logDirectory = Application::s_WorkspaceDirectory + "\\Logs";
+		DirectoryUtil::CreateFolderIfItDoesntExist(logDirectory);
+		filePath = logDirectory + "\\" + GetCurrentTimeAsString() + "_Headless_" + DirectoryUtil::GetFileNameWithoutExtension(settings.sceneName) + ".json";
+	}
+	if (!Benchmark::WriteResults(filePath, Benchmark::GetResultsJSON({ run.ToJSON(settings.sceneName, "turn", FIXED_DT, runTime) })))
+		return false;
+	Log::Info("[ENGINE]: Headless results written to %s", filePath.c_str());
+	return true;
+}
+
+bool Engine::RunBenchmark(ThreadPool* pThreadPool, const Settings::Benchmark& settings)
+{
+	Log::Info("[ENGINE]: Running benchmark ---------------");
+	if (!InitializeHeadless(pThreadPool))
+		return false;
+
+	const std::vector<std::string> sceneNames = settings.sceneNames.empty() ? sEngineSettings.sceneNames : settings.sceneNames;
+	const int numFrames = (std::max)(settings.numFrames, 2);
+	const float timeStep = settings.timeStep > 0.0f ? settings.timeStep : 1.0f / 60.0f;
+
+	std::vector<std::string> sceneRunsJSON;
+	bool bSuccess = true;
+	for (const std::string& sceneName : sceneNames)
+	{
+		const auto itScene = std::find(RANGE(sEngineSettings.sceneNames), sceneName);
+		if (itScene == sEngineSettings.sceneNames.end())
+		{
+			Log::Error("RunBenchmark(): Scene %s is not in the sceneNames list of EngineSettings.ini", sceneName.c_str());
+			bSuccess = false;
+			continue;
+		}
+
+		MathUtil::SeedRandom(0);	// same object placement in the procedural scenes each run
+		if (!LoadSceneHeadless(static_cast<int>(std::distance(sEngineSettings.sceneNames.begin(), itScene))))
+		{
+			bSuccess = false;
+			continue;
+		}
+
+		// CAMERA PATH
+		//
+		Benchmark::CameraPath path;
+		const char* pCameraPath = "recorded";
+		if (settings.cameraPath == Settings::Benchmark::RECORDED)
+		{
+			const std::string pathFile = Benchmark::CameraPath::GetRecordedFilePath(sceneName);
+			if (!path.LoadFromFile(pathFile))
+				Log::Warning("RunBenchmark(): No recorded camera path %s, using the spline through the scene cameras.", pathFile.c_str());
+		}
+		if (path.IsEmpty())
+		{
+			pCameraPath = "spline";
+			std::vector<Settings::Camera> cameras;
+			for (const Camera& cam : mpActiveScene->mCameras)
+				cameras.push_back(cam.m_settings);
+			path = Benchmark::CameraPath::CreateFromSceneCameras(cameras, numFrames * timeStep);
+		}
+
+		// RUN
+		//
+		Benchmark::SceneRun run;
+		Camera& camera = mpActiveScene->mCameras[mpActiveScene->mSelectedCamera];
+		const float duration = path.GetDuration();
+		PerfTimer timer;
+		timer.Start();
+		for (int frame = 0; frame < numFrames; ++frame)
+		{	// a loop ends where it starts: don't render the first view twice
+			const float t = duration * frame / (path.bLoop ? numFrames : numFrames - 1);
+			const Benchmark::CameraPath::Keyframe key = path.Evaluate(t);
+			camera.SetTransform(key.position, key.yaw, key.pitch);
+
+			SimulateAndRenderFrameHeadless(timeStep);
+			run.AddFrame(*mpCPUProfiler, *mpRenderer, mFrameStats.scene);
+		}
+
+		const float runTime = timer.StopGetDeltaTimeAndReset();
+
+		sceneRunsJSON.push_back(run.ToJSON(sceneName, pCameraPath, timeStep, runTime));
+		Log::Info("[ENGINE]: Benchmark %s: %d frames, p95 CPU frame time %.2fms", sceneName.c_str(), numFrames, Benchmark::GetPercentile(run.stageTimes[0], 95.0f));
+	}
+
+	// REPORT
+	//
+	const std::string logDirectory = Application::s_WorkspaceDirectory + "\\Logs";
+	const std::string resultsFile = logDirectory + "\\" + GetCurrentTimeAsString() + "_Benchmark.json";
+	const std::string resultsJSON = Benchmark::GetResultsJSON(sceneRunsJSON);
+	if (!Benchmark::WriteResults(resultsFile, resultsJSON))
+		return false;
+	Log::Info("[ENGINE]: Benchmark results written to %s", resultsFile.c_str());
+
+	// the results are compared the way they're read back from a results file
+	std::vector<Benchmark::Metric> results;
+	Benchmark::ParseResults(resultsJSON.data(), resultsJSON.size(), results);
+
+	std::vector<Benchmark::Metric> baseline;
+	if (!Benchmark::ReadResults(settings.baselineFile, baseline))
+	{
+		Log::Info("[ENGINE]: No benchmark baseline, writing the results as the baseline: %s", settings.baselineFile.c_str());
+		return Benchmark::WriteResults(settings.baselineFile, resultsJSON) && bSuccess;
+	}
+
+	const int numRegressions = Benchmark::Compare(results, baseline, settings);
+	return numRegressions == 0 && bSuccess;
+}
+
 void Engine::RenderThread()	// This thread is currently only used during loading.
 {
 	constexpr bool bOneTimeLoadingScreenRender = false; // We're looping;
+	CPUProfiler::SetThreadName("Render Thread");
 	while (!mbStopRenderThread)
 	{
-		std::unique_lock<std::mutex> lck(mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 #if 0 // solution attempt. #thread-issue
 		mSignalRender.wait(lck, [=]() { return !mbStopRenderThread; });
 #else
@@ -652,7 +920,8 @@ void Engine::RenderThread()	// This thread is currently only used during loading
 		//           StopRenderThreadAndWait() waits on join
 		mSignalRender.wait(lck);
 #endif
-		mpCPUProfiler->BeginEntry("CPU");
+		mpCPUProfiler->BeginProfile(mFrameCount);
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("CPU"));
 
 		mpGPUProfiler->BeginProfile(mFrameCount);
 		mpGPUProfiler->BeginEntry("GPU");
@@ -665,13 +934,14 @@ void Engine::RenderThread()	// This thread is currently only used during loading
 		mpGPUProfiler->EndProfile(mFrameCount);
 
 
-		mpCPUProfiler->BeginEntry("Present");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Present"));
 		mpRenderer->EndFrame();
 		mpCPUProfiler->EndEntry(); // Present
 
 
 		mpCPUProfiler->EndEntry();	// CPU
 		mpCPUProfiler->StateCheck();
+		mpCPUProfiler->EndProfile(mFrameCount);
 		mAccumulator = 0.0f;
 		++mFrameCount;
 	}
@@ -683,6 +953,44 @@ void Engine::RenderThread()	// This thread is currently only used during loading
 	mSignalRender.notify_all();
 }
 
+void Engine::BeginProfilerCapture(int numFrames)
+{
+	const std::string captureDirectory = Application::s_WorkspaceDirectory + "\\Logs";
+	DirectoryUtil::CreateFolderIfItDoesntExist(captureDirectory);
+	mpCPUProfiler->BeginCapture(numFrames, captureDirectory + "\\" + GetCurrentTimeAsString() + "_CPUProfile.json");
+}
+
+void Engine::ToggleCameraPathRecording()
+{
+	const Camera& camera = mpActiveScene->GetActiveCamera();
+	if (!mbRecordingCameraPath)
+	{
+		mRecordedCameraPath = Benchmark::CameraPath();
+		mCameraPathRecordingTime = 0.0f;
+		mRecordedCameraPath.AddKeyframe(0.0f, camera);
+		mbRecordingCameraPath = true;
+		Log::Info("Recording camera path... (F9 to stop)");
+		return;
+	}
+
+	mbRecordingCameraPath = false;
+	if (mCameraPathRecordingTime > mRecordedCameraPath.keyframes.back().time)
+		mRecordedCameraPath.AddKeyframe(mCameraPathRecordingTime, camera);
+	const std::string filePath = Benchmark::CameraPath::GetRecordedFilePath(sEngineSettings.sceneNames[mCurrentLevel]);
+	if (mRecordedCameraPath.SaveToFile(filePath))
+		Log::Info("Camera path (%.2fs, %d keyframes) saved to %s", mCameraPathRecordingTime, static_cast<int>(mRecordedCameraPath.keyframes.size()), filePath.c_str());
+	else
+		Log::Error("Cannot save the camera path to %s", filePath.c_str());
+}
+
+void Engine::RecordCameraPath(float dt)
+{
+	constexpr float KEYFRAME_INTERVAL = 0.1f;	// seconds, the benchmark interpolates the keyframes with a spline
+	mCameraPathRecordingTime += dt;
+	if (mCameraPathRecordingTime - mRecordedCameraPath.keyframes.back().time >= KEYFRAME_INTERVAL)
+		mRecordedCameraPath.AddKeyframe(mCameraPathRecordingTime, mpActiveScene->GetActiveCamera());
+}
+
 void Engine::HandleInput()
 {
 	if (mpInput->IsKeyTriggered("Backspace"))	TogglePause();
@@ -693,6 +1001,11 @@ void Engine::HandleInput()
 	if (mpInput->IsKeyTriggered("F4")) mEngineConfig.bRenderTargets = !mEngineConfig.bRenderTargets;
 	if (mpInput->IsKeyTriggered("F5")) mEngineConfig.bBoundingBoxes = !mEngineConfig.bBoundingBoxes;
 	if (mpInput->IsKeyTriggered("F6")) ToggleRenderingPath();
+	if (mpInput->IsKeyTriggered("F10"))
+	{	// capture a CPU profile, pressing again ends the capture early
+		if (mpCPUProfiler->IsCaptureInProgress())	mpCPUProfiler->EndCapture();
+		else										BeginProfilerCapture(sEngineSettings.profiler.captureFrameCount);
+	}
 
 	//if (mpInput->IsKeyTriggered("'")) 
 	if (mpInput->IsKeyTriggered("F"))// && mpInput->AreKeysDown(2, "ctrl", "shift"))
@@ -708,6 +1021,7 @@ void Engine::HandleInput()
 	// ----------------------------------------------------------------------------------------------
 
 	if (mpInput->IsKeyTriggered("\\")) mpRenderer->ReloadShaders();
+	if (mpInput->IsKeyTriggered("F9")) ToggleCameraPathRecording();
 
 #if SSAO_DEBUGGING
 	// todo: wire this to some UI text/control
@@ -899,7 +1213,10 @@ void Engine::PreRender()
 #if LOAD_ASYNC
 	if (mbLoading) return;
 #endif
-	mpCPUProfiler->BeginEntry("PreRender()");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("PreRender()"));
+
+	// frame N-1's data stays valid, frame N-2's memory is recycled for this frame
+	mFrameAllocator.BeginFrame();
 
 	mpActiveScene->mSceneView.bIsPBRLightingUsed = IsLightingModelPBR();
 	mpActiveScene->mSceneView.bIsDeferredRendering = mEngineConfig.bDeferredOrForward;
@@ -917,6 +1234,17 @@ void Engine::PreRender()
 	mpActiveScene->PreRender(mFrameStats, mSceneLightData);
 	mFrameStats.rstats = mpRenderer->GetRenderStats();
 	mFrameStats.fps = GetFPS();
+	{
+		const BufferMemoryUsage vb = mpRenderer->GetBufferMemoryUsage(VERTEX_BUFFER);
+		const BufferMemoryUsage ib = mpRenderer->GetBufferMemoryUsage(INDEX_BUFFER);
+		const BufferMemoryUsage cb = mpRenderer->GetBufferMemoryUsage(COMPUTE_RW_BUFFER);
+		mFrameStats.memory.vertexBufferKB     = static_cast<int>(vb.GPUBytes / 1024);
+		mFrameStats.memory.vertexBufferCPUKB  = static_cast<int>(vb.CPUBytes / 1024);
+		mFrameStats.memory.indexBufferKB      = static_cast<int>(ib.GPUBytes / 1024);
+		mFrameStats.memory.indexBufferCPUKB   = static_cast<int>(ib.CPUBytes / 1024);
+		mFrameStats.memory.computeBufferKB    = static_cast<int>(cb.GPUBytes / 1024);
+		mFrameStats.memory.computeBufferCPUKB = static_cast<int>(cb.CPUBytes / 1024);
+	}
 
 	mpCPUProfiler->EndEntry();
 }
@@ -926,7 +1254,7 @@ void Engine::PreRender()
 // ====================================================================================
 void Engine::Render()
 {
-	mpCPUProfiler->BeginEntry("Render()");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Render()"));
 
 	mpGPUProfiler->BeginProfile(mFrameCount);
 	mpGPUProfiler->BeginEntry("GPU");
@@ -939,7 +1267,7 @@ void Engine::Render()
 
 	// SHADOW MAPS
 	//------------------------------------------------------------------------
-	mpCPUProfiler->BeginEntry("Shadow Pass");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Shadow Pass"));
 	mpGPUProfiler->BeginEntry("Shadow Pass");
 	mpRenderer->BeginEvent("Shadow Pass");
 	
@@ -978,7 +1306,7 @@ void Engine::Render()
 
 		// GEOMETRY - DEPTH PASS
 		mpGPUProfiler->BeginEntry("Geometry Pass");
-		mpCPUProfiler->BeginEntry("Geometry Pass");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Geometry Pass"));
 		mpRenderer->BeginEvent("Geometry Pass");
 		mDeferredRenderingPasses.RenderGBuffer(mpRenderer, mpActiveScene, mpActiveScene->mSceneView);
 		mpRenderer->EndEvent();	
@@ -986,7 +1314,7 @@ void Engine::Render()
 		mpGPUProfiler->EndEntry();
 
 		// AMBIENT OCCLUSION  PASS
-		mpCPUProfiler->BeginEntry("AO Pass");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("AO Pass"));
 		if (mEngineConfig.bSSAO && bSceneSSAO)
 		{
 			mAOPass.RenderAmbientOcclusion(mpRenderer, texNormal, mpActiveScene->mSceneView);
@@ -994,7 +1322,7 @@ void Engine::Render()
 		mpCPUProfiler->EndEntry(); // AO Pass
 
 		// DEFERRED LIGHTING PASS
-		mpCPUProfiler->BeginEntry("Lighting Pass");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Lighting Pass"));
 		mpGPUProfiler->BeginEntry("Lighting Pass");
 		mpRenderer->BeginEvent("Lighting Pass");
 		mDeferredRenderingPasses.RenderLightingPass(deferredLightingParams);
@@ -1002,7 +1330,7 @@ void Engine::Render()
 		mpCPUProfiler->EndEntry();
 		mpGPUProfiler->EndEntry();
 
-		mpCPUProfiler->BeginEntry("Skybox & Lights");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Skybox & Lights"));
 		
 		// LIGHT SOURCES
 		mpRenderer->BindDepthTarget(mWorldDepthTarget);
@@ -1123,7 +1451,7 @@ void Engine::Render()
 		// currently only SSAA is supported
 		mpRenderer->BeginEvent("Resolve AA");
 		mpGPUProfiler->BeginEntry("Resolve AA");
-		mpCPUProfiler->BeginEntry("Resolve AA");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Resolve AA"));
 
 		mAAResolvePass.SetInputTexture(mpRenderer->GetRenderTargetTexture(mDeferredRenderingPasses._shadeTarget));
 		mAAResolvePass.Render(mpRenderer);
@@ -1148,7 +1476,7 @@ void Engine::Render()
 
 	// POST PROCESS PASS | DEBUG PASS | UI PASS
 	//------------------------------------------------------------------------
-	mpCPUProfiler->BeginEntry("Post Process");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Post Process"));
 	mpGPUProfiler->BeginEntry("Post Process"); 
 #if FULLSCREEN_DEBUG_TEXTURE
 	const TextureID texDebug = mAOPass.GetBlurredAOTexture(mpRenderer);
@@ -1172,7 +1500,7 @@ void Engine::Render()
 void Engine::RenderDebug(const XMMATRIX& viewProj)
 {
 	mpGPUProfiler->BeginEntry("Debug Pass");
-	mpCPUProfiler->BeginEntry("Debug Pass");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Debug Pass"));
 	if (mEngineConfig.bBoundingBoxes)	// BOUNDING BOXES
 	{
 		mpActiveScene->RenderDebug(viewProj);
@@ -1180,7 +1508,7 @@ void Engine::RenderDebug(const XMMATRIX& viewProj)
 
 	if (mEngineConfig.bRenderTargets)	// RENDER TARGETS
 	{
-		mpCPUProfiler->BeginEntry("Debug Textures");
+		mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Debug Textures"));
 		const int screenWidth = sEngineSettings.window.width;
 		const int screenHeight = sEngineSettings.window.height;
 		const float aspectRatio = static_cast<float>(screenWidth) / screenHeight;
@@ -1313,7 +1641,7 @@ void Engine::RenderUI() const
 {
 	mpRenderer->BeginEvent("UI");
 	mpGPUProfiler->BeginEntry("UI");
-	mpCPUProfiler->BeginEntry("UI");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("UI"));
 	mpRenderer->SetRasterizerState(EDefaultRasterizerState::CULL_NONE);	
 	if (mEngineConfig.mbShowProfiler) { mUI.RenderPerfStats(mFrameStats); }
 	if (mEngineConfig.mbShowControls) { mUI.RenderEngineControls(); }
@@ -50,7 +50,7 @@ DirectX::XMMATRIX Light::CalculateSpotLightViewMatrix(const Transform& mTransfor
 	XMVECTOR lookAt = vec3::Forward;	// spot light default orientation looks up
 	lookAt = XMVector3TransformCoord(lookAt, mTransform.RotationMatrix());
 	up = XMVector3TransformCoord(up, mTransform.RotationMatrix());
-	XMVECTOR pos = mTransform._position;
+	XMVECTOR pos = mTransform.GetPosition();
 	XMVECTOR taraget = pos + lookAt;
 	return XMMatrixLookAtLH(pos, taraget, up);
 }
@@ -127,7 +127,7 @@ DirectX::XMMATRIX Light::GetViewMatrix(Texture::CubemapUtility::ECubeMapLookDire
 #else
 	switch (mType)
 	{
-	case Light::POINT:       return CalculatePointLightViewMatrix(lookDir, mTransform._position);
+	case Light::POINT:       return CalculatePointLightViewMatrix(lookDir, mTransform.GetPosition());
 	case Light::SPOT:        return CalculateSpotLightViewMatrix(mTransform);
 	case Light::DIRECTIONAL: return CalculateDirectionalLightViewMatrix(*this); 
 	default:
@@ -159,7 +159,7 @@ void Light::GetGPUData(SpotLightGPU& l) const
 	assert(mType == ELightType::SPOT);
 	const vec3 spotDirection = XMVector3TransformCoord(vec3::Forward, mTransform.RotationMatrix());
 
-	l.position = mTransform._position;
+	l.position = mTransform.GetPosition();
 	l.halfAngle = mSpotOuterConeAngleDegrees * DEG2RAD;
 
 	l.color = mColor.Value();
@@ -174,7 +174,7 @@ void Light::GetGPUData(PointLightGPU& l) const
 {
 	assert(mType == ELightType::POINT);
 
-	l.position = mTransform._position;
+	l.position = mTransform.GetPosition();
 	l.range = mRange;
 
 	l.color = mColor.Value();
@@ -207,7 +207,7 @@ void Light::SetMatrices()
 	case Light::POINT:
 	{
 		for(int i=0; i<6; ++i)
-			mViewMatrix[i] = CalculatePointLightViewMatrix(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(i), mTransform._position);
+			mViewMatrix[i] = CalculatePointLightViewMatrix(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(i), mTransform.GetPosition());
 		break;
 	}
 	case Light::SPOT:         mViewMatrix[0] = CalculateSpotLightViewMatrix(mTransform);   break; 
@@ -17,6 +17,7 @@
 //	Contact: volkanilbeyli@gmail.com
 
 #include "Mesh.h"
+#include "Renderer/Renderer.h"
 #include "Utilities/Log.h"
 
 #define VERBOSE_LOGGING 0
@@ -27,6 +28,132 @@
 // buffer data.
 Renderer* Mesh::spRenderer = nullptr;
 
+Mesh::Mesh(const LODLevelData* pLODLevels, size_t numLODLevels, const std::string& name, const float* pAABBMin /*= nullptr*/, const float* pAABBMax /*= nullptr*/)
+{
+	bool bHasLODErrors = false;
+	for (size_t LOD = 0; LOD < numLODLevels; ++LOD)
+	{
+		const LODLevelData& level = pLODLevels[LOD];
+		assert(level.indexStride == sizeof(unsigned) || level.indexStride == sizeof(uint16_t));
+
+		const std::string VBName = name + "_LOD[" + std::to_string(LOD) + "]_VB";
+		const std::string IBName = name + "_LOD[" + std::to_string(LOD) + "]_IB";
+
+		BufferDesc bufferDesc = {};
+		BufferID vertexBufferID = -1;
+		if (level.vertexStride == sizeof(DefaultVertexBufferData))
+		{
+			vertexBufferID = CreateVertexBuffer(static_cast<const DefaultVertexBufferData*>(level.pVertices), level.numVertices, VBName);
+		}
+		else
+		{
+			bufferDesc.mType = VERTEX_BUFFER;
+			bufferDesc.mUsage = GPU_READ_WRITE;
+			bufferDesc.mElementCount = level.numVertices;
+			bufferDesc.mStride = level.vertexStride;
+			vertexBufferID = spRenderer->CreateBuffer(bufferDesc, level.pVertices, VBName.c_str());
+		}
+
+		BufferID indexBufferID = -1;
+		if (level.indexStride == sizeof(unsigned))
+		{
+			indexBufferID = CreateIndexBuffer(static_cast<const unsigned*>(level.pIndices), level.numIndices, level.numVertices, IBName);
+		}
+		else
+		{
+			bufferDesc.mType = INDEX_BUFFER;
+			bufferDesc.mUsage = GPU_READ_WRITE;
+			bufferDesc.mElementCount = level.numIndices;
+			bufferDesc.mStride = level.indexStride;
+			bufferDesc.mIndexFormat = INDEX_FORMAT_UINT16;
+			indexBufferID = spRenderer->CreateBuffer(bufferDesc, level.pIndices, IBName.c_str());
+		}
+
+		mLODs.push_back({ vertexBufferID, indexBufferID });
+		mLODErrors.push_back(level.error);
+		bHasLODErrors |= level.error > 0.0f;
+	}
+	if (!bHasLODErrors)
+		mLODErrors.clear();
+	mMeshName = name;
+
+	if (pAABBMin && pAABBMax)
+	{
+		mAABBMin = vec3(pAABBMin[0], pAABBMin[1], pAABBMin[2]);
+		mAABBMax = vec3(pAABBMax[0], pAABBMax[1], pAABBMax[2]);
+	}
+	else if (numLODLevels > 0)
+	{
+		CalculateAABB(pLODLevels[0].pVertices, pLODLevels[0].numVertices, pLODLevels[0].vertexStride);
+	}
+}
+
+void Mesh::CalculateAABB(const void* pVertices, size_t numVertices, size_t vertexStride)
+{
+	if (numVertices == 0)
+	{
+		mAABBMin = mAABBMax = vec3::Zero;
+		return;
+	}
+
+	// two min/max accumulators to break the dependency chain between consecutive vertices
+	const char* pVertex = static_cast<const char*>(pVertices);
+	auto fnLoadPosition = [&](size_t i) { return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(pVertex + i * vertexStride)); };
+	XMVECTOR vMin0 = fnLoadPosition(0), vMax0 = vMin0;
+	XMVECTOR vMin1 = vMin0, vMax1 = vMin0;
+	size_t i = 1;
+	for (; i + 1 < numVertices; i += 2)
+	{
+		const XMVECTOR p0 = fnLoadPosition(i);
+		const XMVECTOR p1 = fnLoadPosition(i + 1);
+		vMin0 = XMVectorMin(vMin0, p0); vMax0 = XMVectorMax(vMax0, p0);
+		vMin1 = XMVectorMin(vMin1, p1); vMax1 = XMVectorMax(vMax1, p1);
+	}
+	if (i < numVertices)
+	{
+		const XMVECTOR p = fnLoadPosition(i);
+		vMin0 = XMVectorMin(vMin0, p); vMax0 = XMVectorMax(vMax0, p);
+	}
+	mAABBMin = vec3(XMVectorMin(vMin0, vMin1));
+	mAABBMax = vec3(XMVectorMax(vMax0, vMax1));
+}
+
+BufferID Mesh::CreateVertexBuffer(const DefaultVertexBufferData* pVertices, size_t numVertices, const std::string& name)
+{
+#if PACKED_VERTEX_FORMAT
+	std::vector<PackedVertexBufferData> packedVertices(pVertices, pVertices + numVertices);
+	return CreateVertexBuffer(packedVertices.data(), packedVertices.size(), name);
+#else
+	return CreateVertexBuffer<DefaultVertexBufferData>(pVertices, numVertices, name);
+#endif
+}
+
+BufferID Mesh::CreateIndexBuffer(const unsigned* pIndices, size_t numIndices, size_t numVertices, const std::string& name)
+{
+	BufferDesc bufferDesc = {};
+	bufferDesc.mType = INDEX_BUFFER;
+	bufferDesc.mUsage = GPU_READ_WRITE;
+	bufferDesc.mElementCount = static_cast<unsigned>(numIndices);
+
+	// 0xFFFF is reserved as the strip cut index for 16-bit index buffers
+	if (numVertices < 0xFFFF)
+	{
+		std::vector<uint16_t> indices16(numIndices);
+		for (size_t i = 0; i < numIndices; ++i)
+		{
+			assert(pIndices[i] < numVertices);
+			indices16[i] = static_cast<uint16_t>(pIndices[i]);
+		}
+		bufferDesc.mStride = sizeof(uint16_t);
+		bufferDesc.mIndexFormat = INDEX_FORMAT_UINT16;
+		return spRenderer->CreateBuffer(bufferDesc, indices16.data(), name.c_str());
+	}
+
+	bufferDesc.mStride = sizeof(unsigned);
+	bufferDesc.mIndexFormat = INDEX_FORMAT_UINT32;
+	return spRenderer->CreateBuffer(bufferDesc, pIndices, name.c_str());
+}
+
 std::pair<BufferID, BufferID> Mesh::GetIABuffers(int lod /*= 0*/) const
 {
 	assert(mLODs.size() > 0); // maybe no assert and return <-1, -1> ?
@@ -18,6 +18,8 @@
 
 #include "Model.h"
 #include "Renderer/GeometryGenerator.h"
+#include "Renderer/MeshSimplifier.h"
+#include "Renderer/MeshOptimizer.h"
 
 #include <thread>
 
@@ -29,6 +31,18 @@
 #define MAKE_IRONMAN_METALLIC 1
 #define MAKE_ZENBALL_METALLIC 1
 
+// generates LOD levels for the imported meshes with the mesh simplifier
+#define GENERATE_LOD_CHAINS_FOR_IMPORTED_MODELS 1
+#if GENERATE_LOD_CHAINS_FOR_IMPORTED_MODELS
+// triangle counts of the LOD levels [1, N] relative to the imported mesh
+static const std::vector<float> LOD_CHAIN_TRIANGLE_RATIOS = { 0.5f, 0.25f, 0.125f };
+static const size_t MIN_TRIANGLE_COUNT_FOR_LOD_CHAIN = 512;
+#endif
+
+// reorders the triangles of the imported meshes for the vertex cache & overdraw and their vertices for fetch locality
+#define OPTIMIZE_IMPORTED_MESHES 1
+#define OPTIMIZE_OVERDRAW_FOR_IMPORTED_MESHES 1
+
 
 bool ModelData::AddMaterial(MeshID meshID, MaterialID matID, bool bTransparent)
 {
@@ -88,63 +102,171 @@ Model::Model(const std::string& directoryFullPath, const std::string & modelName
 #include "Scene.h"
 
 #include <assimp/Importer.hpp>
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include "Engine.h"
+#include "ModelCache.h"
+
+#include "Utilities/MemoryMappedFile.h"
+#include "Application/ThreadPool.h"
 
 #include <functional>
+#include <numeric>
+#include <array>
+#include <cfloat>
 
 
 const char* ModelLoader::sRootFolderModels = "Data/Models/";
+bool ModelLoader::sbBenchmarkModelCache = false;
 
 using namespace Assimp;
-using fnTypeProcessNode = std::function<ModelData(aiNode* const, const aiScene*, std::vector<Mesh>&)>;
-using fnTypeProcessMesh = std::function<Mesh(aiMesh*, const aiScene*)>;
 
 
 //----------------------------------------------------------------------------------------------------------------
 // ASSIMP HELPER FUNCTIONS
 //----------------------------------------------------------------------------------------------------------------
-std::vector<TextureID> LoadMaterialTextures(
-	aiMaterial*			pMaterial, 
-	aiTextureType		type, 
-	const std::string&	textureName, 
-	Renderer*			mpRenderer, 
-	const std::string&	modelDirectory
-)
+static std::string GetMaterialTexturePath(aiMaterial* pMaterial, aiTextureType type)
 {
-	std::vector<TextureID> textures;
-	for (unsigned int i = 0; i < pMaterial->GetTextureCount(type); i++)
+	// the materials only use the first texture of each type
+	aiString str;
+	if (pMaterial->GetTextureCount(type) == 0 || aiReturn_SUCCESS != pMaterial->GetTexture(type, 0, &str))
 	{
-		aiString str;
-		pMaterial->GetTexture(type, i, &str);
-		std::string path = str.C_Str();
-		{
-			std::unique_lock<std::mutex> lock(Engine::mLoadRenderingMutex);
-			textures.push_back(mpRenderer->CreateTextureFromFile(path, modelDirectory, true));
-		}
+		return std::string();
+	}
+	return str.C_Str();
+}
+
+// Records the files Assimp opens while importing a model, e.g. the material library of an .obj file.
+class FileRecordingIOSystem : public DefaultIOSystem
+{
+public:
+	IOStream* Open(const char* pFile, const char* pMode = "rb") override
+	{
+		IOStream* pStream = DefaultIOSystem::Open(pFile, pMode);
+		if (pStream)
+			mOpenedFiles.push_back(pFile);
+		return pStream;
+	}
+	inline const std::vector<std::string>& GetOpenedFiles() const { return mOpenedFiles; }
+
+private:
+	std::vector<std::string> mOpenedFiles;
+};
+
+ModelCache::ImportedMaterial ProcessMaterial(aiMaterial* material, const aiScene* pAiScene)
+{
+	// MATERIAL - http://assimp.sourceforge.net/lib_html/materials.html
+	ModelCache::ImportedMaterial mat;
+	mat.textures[ModelCache::DIFFUSE_MAP]  = GetMaterialTexturePath(material, aiTextureType_DIFFUSE);
+	mat.textures[ModelCache::SPECULAR_MAP] = GetMaterialTexturePath(material, aiTextureType_SPECULAR);
+	mat.textures[ModelCache::NORMAL_MAP]   = GetMaterialTexturePath(material, aiTextureType_NORMALS);
+	mat.textures[ModelCache::HEIGHT_MAP]   = GetMaterialTexturePath(material, aiTextureType_HEIGHT);
+	mat.textures[ModelCache::ALPHA_MAP]    = GetMaterialTexturePath(material, aiTextureType_OPACITY);
+
+	aiString name;
+	if (aiReturn_SUCCESS == material->Get(AI_MATKEY_NAME, name))
+	{
+		// we don't store names for materials. probably best to store them in a lookup somewhere,
+		// away from the material data.
+		//
+		// pBRDF->
+	}
+
+	aiColor3D color(0.f, 0.f, 0.f);
+	if (aiReturn_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
+	{
+		mat.diffuse = vec3(color.r, color.g, color.b);
+		mat.flags |= ModelCache::HAS_DIFFUSE_COLOR;
+	}
+
+	aiColor3D specular(0.f, 0.f, 0.f);
+	if (aiReturn_SUCCESS == material->Get(AI_MATKEY_COLOR_SPECULAR, specular))
+	{
+		mat.specular = vec3(specular.r, specular.g, specular.b);
+		mat.flags |= ModelCache::HAS_SPECULAR_COLOR;
+	}
+
+	aiColor3D transparent(0.0f, 0.0f, 0.0f);
+	if (aiReturn_SUCCESS == material->Get(AI_MATKEY_COLOR_TRANSPARENT, transparent))
+	{	// Defines the transparent color of the material, this is the color to be multiplied 
+		// with the color of translucent light to construct the final 'destination color' 
+		// for a particular position in the screen buffer. T
+		//
+		//pBRDF->specular = vec3(specular.r, specular.g, specular.b);
+	}
+
+	float opacity = 0.0f;
+	if (aiReturn_SUCCESS == material->Get(AI_MATKEY_OPACITY, opacity))
+	{
+		mat.opacity = opacity;
+		mat.flags |= ModelCache::HAS_OPACITY;
+	}
+
+	float shininess = 0.0f;
+	if (aiReturn_SUCCESS == material->Get(AI_MATKEY_SHININESS, shininess))
+	{
+		// Phong Shininess -> Beckmann BRDF Roughness conversion
+		//
+		// https://simonstechblog.blogspot.com/2011/12/microfacet-brdf.html
+		// https://computergraphics.stackexchange.com/questions/1515/what-is-the-accepted-method-of-converting-shininess-to-roughness-and-vice-versa
+		//
+		mat.roughness = sqrtf(2.0f / (2.0f + shininess));
+		mat.flags |= ModelCache::HAS_ROUGHNESS;
 	}
-	return textures;
+
+#if MAKE_IRONMAN_METALLIC || MAKE_ZENBALL_METALLIC
+
+	// ---
+	// quick hack to assign metallic value to the loaded mesh
+	//
+	std::string fileName(pAiScene->mRootNode->mName.C_Str());
+	std::transform(RANGE(fileName), fileName.begin(), ::tolower);
+	auto tokens = StrUtil::split(fileName, '.');
+	if (!tokens.empty() && (tokens[0] == "ironman" || tokens[0] == "zen_orb"))
+	{
+		mat.flags |= ModelCache::IS_METALLIC;
+	}
+	//---
+#endif
+
+	// other material keys to consider
+	//
+	// AI_MATKEY_TWOSIDED
+	// AI_MATKEY_ENABLE_WIREFRAME
+	// AI_MATKEY_BLEND_FUNC
+	// AI_MATKEY_BUMPSCALING
+
+	return mat;
 }
 
+// meshes are named after their index in the imported scene, for both the imported and the cooked models
+static std::string GetImportedMeshName(uint32_t meshIndex)
+{
+	return "ImportedModelMesh" + std::to_string(meshIndex);
+}
 
-Mesh ProcessMesh(aiMesh * mesh, const aiScene * scene)
+// runs on the thread pool workers: the input scene is read-only and the output is per-mesh
+ModelCache::ImportedMesh ProcessMesh(aiMesh * mesh, uint32_t meshIndex, const aiScene * scene, MeshOptimizer::Report& outOptimizationReport)
 {
-	std::vector<DefaultVertexBufferData> Vertices;
+	std::vector<DefaultVertexBufferData> Vertices(mesh->mNumVertices);
 	std::vector<unsigned> Indices;
+	Indices.reserve(mesh->mNumFaces * 3);
+
+	aiVector3D aabbMin( FLT_MAX,  FLT_MAX,  FLT_MAX);
+	aiVector3D aabbMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
 
 	// Walk through each of the mesh's vertices
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
-		DefaultVertexBufferData Vert;
+		DefaultVertexBufferData& Vert = Vertices[i];
 
 		// POSITIONS
-		Vert.position = vec3(
-			mesh->mVertices[i].x,
-			mesh->mVertices[i].y,
-			mesh->mVertices[i].z
-		);
+		const aiVector3D& p = mesh->mVertices[i];
+		Vert.position = vec3(p.x, p.y, p.z);
+		aabbMin = aiVector3D((std::min)(aabbMin.x, p.x), (std::min)(aabbMin.y, p.y), (std::min)(aabbMin.z, p.z));
+		aabbMax = aiVector3D((std::max)(aabbMax.x, p.x), (std::max)(aabbMax.y, p.y), (std::max)(aabbMax.z, p.z));
 
 		// NORMALS
 		if (mesh->mNormals)
@@ -180,7 +302,6 @@ Mesh ProcessMesh(aiMesh * mesh, const aiScene * scene)
 		// 	mesh->mBitangents[i].y,
 		// 	mesh->mBitangents[i].z
 		// );
-		Vertices.push_back(Vert);
 	}
 
 	// now walk through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
@@ -192,144 +313,194 @@ Mesh ProcessMesh(aiMesh * mesh, const aiScene * scene)
 			Indices.push_back(face.mIndices[j]);
 	}
 
-	// TODO: mesh name
+	const std::string meshName = GetImportedMeshName(meshIndex);
 
-	Mesh newMesh = [&]()
+	ModelCache::ImportedMesh importedMesh;
+	importedMesh.materialIndex = mesh->mMaterialIndex;
+	if (mesh->mNumVertices > 0)
+	{
+		importedMesh.aabbMin[0] = aabbMin.x; importedMesh.aabbMin[1] = aabbMin.y; importedMesh.aabbMin[2] = aabbMin.z;
+		importedMesh.aabbMax[0] = aabbMax.x; importedMesh.aabbMax[1] = aabbMax.y; importedMesh.aabbMax[2] = aabbMax.z;
+	}
+
+#if GENERATE_LOD_CHAINS_FOR_IMPORTED_MODELS
+	if (Indices.size() / 3 >= MIN_TRIANGLE_COUNT_FOR_LOD_CHAIN)
+	{
+		// simplify on the model loading worker, the buffers are created from the cooked model later on
+		importedMesh.LODData = MeshSimplifier::GenerateLODChain(Vertices, Indices, LOD_CHAIN_TRIANGLE_RATIOS, meshName.c_str());
+	}
+	else
+#endif
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
-		return Mesh(Vertices, Indices, "ImportedModelMesh0");	// return a mesh object created from the extracted mesh data
-	}();
-	return newMesh;
+		importedMesh.LODData = MeshLODData<DefaultVertexBufferData>(1, meshName.c_str());
+		importedMesh.LODData.LODVertices[0] = std::move(Vertices);
+		importedMesh.LODData.LODIndices[0] = std::move(Indices);
+	}
+
+#if OPTIMIZE_IMPORTED_MESHES
+	// after the simplification: the simplifier doesn't preserve the triangle order
+	outOptimizationReport = MeshOptimizer::Optimize(importedMesh.LODData, OPTIMIZE_OVERDRAW_FOR_IMPORTED_MESHES);
+#endif
+	return importedMesh;
 }
 
-ModelData ProcessNode(
-	aiNode* const		pNode,
-	const aiScene*		pAiScene,
-	const std::string&	modelDirectory,
-	Renderer*			mpRenderer,		// creates resources
-	Scene*				pScene			// write
-)
+// records the meshes of the node hierarchy in the order they're visited
+void ProcessNode(aiNode* const pNode, std::vector<uint32_t>& meshReferences)
 {
-	ModelData modelData;
-	std::vector<MeshID>& ModelMeshIDs = modelData.mMeshIDs;
-
 	for (unsigned int i = 0; i < pNode->mNumMeshes; i++)
 	{	// process all the node's meshes (if any)
-		aiMesh* pAiMesh = pAiScene->mMeshes[pNode->mMeshes[i]];
-
-		// MATERIAL - http://assimp.sourceforge.net/lib_html/materials.html
-		aiMaterial* material = pAiScene->mMaterials[pAiMesh->mMaterialIndex];
-		std::vector<TextureID> diffuseMaps  = LoadMaterialTextures(material, aiTextureType_DIFFUSE	, "texture_diffuse" , mpRenderer, modelDirectory);
-		std::vector<TextureID> specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR , "texture_specular", mpRenderer, modelDirectory);
-		std::vector<TextureID> normalMaps   = LoadMaterialTextures(material, aiTextureType_NORMALS	, "texture_normal"  , mpRenderer, modelDirectory);
-		std::vector<TextureID> heightMaps   = LoadMaterialTextures(material, aiTextureType_HEIGHT   , "texture_height"  , mpRenderer, modelDirectory);
-		std::vector<TextureID> alphaMaps    = LoadMaterialTextures(material, aiTextureType_OPACITY	, "texture_alpha"   , mpRenderer, modelDirectory);
-
-		BRDF_Material* pBRDF = static_cast<BRDF_Material*>(pScene->CreateNewMaterial(GGX_BRDF));
-		assert(diffuseMaps.size() <= 1);	assert(normalMaps.size() <= 1);
-		assert(specularMaps.size() <= 1);	assert(heightMaps.size() <= 1);
-		assert(alphaMaps.size() <= 1);
-		if (!diffuseMaps.empty())	pBRDF->diffuseMap = diffuseMaps[0];
-		if (!normalMaps.empty())	pBRDF->normalMap = normalMaps[0];
-		if (!specularMaps.empty())	pBRDF->specularMap = specularMaps[0];
-		if (!heightMaps.empty())	pBRDF->heightMap = heightMaps[0];
-		if (!alphaMaps.empty())		pBRDF->mask = alphaMaps[0];
-
-		aiString name;
-		if (aiReturn_SUCCESS == material->Get(AI_MATKEY_NAME, name))
-		{
-			// we don't store names for materials. probably best to store them in a lookup somewhere,
-			// away from the material data.
-			//
-			// pBRDF->
-		}
-
-		aiColor3D color(0.f, 0.f, 0.f);
-		if (aiReturn_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
-		{
-			pBRDF->diffuse = vec3(color.r, color.g, color.b);
-		}
+		meshReferences.push_back(pNode->mMeshes[i]);
+	}
+	for (unsigned int i = 0; i < pNode->mNumChildren; i++)
+	{	// then do the same for each of its children
+		ProcessNode(pNode->mChildren[i], meshReferences);
+	}
+}
 
-		aiColor3D specular(0.f, 0.f, 0.f);
-		if (aiReturn_SUCCESS == material->Get(AI_MATKEY_COLOR_SPECULAR, specular))
-		{
-			pBRDF->specular = vec3(specular.r, specular.g, specular.b);
-		}
+// Converts the meshes in parallel on the thread pool workers and the calling thread 
+// if @pThreadPool is not nullptr, or serially on the calling thread otherwise.
+ModelCache::ImportedModel ImportModel(const aiScene* pAiScene, VQEngine::ThreadPool* pThreadPool)
+{
+	ModelCache::ImportedModel model;
 
-		aiColor3D transparent(0.0f, 0.0f, 0.0f);
-		if (aiReturn_SUCCESS == material->Get(AI_MATKEY_COLOR_TRANSPARENT, transparent))
-		{	// Defines the transparent color of the material, this is the color to be multiplied 
-			// with the color of translucent light to construct the final 'destination color' 
-			// for a particular position in the screen buffer. T
-			//
-			//pBRDF->specular = vec3(specular.r, specular.g, specular.b);
-		}
+	model.materials.reserve(pAiScene->mNumMaterials);
+	for (unsigned int i = 0; i < pAiScene->mNumMaterials; i++)
+		model.materials.push_back(ProcessMaterial(pAiScene->mMaterials[i], pAiScene));
 
-		float opacity = 0.0f;
-		if (aiReturn_SUCCESS == material->Get(AI_MATKEY_OPACITY, opacity))
-		{
-			pBRDF->alpha = opacity;
-		}
+	// the meshes are pulled one at a time, largest first, so that a few big meshes 
+	// (and their LOD chains) don't end up being processed last on a single thread.
+	std::vector<unsigned> meshOrder(pAiScene->mNumMeshes);
+	std::iota(RANGE(meshOrder), 0u);
+	std::sort(RANGE(meshOrder), [&](unsigned i0, unsigned i1) { return pAiScene->mMeshes[i0]->mNumFaces > pAiScene->mMeshes[i1]->mNumFaces; });
 
-		float shininess = 0.0f;
-		if (aiReturn_SUCCESS == material->Get(AI_MATKEY_SHININESS, shininess))
-		{
-			// Phong Shininess -> Beckmann BRDF Roughness conversion
-			//
-			// https://simonstechblog.blogspot.com/2011/12/microfacet-brdf.html
-			// https://computergraphics.stackexchange.com/questions/1515/what-is-the-accepted-method-of-converting-shininess-to-roughness-and-vice-versa
-			//
-			pBRDF->roughness = sqrtf(2.0f / (2.0f + shininess));
-		}
+	model.meshes.resize(pAiScene->mNumMeshes);
+	std::vector<MeshOptimizer::Report> optimizationReports(pAiScene->mNumMeshes);
+	auto fnProcessMesh = [&](size_t i)
+	{
+		PROFILE_SCOPE("ProcessMesh");
+		const unsigned meshIndex = meshOrder[i];
+		model.meshes[meshIndex] = ProcessMesh(pAiScene->mMeshes[meshIndex], meshIndex, pAiScene, optimizationReports[meshIndex]);
+	};
+	if (pThreadPool)
+	{
+		pThreadPool->ParallelFor(0, meshOrder.size(), 1, fnProcessMesh);
+	}
+	else
+	{
+		for (size_t i = 0; i < meshOrder.size(); ++i)
+			fnProcessMesh(i);
+	}
 
-#if MAKE_IRONMAN_METALLIC || MAKE_ZENBALL_METALLIC
+	ProcessNode(pAiScene->mRootNode, model.meshReferences);
 
-		// ---
-		// quick hack to assign metallic value to the loaded mesh
-		//
-		std::string fileName(pAiScene->mRootNode->mName.C_Str());
-		std::transform(RANGE(fileName), fileName.begin(), ::tolower);
-		auto tokens = StrUtil::split(fileName, '.');
-		if (!tokens.empty() && (tokens[0] == "ironman" || tokens[0] == "zen_orb"))
-		{
-			pBRDF->metalness = 1.0f;
-		}
-		//---
+#if OPTIMIZE_IMPORTED_MESHES
+	MeshOptimizer::Report optimizationReport;
+	for (const MeshOptimizer::Report& report : optimizationReports)
+	{
+		optimizationReport.before += report.before;
+		optimizationReport.after += report.after;
+	}
+	Log::Info("\tMesh optimization (%zu triangles incl. LODs): ACMR %.3f -> %.3f | ATVR %.3f -> %.3f"
+		, optimizationReport.before.numTriangles
+		, optimizationReport.before.GetACMR(), optimizationReport.after.GetACMR()
+		, optimizationReport.before.GetATVR(), optimizationReport.after.GetATVR()
+	);
 #endif
+	return model;
+}
 
-		// other material keys to consider
-		//
-		// AI_MATKEY_TWOSIDED
-		// AI_MATKEY_ENABLE_WIREFRAME
-		// AI_MATKEY_BLEND_FUNC
-		// AI_MATKEY_BUMPSCALING
-		
-		Mesh mesh = ProcessMesh(pAiMesh, pAiScene);
+
+//----------------------------------------------------------------------------------------------------------------
+// COOKED MODEL -> RESOURCES
+//----------------------------------------------------------------------------------------------------------------
+// creates a material and a mesh for each mesh reference of the node hierarchy.
+// all the resources of the model are created in a single locked submission.
+ModelData CreateModelResources(
+	const ModelCache::CookedModel&	cookedModel,
+	const std::string&				modelDirectory,
+	Renderer*						mpRenderer,		// creates resources
+	Scene*							pScene			// write
+)
+{
+	using TextureIDs = std::array<TextureID, ModelCache::NUM_MATERIAL_TEXTURES>;
+	const size_t numMeshReferences = cookedModel.GetNumMeshReferences();
+
+	// gather the LOD levels of the meshes & the materials in use before taking the lock
+	std::vector<LODLevelData> LODLevels;
+	std::vector<size_t> firstLODLevel(numMeshReferences + 1, 0);
+	std::vector<bool> bMaterialUsed(cookedModel.GetNumMaterials(), false);
+	for (size_t i = 0; i < numMeshReferences; ++i)
+	{
+		const uint32_t meshIndex = cookedModel.GetMeshReference(i);
+		const ModelCache::MeshRecord& meshRecord = cookedModel.GetMesh(meshIndex);
+		for (uint32_t lod = 0; lod < meshRecord.numLODs; ++lod)
+			LODLevels.push_back(cookedModel.GetMeshLOD(meshIndex, lod));
+		firstLODLevel[i + 1] = LODLevels.size();
+		bMaterialUsed[meshRecord.materialIndex] = true;
+	}
+
+	std::vector<Mesh> meshes;
+	std::vector<MaterialID> meshMaterials;
+	std::vector<bool> bTransparentMeshes;
+	meshes.reserve(numMeshReferences);
+	meshMaterials.reserve(numMeshReferences);
+	bTransparentMeshes.reserve(numMeshReferences);
+	{
+		std::unique_lock<std::mutex> lock = Engine::LockLoadRenderingMutex();
+
+		// TEXTURES: once per material rather than per mesh reference
+		std::vector<TextureIDs> materialTextures(cookedModel.GetNumMaterials());
+		for (size_t material = 0; material < cookedModel.GetNumMaterials(); ++material)
 		{
-			MeshID id = pScene->AddMesh_Async(mesh);
-			ModelMeshIDs.push_back(id);
+			if (!bMaterialUsed[material])
+				continue;
+			for (size_t texture = 0; texture < ModelCache::NUM_MATERIAL_TEXTURES; ++texture)
+			{
+				const char* pTexturePath = cookedModel.GetMaterialTexture(material, static_cast<ModelCache::EMaterialTexture>(texture));
+				materialTextures[material][texture] = pTexturePath 
+					? mpRenderer->CreateTextureFromFile(pTexturePath, modelDirectory, true) 
+					: INVALID_TEXTURE_ID;
+			}
 		}
 
-		modelData.mMaterialLookupPerMesh[ModelMeshIDs.back()] = pBRDF->ID;
-		if (pBRDF->IsTransparent())
+		for (size_t i = 0; i < numMeshReferences; ++i)
 		{
-			modelData.mTransparentMeshIDs.push_back(ModelMeshIDs.back());
+			const uint32_t meshIndex = cookedModel.GetMeshReference(i);
+			const ModelCache::MeshRecord& meshRecord = cookedModel.GetMesh(meshIndex);
+			const ModelCache::MaterialRecord& material = cookedModel.GetMaterial(meshRecord.materialIndex);
+			const TextureIDs& textures = materialTextures[meshRecord.materialIndex];
+
+			// MATERIAL
+			BRDF_Material* pBRDF = static_cast<BRDF_Material*>(pScene->CreateNewMaterial(GGX_BRDF));
+			if (textures[ModelCache::DIFFUSE_MAP]  != INVALID_TEXTURE_ID) pBRDF->diffuseMap  = textures[ModelCache::DIFFUSE_MAP];
+			if (textures[ModelCache::NORMAL_MAP]   != INVALID_TEXTURE_ID) pBRDF->normalMap   = textures[ModelCache::NORMAL_MAP];
+			if (textures[ModelCache::SPECULAR_MAP] != INVALID_TEXTURE_ID) pBRDF->specularMap = textures[ModelCache::SPECULAR_MAP];
+			if (textures[ModelCache::HEIGHT_MAP]   != INVALID_TEXTURE_ID) pBRDF->heightMap   = textures[ModelCache::HEIGHT_MAP];
+			if (textures[ModelCache::ALPHA_MAP]    != INVALID_TEXTURE_ID) pBRDF->mask        = textures[ModelCache::ALPHA_MAP];
+
+			if (material.flags & ModelCache::HAS_DIFFUSE_COLOR)  pBRDF->diffuse   = vec3(material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+			if (material.flags & ModelCache::HAS_SPECULAR_COLOR) pBRDF->specular  = vec3(material.specular[0], material.specular[1], material.specular[2]);
+			if (material.flags & ModelCache::HAS_OPACITY)        pBRDF->alpha     = material.opacity;
+			if (material.flags & ModelCache::HAS_ROUGHNESS)      pBRDF->roughness = material.roughness;
+			if (material.flags & ModelCache::IS_METALLIC)        pBRDF->metalness = 1.0f;
+			meshMaterials.push_back(pBRDF->ID);
+			bTransparentMeshes.push_back(pBRDF->IsTransparent());
+
+			// MESH: buffers are created directly from the cooked data, with the cooked bounding box
+			meshes.push_back(Mesh(&LODLevels[firstLODLevel[i]], firstLODLevel[i + 1] - firstLODLevel[i], GetImportedMeshName(meshIndex), meshRecord.aabbMin, meshRecord.aabbMax));
 		}
 	}
-	for (unsigned int i = 0; i < pNode->mNumChildren; i++)
-	{	// then do the same for each of its children
-		ModelData childModelData = ProcessNode(pNode->mChildren[i], pAiScene, modelDirectory, mpRenderer, pScene);
-		std::vector<MeshID>& ChildMeshes = childModelData.mMeshIDs;
-		std::vector<MeshID>& ChildMeshesTransparent = childModelData.mTransparentMeshIDs;
 
-		std::copy(ChildMeshes.begin(), ChildMeshes.end(), std::back_inserter(ModelMeshIDs));
-		std::copy(ChildMeshesTransparent.begin(), ChildMeshesTransparent.end(), std::back_inserter(modelData.mTransparentMeshIDs));
-		for (auto& kvp : childModelData.mMaterialLookupPerMesh)
+	ModelData modelData;
+	modelData.mMeshIDs.reserve(numMeshReferences);
+	for (size_t i = 0; i < numMeshReferences; ++i)
+	{
+		const MeshID id = pScene->AddMesh_Async(meshes[i]);
+		modelData.mMeshIDs.push_back(id);
+		modelData.mMaterialLookupPerMesh[id] = meshMaterials[i];
+		if (bTransparentMeshes[i])
 		{
-#if _DEBUG
-			assert(modelData.mMaterialLookupPerMesh.find(kvp.first) == modelData.mMaterialLookupPerMesh.end());
-#endif
-			modelData.mMaterialLookupPerMesh[kvp.first] = kvp.second;
+			modelData.mTransparentMeshIDs.push_back(id);
 		}
 	}
 	return modelData;
@@ -349,6 +520,152 @@ constexpr auto ASSIMP_LOAD_FLAGS
 | aiProcess_JoinIdenticalVertices
 | aiProcess_GenSmoothNormals;
 
+// cooked models are rebuilt when any of the settings that affect the import changes
+static uint64_t GetImportSettingsHash()
+{
+	std::string settings = std::to_string(ASSIMP_LOAD_FLAGS);
+#if GENERATE_LOD_CHAINS_FOR_IMPORTED_MODELS
+	settings += "|LOD:" + std::to_string(MIN_TRIANGLE_COUNT_FOR_LOD_CHAIN);
+	for (float ratio : LOD_CHAIN_TRIANGLE_RATIOS)
+		settings += "," + std::to_string(ratio);
+#endif
+#if OPTIMIZE_IMPORTED_MESHES
+	settings += "|MeshOpt:" + std::to_string(MeshOptimizer::DEFAULT_CACHE_SIZE) + "," + std::to_string(OPTIMIZE_OVERDRAW_FOR_IMPORTED_MESHES);
+#endif
+	return static_cast<uint64_t>(std::hash<std::string>()(settings));
+}
+
+// files the cooked model depends on besides the model file: the files Assimp opened during
+// the import and the textures of the materials, the ones that don't exist are skipped.
+static std::vector<std::string> GetModelDependencies(const ModelCache::ImportedModel& model, const std::vector<std::string>& importedFiles, const std::string& fullPath, const std::string& modelDirectory)
+{
+	std::vector<std::string> dependencies;
+	for (const std::string& file : importedFiles)
+		if (file != fullPath)
+			dependencies.push_back(file);
+	for (const ModelCache::ImportedMaterial& material : model.materials)
+		for (const std::string& texture : material.textures)
+			if (!texture.empty())
+				dependencies.push_back(modelDirectory + texture); // see Renderer::CreateTextureFromFile()
+
+	std::sort(RANGE(dependencies));
+	dependencies.erase(std::unique(RANGE(dependencies)), dependencies.end());
+	dependencies.erase(std::remove_if(RANGE(dependencies), [](const std::string& file) { return !DirectoryUtil::FileExists(file); }), dependencies.end());
+	return dependencies;
+}
+
+// imports the model with Assimp and cooks it, returns an empty vector if the import fails.
+static std::vector<char> ImportAndCookModel(const std::string& fullPath, const std::string& modelDirectory, VQEngine::ThreadPool* pThreadPool)
+{
+	Importer importer;
+	FileRecordingIOSystem* pIOSystem = new FileRecordingIOSystem(); // owned by the importer
+	importer.SetIOHandler(pIOSystem);
+
+	const aiScene* scene = importer.ReadFile(fullPath, ASSIMP_LOAD_FLAGS);
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		Log::Error("Assimp error: %s", importer.GetErrorString());
+		return std::vector<char>();
+	}
+
+	ModelCache::ImportedModel model = ImportModel(scene, pThreadPool);
+	model.dependencies = GetModelDependencies(model, pIOSystem->GetOpenedFiles(), fullPath, modelDirectory);
+	return ModelCache::Cook(model, GetImportSettingsHash());
+}
+
+// Measures the CPU cost of getting a model ready for buffer creation: Assimp import & cook (cold) 
+// vs. mapping & validating the cooked model, checking its dependencies and reading its buffers (warm).
+static void RunModelCacheBenchmark(const std::string& fullPath, const std::string& modelDirectory, const std::string& modelName, VQEngine::ThreadPool* pThreadPool)
+{
+	const uint64_t settingsHash = GetImportSettingsHash();
+	PerfTimer t;
+
+	t.Start();
+	const std::vector<char> cookedData = ImportAndCookModel(fullPath, modelDirectory, pThreadPool);
+	t.Stop();
+	if (cookedData.empty())
+		return;
+	const float coldLoadTime = t.DeltaTime();
+
+	const std::string cachePath = ModelCache::GetCacheFilePath(fullPath);
+	ModelCache::WriteCacheFile(cachePath, cookedData);
+
+	t.Reset();
+	t.Start();
+	MemoryMappedFile cacheFile;
+	ModelCache::CookedModel cookedModel;
+	uint32_t checksum = 0;
+	size_t numDependencies = 0;
+	if (cacheFile.Open(cachePath) 
+		&& cookedModel.Initialize(cacheFile.GetData(), cacheFile.GetSize(), settingsHash) 
+		&& !ModelCache::IsCacheDirty(fullPath, cachePath, cookedModel))
+	{	// touch the buffer data the way the buffer creation would
+		numDependencies = cookedModel.GetNumDependencies();
+		for (size_t mesh = 0; mesh < cookedModel.GetNumMeshes(); ++mesh)
+		{
+			for (uint32_t lod = 0; lod < cookedModel.GetMesh(mesh).numLODs; ++lod)
+			{
+				const LODLevelData level = cookedModel.GetMeshLOD(mesh, lod);
+				const uint32_t* pWords = static_cast<const uint32_t*>(level.pVertices);
+				for (size_t i = 0; i < level.numVertices * level.vertexStride / sizeof(uint32_t); ++i)
+					checksum += pWords[i];
+				pWords = static_cast<const uint32_t*>(level.pIndices);
+				for (size_t i = 0; i < level.numIndices; ++i)
+					checksum += pWords[i];
+			}
+		}
+	}
+	else
+	{
+		Log::Warning("[ModelCache Benchmark] %s: the cooked model can't be read back from %s", modelName.c_str(), cachePath.c_str());
+	}
+	t.Stop();
+	const float warmLoadTime = t.DeltaTime();
+
+	Log::Info("[ModelCache Benchmark] %s (%.2f MB, %zu dependencies): cold=%.3fs | warm=%.3fs | speedup=%.1fx (checksum=%u)"
+		, modelName.c_str(), cookedData.size() / (1024.0f * 1024.0f), numDependencies, coldLoadTime, warmLoadTime, coldLoadTime / (std::max)(warmLoadTime, 1e-6f), checksum);
+}
+
+bool ModelLoader::LoadModelData(const std::string& fullPath, const std::string& modelDirectory, Scene* pScene, ModelData& outModelData, bool& bOutCacheHit)
+{
+	PROFILE_SCOPE("ModelLoader::LoadModelData");
+	const uint64_t settingsHash = GetImportSettingsHash();
+	const std::string cachePath = ModelCache::GetCacheFilePath(fullPath);
+
+	// WARM LOAD: create the resources from the memory mapped cache file
+	//
+	bOutCacheHit = false;
+	if (DirectoryUtil::FileExists(cachePath))
+	{
+		MemoryMappedFile cacheFile;
+		ModelCache::CookedModel cookedModel;
+		if (cacheFile.Open(cachePath) 
+			&& cookedModel.Initialize(cacheFile.GetData(), cacheFile.GetSize(), settingsHash) 
+			&& !ModelCache::IsCacheDirty(fullPath, cachePath, cookedModel))
+		{
+			outModelData = CreateModelResources(cookedModel, modelDirectory, mpRenderer, pScene);
+			bOutCacheHit = true;
+			return true;
+		}
+		Log::Warning("Model cache is out of date or invalid, re-importing: %s", cachePath.c_str());
+	}
+
+	// COLD LOAD: import the model with Assimp and cook it
+	//
+	const std::vector<char> cookedData = ImportAndCookModel(fullPath, modelDirectory, mpThreadPool);
+	if (cookedData.empty())
+	{
+		return false;
+	}
+	ModelCache::WriteCacheFile(cachePath, cookedData);
+
+	ModelCache::CookedModel cookedModel;
+	const bool bCookedModelValid = cookedModel.Initialize(cookedData.data(), cookedData.size(), settingsHash);
+	assert(bCookedModelValid);
+	outModelData = CreateModelResources(cookedModel, modelDirectory, mpRenderer, pScene);
+	return true;
+}
+
 Model ModelLoader::LoadModel(const std::string & modelPath, Scene* pScene)
 {
 	assert(mpRenderer);
@@ -369,16 +686,19 @@ Model ModelLoader::LoadModel(const std::string & modelPath, Scene* pScene)
 
 	Log::Info("Loading Model: %s ...", modelName.c_str());
 
+	if (sbBenchmarkModelCache)
+	{
+		RunModelCacheBenchmark(fullPath, modelDirectory, modelName, mpThreadPool);
+	}
+
 	// IMPORT SCENE
 	//
-	Importer importer;
-	const aiScene* scene = importer.ReadFile(fullPath, ASSIMP_LOAD_FLAGS);
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	ModelData data;
+	bool bCacheHit = false;
+	if (!LoadModelData(fullPath, modelDirectory, pScene, data, bCacheHit))
 	{
-		Log::Error("Assimp error: %s", importer.GetErrorString());
 		return Model();
 	}
-	ModelData data = ProcessNode(scene->mRootNode, scene, modelDirectory, mpRenderer, pScene);
 
 	// cache the model
 	const Model model = Model(modelDirectory, modelName, std::move(data));
@@ -394,7 +714,7 @@ Model ModelLoader::LoadModel(const std::string & modelPath, Scene* pScene)
 		mSceneModels.at(pScene).push_back(fullPath);
 	}
 	t.Stop();
-	Log::Info("Loaded Model '%s' in %.2f seconds.", modelName.c_str(), t.DeltaTime());
+	Log::Info("Loaded Model '%s' in %.2f seconds (%s).", modelName.c_str(), t.DeltaTime(), bCacheHit ? "cooked" : "imported");
 	return model;
 }
 
@@ -421,16 +741,19 @@ Model ModelLoader::LoadModel_Async(const std::string& modelPath, Scene* pScene)
 
 	//Log::Info("Loading Model: %s ...", modelName.c_str());
 
+	if (sbBenchmarkModelCache)
+	{
+		RunModelCacheBenchmark(fullPath, modelDirectory, modelName, mpThreadPool);
+	}
+
 	// IMPORT SCENE
 	//
-	Importer importer;
-	const aiScene* scene = importer.ReadFile(fullPath, ASSIMP_LOAD_FLAGS);
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	ModelData data;
+	bool bCacheHit = false;
+	if (!LoadModelData(fullPath, modelDirectory, pScene, data, bCacheHit))
 	{
-		Log::Error("Assimp error: %s", importer.GetErrorString());
 		return Model();
 	}
-	ModelData data = ProcessNode(scene->mRootNode, scene, modelDirectory, mpRenderer, pScene);
 
 	// cache the model
 	const Model model = Model(modelDirectory, modelName, std::move(data));
@@ -453,7 +776,7 @@ Model ModelLoader::LoadModel_Async(const std::string& modelPath, Scene* pScene)
 	}
 
 	t.Stop();
-	//Log::Info("Loaded Model '%s' in %.2f seconds.", modelName.c_str(), t.DeltaTime());
+	Log::Info("Loaded Model '%s' in %.2f seconds (%s).", modelName.c_str(), t.DeltaTime(), bCacheHit ? "cooked" : "imported");
 	return model;
 }
 
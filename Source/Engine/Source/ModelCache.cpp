@@ -0,0 +1,280 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "ModelCache.h"
+
+#include "Application/Application.h"
+#include "Utilities/Log.h"
+#include "Utilities/utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <cstring>
+
+namespace ModelCache
+{
+	constexpr size_t SECTION_ALIGNMENT = 16;
+	static inline size_t AlignUp(size_t value) { return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1); }
+
+	// sections of the file must be in bounds & aligned for the records to be read in place
+	static bool IsSectionValid(uint64_t offset, uint64_t sizeInBytes, size_t fileSize)
+	{
+		return offset % SECTION_ALIGNMENT == 0 && offset <= fileSize && sizeInBytes <= fileSize - offset;
+	}
+
+	bool CookedModel::Initialize(const void* pData, size_t sizeInBytes, uint64_t importSettingsHash)
+	{
+		*this = CookedModel();
+		if (!pData || sizeInBytes < sizeof(FileHeader))
+			return false;
+
+		const char* pBytes = static_cast<const char*>(pData);
+		const FileHeader* pHeader = reinterpret_cast<const FileHeader*>(pBytes);
+		if (pHeader->magic != COOKED_MODEL_MAGIC || pHeader->version != COOKED_MODEL_VERSION
+			|| pHeader->importSettingsHash != importSettingsHash || pHeader->fileSize != sizeInBytes)
+		{
+			return false;
+		}
+
+		const bool bSectionsValid
+			=  IsSectionValid(pHeader->materialsOffset     , uint64_t(pHeader->numMaterials) * sizeof(MaterialRecord), sizeInBytes)
+			&& IsSectionValid(pHeader->meshesOffset        , uint64_t(pHeader->numMeshes) * sizeof(MeshRecord)       , sizeInBytes)
+			&& IsSectionValid(pHeader->LODsOffset          , uint64_t(pHeader->numLODs) * sizeof(LODRecord)          , sizeInBytes)
+			&& IsSectionValid(pHeader->meshReferencesOffset, uint64_t(pHeader->numMeshReferences) * sizeof(uint32_t) , sizeInBytes)
+			&& IsSectionValid(pHeader->dependenciesOffset  , uint64_t(pHeader->numDependencies) * sizeof(uint32_t)   , sizeInBytes)
+			&& IsSectionValid(pHeader->stringsOffset       , pHeader->stringsSize                                    , sizeInBytes);
+		if (!bSectionsValid)
+			return false;
+
+		const MaterialRecord* pMaterials = reinterpret_cast<const MaterialRecord*>(pBytes + pHeader->materialsOffset);
+		const MeshRecord* pMeshes = reinterpret_cast<const MeshRecord*>(pBytes + pHeader->meshesOffset);
+		const LODRecord* pLODs = reinterpret_cast<const LODRecord*>(pBytes + pHeader->LODsOffset);
+		const uint32_t* pMeshReferences = reinterpret_cast<const uint32_t*>(pBytes + pHeader->meshReferencesOffset);
+		const uint32_t* pDependencies = reinterpret_cast<const uint32_t*>(pBytes + pHeader->dependenciesOffset);
+		const char* pStrings = pBytes + pHeader->stringsOffset;
+
+		// validate the indices & the data ranges once here so that the accessors don't have to
+		if (pHeader->stringsSize > 0 && pStrings[pHeader->stringsSize - 1] != '\0')
+			return false;
+		for (uint32_t i = 0; i < pHeader->numMaterials; ++i)
+			for (uint32_t texture : pMaterials[i].textures)
+				if (texture != INVALID_STRING && texture >= pHeader->stringsSize)
+					return false;
+		for (uint32_t i = 0; i < pHeader->numDependencies; ++i)
+			if (pDependencies[i] >= pHeader->stringsSize)
+				return false;
+		for (uint32_t i = 0; i < pHeader->numMeshes; ++i)
+		{
+			const MeshRecord& mesh = pMeshes[i];
+			if (mesh.materialIndex >= pHeader->numMaterials || mesh.numLODs == 0 || uint64_t(mesh.firstLOD) + mesh.numLODs > pHeader->numLODs)
+				return false;
+		}
+		for (uint32_t i = 0; i < pHeader->numLODs; ++i)
+		{
+			const LODRecord& lod = pLODs[i];
+			if (lod.indexStride != sizeof(uint32_t) // narrowed to 16-bit by Mesh when the buffers are created
+				|| lod.vertexStride != sizeof(DefaultVertexBufferData)
+				|| !IsSectionValid(lod.verticesOffset, uint64_t(lod.numVertices) * lod.vertexStride, sizeInBytes)
+				|| !IsSectionValid(lod.indicesOffset, uint64_t(lod.numIndices) * lod.indexStride, sizeInBytes))
+			{
+				return false;
+			}
+
+			// the index buffers are created from the mapped data as is: an out of range index would read past the vertex buffer on the GPU
+			const uint32_t* pIndices = reinterpret_cast<const uint32_t*>(pBytes + lod.indicesOffset);
+			if (lod.numIndices % 3 != 0 || std::any_of(pIndices, pIndices + lod.numIndices, [&](uint32_t index) { return index >= lod.numVertices; }))
+				return false;
+		}
+		for (uint32_t i = 0; i < pHeader->numMeshReferences; ++i)
+			if (pMeshReferences[i] >= pHeader->numMeshes)
+				return false;
+
+		mpData = pBytes;
+		mpHeader = pHeader;
+		mpMaterials = pMaterials;
+		mpMeshes = pMeshes;
+		mpLODs = pLODs;
+		mpMeshReferences = pMeshReferences;
+		mpDependencies = pDependencies;
+		mpStrings = pStrings;
+		return true;
+	}
+
+	const char* CookedModel::GetMaterialTexture(size_t materialIndex, EMaterialTexture texture) const
+	{
+		const uint32_t offset = mpMaterials[materialIndex].textures[texture];
+		return offset == INVALID_STRING ? nullptr : mpStrings + offset;
+	}
+
+	LODLevelData CookedModel::GetMeshLOD(size_t meshIndex, size_t lod) const
+	{
+		const LODRecord& record = mpLODs[mpMeshes[meshIndex].firstLOD + lod];
+		LODLevelData level;
+		level.pVertices    = mpData + record.verticesOffset;
+		level.pIndices     = mpData + record.indicesOffset;
+		level.numVertices  = record.numVertices;
+		level.numIndices   = record.numIndices;
+		level.vertexStride = record.vertexStride;
+		level.indexStride  = record.indexStride;
+		level.error        = record.error;
+		return level;
+	}
+
+
+	std::vector<char> Cook(const ImportedModel& model, uint64_t importSettingsHash)
+	{
+		// strings
+		std::vector<char> strings;
+		std::vector<MaterialRecord> materials(model.materials.size());
+		for (size_t i = 0; i < model.materials.size(); ++i)
+		{
+			const ImportedMaterial& src = model.materials[i];
+			MaterialRecord& dst = materials[i];
+			for (size_t texture = 0; texture < NUM_MATERIAL_TEXTURES; ++texture)
+			{
+				dst.textures[texture] = src.textures[texture].empty() ? INVALID_STRING : static_cast<uint32_t>(strings.size());
+				if (!src.textures[texture].empty())
+					strings.insert(strings.end(), src.textures[texture].c_str(), src.textures[texture].c_str() + src.textures[texture].size() + 1);
+			}
+			dst.diffuse[0] = src.diffuse.x();   dst.diffuse[1] = src.diffuse.y();   dst.diffuse[2] = src.diffuse.z();
+			dst.specular[0] = src.specular.x(); dst.specular[1] = src.specular.y(); dst.specular[2] = src.specular.z();
+			dst.opacity = src.opacity;
+			dst.roughness = src.roughness;
+			dst.flags = src.flags;
+		}
+		std::vector<uint32_t> dependencies(model.dependencies.size());
+		for (size_t i = 0; i < model.dependencies.size(); ++i)
+		{
+			dependencies[i] = static_cast<uint32_t>(strings.size());
+			strings.insert(strings.end(), model.dependencies[i].c_str(), model.dependencies[i].c_str() + model.dependencies[i].size() + 1);
+		}
+
+		// meshes & LOD records: the data offsets are assigned once the layout is known
+		std::vector<MeshRecord> meshes(model.meshes.size());
+		std::vector<LODRecord> LODs;
+		for (size_t i = 0; i < model.meshes.size(); ++i)
+		{
+			const ImportedMesh& src = model.meshes[i];
+			MeshRecord& dst = meshes[i];
+			dst.materialIndex = src.materialIndex;
+			dst.firstLOD = static_cast<uint32_t>(LODs.size());
+			dst.numLODs = static_cast<uint32_t>(src.LODData.LODVertices.size());
+			std::memcpy(dst.aabbMin, src.aabbMin, sizeof(dst.aabbMin));
+			std::memcpy(dst.aabbMax, src.aabbMax, sizeof(dst.aabbMax));
+
+			for (size_t lod = 0; lod < dst.numLODs; ++lod)
+			{
+				LODRecord record = {};
+				record.numVertices  = static_cast<uint32_t>(src.LODData.LODVertices[lod].size());
+				record.numIndices   = static_cast<uint32_t>(src.LODData.LODIndices[lod].size());
+				record.vertexStride = sizeof(DefaultVertexBufferData);
+				record.indexStride  = sizeof(uint32_t);
+				record.error        = lod < src.LODData.LODErrors.size() ? src.LODData.LODErrors[lod] : 0.0f;
+				LODs.push_back(record);
+			}
+		}
+
+		// layout
+		FileHeader header = {};
+		size_t offset = AlignUp(sizeof(FileHeader));
+		header.materialsOffset      = offset; offset = AlignUp(offset + materials.size() * sizeof(MaterialRecord));
+		header.meshesOffset         = offset; offset = AlignUp(offset + meshes.size() * sizeof(MeshRecord));
+		header.LODsOffset           = offset; offset = AlignUp(offset + LODs.size() * sizeof(LODRecord));
+		header.meshReferencesOffset = offset; offset = AlignUp(offset + model.meshReferences.size() * sizeof(uint32_t));
+		header.dependenciesOffset   = offset; offset = AlignUp(offset + dependencies.size() * sizeof(uint32_t));
+		header.stringsOffset        = offset; offset = AlignUp(offset + strings.size());
+		for (size_t i = 0; i < model.meshes.size(); ++i)
+		{
+			for (uint32_t lod = 0; lod < meshes[i].numLODs; ++lod)
+			{
+				LODRecord& record = LODs[meshes[i].firstLOD + lod];
+				record.verticesOffset = offset; offset = AlignUp(offset + size_t(record.numVertices) * record.vertexStride);
+				record.indicesOffset  = offset; offset = AlignUp(offset + size_t(record.numIndices) * record.indexStride);
+			}
+		}
+
+		header.magic              = COOKED_MODEL_MAGIC;
+		header.version            = COOKED_MODEL_VERSION;
+		header.importSettingsHash = importSettingsHash;
+		header.fileSize           = offset;
+		header.numMaterials       = static_cast<uint32_t>(materials.size());
+		header.numMeshes          = static_cast<uint32_t>(meshes.size());
+		header.numLODs            = static_cast<uint32_t>(LODs.size());
+		header.numMeshReferences  = static_cast<uint32_t>(model.meshReferences.size());
+		header.numDependencies    = static_cast<uint32_t>(dependencies.size());
+		header.stringsSize        = strings.size();
+
+		// write
+		std::vector<char> data(offset, 0);
+		auto fnWrite = [&](uint64_t dstOffset, const void* pSrc, size_t sizeInBytes) { if (sizeInBytes) std::memcpy(data.data() + dstOffset, pSrc, sizeInBytes); };
+		fnWrite(0, &header, sizeof(header));
+		fnWrite(header.materialsOffset, materials.data(), materials.size() * sizeof(MaterialRecord));
+		fnWrite(header.meshesOffset, meshes.data(), meshes.size() * sizeof(MeshRecord));
+		fnWrite(header.LODsOffset, LODs.data(), LODs.size() * sizeof(LODRecord));
+		fnWrite(header.meshReferencesOffset, model.meshReferences.data(), model.meshReferences.size() * sizeof(uint32_t));
+		fnWrite(header.dependenciesOffset, dependencies.data(), dependencies.size() * sizeof(uint32_t));
+		fnWrite(header.stringsOffset, strings.data(), strings.size());
+		for (size_t i = 0; i < model.meshes.size(); ++i)
+		{
+			const MeshLODData<DefaultVertexBufferData>& LODData = model.meshes[i].LODData;
+			for (uint32_t lod = 0; lod < meshes[i].numLODs; ++lod)
+			{
+				const LODRecord& record = LODs[meshes[i].firstLOD + lod];
+				fnWrite(record.verticesOffset, LODData.LODVertices[lod].data(), size_t(record.numVertices) * record.vertexStride);
+				fnWrite(record.indicesOffset, LODData.LODIndices[lod].data(), size_t(record.numIndices) * record.indexStride);
+			}
+		}
+		return data;
+	}
+
+
+	std::string GetCacheFilePath(const std::string& modelPath)
+	{
+		// models with the same name in different folders get different cache files
+		const size_t pathHash = std::hash<std::string>()(modelPath);
+		return Application::s_ModelCacheDirectory + "\\" + DirectoryUtil::GetFileNameWithoutExtension(modelPath) + "_" + std::to_string(pathHash) + ".vqmodel";
+	}
+
+	bool IsCacheDirty(const std::string& modelPath, const std::string& cachePath, const CookedModel& cookedModel)
+	{
+		if (!DirectoryUtil::FileExists(cachePath)) return true;
+		if (DirectoryUtil::IsFileNewer(modelPath, cachePath)) return true;
+
+		// only the dependencies that existed when the model was cooked are recorded: a missing one was deleted or moved since
+		for (size_t i = 0; i < cookedModel.GetNumDependencies(); ++i)
+		{
+			const std::string dependency = cookedModel.GetDependency(i);
+			if (!DirectoryUtil::FileExists(dependency) || DirectoryUtil::IsFileNewer(dependency, cachePath))
+				return true;
+		}
+		return false;
+	}
+
+	bool WriteCacheFile(const std::string& cachePath, const std::vector<char>& cookedModel)
+	{
+		std::ofstream cache(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!cache.good())
+		{
+			Log::Warning("ModelCache: Cannot write cache file: %s", cachePath.c_str());
+			return false;
+		}
+		cache.write(cookedModel.data(), cookedModel.size());
+		cache.close();
+		return true;
+	}
+}
@@ -23,6 +23,7 @@
 
 #include "RenderPasses/RenderPasses.h"
 #include "Utilities/Log.h"
+#include "Utilities/utils.h"
 
 namespace VQEngine
 {
@@ -126,43 +127,115 @@ namespace VQEngine
 		return true;
 	}
 
+	ECullResult ClassifyBoundingBoxAgainstFrustum(const FrustumPlaneset& frustum, const BoundingBox& aabb)
+	{
+		// same epsilon as IsBoundingBoxVisibleFromFrustum() so the results are consistent
+		constexpr float EPSILON = 0.000002f;
+		const vec3 center = (aabb.hi + aabb.low) * 0.5f;
+		const vec3 extent = XMVectorAbs((aabb.hi - aabb.low) * 0.5f);
+
+		ECullResult result = CULL_RESULT_INSIDE;
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			const vec4& P = frustum.abcd[plane];
+			const float dist   = P.x * center.x() + P.y * center.y() + P.z * center.z() + P.w;
+			const float radius = std::fabsf(P.x) * extent.x() + std::fabsf(P.y) * extent.y() + std::fabsf(P.z) * extent.z();
+			
+			if (dist + radius <= EPSILON) // p-vertex is outside
+				return CULL_RESULT_OUTSIDE;
+			
+			if (dist - radius < 0.0f)     // n-vertex is outside
+				result = CULL_RESULT_INTERSECTING;
+		}
+		return result;
+	}
+
+	ECullResult ClassifyBoundingBoxAgainstSphere(const BoundingBox& aabb, const Sphere& sphere)
+	{
+		// squared distances from the sphere center to the closest and the furthest points of the AABB
+		const float C [3] = { sphere.c.x(), sphere.c.y(), sphere.c.z() };
+		const float Lo[3] = { std::fminf(aabb.low.x(), aabb.hi.x()), std::fminf(aabb.low.y(), aabb.hi.y()), std::fminf(aabb.low.z(), aabb.hi.z()) };
+		const float Hi[3] = { std::fmaxf(aabb.low.x(), aabb.hi.x()), std::fmaxf(aabb.low.y(), aabb.hi.y()), std::fmaxf(aabb.low.z(), aabb.hi.z()) };
+
+		float sqDistClosest = 0.0f;
+		float sqDistFurthest = 0.0f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float c = C[axis], lo = Lo[axis], hi = Hi[axis];
+			const float dClosest = c < lo ? lo - c : (c > hi ? c - hi : 0.0f);
+			const float dFurthest = std::fmaxf(std::fabsf(c - lo), std::fabsf(c - hi));
+			sqDistClosest  += dClosest  * dClosest;
+			sqDistFurthest += dFurthest * dFurthest;
+		}
+
+		const float sqRadius = sphere.r * sphere.r;
+		if (sqDistClosest > sqRadius)   return CULL_RESULT_OUTSIDE;
+		if (sqDistFurthest <= sqRadius) return CULL_RESULT_INSIDE;
+		return CULL_RESULT_INTERSECTING;
+	}
+
+	ECullResult ClassifyBoundingBoxAgainstCone(const BoundingBox& aabb, const Cone& cone)
+	{
+		// bounding sphere of the AABB
+		const vec3 center = (aabb.hi + aabb.low) * 0.5f;
+		const vec3 diag = (aabb.hi - aabb.low) * 0.5f;
+		const float r = std::sqrtf(XMVector3Dot(diag, diag).m128_f32[0]);
+
+		// decompose the apex->center vector into the components along and perpendicular to the cone axis
+		const vec3 V = center - cone.apex;
+		const float distAlongAxis = XMVector3Dot(V, cone.direction).m128_f32[0];
+		const float sqDistToApex = XMVector3Dot(V, V).m128_f32[0];
+		const float distToAxis = std::sqrtf(std::fmaxf(sqDistToApex - distAlongAxis * distAlongAxis, 0.0f));
+
+		// signed distance from the sphere center to the lateral surface of the cone
+		const float distToSurface = std::cosf(cone.halfAngle) * distToAxis - std::sinf(cone.halfAngle) * distAlongAxis;
+
+		if (distToSurface > r || distAlongAxis < -r || distAlongAxis > cone.range + r)
+			return CULL_RESULT_OUTSIDE;
+
+		if (distToSurface < -r && distAlongAxis - r >= 0.0f && distAlongAxis + r <= cone.range)
+			return CULL_RESULT_INSIDE;
+
+		return CULL_RESULT_INTERSECTING;
+	}
+
 	size_t CullMeshes(
 		const FrustumPlaneset& frustumPlanes,
 		const GameObject* pObj,
+		const WorldTransformCache& worldCache,
 		MeshDrawData& meshDrawData
 	)
 	{
 		size_t numCulled = pObj->GetModelData().mMeshIDs.size();
 
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-		const XMMATRIX  matWorld = pObj->GetTransform().WorldTransformationMatrix();
+		const XMMATRIX& matWorld = worldCache.GetWorldMatrix(pObj);
 #else
-		meshDrawData.matWorld = pObj->GetTransform().WorldTransformationMatrix();
+		meshDrawData.matWorld = worldCache.GetWorldMatrix(pObj);
 		const XMMATRIX& matWorld = meshDrawData.matWorld;
 #endif
 
 		// first test at GameObject granularity
-		BoundingBox BB = pObj->GetAABB();
-		BB.low = XMVector3Transform(BB.low, matWorld);
-		BB.hi  = XMVector3Transform(BB.hi , matWorld); // world space BB
-		if (!IsBoundingBoxVisibleFromFrustum(frustumPlanes, BB))
+		if (!IsBoundingBoxVisibleFromFrustum(frustumPlanes, worldCache.GetWorldAABB(pObj)))
 		{
 			return numCulled;
 		}
 
 		// if GameObject is visible, then test individual meshes.
 		const std::vector<MeshID>& objMeshIDs = pObj->GetModelData().mMeshIDs;
+		const std::vector<BoundingBox>& meshBBs = worldCache.GetWorldMeshAABBs(pObj); // world space BBs
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+		int matrixIndex = -1; // the visible meshes of the object share the matrix
+#endif
 		for (MeshID meshIDIndex = 0; meshIDIndex < objMeshIDs.size(); ++meshIDIndex)
 		{
 			const MeshID meshID = objMeshIDs[meshIDIndex];
-
-			BB = pObj->GetMeshBBs()[meshIDIndex]; // local space BB
-			BB.low = XMVector3Transform(BB.low, matWorld);
-			BB.hi  = XMVector3Transform(BB.hi , matWorld); // world space BB
-			if (IsBoundingBoxVisibleFromFrustum(frustumPlanes, BB))
+			if (IsBoundingBoxVisibleFromFrustum(frustumPlanes, meshBBs[meshIDIndex]))
 			{
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-				meshDrawData.AddMeshTransformation(meshID, matWorld);
+				if (matrixIndex == -1)
+					matrixIndex = meshDrawData.AddMatrix(matWorld);
+				meshDrawData.AddDraw(meshID, matrixIndex);
 #else
 				meshDrawData.meshIDs.push_back(meshID);
 #endif
@@ -221,48 +294,49 @@ namespace VQEngine
 	}
 #endif
 
+	CullingPlanes ToCullingPlanes(const FrustumPlaneset& frustum)
+	{
+		CullingPlanes planes;
+		for (int p = 0; p < 6; ++p)
+		{
+			planes.abcd[p][0] = frustum.abcd[p].x;
+			planes.abcd[p][1] = frustum.abcd[p].y;
+			planes.abcd[p][2] = frustum.abcd[p].z;
+			planes.abcd[p][3] = frustum.abcd[p].w;
+		}
+		return planes;
+	}
+
+	size_t CullBoundingBoxes_VisibilityMask(const FrustumPlaneset& frustum, const BoundingBoxSoA& aabbs, std::vector<uint32_t>& outVisibilityMask)
+	{
+		return CullBoundingBoxes_VisibilityMask(ToCullingPlanes(frustum), aabbs, outVisibilityMask);
+	}
+
+	size_t CullBoundingBoxes(const FrustumPlaneset& frustum, const BoundingBoxSoA& aabbs, std::vector<int>& outVisibleIndices)
+	{
+		return CullBoundingBoxes(ToCullingPlanes(frustum), aabbs, outVisibleIndices);
+	}
+
 	size_t CullGameObjects(
 		const FrustumPlaneset&                  frustumPlanes
-		, const std::vector<const GameObject*>& pObjs
-		, std::vector<const GameObject*>&       pCulledObjs
+		, const FrameVector<const GameObject*>& pObjs
+		, const WorldTransformCache&            worldCache
+		, FrameVector<const GameObject*>&       pCulledObjs
 	)
 	{
-		size_t currIdx = 0;
+		// gather the world space AABBs into SoA layout, then batch-cull them.
+		// keep the object list in sync with the SoA so we can map indices back.
+		// containers are thread_local so their memory is reused between calls.
+		thread_local BoundingBoxSoA aabbs;
+		thread_local std::vector<const GameObject*> pObjsSoA;
+		thread_local std::vector<int> visibleIndices;
+		aabbs.Clear();
+		pObjsSoA.clear();
+		aabbs.Reserve(pObjs.size());
+		pObjsSoA.reserve(pObjs.size());
+
 		std::for_each(RANGE(pObjs), [&](const GameObject* pObj)
 		{
-			// aabb is static and in world space during load time.
-			// this wouldn't work for dynamic objects in this state.
-			const BoundingBox aabb_world = [&]()
-			{
-				const XMMATRIX world = pObj->GetTransform().WorldTransformationMatrix();
-				const BoundingBox& aabb_local = pObj->GetAABB();
-#if 1
-				// transform low and high points of the bounding box: model->world
-				return BoundingBox(
-				{
-					XMVector4Transform(vec4(aabb_local.low, 1.0f), world),
-					XMVector4Transform(vec4(aabb_local.hi , 1.0f), world)
-				});
-#else
-				//----------------------------------------------------------------------------------
-				// TODO: there's an error in the code below. 
-				// bug repro: turn your back to the nanosuit in sponza scene -> suit won't be culled.
-				//----------------------------------------------------------------------------------
-				// transform center and extent and construct high and low later
-				// we can use XMVector3Transform() for the extent vector to save some instructions
-				const XMMATRIX worldRotation = pObj->GetTransform().RotationMatrix();
-				const vec3 extent = aabb_local.hi - aabb_local.low;
-				const vec4 center = vec4((aabb_local.hi + aabb_local.low) * 0.5f, 1.0f);
-				const vec3 tfC = XMVector4Transform(center, world);
-				const vec3 tfEx = XMVector3Transform(extent, worldRotation) * 0.5f;
-				return BoundingBox(
-					{
-						{tfC - tfEx},	// lo
-						{tfC + tfEx}	// hi
-					});
-#endif
-			}();
-
 			//assert(!pObj->GetModelData().mMeshIDs.empty());
 			if (pObj->GetModelData().mMeshIDs.empty())
 			{
@@ -272,29 +346,36 @@ namespace VQEngine
 				return;
 			}
 
-			if (IsBoundingBoxVisibleFromFrustum(frustumPlanes, aabb_world))
-			{
-				pCulledObjs.push_back(pObj);
-				++currIdx;
-			}
+			aabbs.AddBoundingBox(worldCache.GetWorldAABB(pObj));
+			pObjsSoA.push_back(pObj);
 		});
-		return pObjs.size() - currIdx;
-	}
-
 
+		CullBoundingBoxes(frustumPlanes, aabbs, visibleIndices);
+		for (const int i : visibleIndices)
+		{
+			pCulledObjs.push_back(pObjsSoA[i]);
+		}
+		return pObjs.size() - visibleIndices.size();
+	}
 
-#if THREADED_FRUSTUM_CULL
-	struct CullMeshWorkerData
-	{
-		// in
-		const Light* pLight;
-		const std::vector<const GameObject*>& renderableList;
 
-		// out
-		std::array< MeshDrawList, 6> meshListForPoints;
-	};
-#endif
+}
 
+BoundingBox BoundingBox::GetTransformedAABB(const XMMATRIX& matTransform) const
+{
+	const XMVECTOR center = XMVectorScale(XMVectorAdd(this->hi, this->low), 0.5f);
+	const XMVECTOR extent = XMVectorAbs(XMVectorScale(XMVectorSubtract(this->hi, this->low), 0.5f));
+
+	// rows of the matrix are the transformed basis vectors (row-vector convention)
+	const XMVECTOR tfCenter = XMVector3Transform(center, matTransform);
+	XMVECTOR tfExtent =  XMVectorMultiply   (XMVectorSplatX(extent), XMVectorAbs(matTransform.r[0]));
+	tfExtent         =  XMVectorMultiplyAdd(XMVectorSplatY(extent), XMVectorAbs(matTransform.r[1]), tfExtent);
+	tfExtent         =  XMVectorMultiplyAdd(XMVectorSplatZ(extent), XMVectorAbs(matTransform.r[2]), tfExtent);
+
+	BoundingBox tfAABB;
+	tfAABB.low = XMVectorSubtract(tfCenter, tfExtent);
+	tfAABB.hi  = XMVectorAdd(tfCenter, tfExtent);
+	return tfAABB;
 }
 
 std::array<vec4, 8> BoundingBox::GetCornerPointsV4() const
@@ -328,3 +409,76 @@ std::array<vec3, 8> BoundingBox::GetCornerPointsV3() const
 		vec3(this->low.x(), this->hi.y() , this->hi.z() )
 	};
 }
+
+void BoundingBoxSoA::AddBoundingBox(const BoundingBox& aabb)
+{
+	// low/hi might be swapped if the box was transformed by its corner points only,
+	// hence the abs() for the extent.
+	const vec3 center = (aabb.hi + aabb.low) * 0.5f;
+	const vec3 extent = XMVectorAbs((aabb.hi - aabb.low) * 0.5f);
+	AddBoundingBox(center, extent);
+}
+
+void BoundingBoxSoA::AddBoundingBox(const vec3& center, const vec3& extent)
+{
+	AddBoundingBox(center.x(), center.y(), center.z(), extent.x(), extent.y(), extent.z());
+}
+
+
+void WorldTransformCache::Initialize(const std::vector<GameObject>& objectPool)
+{
+	Clear();
+	if (objectPool.empty())
+		return;
+
+	const size_t poolSize = objectPool.size();
+	mpObjectPoolBegin = &objectPool[0];
+	mTransformVersions.resize(poolSize, INVALID_VERSION);
+	mWorldMatrices.resize(poolSize, XMMatrixIdentity());
+	mWorldAABBs.resize(poolSize);
+	mWorldMeshAABBs.resize(poolSize);
+}
+
+void WorldTransformCache::Clear()
+{
+	mpObjectPoolBegin = nullptr;
+	mTransformVersions.clear();
+	mWorldMatrices.clear();
+	mWorldAABBs.clear();
+	mWorldMeshAABBs.clear();
+}
+
+void WorldTransformCache::Invalidate()
+{
+	std::fill(RANGE(mTransformVersions), INVALID_VERSION);
+}
+
+size_t WorldTransformCache::Update(const std::vector<GameObject*>& pObjects)
+{
+	size_t numUpdated = 0;
+	for (const GameObject* pObj : pObjects)
+	{
+		const size_t i = GetIndex(pObj);
+		assert(i < mTransformVersions.size());
+
+		const Transform& tf = pObj->GetTransform();
+		if (mTransformVersions[i] == tf.GetVersion())
+			continue;
+
+		const XMMATRIX matWorld = tf.WorldTransformationMatrix();
+		mWorldMatrices[i] = matWorld;
+		mWorldAABBs[i] = pObj->GetAABB().GetTransformedAABB(matWorld);
+
+		const std::vector<BoundingBox>& meshBBs = pObj->GetMeshBBs();
+		std::vector<BoundingBox>& worldMeshBBs = mWorldMeshAABBs[i];
+		worldMeshBBs.resize(meshBBs.size());
+		for (size_t mesh = 0; mesh < meshBBs.size(); ++mesh)
+		{
+			worldMeshBBs[mesh] = meshBBs[mesh].GetTransformedAABB(matWorld);
+		}
+
+		mTransformVersions[i] = tf.GetVersion();
+		++numUpdated;
+	}
+	return numUpdated;
+}
@@ -25,13 +25,33 @@
 
 #include "Application/Input.h"
 #include "Application/ThreadPool.h"
+#include "Application/TaskGraph.h"
 #include "Renderer/GeometryGenerator.h"
 #include "Utilities/Log.h"
 
 #include <numeric>
 #include <set>
 
-#define THREADED_FRUSTUM_CULL 0	// uses workers to cull the render lists (not implemented yet)
+#define THREADED_FRUSTUM_CULL 1	// uses the thread pool workers to cull the shadow views
+#define THREADED_PRERENDER    1	// executes the PreRender() stages as a task graph on the thread pool workers
+#define USE_BVH_CULLING       1	// queries the scene BVH instead of culling the render lists linearly
+
+// Runs fnJob(i) for i in [0, numJobs) on the thread pool workers and the calling thread,
+// or serially on the calling thread if @pThreadPool is nullptr.
+// Jobs are pulled one at a time so that uneven job costs (e.g. lights with different 
+// ranges) are balanced between the threads. Returns when all the jobs are finished.
+//
+template<class TFn>
+static void RunParallel(VQEngine::ThreadPool* pThreadPool, size_t numJobs, TFn&& fnJob)
+{
+	if (pThreadPool)
+	{
+		pThreadPool->ParallelFor(0, numJobs, 1, fnJob);
+		return;
+	}
+	for (size_t i = 0; i < numJobs; ++i)
+		fnJob(i);
+}
 
 Scene::Scene(const BaseSceneParams& params)
 	: mpRenderer(params.pRenderer)
@@ -41,7 +61,7 @@ Scene::Scene(const BaseSceneParams& params)
 	, mLODManager(this->mMeshes, this->mpRenderer)
 	, mActiveSkyboxPreset(ENVIRONMENT_MAP_PRESET_COUNT)
 {
-	mModelLoader.Initialize(mpRenderer);
+	mModelLoader.Initialize(mpRenderer, nullptr);
 }
 
 
@@ -50,6 +70,8 @@ Scene::Scene(const BaseSceneParams& params)
 //----------------------------------------------------------------------------------------------------------------
 void Scene::LoadScene(SerializedScene& scene, const Settings::Window& windowSettings)
 {
+	// the thread pool is assigned by the Engine after the scene is constructed
+	mModelLoader.Initialize(mpRenderer, mpThreadPool);
 
 	//
 	// Allocate GameObject & Material memory
@@ -61,6 +83,7 @@ void Scene::LoadScene(SerializedScene& scene, const Settings::Window& windowSett
 	mObjectPool.Initialize(4096 * 8);
 	mMaterials.Initialize(4096 * 8);
 #endif
+	mWorldTransformCache.Initialize(mObjectPool.mObjects);
 
 	mMeshes.clear();
 	mpObjects.clear();
@@ -116,7 +139,9 @@ void Scene::LoadScene(SerializedScene& scene, const Settings::Window& windowSett
 
 	EndLoadingModels();
 
-	// initialize LOD manager
+	CalculateSceneBoundingBox();	// needs to happen after models are loaded
+
+	// initialize LOD manager: uses the bounding boxes for the LOD distances
 	{
 		std::vector<GameObject*> pSceneObjects;
 		for (GameObject* pObj : mpObjects)
@@ -127,9 +152,13 @@ void Scene::LoadScene(SerializedScene& scene, const Settings::Window& windowSett
 			}
 		}
 
-		mLODManager.Initialize(GetActiveCamera(), pSceneObjects);
+		mLODManager.Initialize(GetActiveCamera(), pSceneObjects, mObjectPool.mObjects);
 	}
-	CalculateSceneBoundingBox();	// needs to happen after models are loaded
+	
+	// bounding boxes are calculated: populate the cache for the static objects
+	mWorldTransformCache.Invalidate();
+	mWorldTransformCache.Update(mpObjects);
+	BuildSceneBVH();
 }
 
 void Scene::UnloadScene()
@@ -142,6 +171,8 @@ void Scene::UnloadScene()
 	mMaterials.Clear();
 	//---------------------------------------------------------------------------
 	mCameras.clear();
+	mWorldTransformCache.Clear();
+	mBVH.Clear();
 	mObjectPool.Cleanup();
 	mMeshes.clear();
 	mObjectPool.Cleanup();
@@ -149,6 +180,11 @@ void Scene::UnloadScene()
 	mLODManager.Reset();
 	Unload();
 	mpObjects.clear();
+
+	// drop the render lists while the frame memory they're allocated from is still valid
+	mSceneView.ClearRenderLists(nullptr);
+	mShadowView.Clear(nullptr);
+	mpFrameMemory = nullptr;
 }
 
 
@@ -281,23 +317,20 @@ void Scene::UpdateScene(float dt)
 
 	// UPDATE CAMERA & WORLD
 	//
-	mpCPUProfiler->BeginEntry("Scene::Update()");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Scene::Update()"));
 	mCameras[mSelectedCamera].Update(dt);
 	Update(dt);
 	mpCPUProfiler->EndEntry();
 
-	// UPDATE LOD MANAGER
-	//
-	mpCPUProfiler->BeginEntry("LODManager::Update()");
-	mLODManager.Update();
+	// the LOD manager & the culling read the object positions from the world transform cache
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("UpdateWorldTransformCache"));
+	UpdateWorldTransformCache();
 	mpCPUProfiler->EndEntry();
 
-
-	// Note:
-	// this could be moved outside this function to allow for more time 
-	// for concurrency of lod manager update operations (if it takes that long).
-	mpCPUProfiler->BeginEntry("LODManager::LateUpdate()");
-	mLODManager.LateUpdate();
+	// UPDATE LOD MANAGER
+	//
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("LODManager::Update()"));
+	mLODManager.Update(mpThreadPool, mWorldTransformCache);
 	mpCPUProfiler->EndEntry();
 }
 
@@ -314,10 +347,18 @@ void Scene::PreRender(FrameStats& stats, SceneLightingConstantBuffer& outLightin
 {
 	using namespace VQEngine;
 
+	// counts the heap allocations of the whole function, including building the task graph
+	const size_t numHeapAllocationsBefore = GetHeapAllocationCount();
+
+	// the render lists of this frame are allocated from the current frame memory, 
+	// which the Engine resets at the beginning of the frame.
+	mpFrameMemory = mpFrameAllocator ? &mpFrameAllocator->GetCurrent() : nullptr;
+
 	// containers we'll work on for preparing draw lists
-	std::vector<const GameObject*> mainViewRenderList; // Shadow casters + non-shadow casters
-	std::vector<const GameObject*> mainViewShadowCasterRenderList;
-	SceneShadowingLightIndexCollection shadowingLightIndexCollection;
+	RenderList mainViewRenderList(mpFrameMemory); // Shadow casters + non-shadow casters
+	RenderList mainViewShadowCasterRenderList(mpFrameMemory);
+	SceneShadowingLightIndexCollection shadowingLightIndexCollection(mpFrameMemory);
+	FrameVector<const Light*> pShadowingLights(mpFrameMemory);
 
 
 	//----------------------------------------------------------------------------
@@ -325,74 +366,87 @@ void Scene::PreRender(FrameStats& stats, SceneLightingConstantBuffer& outLightin
 	//----------------------------------------------------------------------------
 	SetSceneViewData();
 	ResetSceneStatCounters(stats.scene);
-	
-
-	//----------------------------------------------------------------------------
-	// PREPARE RENDER LISTS
-	//----------------------------------------------------------------------------
-	mpCPUProfiler->BeginEntry("GatherSceneObjects");
-	GatherSceneObjects(mainViewShadowCasterRenderList, stats.scene.numObjects);
-	mpCPUProfiler->EndEntry();
-
-	//----------------------------------------------------------------------------
-	// CULL LIGHTS
-	//----------------------------------------------------------------------------
-	mpCPUProfiler->BeginEntry("Cull_Lights");
-	shadowingLightIndexCollection = CullShadowingLights(stats.scene.numCulledShadowingPointLights, stats.scene.numCulledShadowingSpotLights);
-	mpCPUProfiler->EndEntry(); 
-
-	//----------------------------------------------------------------------------
-	// CULL MAIN VIEW RENDER LISTS
-	//----------------------------------------------------------------------------
-	mpCPUProfiler->BeginEntry("Cull_MainView");
-	mainViewRenderList = FrustumCullMainView(stats.scene.numMainViewCulledObjects);
-	mpCPUProfiler->EndEntry(); 
 
 
 	//----------------------------------------------------------------------------
-	// CULL SHADOW VIEW RENDER LISTS
+	// BUILD THE TASK GRAPH
 	//----------------------------------------------------------------------------
-	//mpCPUProfiler->BeginEntry("Cull_ShadowViews"); 
-	FrustumCullPointAndSpotShadowViews(mainViewShadowCasterRenderList, shadowingLightIndexCollection, stats);
-	//mpCPUProfiler->EndEntry(); 
-
+	// Each stage only writes to its own outputs, which are either local
+	// containers of this function or separate members of the scene/shadow view.
+	//
+	// GatherSceneObjects --+--> Cull_MainView ----> Batch_MainView ----> DrawItems_MainView
+	//                      |
+	// Cull_Lights ---------+--> Cull_ShadowViews -> Batch_ShadowViews -> DrawItems_ShadowViews
+	//      |                                                              ^
+	//      +--> Gather_FlattenedLightList --------------------------------+--> GatherLightData
+	//
+	const bool bSortRenderLists = mSceneRenderSettings.optimization.bSortRenderLists;
+	TaskGraph& taskGraph = mPreRenderTaskGraph;
+	taskGraph.Clear();
 
-	//----------------------------------------------------------------------------
-	// OCCLUSION CULL DIRECTIONAL SHADOW VIEW RENDER LISTS (not implemented yet)
-	//----------------------------------------------------------------------------
-	if (mSceneRenderSettings.optimization.bShadowViewCull)
+	const TaskGraph::TaskID gatherSceneObjects = taskGraph.AddTask(PROFILER_ENTRY("GatherSceneObjects"), [&]()
 	{
-		mpCPUProfiler->BeginEntry("Cull_Directional_Occl");
-		OcclusionCullDirectionalLightView();
-		mpCPUProfiler->EndEntry();
-	}
+		GatherSceneObjects(mainViewShadowCasterRenderList, stats.scene.numObjects);
+	});
+	const TaskGraph::TaskID cullLights = taskGraph.AddTask(PROFILER_ENTRY("Cull_Lights"), [&]()
+	{
+		shadowingLightIndexCollection = CullShadowingLights(stats.scene.numCulledShadowingPointLights, stats.scene.numCulledShadowingSpotLights);
+	});
+	const TaskGraph::TaskID gatherLightList = taskGraph.AddTask(PROFILER_ENTRY("Gather_FlattenedLightList"), [&]()
+	{
+		pShadowingLights = shadowingLightIndexCollection.GetFlattenedListOfLights(mLightsStatic, mLightsDynamic, mpFrameMemory);
+	}, { cullLights });
 
-	//mpCPUProfiler->BeginEntry("Gather_FlattenedLightList");
-	std::vector<const Light*> pShadowingLights = shadowingLightIndexCollection.GetFlattenedListOfLights(mLightsStatic, mLightsDynamic);
-	//mpCPUProfiler->EndEntry();
+	// MAIN VIEW
+	const TaskGraph::TaskID cullMainView = taskGraph.AddTask(PROFILER_ENTRY("Cull_MainView"), [&]()
+	{
+		mainViewRenderList = FrustumCullMainView(stats.scene.numMainViewCulledObjects);
+	}, { gatherSceneObjects });
+	const TaskGraph::TaskID batchMainView = taskGraph.AddTask(PROFILER_ENTRY("Batch_MainView"), [&]()
+	{
+		BatchMainViewRenderList(mainViewRenderList);
+	}, { cullMainView });
+	taskGraph.AddTask(PROFILER_ENTRY("DrawItems_MainView"), [&]()
+	{
+		BuildMainViewDrawItems(bSortRenderLists);
+	}, { batchMainView });
 
-	//----------------------------------------------------------------------------
-	// SORT RENDER LISTS
-	//----------------------------------------------------------------------------
-	if (mSceneRenderSettings.optimization.bSortRenderLists)
+	// SHADOW VIEWS
+	TaskGraph::TaskID shadowViewsReady = taskGraph.AddTask(PROFILER_ENTRY("Cull_ShadowViews"), [&]()
 	{
-		mpCPUProfiler->BeginEntry("Sort");
-		SortRenderLists(mainViewShadowCasterRenderList, pShadowingLights);
-		mpCPUProfiler->EndEntry();
+		FrustumCullPointAndSpotShadowViews(mainViewShadowCasterRenderList, shadowingLightIndexCollection, stats);
+	}, { gatherSceneObjects, cullLights });
+	if (mSceneRenderSettings.optimization.bShadowViewCull) // occlusion cull directional shadow view (not implemented yet)
+	{
+		shadowViewsReady = taskGraph.AddTask(PROFILER_ENTRY("Cull_Directional_Occl"), [&]()
+		{
+			OcclusionCullDirectionalLightView();
+		}, { shadowViewsReady });
 	}
+	const TaskGraph::TaskID batchShadowViews = taskGraph.AddTask(PROFILER_ENTRY("Batch_ShadowViews"), [&]()
+	{
+		BatchShadowViewRenderLists(mainViewShadowCasterRenderList);
+	}, { shadowViewsReady });
+	taskGraph.AddTask(PROFILER_ENTRY("DrawItems_ShadowViews"), [&]()
+	{
+		BuildShadowViewDrawItems(pShadowingLights, bSortRenderLists);
+	}, { batchShadowViews, gatherLightList });
+
+	// LIGHTS
+	taskGraph.AddTask(PROFILER_ENTRY("GatherLightData"), [&]()
+	{	// GatherSceneObjects() clears the shadow view lights this task populates
+		GatherLightData(outLightingData, pShadowingLights);
+	}, { gatherLightList, gatherSceneObjects });
 
 
 	//----------------------------------------------------------------------------
-	// BATCH SHADOW VIEW RENDER LISTS
-	//----------------------------------------------------------------------------
-	BatchShadowViewRenderLists(mainViewShadowCasterRenderList);
-	
-	
-	//----------------------------------------------------------------------------
-	// BATCH MAIN VIEW RENDER LISTS
+	// EXECUTE
 	//----------------------------------------------------------------------------
-	mpCPUProfiler->BeginEntry("Batch_MainView");
-	BatchMainViewRenderList(mainViewRenderList);
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("PreRender_TaskGraph"));
+	taskGraph.Execute(THREADED_PRERENDER ? mpThreadPool : nullptr);
+	stats.scene.numPreRenderHeapAllocations = static_cast<int>(GetHeapAllocationCount() - numHeapAllocationsBefore) // operator new, 0 if !COUNT_HEAP_ALLOCATIONS
+		+ (mpFrameMemory ? mpFrameMemory->GetNumHeapAllocations() : 0); // frame memory overflow & growth
+	stats.scene.frameMemoryUsageKB = mpFrameMemory ? static_cast<int>(mpFrameMemory->GetUsedBytes() / 1024) : 0;
 	mpCPUProfiler->EndEntry();
 
 
@@ -417,11 +471,6 @@ void Scene::PreRender(FrameStats& stats, SceneLightingConstantBuffer& outLightin
 	}
 #endif // THREADED_FRUSTUM_CULL
 
-
-	mpCPUProfiler->BeginEntry("GatherLightData");
-	GatherLightData(outLightingData, pShadowingLights);
-	mpCPUProfiler->EndEntry();
-
 	//return numFrustumCulledObjs + numShadowFrustumCullObjs;
 }
 
@@ -494,7 +543,7 @@ using pSpotLightDataArray = std::array<SpotLightDataArray*, 2>;
 
 // stores the number of lights per light type (2 types : point and spot)
 using pNumArray = std::array<int*, 2>;
-void Scene::GatherLightData(SceneLightingConstantBuffer & outLightingData, const std::vector<const Light*>& pLightList)
+void Scene::GatherLightData(SceneLightingConstantBuffer & outLightingData, const FrameVector<const Light*>& pLightList)
 {
 	SceneLightingConstantBuffer::cb& cbuffer = outLightingData._cb;
 
@@ -629,24 +678,43 @@ void Scene::SetSceneViewData()
 	mSceneView.bIsIBLEnabled = mSceneRenderSettings.bSkylightEnabled && mSceneView.bIsPBRLightingUsed && mSceneView.environmentMap.environmentMap != -1;
 }
 
-void Scene::GatherSceneObjects(std::vector <const GameObject*>& mainViewShadowCasterRenderList, int& outNumSceneObjects)
+void Scene::UpdateWorldTransformCache()
+{
+	// only the objects with modified transforms are recalculated
+	const size_t numUpdatedObjects = mWorldTransformCache.Update(mpObjects);
+
+	// objects created after LoadScene() require a rebuild, whereas moving 
+	// objects only need the node bounds to be updated.
+	if (mpObjects.size() != mNumBVHSceneObjects)
+	{
+		BuildSceneBVH();
+	}
+	else if (numUpdatedObjects > 0)
+	{
+		mBVH.Refit(mWorldTransformCache);
+	}
+}
+
+void Scene::BuildSceneBVH()
+{
+	std::vector<const GameObject*> pBVHObjects;
+	pBVHObjects.reserve(mpObjects.size());
+	for (const GameObject* pObj : mpObjects)
+	{
+		if (pObj->mpScene == this && !pObj->GetModelData().mMeshIDs.empty())
+			pBVHObjects.push_back(pObj);
+	}
+	mBVH.Build(pBVHObjects, mWorldTransformCache);
+	mNumBVHSceneObjects = mpObjects.size();
+}
+
+void Scene::GatherSceneObjects(RenderList& mainViewShadowCasterRenderList, int& outNumSceneObjects)
 {
 	// CLEAN UP RENDER LISTS
 	//
-	//pCPUProfiler->BeginEntry("CleanUp");
-	// scene view
-	mSceneView.opaqueList.clear();
-	mSceneView.culledOpaqueList.clear();
-	mSceneView.culluedOpaqueInstancedRenderListLookup.clear();
-	mSceneView.alphaList.clear();
-
-	// shadow views
-	mShadowView.Clear();
-	mShadowView.RenderListsPerMeshType.clear();
-	mShadowView.casters.clear();
-	mShadowView.shadowMapRenderListLookUp.clear();
-	mShadowView.shadowMapInstancedRenderListLookUp.clear();
-	//pCPUProfiler->EndEntry();
+	// last frame's lists are dropped and the new ones are bound to this frame's memory.
+	mSceneView.ClearRenderLists(mpFrameMemory);
+	mShadowView.Clear(mpFrameMemory);
 
 	// POPULATE RENDER LISTS WITH SCENE OBJECTS
 	//
@@ -687,90 +755,95 @@ void Scene::GatherSceneObjects(std::vector <const GameObject*>& mainViewShadowCa
 }
 
 
-void Scene::SortRenderLists(std::vector <const GameObject*>& mainViewShadowCasterRenderList, std::vector<const Light*>& pShadowingLights)
+void Scene::BuildDrawItems(const RenderList& renderList, const vec3& viewPosition, float viewRange, bool bSortByMaterial, DrawItemList& outDrawItems) const
 {
-	// LAMBDA DEFINITIONS
-	//---------------------------------------------------------------------------------------------
-	// Meshes are sorted according to BUILT_IN_TYPE < CUSTOM, 
-	// and BUILT_IN_TYPEs are sorted in themselves
-	auto SortByMeshType = [&](const GameObject* pObj0, const GameObject* pObj1)
+	const float invViewRange = viewRange > 0.0f ? 1.0f / viewRange : 0.0f;
+	for (const GameObject* pObj : renderList)
 	{
-		const ModelData& model0 = pObj0->GetModelData();
-		const ModelData& model1 = pObj1->GetModelData();
-
-		const MeshID mID0 = model0.mMeshIDs.empty() ? -1 : model0.mMeshIDs.back();
-		const MeshID mID1 = model1.mMeshIDs.empty() ? -1 : model1.mMeshIDs.back();
-
-		assert(mID0 != -1 && mID1 != -1);
+		const ModelData& model = pObj->GetModelData();
+		const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(pObj->GetPosition(), viewPosition)));
+		const float normalizedDepth = distance * invViewRange;
 
-		// case: one of the objects have a custom mesh
-		if (mID0 >= EGeometry::MESH_TYPE_COUNT || mID1 >= EGeometry::MESH_TYPE_COUNT)
+		for (MeshID meshID : model.mMeshIDs)
 		{
-			if (mID0 < EGeometry::MESH_TYPE_COUNT)
-				return true;
-
-			if (mID1 < EGeometry::MESH_TYPE_COUNT)
-				return false;
+			unsigned pipeline = 0;
+			if (SceneResourceView::GetMeshRenderMode(this, pObj, meshID) == MeshRenderSettings::WIREFRAME)
+				pipeline |= DrawItemKey::PIPELINE_WIREFRAME;
+			if (meshID < EGeometry::MESH_TYPE_COUNT && GeometryGenerator::Is2DGeometry(static_cast<EGeometry>(meshID)))
+				pipeline |= DrawItemKey::PIPELINE_2D_GEOMETRY;
+
+			int materialID = -1;
+			if (bSortByMaterial)
+			{
+				const auto itMaterial = model.mMaterialLookupPerMesh.find(meshID);
+				if (itMaterial != model.mMaterialLookupPerMesh.end())
+					materialID = itMaterial->second.ID;
+			}
 
-			return false;
+			const int lod = mLODManager.GetLODValue(pObj, meshID);
+			outDrawItems.push_back({ DrawItemKey::Make(pipeline, materialID, meshID, lod, normalizedDepth), pObj, meshID, lod });
 		}
+	}
+}
 
-		// case: both objects are built-in types
-		else
-		{
-			return mID0 < mID1;
-		}
-	};
-	auto SortByMaterialID = [](const GameObject* pObj0, const GameObject* pObj1)
-	{
-		// TODO:
-		return true;
-	};
-	auto SortByViewSpaceDepth = [](const GameObject* pObj0, const GameObject* pObj1)
+void Scene::BuildMainViewDrawItems(bool bSortDrawItems)
+{
+	const float viewRange = GetActiveCamera().m_settings.farPlane;
+	BuildDrawItems(mSceneView.culledOpaqueList, mSceneView.cameraPosition, viewRange, true, mSceneView.culledOpaqueDrawItems);
+	if (bSortDrawItems)
 	{
-		// TODO:
-		return true;
-	};
-	//---------------------------------------------------------------------------------------------
+		DrawItemList scratch(mpFrameMemory);
+		RadixSortDrawItems(mSceneView.culledOpaqueDrawItems, scratch, THREADED_PRERENDER ? mpThreadPool : nullptr);
+	}
+}
 
-	std::sort(RANGE(mSceneView.culledOpaqueList), SortByMeshType);
-	std::sort(RANGE(mainViewShadowCasterRenderList), SortByMeshType);
+void Scene::BuildShadowViewDrawItems(const FrameVector<const Light*>& pShadowingLights, bool bSortDrawItems)
+{
+	// depth passes don't bind materials: the keys only group by the rasterizer state and mesh.
+	// directional light is orthographic, hence no depth ordering for its casters.
+	FrameVector<const Light*> pSpots(mpFrameMemory);
 	for (const Light* pLight : pShadowingLights)
 	{
-		switch (pLight->mType)
+		if (pLight->mType == Light::ELightType::SPOT)
 		{
-
-		case Light::ELightType::POINT:
-		{
-			for (int i = 0; i < 6; ++i)
-			{
-				;
-			}
-			break;
+			pSpots.push_back(pLight);
+			mShadowView.shadowMapDrawItemListLookUp.try_emplace(pLight, mpFrameMemory); // create the lists before the workers access the lookup
 		}
-		case Light::ELightType::SPOT:
+	}
+
+	// the draw lists of the views are independent: build and sort them in parallel
+	RunParallel(THREADED_PRERENDER ? mpThreadPool : nullptr, pSpots.size() + 1, [&](size_t i)
+	{
+		PROFILE_SCOPE("DrawItems_ShadowView");
+		DrawItemList scratch(mpFrameMemory);
+		if (i == pSpots.size())
 		{
-			RenderList& lightRenderList = mShadowView.shadowMapRenderListLookUp.at(pLight);
-			std::sort(RANGE(lightRenderList), SortByMeshType);
-			break;
-		}
+			BuildDrawItems(mShadowView.casters, vec3(0.0f), 0.0f, false, mShadowView.casterDrawItems);
+			if (bSortDrawItems)
+				RadixSortDrawItems(mShadowView.casterDrawItems, scratch, nullptr);
+			return;
 		}
 
-	}
+		const Light* pSpot = pSpots[i];
+		DrawItemList& drawItems = mShadowView.shadowMapDrawItemListLookUp.at(pSpot);
+		BuildDrawItems(mShadowView.shadowMapRenderListLookUp.at(pSpot), pSpot->mTransform.GetPosition(), pSpot->mRange, false, drawItems);
+		if (bSortDrawItems)
+			RadixSortDrawItems(drawItems, scratch, nullptr);
+	});
 }
 
 Scene::SceneShadowingLightIndexCollection Scene::CullShadowingLights(int& outNumCulledPoints, int& outNumCulledSpots)
 {
 	using namespace VQEngine;
 	
-	SceneShadowingLightIndexCollection sceneShadowingLightIndexCollection;
+	SceneShadowingLightIndexCollection sceneShadowingLightIndexCollection(mpFrameMemory);
 
 	outNumCulledPoints = 0;
 	outNumCulledSpots = 0;
 
 	auto fnCullLights = [&](const std::vector<Light>& lights) -> ShadowingLightIndexCollection
 	{
-		ShadowingLightIndexCollection outLightIndices;
+		ShadowingLightIndexCollection outLightIndices(mpFrameMemory);
 
 		for (int i = 0; i < lights.size(); ++i)
 		{
@@ -795,12 +868,12 @@ Scene::SceneShadowingLightIndexCollection Scene::CullShadowingLights(int& outNum
 
 			case Light::ELightType::POINT:
 			{
-				vec3 vecCamera = GetActiveCamera().GetPositionF() - l.mTransform._position;
+				vec3 vecCamera = GetActiveCamera().GetPositionF() - l.mTransform.GetPosition();
 				const float dstSqrCameraToLight = XMVector3Dot(vecCamera, vecCamera).m128_f32[0];
 				const float rangeSqr = l.mRange * l.mRange;
 
 				const bool bIsCameraInPointLightSphereOfIncluence = dstSqrCameraToLight < rangeSqr;
-				const bool bSphereInFrustum = IsSphereInFrustum(GetActiveCamera().GetViewFrustumPlanes(), Sphere(l.mTransform._position, l.mRange));
+				const bool bSphereInFrustum = IsSphereInFrustum(GetActiveCamera().GetViewFrustumPlanes(), Sphere(l.mTransform.GetPosition(), l.mRange));
 
 				if (bIsCameraInPointLightSphereOfIncluence || bSphereInFrustum)
 				{
@@ -823,21 +896,31 @@ Scene::SceneShadowingLightIndexCollection Scene::CullShadowingLights(int& outNum
 	return sceneShadowingLightIndexCollection;
 }
 
-std::vector<const GameObject*> Scene::FrustumCullMainView(int& outNumCulledObjects)
+RenderList Scene::FrustumCullMainView(int& outNumCulledObjects)
 {
 	using namespace VQEngine;
 
 	const bool& bCullMainView = mSceneRenderSettings.optimization.bViewFrustumCull_MainView;
 
-	std::vector<const GameObject*> mainViewRenderList;
+	RenderList mainViewRenderList(mpFrameMemory);
 
 	//mpCPUProfiler->BeginEntry("[Cull Main View]");
 	if (bCullMainView)
 	{
+#if USE_BVH_CULLING
+		mainViewRenderList.reserve(mSceneView.opaqueList.size());
+		const size_t numVisibleObjects = mBVH.QueryFrustum(
+			  FrustumPlaneset::ExtractFromMatrix(mSceneView.viewProj)
+			, mainViewRenderList
+			, [](const GameObject* pObj) { return pObj->mRenderSettings.bRender; });
+		outNumCulledObjects = static_cast<int>(mSceneView.opaqueList.size() - numVisibleObjects);
+#else
 		outNumCulledObjects = static_cast<int>(CullGameObjects(
 			FrustumPlaneset::ExtractFromMatrix(mSceneView.viewProj)
 			, mSceneView.opaqueList
+			, mWorldTransformCache
 			, mainViewRenderList));
+#endif
 	}
 	else
 	{
@@ -852,88 +935,115 @@ std::vector<const GameObject*> Scene::FrustumCullMainView(int& outNumCulledObjec
 
 
 void Scene::FrustumCullPointAndSpotShadowViews(
-	  const std::vector <const GameObject*>&	mainViewShadowCasterRenderList
+	  const RenderList&							mainViewShadowCasterRenderList
 	, const SceneShadowingLightIndexCollection& shadowingLightIndices
 	, FrameStats&								stats
 )
 {
 	using namespace VQEngine;
 
-
-	auto fnCullPointLightView = [&](const Light* l, const std::array<FrustumPlaneset, 6>& frustumPlaneSetPerFace)
+#if USE_BVH_CULLING
+	// same criteria as the shadow caster list built in GatherSceneObjects()
+	const SceneBVH::ObjectFilterFn fnIsShadowCaster = [](const GameObject* pObj)
 	{
-#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-		std::array< MeshDrawData, 6>& meshDrawDataPerFace = mShadowView.shadowCubeMapMeshDrawListLookup[l];
-		for (int i = 0; i < 6; ++i)
-			meshDrawDataPerFace[i].meshTransformListLookup.clear();
-#else
-		std::array< MeshDrawList, 6>& meshListForPoints = mShadowView.shadowCubeMapMeshDrawListLookup[l];
-		for (int i = 0; i < 6; ++i)
-			meshListForPoints[i].clear();
+		return pObj->mRenderSettings.bRender && pObj->mRenderSettings.bCastShadow;
+	};
 #endif
 
+	// Shadow view culling is split into independent jobs, each writing only to its own 
+	// output slot. The outputs are moved into the ShadowView lookups on this thread in 
+	// job order once all the jobs are finished, hence the render lists and the stats
+	// don't depend on the order the workers execute the jobs in.
+	//
+	struct PointLightCullJob
+	{
+		const Light*                              pLight = nullptr;
+		std::array<FrustumPlaneset, 6>            frustumPlanesPerFace;
+		RenderList                                casters; // shadow casters within the range of the light
+		PointLightMeshDrawListLookup::mapped_type drawDataPerFace;
+		std::array<int, 6>                        numCulledObjectsPerFace = { 0, 0, 0, 0, 0, 0 };
+	};
+	struct SpotLightCullJob
+	{
+		const Light*    pLight = nullptr;
+		FrustumPlaneset frustumPlanes;
+		RenderList      renderList;
+		int             numCulledObjects = 0;
+	};
+
+	auto fnCullPointLightRange = [&](PointLightCullJob& job)
+	{
 		// cull for far distance
-		std::vector<const GameObject*> filteredMainViewShadowCasterList(mainViewShadowCasterRenderList.size(), nullptr);
-		int numObjs = 0;
+		const Sphere lightSphere(job.pLight->GetTransform().GetPosition(), job.pLight->mRange);
+#if USE_BVH_CULLING
+		mBVH.QuerySphere(lightSphere, job.casters, fnIsShadowCaster);
+#else
 		for (const GameObject* pObj : mainViewShadowCasterRenderList)
 		{
-			const XMMATRIX matWorld = pObj->GetTransform().WorldTransformationMatrix();
-			BoundingBox BB = pObj->GetAABB(); // local space AABB (this is wrong, AABB should be calculated on update()).
-			BB.low = XMVector3Transform(BB.low, matWorld);
-			BB.hi  = XMVector3Transform(BB.hi , matWorld); // world space BB
-			if (IsBoundingBoxInsideSphere_Approx(BB, Sphere(l->GetTransform()._position, l->mRange)))
-				filteredMainViewShadowCasterList[numObjs++] = pObj;
+			if (IsBoundingBoxInsideSphere_Approx(mWorldTransformCache.GetWorldAABB(pObj), lightSphere))
+				job.casters.push_back(pObj);
 		}
-		if (numObjs == 0)
-		{
-			return;
-		}
-
+#endif
+	};
+	auto fnCullPointLightFace = [&](PointLightCullJob& job, int face)
+	{
 		// cull for visibility per face
-		for (int face = 0; face < 6; ++face)
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+		job.drawDataPerFace[face].Clear(mpFrameMemory);
+#endif
+		for (const GameObject* pObj : job.casters)
 		{
-			const Texture::CubemapUtility::ECubeMapLookDirections CubemapFaceDirectionEnum = static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(face);
-			for (const GameObject* pObj : filteredMainViewShadowCasterList)
-			{
-				if (!pObj) // stop at first null game object because we resize @filteredMainViewShadowCasterList when creating it.
-					break;
-
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-				stats.scene.numPointsCulledObjects += static_cast<int>(CullMeshes
-				(
-					frustumPlaneSetPerFace[face],
-					pObj,
-					meshDrawDataPerFace[face]
-				));
+			job.numCulledObjectsPerFace[face] += static_cast<int>(CullMeshes
+			(
+				job.frustumPlanesPerFace[face],
+				pObj,
+				mWorldTransformCache,
+				job.drawDataPerFace[face]
+			));
 #else
-				meshDrawData.meshIDs.clear();
-				stats.scene.numPointsCulledObjects += static_cast<int>(CullMeshes
-				(
-					frustumPlaneSetPerFace[face],
-					pObj,
-					meshDrawData
-				));
-				meshListForPoints[face].push_back(meshDrawData);
+			MeshDrawData meshDrawData;
+			job.numCulledObjectsPerFace[face] += static_cast<int>(CullMeshes
+			(
+				job.frustumPlanesPerFace[face],
+				pObj,
+				mWorldTransformCache,
+				meshDrawData
+			));
+			job.drawDataPerFace[face].push_back(meshDrawData);
 #endif
-			}
 		}
+
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+		// group the visible meshes into instance ranges for the shadow pass
+		job.drawDataPerFace[face].Build(job.pLight->GetLightSpaceMatrix(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(face)));
+#endif
 	};
-	auto fnCullSpotLightView = [&](const Light* l, const FrustumPlaneset& frustumPlaneSet)
+	auto fnCullSpotLightView = [&](SpotLightCullJob& job)
 	{
-		RenderList& renderList = mShadowView.shadowMapRenderListLookUp[l];
-		
-		renderList.clear();
-		stats.scene.numSpotsCulledObjects += static_cast<int>(
+		const Light* l = job.pLight;
+#if USE_BVH_CULLING
+		// the cone is tighter than the frustum of the spot light: frustum planes are not needed.
+		const Cone lightCone(
+			  l->GetTransform().GetPosition()
+			, XMVector3TransformCoord(vec3::Forward, l->GetTransform().RotationMatrix())
+			, l->mSpotOuterConeAngleDegrees * DEG2RAD
+			, l->mRange
+		);
+		const size_t numVisibleObjects = mBVH.QueryCone(lightCone, job.renderList, fnIsShadowCaster);
+		job.numCulledObjects = static_cast<int>(mainViewShadowCasterRenderList.size() - numVisibleObjects);
+#else
+		job.numCulledObjects = static_cast<int>(
 			CullGameObjects(
-				  frustumPlaneSet 
+				  job.frustumPlanes
 				, mainViewShadowCasterRenderList
-				, renderList
+				, mWorldTransformCache
+				, job.renderList
 			));
+#endif
 	};
 
 
-	RenderList objList;
-
 	// Culling Disabled: just copy the mainViewShadowCasterRenderList
 	//                   to the render lists of lights without any culling.
 	//
@@ -944,7 +1054,7 @@ void Scene::FrustumCullPointAndSpotShadowViews(
 		{
 			const Light* l = &mLightsStatic[shadowingLightIndices.mStaticLights.spotLightIndices[i]];
 
-			RenderList& renderList = mShadowView.shadowMapRenderListLookUp[l];
+			RenderList& renderList = mShadowView.shadowMapRenderListLookUp.try_emplace(l, mpFrameMemory).first->second;
 			renderList.resize(mainViewShadowCasterRenderList.size());
 			std::copy(RANGE(mainViewShadowCasterRenderList), renderList.begin());
 		}
@@ -952,14 +1062,14 @@ void Scene::FrustumCullPointAndSpotShadowViews(
 		{
 			const Light* l = &mLightsStatic[shadowingLightIndices.mDynamicLights.spotLightIndices[i]];
 
-			RenderList& renderList = mShadowView.shadowMapRenderListLookUp[l];
+			RenderList& renderList = mShadowView.shadowMapRenderListLookUp.try_emplace(l, mpFrameMemory).first->second;
 			renderList.resize(mainViewShadowCasterRenderList.size());
 			std::copy(RANGE(mainViewShadowCasterRenderList), renderList.begin());
 		}
 
 
 		// points
-		auto fnCopyPointLightRenderLists = [&](const std::vector<Light>& lightContainer, const std::vector<int>& lightIndices)
+		auto fnCopyPointLightRenderLists = [&](const std::vector<Light>& lightContainer, const FrameVector<int>& lightIndices)
 		{
 			for (int i = 0; i < lightIndices.size(); ++i)
 			{
@@ -973,16 +1083,22 @@ void Scene::FrustumCullPointAndSpotShadowViews(
 
 				for (int face = 0; face < 6; ++face)
 				{
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+					meshDrawDataPerFace[face].Clear(mpFrameMemory);
+#endif
 					for (const GameObject* pObj : mainViewShadowCasterRenderList)
 					{
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-						const XMMATRIX matWorld = pObj->GetTransform().WorldTransformationMatrix();
+						const int matrixIndex = meshDrawDataPerFace[face].AddMatrix(mWorldTransformCache.GetWorldMatrix(pObj));
 						for (MeshID meshID : pObj->GetModelData().mMeshIDs)
-							meshDrawDataPerFace[face].AddMeshTransformation(meshID, matWorld);
+							meshDrawDataPerFace[face].AddDraw(meshID, matrixIndex);
 #else
 						meshListForPoints[face].push_back(pObj);
 #endif
 					}
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+					meshDrawDataPerFace[face].Build(l->GetLightSpaceMatrix(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(face)));
+#endif
 				}
 			}
 		};
@@ -1002,55 +1118,78 @@ void Scene::FrustumCullPointAndSpotShadowViews(
 	stats.scene.numPoints = static_cast<int>(shadowingLightIndices.GetLightCount(Light::ELightType::POINT));
 
 
-	// Cull Static Lights
-	mpCPUProfiler->BeginEntry("Cull_ShadowView_Point_s");
+	// Gather the culling jobs
+	FrameVector<PointLightCullJob> pointLightJobs(shadowingLightIndices.mStaticLights.pointLightIndices.size() + shadowingLightIndices.mDynamicLights.pointLightIndices.size(), mpFrameMemory);
+	FrameVector<SpotLightCullJob>  spotLightJobs (shadowingLightIndices.mStaticLights.spotLightIndices.size()  + shadowingLightIndices.mDynamicLights.spotLightIndices.size() , mpFrameMemory);
+	for (PointLightCullJob& job : pointLightJobs) job.casters    = RenderList(mpFrameMemory);
+	for (SpotLightCullJob&  job : spotLightJobs)  job.renderList = RenderList(mpFrameMemory);
 	{
-		const std::vector<int>& lightIndexContainer = shadowingLightIndices.mStaticLights.pointLightIndices;
-		for (int i = 0; i < lightIndexContainer.size(); ++i)	// point lights
+		size_t iPoint = 0;
+		size_t iSpot = 0;
+		for (int lightIndex : shadowingLightIndices.mStaticLights.pointLightIndices)
 		{
-			int lightIndex = lightIndexContainer[i];
 			const Light* l = &mLightsStatic[lightIndex];
-			fnCullPointLightView(l, mStaticLightCache.mStaticPointLightFrustumPlanes.at(l));
+			pointLightJobs[iPoint].pLight = l;
+			pointLightJobs[iPoint++].frustumPlanesPerFace = mStaticLightCache.mStaticPointLightFrustumPlanes.at(l);
 		}
-	}
-	mpCPUProfiler->EndEntry();
-
-	mpCPUProfiler->BeginEntry("Cull_ShadowView_Spot_s");
-	{
-		const std::vector<int>& lightIndexContainer = shadowingLightIndices.mStaticLights.spotLightIndices;
-		for (int i = 0; i < lightIndexContainer.size(); ++i) // spot lights
+		for (int lightIndex : shadowingLightIndices.mDynamicLights.pointLightIndices)
+		{
+			const Light* l = &mLightsDynamic[lightIndex];
+			pointLightJobs[iPoint].pLight = l;
+			for (int face = 0; face < 6; ++face)
+				pointLightJobs[iPoint].frustumPlanesPerFace[face] = l->GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(face));
+			++iPoint;
+		}
+		for (int lightIndex : shadowingLightIndices.mStaticLights.spotLightIndices)
 		{
-			int lightIndex = lightIndexContainer[i];
 			const Light* l = &mLightsStatic[lightIndex];
-			fnCullSpotLightView(&mLightsStatic[lightIndex], mStaticLightCache.mStaticSpotLightFrustumPlanes.at(l));
+			spotLightJobs[iSpot].pLight = l;
+			spotLightJobs[iSpot++].frustumPlanes = mStaticLightCache.mStaticSpotLightFrustumPlanes.at(l);
+		}
+		for (int lightIndex : shadowingLightIndices.mDynamicLights.spotLightIndices)
+		{
+			const Light* l = &mLightsDynamic[lightIndex];
+			spotLightJobs[iSpot].pLight = l;
+			spotLightJobs[iSpot++].frustumPlanes = l->GetViewFrustumPlanes();
 		}
 	}
-	mpCPUProfiler->EndEntry();
 
-	// Cull Dynamic Lights
-	mpCPUProfiler->BeginEntry("Cull_ShadowView_Point_d");
-	for (int lightIndex : shadowingLightIndices.mDynamicLights.pointLightIndices)
+	VQEngine::ThreadPool* pThreadPool = THREADED_FRUSTUM_CULL ? mpThreadPool : nullptr;
+
+	// Cull spot light views & the range of the point lights
+	RunParallel(pThreadPool, pointLightJobs.size() + spotLightJobs.size(), [&](size_t i)
 	{
-		std::array<FrustumPlaneset, 6> frustumPlanesPerFace =
+		if (i < pointLightJobs.size())
 		{
-			  mLightsDynamic[lightIndex].GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(0))
-			, mLightsDynamic[lightIndex].GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(1))
-			, mLightsDynamic[lightIndex].GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(2))
-			, mLightsDynamic[lightIndex].GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(3))
-			, mLightsDynamic[lightIndex].GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(4))
-			, mLightsDynamic[lightIndex].GetViewFrustumPlanes(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(5))
-		};
-		fnCullPointLightView(&mLightsDynamic[lightIndex], frustumPlanesPerFace);
-	}
-	mpCPUProfiler->EndEntry();
+			PROFILE_SCOPE("Cull_PointLightRange");
+			fnCullPointLightRange(pointLightJobs[i]);
+		}
+		else
+		{
+			PROFILE_SCOPE("Cull_SpotLightView");
+			fnCullSpotLightView(spotLightJobs[i - pointLightJobs.size()]);
+		}
+	});
 
-	mpCPUProfiler->BeginEntry("Cull_ShadowView_Spot_d");
-	for (int lightIndex : shadowingLightIndices.mDynamicLights.spotLightIndices)
+	// Cull point light views per cube face
+	RunParallel(pThreadPool, pointLightJobs.size() * 6, [&](size_t i)
 	{
-		const Light* l = &mLightsDynamic[lightIndex];
-		fnCullSpotLightView(l, l->GetViewFrustumPlanes());
+		PROFILE_SCOPE("Cull_PointLightFace");
+		fnCullPointLightFace(pointLightJobs[i / 6], static_cast<int>(i % 6));
+	});
+
+	// Merge the job outputs
+	for (PointLightCullJob& job : pointLightJobs)
+	{
+		mShadowView.shadowCubeMapMeshDrawListLookup[job.pLight] = std::move(job.drawDataPerFace);
+		for (int face = 0; face < 6; ++face)
+			stats.scene.numPointsCulledObjects += job.numCulledObjectsPerFace[face];
+	}
+	for (SpotLightCullJob& job : spotLightJobs)
+	{
+		mShadowView.shadowMapRenderListLookUp.insert_or_assign(job.pLight, std::move(job.renderList));
+		stats.scene.numSpotsCulledObjects += job.numCulledObjects;
 	}
-	mpCPUProfiler->EndEntry();
 }
 
 void Scene::OcclusionCullDirectionalLightView()
@@ -1058,7 +1197,7 @@ void Scene::OcclusionCullDirectionalLightView()
 	// TODO: consider this for directionals: http://stefan-s.net/?p=92 or umbra paper
 }
 
-void Scene::BatchMainViewRenderList(const std::vector<const GameObject*> mainViewRenderList)
+void Scene::BatchMainViewRenderList(const RenderList& mainViewRenderList)
 {
 	for (int i = 0; i < mainViewRenderList.size(); ++i)
 	{
@@ -1086,21 +1225,15 @@ void Scene::BatchMainViewRenderList(const std::vector<const GameObject*> mainVie
 		}
 
 		RenderListLookup& instancedRenderLists = mSceneView.culluedOpaqueInstancedRenderListLookup;
-		if (instancedRenderLists.find(meshID) == instancedRenderLists.end())
-		{
-			instancedRenderLists[meshID] = std::vector<const GameObject*>();
-		}
-
-		std::vector<const GameObject*>& renderList = instancedRenderLists.at(meshID);
+		RenderList& renderList = instancedRenderLists.try_emplace(meshID, mpFrameMemory).first->second;
 		renderList.push_back(std::move(mainViewRenderList[i]));
 	}
 }
 
-void Scene::BatchShadowViewRenderLists(const std::vector <const GameObject*>& mainViewShadowCasterRenderList)
+void Scene::BatchShadowViewRenderLists(const RenderList& mainViewShadowCasterRenderList)
 {
-	std::unordered_map<MeshID, std::vector<const GameObject*>>& instancedCasterLists = mShadowView.RenderListsPerMeshType;
+	DirectionalMeshDrawData& instancedDrawData = mShadowView.casterInstancedDrawData; // rebound to the frame memory in ShadowView::Clear()
 
-	mpCPUProfiler->BeginEntry("Batch_DirectionalView");
 	for (int i = 0; i < mainViewShadowCasterRenderList.size(); ++i)
 	{
 		const GameObject* pCaster = mainViewShadowCasterRenderList[i];
@@ -1112,15 +1245,13 @@ void Scene::BatchShadowViewRenderLists(const std::vector <const GameObject*>& ma
 			continue;
 		}
 
-		if (instancedCasterLists.find(meshID) == instancedCasterLists.end())
-		{
-			instancedCasterLists[meshID] = std::vector<const GameObject*>();
-		}
-		std::vector<const GameObject*>& renderList = instancedCasterLists.at(meshID);
-		renderList.push_back(std::move(mainViewShadowCasterRenderList[i]));
+		instancedDrawData.AddMeshTransformation(meshID, mWorldTransformCache.GetWorldMatrix(pCaster));
 	}
-	mpCPUProfiler->EndEntry();
 
+	if (mDirectionalLight.mbEnabled)
+	{
+		instancedDrawData.Build(mDirectionalLight.GetLightSpaceMatrix());
+	}
 }
 
 void Scene::SetLightCache()
@@ -1188,126 +1319,52 @@ void Scene::CalculateSceneBoundingBox()
 	}
 
 	constexpr float max_f = std::numeric_limits<float>::max();
-	vec3 mins(max_f);
-	vec3 maxs(-(max_f - 1.0f));
+	constexpr float DegenerateMeshPositionChannelValueMax = 15000.0f; // make sure no vertex.xyz is > 15,000.0f
+	const XMVECTOR vDegenerateMax = XMVectorReplicate(DegenerateMeshPositionChannelValueMax);
+	XMVECTOR mins = XMVectorReplicate(max_f);
+	XMVECTOR maxs = XMVectorReplicate(-(max_f - 1.0f));
 	PerfTimer timer;
 	timer.Start();
 	std::for_each(RANGE(pObjects), [&](GameObject* pObj)
 	{
-		XMMATRIX worldMatrix = pObj->GetTransform().WorldTransformationMatrix();
+		const XMMATRIX worldMatrix = pObj->GetTransform().WorldTransformationMatrix();
 
-		vec3 mins_obj(max_f);
-		vec3 maxs_obj(-(max_f - 1.0f));
+		XMVECTOR mins_obj = XMVectorReplicate(max_f);
+		XMVECTOR maxs_obj = XMVectorReplicate(-(max_f - 1.0f));
 
+		// mesh bounding boxes are calculated when the meshes are created, the object 
+		// and the scene bounding boxes are derived from them without touching the vertices.
 		const ModelData& modelData = pObj->GetModelData();
-		pObj->mMeshBoundingBoxes.clear();
-		std::for_each(RANGE(modelData.mMeshIDs), [&](const MeshID& meshID)
+		pObj->mMeshBoundingBoxes.resize(modelData.mMeshIDs.size());
+		for (size_t i = 0; i < modelData.mMeshIDs.size(); ++i)
 		{
-			const BufferID VertexBufferID = mMeshes[meshID].GetIABuffers().first;
-			const Buffer& VertexBuffer = mpRenderer->GetVertexBuffer(VertexBufferID);
-			const size_t numVerts = VertexBuffer.mDesc.mElementCount;
-			const size_t stride = VertexBuffer.mDesc.mStride;
-
-			constexpr size_t defaultSz = sizeof(DefaultVertexBufferData);
-			constexpr float DegenerateMeshPositionChannelValueMax = 15000.0f; // make sure no vertex.xyz is > 15,000.0f
-
-			// #SHADER REFACTOR:
-			//
-			// currently all the shader input is using default vertex buffer data.
-			// we just make sure that we can interpret the position data properly here
-			// by ensuring the vertex buffer stride for a given mesh matches
-			// the default vertex buffer.
-			//
-			// TODO:
-			// Type information is not preserved once the vertex/index buffer is created.
-			// need to figure out a way to interpret the position data in a given buffer
-			//
-			if (stride == defaultSz)
-			{
-				const DefaultVertexBufferData* pData = reinterpret_cast<const DefaultVertexBufferData*>(VertexBuffer.mpCPUData);
-				if (pData == nullptr)
-				{
-					Log::Info("Nope: %d", int(stride));
-					return;
-				}
-
-				vec3 mins_mesh(max_f);
-				vec3 maxs_mesh(-(max_f - 1.0f));
-				for (int i = 0; i < numVerts; ++i)
-				{
-					const float x_mesh_local = pData[i].position.x();
-					const float y_mesh_local = pData[i].position.y();
-					const float z_mesh_local = pData[i].position.z();
-
-					mins_mesh = vec3
-					(
-						std::min(x_mesh_local, mins_mesh.x()),
-						std::min(y_mesh_local, mins_mesh.y()),
-						std::min(z_mesh_local, mins_mesh.z())
-					);
-					maxs_mesh = vec3
-					(
-						std::max(x_mesh_local, maxs_mesh.x()),
-						std::max(y_mesh_local, maxs_mesh.y()),
-						std::max(z_mesh_local, maxs_mesh.z())
-					);
-
-
-					const vec3 worldPos = vec3(XMVector4Transform(vec4(pData[i].position, 1.0f), worldMatrix));
-					const float x_mesh = std::min(worldPos.x(), DegenerateMeshPositionChannelValueMax);
-					const float y_mesh = std::min(worldPos.y(), DegenerateMeshPositionChannelValueMax);
-					const float z_mesh = std::min(worldPos.z(), DegenerateMeshPositionChannelValueMax);
-
-
-					// scene bounding box - world space
-					mins = vec3
-					(
-						std::min(x_mesh, mins.x()),
-						std::min(y_mesh, mins.y()),
-						std::min(z_mesh, mins.z())
-					);
-					maxs = vec3
-					(
-						std::max(x_mesh, maxs.x()),
-						std::max(y_mesh, maxs.y()),
-						std::max(z_mesh, maxs.z())
-					);
-
-					// object bounding box - model space
-					mins_obj = vec3
-					(
-						std::min(x_mesh_local, mins_obj.x()),
-						std::min(y_mesh_local, mins_obj.y()),
-						std::min(z_mesh_local, mins_obj.z())
-					);
-					maxs_obj = vec3
-					(
-						std::max(x_mesh_local, maxs_obj.x()),
-						std::max(y_mesh_local, maxs_obj.y()),
-						std::max(z_mesh_local, maxs_obj.z())
-					);
-				}
-
-				pObj->mMeshBoundingBoxes.push_back(BoundingBox({ mins_mesh, maxs_mesh }));
-			}
-			else
-			{
-				Log::Warning("Unsupported vertex stride for mesh.");
-			}
-		});
+			const Mesh& mesh = mMeshes[modelData.mMeshIDs[i]];
+			BoundingBox& meshBB = pObj->mMeshBoundingBoxes[i];
+			meshBB.low = mesh.GetAABBMin();
+			meshBB.hi = mesh.GetAABBMax();
+
+			// object bounding box - model space
+			mins_obj = XMVectorMin(mins_obj, meshBB.low);
+			maxs_obj = XMVectorMax(maxs_obj, meshBB.hi);
+
+			// scene bounding box - world space
+			const BoundingBox worldMeshBB = meshBB.GetTransformedAABB(worldMatrix);
+			mins = XMVectorMin(mins, XMVectorMin(worldMeshBB.low, vDegenerateMax));
+			maxs = XMVectorMax(maxs, XMVectorMin(worldMeshBB.hi, vDegenerateMax));
+		}
 
 		pObj->mBoundingBox.hi = maxs_obj;
 		pObj->mBoundingBox.low = mins_obj;
 	});
 
 	timer.Stop();
+	this->mSceneBoundingBox.hi = maxs;
+	this->mSceneBoundingBox.low = mins;
 	Log::Info("SceneBoundingBox:lo=(%.2f, %.2f, %.2f)\thi=(%.2f, %.2f, %.2f) in %.2fs"
-		, mins.x() , mins.y() , mins.z()
-		, maxs.x() , maxs.y() , maxs.z()
+		, mSceneBoundingBox.low.x(), mSceneBoundingBox.low.y(), mSceneBoundingBox.low.z()
+		, mSceneBoundingBox.hi.x() , mSceneBoundingBox.hi.y() , mSceneBoundingBox.hi.z()
 		, timer.DeltaTime()
 	);
-	this->mSceneBoundingBox.hi = maxs;
-	this->mSceneBoundingBox.low = mins;
 }
 
 
@@ -1350,84 +1407,87 @@ int Scene::RenderOpaque(const SceneView& sceneView) const
 			|| shader == EShaders::NORMAL
 			|| shader == EShaders::FORWARD_BRDF);
 	};
-	auto RenderObject = [&](const GameObject* pObj)
+	const EShaders shader = static_cast<EShaders>(mpRenderer->GetActiveShader());
+	const GameObject* pPrevObj = nullptr;
+	auto RenderDrawItem = [&](const DrawItem& drawItem)
 	{
-		const Transform& tf = pObj->GetTransform();
+		const GameObject* pObj = drawItem.pObject;
 		const ModelData& model = pObj->GetModelData();
+		const MeshID id = drawItem.meshID;
 
-		const EShaders shader = static_cast<EShaders>(mpRenderer->GetActiveShader());
-		const XMMATRIX world = tf.WorldTransformationMatrix();
-		const XMMATRIX wvp = world * sceneView.viewProj;
-
-		switch (shader)
+		// SET OBJECT MATRICES: consecutive draw items of the same object share the matrices
+		if (pObj != pPrevObj)
 		{
-		case EShaders::TBN:
-			mpRenderer->SetConstant4x4f("world", world);
-			mpRenderer->SetConstant4x4f("viewProj", sceneView.viewProj);
-			mpRenderer->SetConstant4x4f("normalMatrix", tf.NormalMatrix(world));
-			break;
-		case EShaders::NORMAL:
-			mpRenderer->SetConstant4x4f("normalMatrix", tf.NormalMatrix(world));
-		case EShaders::UNLIT:
-		case EShaders::TEXTURE_COORDINATES:
-			mpRenderer->SetConstant4x4f("worldViewProj", wvp);
-			break;
-		default:	// lighting shaders
-		{
-			const ObjectMatrices_WorldSpace mats =
+			const Transform& tf = pObj->GetTransform();
+			const XMMATRIX world = tf.WorldTransformationMatrix();
+			const XMMATRIX wvp = world * sceneView.viewProj;
+
+			switch (shader)
 			{
-				wvp,
-				world,
-				tf.NormalMatrix(world)
-			};
-			mpRenderer->SetConstantStruct("ObjMatrices", &mats);
-			break;
-		}
+			case EShaders::TBN:
+				mpRenderer->SetConstant4x4f("world", world);
+				mpRenderer->SetConstant4x4f("viewProj", sceneView.viewProj);
+				mpRenderer->SetConstant4x4f("normalMatrix", tf.NormalMatrix(world));
+				break;
+			case EShaders::NORMAL:
+				mpRenderer->SetConstant4x4f("normalMatrix", tf.NormalMatrix(world));
+			case EShaders::UNLIT:
+			case EShaders::TEXTURE_COORDINATES:
+				mpRenderer->SetConstant4x4f("worldViewProj", wvp);
+				break;
+			default:	// lighting shaders
+			{
+				const ObjectMatrices_WorldSpace mats =
+				{
+					wvp,
+					world,
+					tf.NormalMatrix(world)
+				};
+				mpRenderer->SetConstantStruct("ObjMatrices", &mats);
+				break;
+			}
+			}
+			pPrevObj = pObj;
 		}
 
-		// SET GEOMETRY & MATERIAL, THEN DRAW
-		mpRenderer->SetRasterizerState(EDefaultRasterizerState::CULL_BACK);
-		for (MeshID id : model.mMeshIDs)
+		// SET MATERIAL CONSTANTS
+		if (ShouldSendMaterial(shader))
 		{
-			const auto IABuffer = mMeshes[id].GetIABuffers(mLODManager.GetLODValue(pObj, id));
-
-			// SET MATERIAL CONSTANTS
-			if (ShouldSendMaterial(shader))
+			const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
+			if (bMeshHasMaterial)
 			{
-				const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
-				if (bMeshHasMaterial)
-				{
-					const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
-					const Material* pMat = mMaterials.GetMaterial_const(materialID);
-					// #TODO: uncomment below when transparency is implemented.
-					//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
-					//	return;
-					pMat->SetMaterialConstants(mpRenderer, shader, sceneView.bIsDeferredRendering);
-				}
-				else
-				{
-					mMaterials.GetDefaultMaterial(GGX_BRDF)->SetMaterialConstants(mpRenderer, shader, sceneView.bIsDeferredRendering);
-				}
+				const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
+				const Material* pMat = mMaterials.GetMaterial_const(materialID);
+				// #TODO: uncomment below when transparency is implemented.
+				//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
+				//	return;
+				pMat->SetMaterialConstants(mpRenderer, shader, sceneView.bIsDeferredRendering);
+			}
+			else
+			{
+				mMaterials.GetDefaultMaterial(GGX_BRDF)->SetMaterialConstants(mpRenderer, shader, sceneView.bIsDeferredRendering);
 			}
+		}
 
-			mpRenderer->SetVertexBuffer(IABuffer.first);
-			mpRenderer->SetIndexBuffer(IABuffer.second);
-			mpRenderer->Apply();
-			mpRenderer->DrawIndexed();
-		};
+		// SET GEOMETRY, THEN DRAW
+		const auto IABuffer = mMeshes[id].GetIABuffers(drawItem.lod);
+		mpRenderer->SetVertexBuffer(IABuffer.first);
+		mpRenderer->SetIndexBuffer(IABuffer.second);
+		mpRenderer->Apply();
+		mpRenderer->DrawIndexed();
 	};
 	//-----------------------------------------------------------------------------------------------
 
 	// RENDER NON-INSTANCED SCENE OBJECTS
 	//
-	int numObj = 0;
-	for (const auto* obj : mSceneView.culledOpaqueList)
+	// draw items are sorted by state in PreRender(), hence consecutive draws mostly
+	// share the vertex/index buffers and the material, which Apply() doesn't re-bind.
+	mpRenderer->SetRasterizerState(EDefaultRasterizerState::CULL_BACK);
+	for (const DrawItem& drawItem : sceneView.culledOpaqueDrawItems)
 	{
-		RenderObject(obj);
-		++numObj;
+		RenderDrawItem(drawItem);
 	}
-
-
+	const int numObj = static_cast<int>(sceneView.culledOpaqueList.size());
 
 	return numObj;
 }
@@ -1556,7 +1616,7 @@ int Scene::RenderDebug(const XMMATRIX& viewProj) const
 				{
 					mpRenderer->SetConstant3f("diffuse", l.mColor);
 
-					tf.SetPosition(l.mTransform._position);
+					tf.SetPosition(l.mTransform.GetPosition());
 					tf.SetScale(l.mRange * 0.5f); // Mesh's model space R = 2.0f, hence scale it by 0.5f...
 					wvp = tf.WorldTransformationMatrix() * viewProj;
 					mpRenderer->SetConstant4x4f("worldViewProj", wvp);
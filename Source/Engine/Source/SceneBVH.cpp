@@ -0,0 +1,266 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "SceneBVH.h"
+#include "GameObject.h"
+
+#include "Utilities/utils.h"
+
+#include <algorithm>
+#include <limits>
+
+static BoundingBox MergeAABBs(const BoundingBox& a, const BoundingBox& b)
+{
+	BoundingBox aabb;
+	aabb.low = XMVectorMin(a.low, b.low);
+	aabb.hi  = XMVectorMax(a.hi , b.hi );
+	return aabb;
+}
+
+static BoundingBox EmptyAABB()
+{
+	constexpr float max_f = std::numeric_limits<float>::max();
+	BoundingBox aabb;
+	aabb.low = vec3( max_f);
+	aabb.hi  = vec3(-max_f);
+	return aabb;
+}
+
+void SceneBVH::Clear()
+{
+	mNodes.clear();
+	mpObjects.clear();
+	mObjectAABBs.clear();
+	mObjectAABBsSoA.Clear();
+}
+
+void SceneBVH::Build(const std::vector<const GameObject*>& pObjects, const WorldTransformCache& worldCache)
+{
+	Clear();
+	if (pObjects.empty())
+		return;
+
+	// the recursion partitions an array of object indices in place, objects are
+	// reordered once at the end. centroids are indexed by the input object index.
+	std::vector<vec3> centroids(pObjects.size());
+	std::vector<int> objectOrder(pObjects.size());
+	for (size_t i = 0; i < pObjects.size(); ++i)
+	{
+		const BoundingBox& aabb = worldCache.GetWorldAABB(pObjects[i]);
+		centroids[i] = XMVectorScale(XMVectorAdd(aabb.hi, aabb.low), 0.5f);
+		objectOrder[i] = static_cast<int>(i);
+	}
+
+	mNodes.reserve(2 * (pObjects.size() / MAX_OBJECTS_PER_LEAF + 1));
+	BuildRecursive(0, static_cast<int>(pObjects.size()), objectOrder, centroids);
+
+	mpObjects.resize(pObjects.size());
+	for (size_t i = 0; i < pObjects.size(); ++i)
+	{
+		mpObjects[i] = pObjects[objectOrder[i]];
+	}
+	
+	// leaf order of the objects is final: store the AABBs & calculate node bounds
+	mObjectAABBs.resize(mpObjects.size());
+	Refit(worldCache);
+}
+
+int SceneBVH::BuildRecursive(int firstObject, int numObjects, std::vector<int>& objectOrder, const std::vector<vec3>& centroids)
+{
+	const int nodeIndex = static_cast<int>(mNodes.size());
+	mNodes.emplace_back();
+	mNodes[nodeIndex].firstObject = firstObject;
+	mNodes[nodeIndex].numObjects = numObjects;
+
+	if (numObjects <= MAX_OBJECTS_PER_LEAF)
+		return nodeIndex;
+
+	const auto itBegin = objectOrder.begin() + firstObject;
+	const auto itEnd   = itBegin + numObjects;
+
+	// split along the longest axis of the centroid bounds
+	constexpr float max_f = std::numeric_limits<float>::max();
+	XMVECTOR cMin = vec3( max_f);
+	XMVECTOR cMax = vec3(-max_f);
+	for (auto it = itBegin; it != itEnd; ++it)
+	{
+		cMin = XMVectorMin(cMin, centroids[*it]);
+		cMax = XMVectorMax(cMax, centroids[*it]);
+	}
+	const vec3 centroidExtent = XMVectorSubtract(cMax, cMin);
+	const int axis = centroidExtent.x() > centroidExtent.y()
+		? (centroidExtent.x() > centroidExtent.z() ? 0 : 2)
+		: (centroidExtent.y() > centroidExtent.z() ? 1 : 2);
+
+	// median split: partition the object indices of the node around the median centroid in place
+	auto fnAxisValue = [&](int objIndex) -> float
+	{
+		const vec3& c = centroids[objIndex];
+		return axis == 0 ? c.x() : (axis == 1 ? c.y() : c.z());
+	};
+	const int numLeft = numObjects / 2;
+	std::nth_element(itBegin, itBegin + numLeft, itEnd, [&](int i0, int i1) { return fnAxisValue(i0) < fnAxisValue(i1); });
+
+	// mNodes might be reallocated during the recursion: don't hold references to the node
+	const int leftChild  = BuildRecursive(firstObject, numLeft, objectOrder, centroids);
+	const int rightChild = BuildRecursive(firstObject + numLeft, numObjects - numLeft, objectOrder, centroids);
+	mNodes[nodeIndex].leftChild = leftChild;
+	mNodes[nodeIndex].rightChild = rightChild;
+	return nodeIndex;
+}
+
+void SceneBVH::Refit(const WorldTransformCache& worldCache)
+{
+	mObjectAABBsSoA.Clear();
+	mObjectAABBsSoA.Reserve(mpObjects.size());
+	for (size_t i = 0; i < mpObjects.size(); ++i)
+	{
+		mObjectAABBs[i] = worldCache.GetWorldAABB(mpObjects[i]);
+		mObjectAABBsSoA.AddBoundingBox(mObjectAABBs[i]);
+	}
+
+	// nodes are stored in pre-order: children always come after their parents,
+	// hence iterating backwards processes the children first.
+	for (int nodeIndex = static_cast<int>(mNodes.size()) - 1; nodeIndex >= 0; --nodeIndex)
+	{
+		Node& node = mNodes[nodeIndex];
+		if (node.IsLeaf())
+		{
+			node.aabb = EmptyAABB();
+			for (int i = node.firstObject; i < node.firstObject + node.numObjects; ++i)
+				node.aabb = MergeAABBs(node.aabb, mObjectAABBs[i]);
+		}
+		else
+		{
+			node.aabb = MergeAABBs(mNodes[node.leftChild].aabb, mNodes[node.rightChild].aabb);
+		}
+	}
+}
+
+// scalar leaf test for the query volumes that don't have a batch version
+template<class TFnClassifyAABB>
+static void CullObjectAABBs(const std::vector<BoundingBox>& aabbs, TFnClassifyAABB& fnClassifyAABB, int first, int count, std::vector<int>& outVisibleIndices)
+{
+	for (int i = first; i < first + count; ++i)
+	{
+		if (fnClassifyAABB(aabbs[i]) != CULL_RESULT_OUTSIDE)
+			outVisibleIndices.push_back(i);
+	}
+}
+
+template<class TFnClassifyAABB, class TFnCullObjects>
+size_t SceneBVH::Query(TFnClassifyAABB&& fnClassifyAABB, TFnCullObjects&& fnCullObjects, FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter) const
+{
+	if (mNodes.empty())
+		return 0;
+
+	// queries of the light views run in parallel: the scratch memory is per thread
+	// and reused between the calls.
+	thread_local std::vector<int> visibleIndices;
+
+	const size_t numObjectsBefore = outObjects.size();
+	auto fnAppendObject = [&](int i)
+	{
+		if (!fnFilter || fnFilter(mpObjects[i]))
+			outObjects.push_back(mpObjects[i]);
+	};
+
+	// the nodes are visited in pre-order, hence consecutive intersecting leaves cover
+	// a contiguous range of mpObjects: collect the range and test it in one batch.
+	int pendingFirst = 0;
+	int pendingCount = 0;
+	auto fnFlushPendingLeaves = [&]()
+	{
+		if (pendingCount == 0)
+			return;
+		visibleIndices.clear();
+		fnCullObjects(pendingFirst, pendingCount, visibleIndices);
+		for (const int i : visibleIndices)
+			fnAppendObject(i);
+		pendingCount = 0;
+	};
+
+	int stack[MAX_TREE_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const Node& node = mNodes[stack[--stackSize]];
+		switch (fnClassifyAABB(node.aabb))
+		{
+		case CULL_RESULT_OUTSIDE:
+			break;
+
+		case CULL_RESULT_INSIDE: // accept the whole subtree
+			fnFlushPendingLeaves(); // keep the output in object order
+			for (int i = node.firstObject; i < node.firstObject + node.numObjects; ++i)
+				fnAppendObject(i);
+			break;
+
+		case CULL_RESULT_INTERSECTING:
+			if (node.IsLeaf())
+			{
+				if (pendingCount > 0 && pendingFirst + pendingCount == node.firstObject)
+				{
+					pendingCount += node.numObjects;
+				}
+				else
+				{
+					fnFlushPendingLeaves();
+					pendingFirst = node.firstObject;
+					pendingCount = node.numObjects;
+				}
+			}
+			else
+			{
+				assert(stackSize + 2 <= MAX_TREE_DEPTH);
+				stack[stackSize++] = node.rightChild;
+				stack[stackSize++] = node.leftChild;
+			}
+			break;
+		}
+	}
+	fnFlushPendingLeaves();
+	return outObjects.size() - numObjectsBefore;
+}
+
+size_t SceneBVH::QueryFrustum(const FrustumPlaneset& frustum, FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter) const
+{
+	// nodes are classified one at a time, the objects of the intersecting leaves
+	// are tested 4 (SSE) or 8 (AVX) at a time by the batch culler.
+	const CullingPlanes planes = VQEngine::ToCullingPlanes(frustum);
+	return Query([&](const BoundingBox& aabb) { return VQEngine::ClassifyBoundingBoxAgainstFrustum(frustum, aabb); }
+		, [&](int first, int count, std::vector<int>& outVisibleIndices) { VQEngine::CullBoundingBoxRange(planes, mObjectAABBsSoA, first, count, outVisibleIndices); }
+		, outObjects, fnFilter);
+}
+
+size_t SceneBVH::QuerySphere(const Sphere& sphere, FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter) const
+{
+	auto fnClassifyAABB = [&](const BoundingBox& aabb) { return VQEngine::ClassifyBoundingBoxAgainstSphere(aabb, sphere); };
+	return Query(fnClassifyAABB
+		, [&](int first, int count, std::vector<int>& outVisibleIndices) { CullObjectAABBs(mObjectAABBs, fnClassifyAABB, first, count, outVisibleIndices); }
+		, outObjects, fnFilter);
+}
+
+size_t SceneBVH::QueryCone(const Cone& cone, FrameVector<const GameObject*>& outObjects, ObjectFilterFn fnFilter) const
+{
+	auto fnClassifyAABB = [&](const BoundingBox& aabb) { return VQEngine::ClassifyBoundingBoxAgainstCone(aabb, cone); };
+	return Query(fnClassifyAABB
+		, [&](int first, int count, std::vector<int>& outVisibleIndices) { CullObjectAABBs(mObjectAABBs, fnClassifyAABB, first, count, outVisibleIndices); }
+		, outObjects, fnFilter);
+}
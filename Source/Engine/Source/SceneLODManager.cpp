@@ -19,36 +19,83 @@
 #include "SceneLODManager.h"
 #include "Camera.h"
 #include "GameObject.h"
+#include "ObjectCullingSystem.h"
 #include "Engine.h"
 
 #include "Renderer/RenderingStructs.h"
 #include "Renderer/Renderer.h"
 
 #include "Application/Input.h"
+#include "Application/ThreadPool.h"
 
 #include "Utilities/Log.h"
+#include "Utilities/Profiler.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <numeric>
+#include <cfloat>
 
-#define THREADED_UPDATE 0
 #define DEBUG_LOD_LEVELS 1
 
+// 1: selects the LOD levels based on the projected geometric error of the levels
+// 0: selects the LOD levels based on the distance thresholds of the LODSettings
+#define LOD_SELECTION_SCREEN_SPACE_ERROR 1
+
 #if DEBUG_LOD_LEVELS
 	#define ENABLE_FORCE_LOD_LEVELS 0
 #endif
 
+// below this, threading the update costs more than it saves
+constexpr size_t MIN_ENTRIES_PER_UPDATE_JOB = 2048;
+
 std::unordered_map<EGeometry, LODManager::LODSettings> LODManager::sBuiltinMeshLODSettings;
 
+static size_t GetNumTrianglesOfLOD(const Mesh& mesh, int lod, Renderer* pRenderer)
+{
+	const BufferID indexBufferID = mesh.GetIABuffers(lod).second;
+	return pRenderer->GetBufferDesc(EBufferType::INDEX_BUFFER, indexBufferID).mElementCount / 3;
+}
+
+// level-major arrays have to be re-laid out when the padded entry count changes
+template<class T>
+static void ResizeLevelMajorArray(std::vector<T>& levelMajorArray, size_t prevPaddedSize, size_t paddedSize, T fillValue)
+{
+	std::vector<T> newArray(NUM_MAX_LOD_LEVELS * paddedSize, fillValue);
+	for (size_t level = 0; level < NUM_MAX_LOD_LEVELS; ++level)
+		for (size_t i = 0; i < prevPaddedSize; ++i)
+			newArray[level * paddedSize + i] = levelMajorArray[level * prevPaddedSize + i];
+	levelMajorArray = std::move(newArray);
+}
+
+// SSE2 doesn't have the 32-bit integer min/max instructions
+static inline __m128i Min_epi32(__m128i a, __m128i b)
+{
+	const __m128i aGreater = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(aGreater, b), _mm_andnot_si128(aGreater, a));
+}
+static inline __m128i Max_epi32(__m128i a, __m128i b)
+{
+	const __m128i aGreater = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(aGreater, a), _mm_andnot_si128(aGreater, b));
+}
+
 
-void LODManager::Initialize(const Camera& camera, const std::vector<GameObject*>& pObjects)
+void LODManager::Initialize(const Camera& camera, const std::vector<GameObject*>& pObjects, const std::vector<GameObject>& objectPool)
 {
 	Reset();
-	mpViewerPosition = &camera.mPosition;
+	mpViewer = &camera;
+	mProjectionScale = CalculateProjectionScale();
 
 #if ENABLE_FORCE_LOD_LEVELS
 	this->mbEnableForceLODLevels = true;
 #endif
 
+	mpObjectPool = &objectPool;
+	mpObjectPoolBegin = objectPool.data();
+	mFirstEntryPerObject.resize(objectPool.size(), INVALID_ENTRY);
+
 	// create settings objects
-	size_t sz_MeshLODUpdateList = 0;
 	for (GameObject* pObj : pObjects)
 	{
 		if (pObj->GetModelData().mMeshIDs.empty())
@@ -57,93 +104,282 @@ void LODManager::Initialize(const Camera& camera, const std::vector<GameObject*>
 			continue;
 		}
 
-		// only a few built-in meshes support LOD levels
-		const MeshID objMeshID = pObj->GetModelData().mMeshIDs.back();
-		const bool bObjHasBuiltinMesh = objMeshID < EGeometry::MESH_TYPE_COUNT;
-		if (!bObjHasBuiltinMesh)
+		const std::vector<MeshID>& meshIDs = pObj->GetModelData().mMeshIDs;
+		const std::vector<BoundingBox>& meshBBs = pObj->GetMeshBBs();
+		for (size_t meshIndex = 0; meshIndex < meshIDs.size(); ++meshIndex)
 		{
-			continue;
-		}
+			const MeshID meshID = meshIDs[meshIndex];
+			const Mesh& mesh = mMeshContainer[meshID];
+
+			// a few built-in meshes support LOD levels with their LOD settings
+			// and imported meshes support LOD levels if the model loader generated them.
+			LODSettings lodSettings;
+			const bool bBuiltinMesh = meshID < EGeometry::MESH_TYPE_COUNT;
+			if (bBuiltinMesh)
+			{
+				const EGeometry meshLODSettingsKey = static_cast<EGeometry>(meshID);
+				const auto itLODSettings = sBuiltinMeshLODSettings.find(meshLODSettingsKey);
+				if (itLODSettings == sBuiltinMeshLODSettings.end())
+				{
+					continue;
+				}
+				lodSettings = itLODSettings->second;
+			}
+			else
+			{
+				if (mesh.GetNumLODs() < 2)
+				{
+					continue;
+				}
+				lodSettings.geometricErrors = mesh.GetLODErrors(); // no distance thresholds: LOD 0 w/ distance based selection
+			}
 
-		// check if LOD settings exist for the built-in mesh
-		const EGeometry meshLODSettingsKey = static_cast<EGeometry>(objMeshID);
-		const bool bMeshLODSettingExists = sBuiltinMeshLODSettings.find(meshLODSettingsKey) != sBuiltinMeshLODSettings.end();
-		if (!bMeshLODSettingExists)
-		{
-			continue;
-		}
+			// bounding sphere of the mesh in world units
+			float boundingRadius = 0.0f;
+			if (meshBBs.size() == meshIDs.size())
+			{
+				const BoundingBox& bb = meshBBs[meshIndex];
+				const vec3& scl = pObj->GetTransform().GetScale();
+				const float halfDiagonal = 0.5f * XMVectorGetX(XMVector3Length(XMVectorSubtract(bb.hi, bb.low)));
+				boundingRadius = halfDiagonal * (std::max)((std::max)(scl.x(), scl.y()), scl.z());
+			}
 
-		// LODSettings objects carry the 'current LOD level' information,
-		// hence should be attached to all objects that the LODManager will track.
-		LODSettings lodSettings = sBuiltinMeshLODSettings.at(meshLODSettingsKey);
-		for (int i = 0; i < lodSettings.distanceThresholds.size(); ++i)
-		{
-			const vec3& scl = pObj->GetTransform()._scale;
-			//lodSettings.distanceThresholds[i] *= std::max(std::max(scl.x(), scl.y()), scl.z());
-		}
+			// estimate the geometric errors of the LOD levels if they're not provided
+			if (lodSettings.geometricErrors.empty())
+			{
+				for (int lod = 0; lod < mesh.GetNumLODs(); ++lod)
+					lodSettings.geometricErrors.push_back(LODSettings::EstimateGeometricError(GetNumTrianglesOfLOD(mesh, lod, mpRenderer)));
+			}
 
-		// register object with LODSettings.
-		RegisterMeshLOD(pObj, objMeshID, lodSettings);
-		++sz_MeshLODUpdateList;
+			// register object with LODSettings.
+			RegisterMeshLOD(pObj, meshID, lodSettings, boundingRadius);
+		}
 	}
-
-	mMeshLODUpdateList.resize(sz_MeshLODUpdateList);
 }
 
 void LODManager::Reset()
 {
-	mpViewerPosition = nullptr;
+	mpViewer = nullptr;
 	mbEnableForceLODLevels = false;
 	mForcedLODValue = 0;
-	mSceneObjectLODSettingsLookup.clear();
-	mMeshLODUpdateList.clear();
-	mLODObjects.clear();
+	mProjectionScale = 0.0f;
+	mNumTriangles = 0;
+
+	mNumEntries = 0;
+	mPositionX.clear(); mPositionY.clear(); mPositionZ.clear();
+	mBoundingRadius.clear();
+	mLODSettingsIndex.clear();
+	mNumLODs.clear();
+	mSelectedLOD.clear();
+	mActiveLOD.clear();
+	mSqDistance.clear();
+	mEntryObjects.clear();
+	mEntryMeshIDs.clear();
+	mSqDistanceThresholds.clear();
+	mNumLODTriangles.clear();
+	mBudgetOrder.clear();
+	mLODSettings.clear();
+
+	mpObjectPool = nullptr;
+	mpObjectPoolBegin = nullptr;
+	mFirstEntryPerObject.clear();
 }
 
-void LODManager::Update()
+void LODManager::Update(VQEngine::ThreadPool* pThreadPool, const WorldTransformCache& worldCache)
 {
-	if (!mpViewerPosition)
+	if (!mpViewer)
 	{
 		Log::Warning("LODManager::Update() called with null viewer!");
 		return;
 	}
 
+	// the entries & the lookup table point into the pool storage
+	assert(!mpObjectPool || (mpObjectPool->data() == mpObjectPoolBegin && mpObjectPool->size() == mFirstEntryPerObject.size()));
+
 	HandleInput();
 
 
-	if (mbEnableForceLODLevels)
+	if (mbEnableForceLODLevels || mNumEntries == 0)
 		return;
 
-#if THREADED_UPDATE 
-	UpdateLODs_MultiThreaded_Begin();
-#else 
-	UpdateLODs_SingleThread();
-#endif 
+	// the switch distances depend on the projection: recalculate them 
+	// if the camera, its field of view or the pixel error budget has changed.
+	const float projectionScale = CalculateProjectionScale();
+	if (projectionScale != mProjectionScale)
+	{
+		mProjectionScale = projectionScale;
+		for (size_t entry = 0; entry < mNumEntries; ++entry)
+			CalculateSwitchDistances(entry);
+	}
+
+	const vec3 viewPos = mpViewer->mPosition; // cache the memory indirection
+
+	// jobs process contiguous ranges of SIMD groups: each entry is written by one thread only.
+	const size_t numGroups = mPositionX.size() / SIMD_WIDTH;
+	const size_t numJobs = pThreadPool ? (std::min)(pThreadPool->GetThreadPoolSize() + 1, (std::max)<size_t>(1, mNumEntries / MIN_ENTRIES_PER_UPDATE_JOB)) : 1;
+	if (numJobs == 1)
+	{
+		UpdateLODs(0, mNumEntries, viewPos, worldCache);
+	}
+	else
+	{
+		const size_t numGroupsPerJob = (numGroups + numJobs - 1) / numJobs;
+		pThreadPool->ParallelFor(0, numJobs, 1, [&](size_t job)
+		{
+			PROFILE_SCOPE("UpdateLODs_Job");
+			const size_t firstEntry = job * numGroupsPerJob * SIMD_WIDTH;
+			const size_t lastEntry = (std::min)(mNumEntries, (job + 1) * numGroupsPerJob * SIMD_WIDTH);
+			if (firstEntry < lastEntry)
+				UpdateLODs(firstEntry, lastEntry, viewPos, worldCache);
+		});
+	}
+
+	ApplyTriangleBudget();
 }
 
-void LODManager::LateUpdate()
+void LODManager::UpdateLODs(size_t firstEntry, size_t lastEntry, const vec3& viewPos, const WorldTransformCache& worldCache)
 {
-	if (mbEnableForceLODLevels)
-		return;
+	assert(firstEntry % SIMD_WIDTH == 0);
+	const size_t paddedSize = mPositionX.size();
+
+	// refresh the positions of the dynamic objects: the translation of the cached world matrices,
+	// the objects themselves aren't accessed.
+	for (size_t i = firstEntry; i < lastEntry; ++i)
+	{
+		const XMVECTOR pos = worldCache.GetWorldMatrix(mEntryObjects[i]).r[3];
+		mPositionX[i] = XMVectorGetX(pos);
+		mPositionY[i] = XMVectorGetY(pos);
+		mPositionZ[i] = XMVectorGetZ(pos);
+	}
+
+	// LOD = number of switch distances the distance is at or above. With hysteresis, the switch distances 
+	// scaled up by the band give the finest level allowed and the ones scaled down give the coarsest level 
+	// allowed: the selected level of the previous update is kept if it's within this range.
+	const __m128 sqBandHi = _mm_set1_ps((1.0f + mHysteresis) * (1.0f + mHysteresis));
+	const __m128 sqBandLo = _mm_set1_ps((1.0f - mHysteresis) * (1.0f - mHysteresis));
+	const __m128 viewX = _mm_set1_ps(viewPos.x());
+	const __m128 viewY = _mm_set1_ps(viewPos.y());
+	const __m128 viewZ = _mm_set1_ps(viewPos.z());
+	for (size_t i = firstEntry; i < lastEntry; i += SIMD_WIDTH)
+	{
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&mPositionX[i]), viewX);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&mPositionY[i]), viewY);
+		const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&mPositionZ[i]), viewZ);
+		const __m128 sqDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		_mm_storeu_ps(&mSqDistance[i], sqDistance);
+
+		__m128i lodFinest = _mm_setzero_si128();
+		__m128i lodCoarsest = _mm_setzero_si128();
+		for (size_t level = 0; level < NUM_MAX_LOD_LEVELS - 1; ++level)
+		{
+			const __m128 sqThreshold = _mm_loadu_ps(&mSqDistanceThresholds[level * paddedSize + i]);
+			lodFinest   = _mm_sub_epi32(lodFinest  , _mm_castps_si128(_mm_cmpge_ps(sqDistance, _mm_mul_ps(sqThreshold, sqBandHi)))); // mask is -1 per lane
+			lodCoarsest = _mm_sub_epi32(lodCoarsest, _mm_castps_si128(_mm_cmpge_ps(sqDistance, _mm_mul_ps(sqThreshold, sqBandLo))));
+		}
+
+		const __m128i prevLOD = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mSelectedLOD[i]));
+		const __m128i lod = Max_epi32(lodFinest, Min_epi32(prevLOD, lodCoarsest));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&mSelectedLOD[i]), lod); // padding entries keep LOD 0
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&mActiveLOD[i]), lod);
+	}
+}
+
+void LODManager::ApplyTriangleBudget()
+{
+	const size_t paddedSize = mPositionX.size();
+
+	size_t numTriangles = 0;
+	for (size_t entry = 0; entry < mNumEntries; ++entry)
+		numTriangles += mNumLODTriangles[mActiveLOD[entry] * paddedSize + entry];
 
-#if THREADED_UPDATE 
-	UpdateLODs_MultiThreaded_End();
-#endif 
+	if (mTriangleBudget != 0 && numTriangles > mTriangleBudget)
+	{
+		// degrade the farthest entries first, they lose the least detail on the screen
+		mBudgetOrder.resize(mNumEntries);
+		std::iota(mBudgetOrder.begin(), mBudgetOrder.end(), 0);
+		std::sort(mBudgetOrder.begin(), mBudgetOrder.end(), [&](int i, int j) { return mSqDistance[i] > mSqDistance[j]; });
+
+		for (const int entry : mBudgetOrder)
+		{
+			int& lod = mActiveLOD[entry];
+			while (numTriangles > mTriangleBudget && lod + 1 < mNumLODs[entry])
+			{
+				numTriangles = numTriangles - mNumLODTriangles[lod * paddedSize + entry] + mNumLODTriangles[(lod + 1) * paddedSize + entry];
+				++lod;
+			}
+			if (numTriangles <= mTriangleBudget)
+				break;
+		}
+	}
+
+	mNumTriangles = numTriangles;
 }
 
-void LODManager::SetViewer(const Camera& camera) { mpViewerPosition = &camera.mPosition; }
+float LODManager::CalculateProjectionScale() const
+{
+	if (!mpViewer)
+		return 0.0f;
 
-const LODManager::LODSettings& LODManager::GetMeshLODSettings(const GameObject* pObj, MeshID meshID) const
+	// _22 of the perspective projection matrix is 1 / tan(fovY/2)
+	const float screenHeight = static_cast<float>(ENGINE->GetSettings().window.height);
+	return 0.5f * screenHeight * mpViewer->mMatProj._22 / mPixelErrorBudget;
+}
+
+void LODManager::CalculateSwitchDistances(size_t entry)
 {
+	const size_t paddedSize = mPositionX.size();
+	const LODSettings& lodSettings = mLODSettings[mLODSettingsIndex[entry]];
+	const float boundingRadius = mBoundingRadius[entry];
+	const int numLODs = mNumLODs[entry];
+
+#if LOD_SELECTION_SCREEN_SPACE_ERROR
+	const bool bUseScreenSpaceError = boundingRadius > 0.0f && mProjectionScale > 0.0f && lodSettings.geometricErrors.size() >= static_cast<size_t>(numLODs);
+#else
+	const bool bUseScreenSpaceError = false;
+#endif
 
-	const GameObjectLODSettings& objLODSettings = mSceneObjectLODSettingsLookup.at(pObj);
+	for (size_t level = 0; level < NUM_MAX_LOD_LEVELS; ++level)
+		mSqDistanceThresholds[level * paddedSize + entry] = FLT_MAX;
 
-	if (objLODSettings.meshLODSettingsLookup.find(meshID) == objLODSettings.meshLODSettingsLookup.end())
+	if (bUseScreenSpaceError)
 	{
-		assert(false);
+		// the projected error of the next level reaches the pixel error budget at the switch distance
+		for (int level = 0; level + 1 < numLODs; ++level)
+		{
+			const float switchDistance = lodSettings.geometricErrors[level + 1] * boundingRadius * mProjectionScale;
+			mSqDistanceThresholds[level * paddedSize + entry] = switchDistance * switchDistance;
+		}
 	}
+	else
+	{
+		// the last level is selected beyond the last but one threshold, regardless of the distance
+		const std::vector<float>& thresholds = lodSettings.distanceThresholds;
+		for (int level = 0; level + 1 < numLODs && level + 1 < static_cast<int>(thresholds.size()); ++level)
+		{
+			const float switchDistance = thresholds[level] + boundingRadius;
+			mSqDistanceThresholds[level * paddedSize + entry] = switchDistance * switchDistance;
+		}
+	}
+}
+
+void LODManager::SetPixelErrorBudget(float pixelError)
+{
+	mPixelErrorBudget = (std::max)(pixelError, 0.01f);
+	mProjectionScale = 0.0f; // recalculates the switch distances in the next update
+}
 
-	return objLODSettings.meshLODSettingsLookup.at(meshID);
+void LODManager::SetHysteresis(float hysteresis)
+{
+	mHysteresis = (std::min)((std::max)(hysteresis, 0.0f), 0.5f);
+}
+
+void LODManager::SetViewer(const Camera& camera) { mpViewer = &camera; }
+
+const LODManager::LODSettings& LODManager::GetMeshLODSettings(const GameObject* pObj, MeshID meshID) const
+{
+	const int entry = GetEntryIndex(pObj, meshID);
+	assert(entry != INVALID_ENTRY);
+	return mLODSettings[mLODSettingsIndex[entry]];
 }
 
 int LODManager::GetLODValue(const GameObject* pObj, MeshID meshID) const
@@ -164,10 +400,6 @@ int LODManager::GetLODValue(const GameObject* pObj, MeshID meshID) const
 	// This will result in UI updating with correct stats but renderer
 	// only seeing LOD=0 for all meshes because they're not providing pObj.
 	//
-#if 0 // disable assert for now
-	assert(pObj);
-#endif
-
 	assert(meshID != -1);
 
 
@@ -177,39 +409,99 @@ int LODManager::GetLODValue(const GameObject* pObj, MeshID meshID) const
 		return this->mForcedLODValue;
 	}
 #endif
-	
-	if (mSceneObjectLODSettingsLookup.find(pObj) == mSceneObjectLODSettingsLookup.end())
-	{
-#if _DEBUG
-		if(std::find(RANGE(this->mLODObjects), pObj) != this->mLODObjects.end())
-			Log::Warning("LODManager::GetLODValue(): MeshID=%d of GameObj*=TODO doesn't exist in SceneMeshLODSettingsLookup table.", meshID); // TODO msg
-#endif
-		return 0;
-	}
 
-	const GameObjectLODSettings& objLODSettings = mSceneObjectLODSettingsLookup.at(pObj);
+	const int entry = GetEntryIndex(pObj, meshID);
+	return entry == INVALID_ENTRY ? 0 : mActiveLOD[entry];
+}
+
+float LODManager::GetLODSwitchDistance(const GameObject* pObj, MeshID meshID) const
+{
+	const int entry = GetEntryIndex(pObj, meshID);
+	if (entry == INVALID_ENTRY)
+		return 0.0f;
+
+	const float sqSwitchDistance = mSqDistanceThresholds[mActiveLOD[entry] * mPositionX.size() + entry];
+	return sqSwitchDistance == FLT_MAX ? 0.0f : std::sqrt(sqSwitchDistance);
+}
 
-	if (objLODSettings.meshLODSettingsLookup.find(meshID) == objLODSettings.meshLODSettingsLookup.end())
+int LODManager::GetEntryIndex(const GameObject* pObj, MeshID meshID) const
+{
+	if (!pObj || pObj < mpObjectPoolBegin)
+		return INVALID_ENTRY;
+
+	const size_t slot = static_cast<size_t>(pObj - mpObjectPoolBegin);
+	if (slot >= mFirstEntryPerObject.size())
+		return INVALID_ENTRY;
+
+	// objects have a few LOD meshes at most: scan the consecutive entries of the object
+	for (int entry = mFirstEntryPerObject[slot]; entry != INVALID_ENTRY && entry < static_cast<int>(mNumEntries) && mEntryObjects[entry] == pObj; ++entry)
 	{
-		Log::Warning("LODManager::GetLODValue(): MeshID=%d of GameObj*=TODO doesn't exist in SceneMeshLODSettingsLookup table.", meshID); // TODO msg
-		return 0;
+		if (mEntryMeshIDs[entry] == meshID)
+			return entry;
 	}
+	return INVALID_ENTRY;
+}
 
-	return objLODSettings.meshLODSettingsLookup.at(meshID).activeLOD;
+int LODManager::GetOrAddLODSettingsIndex(const LODSettings& lodSettings)
+{
+	for (size_t i = 0; i < mLODSettings.size(); ++i)
+	{
+		if (mLODSettings[i].distanceThresholds == lodSettings.distanceThresholds && mLODSettings[i].geometricErrors == lodSettings.geometricErrors)
+			return static_cast<int>(i);
+	}
+	mLODSettings.push_back(lodSettings);
+	return static_cast<int>(mLODSettings.size() - 1);
 }
 
 
-void LODManager::RegisterMeshLOD(const GameObject* pObj, MeshID meshID, const LODSettings& _LODSettings)
+void LODManager::RegisterMeshLOD(const GameObject* pObj, MeshID meshID, const LODSettings& _LODSettings, float boundingRadius)
 {
-	// register the pObj if it doesn't exist in the lookup
-	if (mSceneObjectLODSettingsLookup.find(pObj) == mSceneObjectLODSettingsLookup.end())
+	const size_t slot = static_cast<size_t>(pObj - mpObjectPoolBegin);
+	assert(mpObjectPoolBegin && pObj >= mpObjectPoolBegin && slot < mFirstEntryPerObject.size());
+	if (GetEntryIndex(pObj, meshID) != INVALID_ENTRY)
+		return; // already registered
+
+	const int entry = static_cast<int>(mNumEntries++);
+	if (mFirstEntryPerObject[slot] == INVALID_ENTRY)
 	{
-		GameObjectLODSettings& objLODSettings = mSceneObjectLODSettingsLookup[pObj];
-		objLODSettings.LODMeshes.push_back(meshID);
-		objLODSettings.meshLODSettingsLookup[meshID] = _LODSettings;
+		mFirstEntryPerObject[slot] = entry;
 	}
+	assert(mEntryObjects.empty() || mEntryObjects.back() == pObj || mFirstEntryPerObject[slot] == entry); // consecutive entries per object
 
-	mLODObjects.push_back(pObj);
+	// the SoA arrays are sized to the SIMD width, the new entry fills the padding if there's any
+	const size_t paddedSize = (mNumEntries + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+	if (paddedSize != mPositionX.size())
+	{
+		const size_t prevPaddedSize = mPositionX.size();
+		mPositionX.resize(paddedSize, 0.0f);
+		mPositionY.resize(paddedSize, 0.0f);
+		mPositionZ.resize(paddedSize, 0.0f);
+		mSelectedLOD.resize(paddedSize, 0);
+		mActiveLOD.resize(paddedSize, 0);
+		mSqDistance.resize(paddedSize, 0.0f);
+		ResizeLevelMajorArray(mSqDistanceThresholds, prevPaddedSize, paddedSize, FLT_MAX);
+		ResizeLevelMajorArray(mNumLODTriangles, prevPaddedSize, paddedSize, 0u);
+	}
+
+	const vec3& pos = pObj->GetTransform().GetPosition();
+	mPositionX[entry] = pos.x();
+	mPositionY[entry] = pos.y();
+	mPositionZ[entry] = pos.z();
+	mSelectedLOD[entry] = 0;
+	mActiveLOD[entry] = 0;
+	mBoundingRadius.push_back(boundingRadius);
+	mLODSettingsIndex.push_back(GetOrAddLODSettingsIndex(_LODSettings));
+	mEntryObjects.push_back(pObj);
+	mEntryMeshIDs.push_back(meshID);
+
+	const Mesh& mesh = mMeshContainer[meshID];
+	const int numLODs = (std::min)(mesh.GetNumLODs(), static_cast<int>(NUM_MAX_LOD_LEVELS));
+	assert(_LODSettings.distanceThresholds.size() <= NUM_MAX_LOD_LEVELS);
+	mNumLODs.push_back(numLODs);
+	for (int level = 0; level < numLODs; ++level)
+		mNumLODTriangles[level * paddedSize + entry] = static_cast<unsigned>(GetNumTrianglesOfLOD(mesh, level, mpRenderer));
+
+	CalculateSwitchDistances(entry);
 }
 
 int LODManager::LODSettings::CalculateLODValueFromSquareDistance(float sqDistance, const std::vector<float>& distanceThresholds)
@@ -224,6 +516,15 @@ int LODManager::LODSettings::CalculateLODValueFromSquareDistance(float sqDistanc
 	return static_cast<int>(distanceThresholds.size()-1);
 }
 
+float LODManager::LODSettings::EstimateGeometricError(size_t numTriangles)
+{
+	// a sphere of radius r tessellated with T equilateral triangles has the squared edge length 
+	// e^2 = 16*PI*r^2 / (sqrt(3)*T), and the flat triangles deviate from the surface by ~e^2 / (8r).
+	if (numTriangles == 0)
+		return 1.0f;
+	return (std::min)(1.0f, 2.0f * XM_PI / (std::sqrt(3.0f) * static_cast<float>(numTriangles)));
+}
+
 int LODManager::LODSettings::CalculateLODValueFromDistance(float distance, const std::vector<float>& distanceThresholds)
 {
 	for (int lod = 0; lod < distanceThresholds.size(); ++lod)
@@ -237,13 +538,6 @@ int LODManager::LODSettings::CalculateLODValueFromDistance(float distance, const
 }
 
 
-const LODManager::LODSettings& LODManager::GetLODSettings(const GameObject* pObj, MeshID meshID) const
-{
-	// TODO: error check + report
-	const GameObjectLODSettings& objLODSettings = mSceneObjectLODSettingsLookup.at(pObj);
-	return objLODSettings.meshLODSettingsLookup.at(meshID);
-}
-
 void LODManager::HandleInput()
 {
 #if DEBUG_LOD_LEVELS
@@ -262,75 +556,37 @@ void LODManager::HandleInput()
 		std::stringstream ss;
 		ss << "Scene LOD Manager\n\n";
 		ss << "Game Objects / Mesh LOD Settings:\n";
+		const GameObject* pPrevObj = nullptr;
 		int currObj = 0;
-		for (const GameObject* pObj : mLODObjects)
+		for (size_t entry = 0; entry < mNumEntries; ++entry)
 		{
-			ss << "\tmLODObjects[" << currObj++ << "]:\n";
-			for (MeshID meshID : mSceneObjectLODSettingsLookup.at(pObj).LODMeshes)
+			if (mEntryObjects[entry] != pPrevObj)
 			{
-				const LODSettings& lodSettings = GetLODSettings(pObj, meshID);
-				ss << "\t\tMeshID=" << meshID << " | LOD=" << lodSettings.activeLOD << " | ";
-				ss << " distance threshold=" << std::fixed << std::setprecision(2) << lodSettings.distanceThresholds[lodSettings.activeLOD] << "\n";
-
-				auto VB_IB_IDs = mMeshContainer[meshID].GetIABuffers(lodSettings.activeLOD);
-				const BufferDesc bufDescVB = mpRenderer->GetBufferDesc(EBufferType::VERTEX_BUFFER, VB_IB_IDs.first);
-				const BufferDesc bufDescIB = mpRenderer->GetBufferDesc(EBufferType::INDEX_BUFFER, VB_IB_IDs.second);
-				ss << "\t\tVertices: " << bufDescVB.mElementCount << " | Triangles: " << bufDescIB.mElementCount / 3 << "\n";
+				if (pPrevObj) ss << "\n";
+				ss << "\tmLODObjects[" << currObj++ << "]:\n";
+				pPrevObj = mEntryObjects[entry];
 			}
-			ss << "\n";
+
+			const MeshID meshID = mEntryMeshIDs[entry];
+			const int activeLOD = mActiveLOD[entry];
+			const LODSettings& lodSettings = mLODSettings[mLODSettingsIndex[entry]];
+			ss << "\t\tMeshID=" << meshID << " | LOD=" << activeLOD << " (selected=" << mSelectedLOD[entry] << ") | ";
+			ss << " switch distance=" << std::fixed << std::setprecision(2) << GetLODSwitchDistance(mEntryObjects[entry], meshID);
+			if (activeLOD < static_cast<int>(lodSettings.geometricErrors.size()))
+				ss << " | geometric error=" << std::setprecision(4) << lodSettings.geometricErrors[activeLOD] << std::setprecision(2);
+			ss << " | bounding radius=" << mBoundingRadius[entry] << "\n";
+
+			auto VB_IB_IDs = mMeshContainer[meshID].GetIABuffers(activeLOD);
+			const BufferDesc bufDescVB = mpRenderer->GetBufferDesc(EBufferType::VERTEX_BUFFER, VB_IB_IDs.first);
+			const BufferDesc bufDescIB = mpRenderer->GetBufferDesc(EBufferType::INDEX_BUFFER, VB_IB_IDs.second);
+			ss << "\t\tVertices: " << bufDescVB.mElementCount << " | Triangles: " << bufDescIB.mElementCount / 3 << "\n";
 		}
+		ss << "\nTriangles: " << mNumTriangles << " | Triangle Budget: " << mTriangleBudget << " | Pixel Error Budget: " << mPixelErrorBudget << "\n";
 		Log::Info(ss.str());
 	}
 #endif
 }
 
-void LODManager::UpdateLODs_SingleThread()
-{
-	const vec3 viewPos = *this->mpViewerPosition; // cache the memory indirection
-
-	// calculate new LODs and output a list of <MeshID, lodVal> pair.
-	int numLODUpdates = 0;
-	for (const GameObject* pObj : mLODObjects)
-	{
-		for (MeshID meshID : mSceneObjectLODSettingsLookup.at(pObj).LODMeshes)
-		{
-			const LODSettings& lodSettings = GetLODSettings(pObj, meshID);
-
-			// calculate square distance to the viewer
-			vec3 sqDistV = pObj->GetTransform()._position - viewPos;
-			sqDistV = XMVector3Dot(sqDistV, sqDistV);
-			const float& sqDist = sqDistV.x();
-
-			const int newLODval = LODSettings::CalculateLODValueFromSquareDistance(sqDist, lodSettings.distanceThresholds);
-			if (newLODval != lodSettings.activeLOD)
-			{
-				mMeshLODUpdateList[numLODUpdates].pObj = pObj;
-				mMeshLODUpdateList[numLODUpdates].meshID = meshID;
-				mMeshLODUpdateList[numLODUpdates].newLOD = newLODval;
-				++numLODUpdates;
-			}
-		}
-	}
-
-	// update the LOD values
-	for (int i = 0; i < numLODUpdates; ++i)
-	{
-		mSceneObjectLODSettingsLookup.at(mMeshLODUpdateList[i].pObj)
-			.meshLODSettingsLookup.at(mMeshLODUpdateList[i].meshID)
-			.activeLOD = mMeshLODUpdateList[i].newLOD;
-	}
-}
-
-void LODManager::UpdateLODs_MultiThreaded_Begin()
-{
-	// TODO: SetupWorkers(); Dispatch();
-}
-
-void LODManager::UpdateLODs_MultiThreaded_End()
-{
-	// TODO: Sync(); ReadResults();
-}
-
 void LODManager::InitializeBuiltinMeshLODSettings()
 {
 	LODSettings coneSettings;
@@ -370,9 +626,3 @@ void LODManager::InitializeBuiltinMeshLODSettings()
 	sBuiltinMeshLODSettings[EGeometry::SPHERE]   = sphereSettings;
 	sBuiltinMeshLODSettings[EGeometry::CYLINDER] = cylinderSettings;
 }
-
-const LODManager::LODSettings& LODManager::GameObjectLODSettings::GetLODSettings(MeshID meshID) const
-{
-	// TODO: error check + report
-	return meshLODSettingsLookup.at(meshID);
-}
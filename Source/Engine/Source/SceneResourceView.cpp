@@ -18,6 +18,7 @@
 
 #include "SceneResourceView.h"
 #include "Scene.h"
+#include "DrawItem.h"
 
 std::pair<BufferID, BufferID> SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(const Scene* pScene, MeshID meshID, const GameObject* pObj)
 {
@@ -29,6 +30,11 @@ std::pair<BufferID, BufferID> SceneResourceView::GetVertexAndIndexBufferIDsOfMes
 	return pScene->mMeshes[meshID].GetIABuffers(pScene->mLODManager.GetLODValue(pObj, meshID));
 }
 
+std::pair<BufferID, BufferID> SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(const Scene* pScene, const DrawItem& drawItem)
+{
+	return pScene->mMeshes[drawItem.meshID].GetIABuffers(drawItem.lod);
+}
+
 std::pair<BufferID, BufferID> SceneResourceView::GetBuiltinMeshVertexAndIndexBufferID(EGeometry builtInGeometry, int lod)
 {
 	return Scene::GetGeometryVertexAndIndexBuffers(builtInGeometry, lod);
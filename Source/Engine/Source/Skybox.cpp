@@ -110,13 +110,14 @@ std::pair < std::string, EnvironmentMapFileNames>  GetsIBLFiles(EEnvironmentMapP
 
 void Skybox::InitializePresets_Async(Renderer* pRenderer, const Settings::Rendering& renderSettings)
 {
+	PROFILE_SCOPE("Skybox::InitializePresets_Async");
 	EnvironmentMap::Initialize(pRenderer);
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		EnvironmentMap::LoadShaders();
 	}
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		Texture LUTTexture = EnvironmentMap::CreateBRDFIntegralLUTTexture();
 		EnvironmentMap::sBRDFIntegrationLUTTexture = LUTTexture._id;
 	}
@@ -132,7 +133,7 @@ void Skybox::InitializePresets_Async(Renderer* pRenderer, const Settings::Render
 
 		TextureID skydomeTex = -1;
 		{
-			std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+			std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 			skydomeTex = pRenderer->CreateCubemapFromFaceTextures(filePaths, false);
 		}
 		s_Presets[ECubeMapPresets::NIGHT_SKY] = Skybox(pRenderer, skydomeTex, bEquirectangular);
@@ -281,7 +282,7 @@ bool Skybox::Initialize(const EnvironmentMapFileNames& environmentMapFiles, cons
 {
 	environmentMap.Initialize(pRenderer, environmentMapFiles, rootDirectory);
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		skyboxTexture = pRenderer->CreateTextureFromFile(environmentMapFiles.skyboxFileName, rootDirectory);
 	}
 	return skyboxTexture != -1;
@@ -334,7 +335,7 @@ void EnvironmentMap::Initialize(Renderer * pRenderer, const EnvironmentMapFileNa
 
 	// irradiance map texture
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		this->irradianceMap = pRenderer->CreateHDRTexture(files.irradianceMapFileName, rootDirectory);
 	}
 	
@@ -354,7 +355,7 @@ void EnvironmentMap::Initialize(Renderer * pRenderer, const EnvironmentMapFileNa
 			}
 		}
 		{
-			std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+			std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 			this->prefilteredEnvironmentMap = pRenderer->CreateCubemapFromFaceTextures(cubemapTexturePaths, true, PREFILTER_MIP_LEVEL_COUNT);
 			this->environmentMap = this->prefilteredEnvironmentMap;
 		}
@@ -362,7 +363,7 @@ void EnvironmentMap::Initialize(Renderer * pRenderer, const EnvironmentMapFileNa
 	else
 	{
 		{
-			std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+			std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 			this->environmentMap = pRenderer->CreateHDRTexture(files.environmentMapFileName, rootDirectory);
 		}
 		InitializePrefilteredEnvironmentMap(pRenderer->GetTextureObject(environmentMap), pRenderer->GetTextureObject(irradianceMap), cacheFolderPath);
@@ -379,7 +380,7 @@ void EnvironmentMap::Initialize(Renderer * pRenderer, const EnvironmentMapFileNa
 	envMapSamplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
 	envMapSamplerDesc.MaxAnisotropy = 1;
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		this->envMapSampler = spRenderer->CreateSamplerState(envMapSamplerDesc);
 	}
 
@@ -496,7 +497,7 @@ TextureID EnvironmentMap::InitializePrefilteredEnvironmentMap(const Texture& spe
 	texDesc.usage = RENDER_TARGET_RW;
 	texDesc.bIsCubeMap = true;
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		texDesc.texFileName = DirectoryUtil::GetFileNameWithoutExtension(irradienceMap._name) + "_preFiltered";
 		this->prefilteredEnvironmentMap = pRenderer->CreateTexture2D(texDesc);
 	}
@@ -504,7 +505,7 @@ TextureID EnvironmentMap::InitializePrefilteredEnvironmentMap(const Texture& spe
 	texDesc.bGenerateMips = true;
 	texDesc.mipCount = PREFILTER_MIP_LEVEL_COUNT;
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		texDesc.texFileName = DirectoryUtil::GetFileNameWithoutExtension(specularMap._name) + "_cubemap";
 		this->mippedEnvironmentCubemap = pRenderer->CreateTexture2D(texDesc);
 	}
@@ -542,7 +543,7 @@ TextureID EnvironmentMap::InitializePrefilteredEnvironmentMap(const Texture& spe
 
 	// TODO: Compute shader in single pass.
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		SetPreFilterStates();
 		for (unsigned cubeFace = 0; cubeFace < 6; ++cubeFace)
 		{
@@ -566,7 +567,7 @@ TextureID EnvironmentMap::InitializePrefilteredEnvironmentMap(const Texture& spe
 	}
 	
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		pRenderer->m_deviceContext->GenerateMips(mippedEnvironmentCubemapTex._srv);
 	}
 
@@ -574,7 +575,7 @@ TextureID EnvironmentMap::InitializePrefilteredEnvironmentMap(const Texture& spe
 	// pre-filter environment map into each cube face and mip level (~ roughness)
 	// TODO: Compute shader in single pass.
 	{
-		std::unique_lock<std::mutex> lck(Engine::mLoadRenderingMutex);
+		std::unique_lock<std::mutex> lck = Engine::LockLoadRenderingMutex();
 		pRenderer->SetShader(sPrefilterShader, true);
 		pRenderer->SetTexture("tEnvironmentMap", mippedEnvironmentCubemap);
 		for (unsigned mipLevel = 0; mipLevel < PREFILTER_MIP_LEVEL_COUNT; ++mipLevel)
@@ -24,6 +24,7 @@ Transform::Transform(const vec3& position, const Quaternion& rotation, const vec
 	, _originalPosition(position)
 	, _originalRotation(rotation)
 	, _scale(scale)
+	, _version(0)
 	//, Component(ComponentType::TRANSFORM, "Transform")
 {}
 
@@ -34,22 +35,26 @@ Transform & Transform::operator=(const Transform & t)
 	this->_position = t._position;
 	this->_rotation = t._rotation;
 	this->_scale    = t._scale;
+	++this->_version;
 	return *this;
 }
 
 void Transform::Translate(const vec3& translation)
 {
 	_position = _position + translation;
+	++_version;
 }
 
 void Transform::Translate(float x, float y, float z)
 {
 	_position = _position + vec3(x, y, z);
+	++_version;
 }
 
 void Transform::Scale(const vec3& scl)
 {
 	_scale = scl;
+	++_version;
 }
 
 void Transform::RotateAroundPointAndAxis(const vec3& axis, float angle, const vec3& point)
@@ -58,6 +63,7 @@ void Transform::RotateAroundPointAndAxis(const vec3& axis, float angle, const ve
 	const Quaternion rot = Quaternion::FromAxisAngle(axis, angle);
 	R = rot.TransformVector(R);
 	_position = point + R;
+	++_version;
 }
 
 XMMATRIX Transform::WorldTransformationMatrix() const
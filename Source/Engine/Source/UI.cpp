@@ -26,6 +26,7 @@
 
 #include "Utilities/vectormath.h"
 #include "Utilities/Profiler.h"
+#include "Utilities/FrameAllocator.h"
 
 using namespace VQEngine;
 
@@ -42,7 +43,7 @@ void UI::RenderBackground(Renderer* mpRenderer, const vec3& color, float alpha,
 	Transform tf;
 	tf.SetScale(size.x(), size.y(), 1.0f);
 
-	const vec2 pos = ( (vec2(CoordsNDC.x(), -CoordsNDC.y()) ) / windowSizeXY) * 2.0 - vec2(1.0f, -1.0f) + vec2(tf._scale.x(), -tf._scale.y());
+	const vec2 pos = ( (vec2(CoordsNDC.x(), -CoordsNDC.y()) ) / windowSizeXY) * 2.0 - vec2(1.0f, -1.0f) + vec2(tf.GetScale().x(), -tf.GetScale().y());
 	tf.SetPosition(pos.x(), pos.y(), 0.0f);
 	
 	const XMMATRIX proj = XMMatrixOrthographicLH(windowSizeXY.x(), windowSizeXY.y(), 0.1f, 1000.0f);
@@ -105,9 +106,24 @@ const char* FrameStats::statNames[FrameStats::numStat] =
 	"[Cull] PointViews: ",
 	//"[Cull] DirectionalView : ",
 	"[Cull] PointLights: ",
+	"[Cull] SpotLights : ",
+
+#if COUNT_HEAP_ALLOCATIONS
+	"[Mem] PreRender Allocs: ",
+#else // operator new isn't counted
+	"[Mem] PreRender Allocs (arena overflow only): ",
+#endif
+	"[Mem] Frame KB        : ",
+
+	"[Mem] VB KB     : ",
+	"[Mem] VB CPU KB : ",
+	"[Mem] IB KB      : ",
+	"[Mem] IB CPU KB  : ",
+	"[Mem] UAV KB     : ",
+	"[Mem] UAV CPU KB : ",
 };
-constexpr size_t RENDER_ORDER_FRAME_STATS_ROW_1[] = { 0, 3, 4, 1, 2};
-constexpr size_t RENDER_ORDER_FRAME_STATS_ROW_2[] = { 5, 6, 7, 8, 9, 10, 11 };
+constexpr size_t RENDER_ORDER_FRAME_STATS_ROW_1[] = { 0, 3, 4, 1, 2, 15, 16, 17, 18, 19, 20 };
+constexpr size_t RENDER_ORDER_FRAME_STATS_ROW_2[] = { 5, 6, 7, 8, 9, 10, 11, 13, 14 };
 
 auto GetFPSColor = [](int FPS) -> LinearColor
 {
@@ -175,7 +191,8 @@ void VQEngine::UI::RenderPerfStats(const FrameStats& stats) const
 	const vec2 GPUProfilerAreaBounds = mProfilerStack.pGPU->GetEntryAreaBounds(screenSizeInPixels);
 	const vec2 ProfilerAreaBounds(BACKGROUND_NORMALIZED_LENGTH_X, std::max(CPUProfilerAreaBounds.y(), GPUProfilerAreaBounds.y()) );
 
-	vec2 sz = ProfilerAreaBounds +vec2(0.0f, (8 * LINE_HEIGHT_IN_PX) / screenSizeInPixels.y());
+	constexpr size_t NUM_FRAME_STATS_ROWS = sizeof(RENDER_ORDER_FRAME_STATS_ROW_1) / sizeof(size_t);
+	vec2 sz = ProfilerAreaBounds +vec2(0.0f, ((NUM_FRAME_STATS_ROWS + 5) * LINE_HEIGHT_IN_PX) / screenSizeInPixels.y());
 	vec2 pos = PX_POS_FRAMESTATS - vec2(X_MARGIN_PX, Y_OFFSET_PX);
 	RenderBackground(mpRenderer, sBackgroundColor, BACKGROUND_ALPHA, sz, pos);
 
@@ -35,14 +35,23 @@ public:
 	//----------------------------------------------------------------------------------------------------------------
 	// GETTERS & SETTERS
 	//----------------------------------------------------------------------------------------------------------------
-	inline void SetXRotationDeg(float xDeg)            { _rotation = Quaternion::FromAxisAngle(vec3::Right  , xDeg * DEG2RAD); }
-	inline void SetYRotationDeg(float yDeg)            { _rotation = Quaternion::FromAxisAngle(vec3::Up     , yDeg * DEG2RAD); }
-	inline void SetZRotationDeg(float zDeg)            { _rotation = Quaternion::FromAxisAngle(vec3::Forward, zDeg * DEG2RAD); }
-	inline void SetScale(float x, float y, float z)    { _scale	= vec3(x, y, z); }
-	inline void SetScale(const vec3& scl)              { _scale	= scl; }
-	inline void SetUniformScale(float s)		       { _scale	= vec3(s, s, s); }
-	inline void SetPosition(float x, float y, float z) { _position = vec3(x, y, z); }
-	inline void SetPosition(const vec3& pos)		   { _position = pos; }
+	inline void SetXRotationDeg(float xDeg)            { _rotation = Quaternion::FromAxisAngle(vec3::Right  , xDeg * DEG2RAD); ++_version; }
+	inline void SetYRotationDeg(float yDeg)            { _rotation = Quaternion::FromAxisAngle(vec3::Up     , yDeg * DEG2RAD); ++_version; }
+	inline void SetZRotationDeg(float zDeg)            { _rotation = Quaternion::FromAxisAngle(vec3::Forward, zDeg * DEG2RAD); ++_version; }
+	inline void SetScale(float x, float y, float z)    { _scale	= vec3(x, y, z); ++_version; }
+	inline void SetScale(const vec3& scl)              { _scale	= scl; ++_version; }
+	inline void SetUniformScale(float s)		       { _scale	= vec3(s, s, s); ++_version; }
+	inline void SetPosition(float x, float y, float z) { _position = vec3(x, y, z); ++_version; }
+	inline void SetPosition(const vec3& pos)		   { _position = pos; ++_version; }
+
+	inline const vec3&       GetPosition() const { return _position; }
+	inline const Quaternion& GetRotation() const { return _rotation; }
+	inline const vec3&       GetScale() const    { return _scale; }
+
+	// Version is incremented every time the transform is modified. Systems caching 
+	// data derived from the transform (e.g. the world space bounding boxes) compare 
+	// versions to detect changes, hence the data is only writable through the setters.
+	inline unsigned GetVersion() const { return _version; }
 
 	//----------------------------------------------------------------------------------------------------------------
 	// TRANSFORMATIONS
@@ -62,12 +71,12 @@ public:
 	inline void RotateAroundGlobalYAxisDegrees(float angle)	{ RotateAroundAxisDegrees(vec3::YAxis, std::forward<float>(angle)); }
 	inline void RotateAroundGlobalZAxisDegrees(float angle)	{ RotateAroundAxisDegrees(vec3::ZAxis, std::forward<float>(angle)); }
 
-	inline void RotateInWorldSpace(const Quaternion& q)	{ _rotation = q * _rotation;	}
-	inline void RotateInLocalSpace(const Quaternion& q)	{ _rotation = _rotation * q;	}
+	inline void RotateInWorldSpace(const Quaternion& q)	{ _rotation = q * _rotation; ++_version; }
+	inline void RotateInLocalSpace(const Quaternion& q)	{ _rotation = _rotation * q; ++_version; }
 
-	inline void ResetPosition() { _position = vec3(0, 0, 0); }
-	inline void ResetRotation() { _rotation = Quaternion::Identity(); }
-	inline void ResetScale() { _scale = vec3(1, 1, 1); }
+	inline void ResetPosition() { _position = vec3(0, 0, 0); ++_version; }
+	inline void ResetRotation() { _rotation = Quaternion::Identity(); ++_version; }
+	inline void ResetScale() { _scale = vec3(1, 1, 1); ++_version; }
 	inline void Reset() { ResetScale(); ResetRotation(); ResetPosition(); }
 
 	XMMATRIX WorldTransformationMatrix() const;
@@ -78,10 +87,13 @@ public:
 	//----------------------------------------------------------------------------------------------------------------
 	// DATA
 	//----------------------------------------------------------------------------------------------------------------
+	const vec3			_originalPosition;
+	const Quaternion	_originalRotation;
+
+private:
 	vec3				_position;
 	Quaternion			_rotation;
 	vec3				_scale;
-	const vec3			_originalPosition;
-	const Quaternion	_originalRotation;
+	unsigned			_version;
 };
 
@@ -26,9 +26,11 @@
 #include "Renderer/RenderingEnums.h"
 
 #include "Utilities/vectormath.h"
+#include "Utilities/FrameAllocator.h"
 
 #include <array>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
@@ -111,67 +113,96 @@ struct RenderPass
 
 
 
-#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-struct MeshDrawData
+constexpr int MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS = 64;
+struct DepthOnlyPass_PerObjectMatrices             { XMMATRIX wvp; };
+struct DepthOnlyPass_PerObjectMatricesCubemap      { XMMATRIX matWorld; XMMATRIX wvp; };
+struct DepthOnlyPass_InstancedObjectCBuffer        { DepthOnlyPass_PerObjectMatrices        objMatrices[MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS]; };
+struct DepthOnlyPass_InstancedObjectCubemapCBuffer { DepthOnlyPass_PerObjectMatricesCubemap objMatrices[MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS]; };
+
+inline void MakeInstanceData(DepthOnlyPass_PerObjectMatrices& instance, const XMMATRIX& matWorld, const XMMATRIX& viewProj)        { instance = { matWorld * viewProj }; }
+inline void MakeInstanceData(DepthOnlyPass_PerObjectMatricesCubemap& instance, const XMMATRIX& matWorld, const XMMATRIX& viewProj) { instance = { matWorld, matWorld * viewProj }; }
+
+// Flat instanced draw data of a shadow view.
+//
+// The culling appends the world matrix of a visible object once into a contiguous array
+// and a draw per visible mesh referencing the matrix by index. Build() groups the draws
+// by mesh with a counting sort and writes the per-instance cbuffer data (TInstanceData) of
+// each mesh contiguously, hence the shadow pass uploads the instances with a memcpy of up
+// to MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS instances per draw call.
+//
+// The containers live in the frame memory: Clear() rebinds them to the allocator of the
+// current frame, which must be done each frame before the draw data is populated again.
+//
+template<class TInstanceData>
+struct InstancedMeshDrawData
 {
-#define INCLUDE_OBJECT_POINTER_TO_DRAW_DATA 0
-#if !INCLUDE_OBJECT_POINTER_TO_DRAW_DATA
-	void AddMeshTransformation(MeshID meshID, const XMMATRIX& matTransform)
+	struct Draw      { MeshID meshID; int matrixIndex; };
+	struct MeshRange { MeshID meshID; int firstInstance; int numInstances; };
+
+	inline int  AddMatrix(const XMMATRIX& matWorld)        { mMatrices.push_back(matWorld); return static_cast<int>(mMatrices.size()) - 1; }
+	inline void AddDraw(MeshID meshID, int matrixIndex)    { mDraws.push_back({ meshID, matrixIndex }); }
+	inline void AddMeshTransformation(MeshID meshID, const XMMATRIX& matWorld) { AddDraw(meshID, AddMatrix(matWorld)); }
+
+	inline const TInstanceData* GetInstances(const MeshRange& range) const { return &mInstances[range.firstInstance]; }
+
+	// Groups the draws per mesh into mInstances & mMeshRanges. @viewProj is the view-projection of the shadow view.
+	void Build(const XMMATRIX& viewProj)
 	{
-		if (meshTransformListLookup.find(meshID) != meshTransformListLookup.end())
-		{
-			meshTransformListLookup.at(meshID).push_back(matTransform);
-		}
-		else
+		mInstances.resize(mDraws.size());
+		mMeshRanges.clear();
+		if (mDraws.empty())
+			return;
+
+		// COUNT: the mesh IDs of a view are in a narrow range, count them in a flat array
+		MeshID minMeshID = mDraws.front().meshID;
+		MeshID maxMeshID = minMeshID;
+		for (const Draw& draw : mDraws)
 		{
-			meshTransformListLookup[meshID].push_back(matTransform);
+			minMeshID = (std::min)(minMeshID, draw.meshID);
+			maxMeshID = (std::max)(maxMeshID, draw.meshID);
 		}
-	}
-
-	// Note:
-	//
-	// may result in a lot of XMMATRIX copies, we can use ID's to keep
-	// track of matrices instead of storing one per mesh.
-	std::unordered_map<MeshID, std::vector<XMMATRIX>> meshTransformListLookup;
-#else
-	// Want to eliminate redundant matrix copies with the above design.
-	// each mesh should be mapped to draw data which should contain:
-	// - the game object we're drawing (to be used as the LOD lookup key)
-	// - matrix data index. # game objs = # matrices.
-	//   remember to copy matrices here to an array so we can access with 
-	//   higher cache coherency. (in the long run, game objects should be
-	//   separated from transforms and transforms should all be kept in
-	//   an array so only one copy of contiguous transforms are stored
-	//   and iterated over.
-	//
-	struct ObjectDrawLookupData
-	{
-		const GameObject* pObj = nullptr;
-		int martixID = -1;
-	};
-	std::vector< ObjectDrawLookupData> mObjectdrawData;
-	std::vector<const XMMATRIX*> mpTransformationMatrices;
-	std::unordered_map<MeshID, std::vector< ObjectDrawLookupData>> mMeshDrawDataLookup;
+		mMeshOffsets.assign(maxMeshID - minMeshID + 1, 0);
+		for (const Draw& draw : mDraws)
+			++mMeshOffsets[draw.meshID - minMeshID];
 
-	void AddMeshTransformation(MeshID meshID, const XMMATRIX& matTransform, const GameObject* pObj = nullptr)
-	{
-		assert(pObj);
-		const bool bMeshExistsInLookup = mMeshDrawDataLookup.find(meshID) != mMeshDrawDataLookup.end();
-		if (bMeshExistsInLookup)
+		// PREFIX SUM: per-mesh instance ranges
+		int numInstances = 0;
+		for (int i = 0; i < static_cast<int>(mMeshOffsets.size()); ++i)
 		{
-			//mpTransformationMatrices
-			mMeshDrawDataLookup.at(meshID).push_back(ObjectDrawLookupData{pObj, -1});
+			const int count = mMeshOffsets[i];
+			if (count == 0)
+				continue;
+			mMeshRanges.push_back({ minMeshID + i, numInstances, count });
+			mMeshOffsets[i] = numInstances;
+			numInstances += count;
 		}
 
-		// add to lookup
-		else
+		// SCATTER: instance data of each mesh becomes contiguous, in culling order
+		for (const Draw& draw : mDraws)
 		{
-			 mMeshDrawDataLookup[meshID].push_back(ObjectDrawLookupData{pObj,-1 });
+			MakeInstanceData(mInstances[mMeshOffsets[draw.meshID - minMeshID]++], mMatrices[draw.matrixIndex], viewProj);
 		}
 	}
 
-#endif
+	void Clear(LinearAllocator* pFrameMemory)
+	{
+		mMatrices    = FrameVector<XMMATRIX>(pFrameMemory);
+		mDraws       = FrameVector<Draw>(pFrameMemory);
+		mInstances   = FrameVector<TInstanceData>(pFrameMemory);
+		mMeshRanges  = FrameVector<MeshRange>(pFrameMemory);
+		mMeshOffsets = FrameVector<int>(pFrameMemory);
+	}
+
+	FrameVector<XMMATRIX>      mMatrices;    // world matrices of the visible objects
+	FrameVector<Draw>          mDraws;       // visible meshes, in culling order
+	FrameVector<TInstanceData> mInstances;   // instance data grouped by mesh after Build()
+	FrameVector<MeshRange>     mMeshRanges;  // (offset, count) of each mesh in mInstances, sorted by MeshID
+	FrameVector<int>           mMeshOffsets; // counting sort scratch, indexed by [meshID - min meshID]
 };
+using DirectionalMeshDrawData = InstancedMeshDrawData<DepthOnlyPass_PerObjectMatrices>;
+
+#if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
+using MeshDrawData = InstancedMeshDrawData<DepthOnlyPass_PerObjectMatricesCubemap>; // point light cube faces
 #else
 struct MeshDrawData
 {
@@ -188,11 +219,6 @@ struct MeshDrawData
 
 using DepthTargetIDArray = std::vector<DepthTargetID>;
 
-constexpr int MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS = 64;
-struct DepthOnlyPass_PerObjectMatrices             { XMMATRIX wvp; };
-struct DepthOnlyPass_PerObjectMatricesCubemap      { XMMATRIX matWorld; XMMATRIX wvp; };
-struct DepthOnlyPass_InstancedObjectCBuffer        { DepthOnlyPass_PerObjectMatrices        objMatrices[MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS]; };
-struct DepthOnlyPass_InstancedObjectCubemapCBuffer { DepthOnlyPass_PerObjectMatricesCubemap objMatrices[MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS]; };
 struct ShadowMapPass : public RenderPass
 {
 	ShadowMapPass(CPUProfiler*& pCPU_, GPUProfiler*& pGPU_) : RenderPass(pCPU_, pGPU_) {}
@@ -186,8 +186,9 @@ void DeferredRenderingPasses::RenderGBuffer(Renderer* pRenderer, const Scene* pS
 {
 	//--------------------------------------------------------------------------------------------------------------------
 	struct InstancedGbufferObjectMaterials { SurfaceMaterial objMaterials[DRAW_INSTANCED_COUNT_GBUFFER_PASS]; };
-	auto RenderObject = [&](const GameObject* pObj)
+	auto RenderDrawItem = [&](const DrawItem& drawItem)
 	{
+		const GameObject* pObj = drawItem.pObject;
 		const Transform& tf = pObj->GetTransform();
 		const ModelData& model = pObj->GetModelData();
 
@@ -201,61 +202,60 @@ void DeferredRenderingPasses::RenderGBuffer(Renderer* pRenderer, const Scene* pS
 
 
 		SurfaceMaterial material;
-		for (MeshID id : model.mMeshIDs)
-		{
-			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(pScene, id, pObj);
+		const MeshID id = drawItem.meshID;
+		const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(pScene, drawItem);
 
-			// SET MATERIAL CONSTANT BUFFER & TEXTURES
-			//
-			const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
-			if (bMeshHasMaterial)
-			{
-				const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
-				const Material* pMat = SceneResourceView::GetMaterial(pScene, materialID);
-
-				// #TODO: uncomment below when transparency is implemented.
-				//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
-				//	return;
-
-				material = pMat->GetCBufferData();
-				pRenderer->SetConstantStruct("surfaceMaterial", &material);
-				pRenderer->SetConstantStruct("ObjMatrices", &mats);
-
-				// #TODO: this is duplicate code, see Forward.
-				pRenderer->SetSamplerState("sAnisoSampler", EDefaultSamplerState::ANISOTROPIC_4_WRAPPED_SAMPLER);
-				if (pMat->diffuseMap >= 0)		pRenderer->SetTexture("texDiffuseMap", pMat->diffuseMap);
-				if (pMat->normalMap >= 0)		pRenderer->SetTexture("texNormalMap", pMat->normalMap);
-				if (pMat->specularMap >= 0)		pRenderer->SetTexture("texSpecularMap", pMat->specularMap);
-				if (pMat->mask >= 0)			pRenderer->SetTexture("texAlphaMask", pMat->mask);
-				if (pMat->metallicMap >= 0)		pRenderer->SetTexture("texMetallicMap", pMat->metallicMap);
-				if (pMat->roughnessMap >= 0)	pRenderer->SetTexture("texRoughnessMap", pMat->roughnessMap);
+		// SET MATERIAL CONSTANT BUFFER & TEXTURES
+		//
+		const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
+		if (bMeshHasMaterial)
+		{
+			const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
+			const Material* pMat = SceneResourceView::GetMaterial(pScene, materialID);
+
+			// #TODO: uncomment below when transparency is implemented.
+			//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
+			//	return;
+
+			material = pMat->GetCBufferData();
+			pRenderer->SetConstantStruct("surfaceMaterial", &material);
+			pRenderer->SetConstantStruct("ObjMatrices", &mats);
+
+			// #TODO: this is duplicate code, see Forward.
+			pRenderer->SetSamplerState("sAnisoSampler", EDefaultSamplerState::ANISOTROPIC_4_WRAPPED_SAMPLER);
+			if (pMat->diffuseMap >= 0)		pRenderer->SetTexture("texDiffuseMap", pMat->diffuseMap);
+			if (pMat->normalMap >= 0)		pRenderer->SetTexture("texNormalMap", pMat->normalMap);
+			if (pMat->specularMap >= 0)		pRenderer->SetTexture("texSpecularMap", pMat->specularMap);
+			if (pMat->mask >= 0)			pRenderer->SetTexture("texAlphaMask", pMat->mask);
+			if (pMat->metallicMap >= 0)		pRenderer->SetTexture("texMetallicMap", pMat->metallicMap);
+			if (pMat->roughnessMap >= 0)	pRenderer->SetTexture("texRoughnessMap", pMat->roughnessMap);
 #if ENABLE_PARALLAX_MAPPING
-				if (pMat->heightMap >= 0)		pRenderer->SetTexture("texHeightMap", pMat->heightMap);
+			if (pMat->heightMap >= 0)		pRenderer->SetTexture("texHeightMap", pMat->heightMap);
 #endif
-				if (pMat->emissiveMap >= 0)		pRenderer->SetTexture("texEmissiveMap", pMat->emissiveMap);
-				pRenderer->SetConstant1f("BRDFOrPhong", 1.0f);	// assume brdf for now
+			if (pMat->emissiveMap >= 0)		pRenderer->SetTexture("texEmissiveMap", pMat->emissiveMap);
+			pRenderer->SetConstant1f("BRDFOrPhong", 1.0f);	// assume brdf for now
 
-			}
-			else
-			{
-				// each object should have a material assigned.
-				// if not, we just send default
-				Material::GetDefaultMaterialCBufferData();
-			}
+		}
+		else
+		{
+			// each object should have a material assigned.
+			// if not, we just send default
+			Material::GetDefaultMaterialCBufferData();
+		}
 
-			
-			pRenderer->SetRasterizerState(SceneResourceView::GetMeshRenderMode(pScene, pObj, id) == MeshRenderSettings::EMeshRenderMode::WIREFRAME
-				? EDefaultRasterizerState::WIREFRAME 
-				: EDefaultRasterizerState::CULL_BACK);
+		
+		pRenderer->SetRasterizerState(SceneResourceView::GetMeshRenderMode(pScene, pObj, id) == MeshRenderSettings::EMeshRenderMode::WIREFRAME
+			? EDefaultRasterizerState::WIREFRAME 
+			: EDefaultRasterizerState::CULL_BACK);
 
-			pRenderer->SetVertexBuffer(IABuffer.first);
-			pRenderer->SetIndexBuffer(IABuffer.second);
-			pRenderer->Apply();
-			pRenderer->DrawIndexed();
-		}
+		pRenderer->SetVertexBuffer(IABuffer.first);
+		pRenderer->SetIndexBuffer(IABuffer.second);
+		pRenderer->Apply();
+		pRenderer->DrawIndexed();
 	};
-	auto RenderObject_DepthOnly = [&](const GameObject* pObj)
+	auto RenderDrawItem_DepthOnly = [&](const DrawItem& drawItem)
 	{
+		const GameObject* pObj = drawItem.pObject;
 		const Transform& tf = pObj->GetTransform();
 		const ModelData& model = pObj->GetModelData();
 
@@ -265,42 +265,40 @@ void DeferredRenderingPasses::RenderGBuffer(Renderer* pRenderer, const Scene* pS
 		pRenderer->SetRasterizerState(EDefaultRasterizerState::CULL_BACK);
 
 		SurfaceMaterial material;
-		for (MeshID id : model.mMeshIDs)
-		{
-			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(pScene, id, pObj);
+		const MeshID id = drawItem.meshID;
+		const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(pScene, drawItem);
 
-			// SET MATERIAL CONSTANT BUFFER & TEXTURES
-			//
-			const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
-			if (bMeshHasMaterial)
-			{
-				const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
-				const Material* pMat = SceneResourceView::GetMaterial(pScene, materialID);
+		// SET MATERIAL CONSTANT BUFFER & TEXTURES
+		//
+		const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
+		if (bMeshHasMaterial)
+		{
+			const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
+			const Material* pMat = SceneResourceView::GetMaterial(pScene, materialID);
 
-				// #TODO: uncomment below when transparency is implemented.
-				//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
-				//	return;
+			// #TODO: uncomment below when transparency is implemented.
+			//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
+			//	return;
 #if 0
-				material = pMat->GetShaderFriendlyStruct();
-				pRenderer->SetConstantStruct("surfaceMaterial", &material);
-				pRenderer->SetSamplerState("sAnisoSampler", EDefaultSamplerState::LINEAR_FILTER_SAMPLER);
-				if (pMat->diffuseMap >= 0)		pRenderer->SetTexture("texDiffuseMap", pMat->diffuseMap);
-				if (pMat->mask >= 0)			pRenderer->SetTexture("texAlphaMask", pMat->mask);
+			material = pMat->GetShaderFriendlyStruct();
+			pRenderer->SetConstantStruct("surfaceMaterial", &material);
+			pRenderer->SetSamplerState("sAnisoSampler", EDefaultSamplerState::LINEAR_FILTER_SAMPLER);
+			if (pMat->diffuseMap >= 0)		pRenderer->SetTexture("texDiffuseMap", pMat->diffuseMap);
+			if (pMat->mask >= 0)			pRenderer->SetTexture("texAlphaMask", pMat->mask);
 #if ENABLE_PARALLAX_MAPPING
-				if (pMat->heightMap >= 0)		pRenderer->SetTexture("texHeightMap", pMat->heightMap);
+			if (pMat->heightMap >= 0)		pRenderer->SetTexture("texHeightMap", pMat->heightMap);
 #endif
-				if (pMat->emissiveMap >= 0)		pRenderer->SetTexture("texEmissiveMap", pMat->emissiveMap);
-				pRenderer->SetConstant1f("BRDFOrPhong", 1.0f);	// assume brdf for now
+			if (pMat->emissiveMap >= 0)		pRenderer->SetTexture("texEmissiveMap", pMat->emissiveMap);
+			pRenderer->SetConstant1f("BRDFOrPhong", 1.0f);	// assume brdf for now
 #endif
-			}
+		}
 
-			pRenderer->SetConstantStruct("ObjMats", &objMats);
+		pRenderer->SetConstantStruct("ObjMats", &objMats);
 
-			pRenderer->SetVertexBuffer(IABuffer.first);
-			pRenderer->SetIndexBuffer(IABuffer.second);
-			pRenderer->Apply();
-			pRenderer->DrawIndexed();
-		}
+		pRenderer->SetVertexBuffer(IABuffer.first);
+		pRenderer->SetIndexBuffer(IABuffer.second);
+		pRenderer->Apply();
+		pRenderer->DrawIndexed();
 	};
 	//--------------------------------------------------------------------------------------------------------------------
 
@@ -324,9 +322,9 @@ void DeferredRenderingPasses::RenderGBuffer(Renderer* pRenderer, const Scene* pS
 		// RENDER NON-INSTANCED SCENE OBJECTS
 		//
 		int numObj = 0;
-		for (const auto* obj : sceneView.culledOpaqueList)
+		for (const DrawItem& drawItem : sceneView.culledOpaqueDrawItems)
 		{
-			RenderObject_DepthOnly(obj);
+			RenderDrawItem_DepthOnly(drawItem);
 			++numObj;
 		}
 
@@ -419,10 +417,9 @@ void DeferredRenderingPasses::RenderGBuffer(Renderer* pRenderer, const Scene* pS
 	// RENDER NON-INSTANCED SCENE OBJECTS
 	//
 	int numObj = 0;
-	for (const auto* obj : sceneView.culledOpaqueList)
-	{	// TODO: nuke this object-oriented container and render 
-		//       on the mesh level.
-		RenderObject(obj);
+	for (const DrawItem& drawItem : sceneView.culledOpaqueDrawItems)
+	{
+		RenderDrawItem(drawItem);
 		++numObj;
 	}
 
@@ -684,7 +681,7 @@ void DeferredRenderingPasses::RenderLightingPass(const RenderParams& args) const
 		if (light._type == Light::ELightType::POINT)
 		{
 			const float& r = light._range;	//bounding sphere radius
-			const vec3&  pos = light._transform._position;
+			const vec3&  pos = light._transform.GetPosition();
 			const XMMATRIX world = {
 				r, 0, 0, 0,
 				0, r, 0, 0,
@@ -744,7 +741,7 @@ void DeferredRenderingPasses::RenderLightingPass(const RenderParams& args) const
 
 #if ENABLE_TRANSPARENCY
 	mpGPUProfiler->BeginEntry("Opaque Pass (ScreenSpace)");
-	mpCPUProfiler->BeginEntry("Opaque Pass (ScreenSpace)");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Opaque Pass (ScreenSpace)"));
 
 
 
@@ -757,7 +754,7 @@ void DeferredRenderingPasses::RenderLightingPass(const RenderParams& args) const
 
 	// TRANSPARENT OBJECTS - FORWARD RENDER
 	mpGPUProfiler->BeginEntry("Alpha Pass (Forward)");
-	mpCPUProfiler->BeginEntry("Alpha Pass (Forward)");
+	mpCPUProfiler->BeginEntry(PROFILER_ENTRY("Alpha Pass (Forward)"));
 	{
 		mpRenderer->BindDepthTarget(GetWorldDepthTarget());
 		mpRenderer->SetShader(EShaders::FORWARD_BRDF);
@@ -56,8 +56,9 @@ void ZPrePass::Initialize(Renderer* pRenderer)
 void ZPrePass::RenderDepth(const RenderParams& args) const
 {
 	//--------------------------------------------------------------------------------------------------------------------
-	auto RenderObject = [&](const GameObject* pObj)
+	auto RenderDrawItem = [&](const DrawItem& drawItem)
 	{
+		const GameObject* pObj = drawItem.pObject;
 		const Transform& tf = pObj->GetTransform();
 		const ModelData& model = pObj->GetModelData();
 
@@ -71,44 +72,42 @@ void ZPrePass::RenderDepth(const RenderParams& args) const
 		
 		SurfaceMaterial material;
 		args.pRenderer->SetConstant1i("textureConfig", 0);
-		for (MeshID id : model.mMeshIDs)
-		{
-			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(args.pScene, id, pObj);
+		const MeshID id = drawItem.meshID;
+		const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(args.pScene, drawItem);
 
-			// SET MATERIAL CONSTANT BUFFER & TEXTURES
-			//
-			const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
-			if (bMeshHasMaterial)
-			{
-				const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
-				const Material* pMat = SceneResourceView::GetMaterial(args.pScene, materialID);
-
-				// #TODO: uncomment below when transparency is implemented.
-				//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
-				//	return;
-
-				if (pMat->normalMap >= 0)	args.pRenderer->SetTexture("texNormalMap", pMat->normalMap);
-				if (pMat->mask >= 0)		args.pRenderer->SetTexture("texAlphaMask", pMat->mask);
-				args.pRenderer->SetConstant1i("textureConfig", pMat->GetTextureConfig());
-				args.pRenderer->SetConstant2f("uvScale", pMat->tiling);
-				args.pRenderer->SetConstantStruct("ObjMatrices", &mats);
-			}
-			else
-			{
-				// each object should have a material assigned.
-				// if not, we just send default
-				Material::GetDefaultMaterialCBufferData();
-			}
+		// SET MATERIAL CONSTANT BUFFER & TEXTURES
+		//
+		const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
+		if (bMeshHasMaterial)
+		{
+			const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
+			const Material* pMat = SceneResourceView::GetMaterial(args.pScene, materialID);
+
+			// #TODO: uncomment below when transparency is implemented.
+			//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
+			//	return;
+
+			if (pMat->normalMap >= 0)	args.pRenderer->SetTexture("texNormalMap", pMat->normalMap);
+			if (pMat->mask >= 0)		args.pRenderer->SetTexture("texAlphaMask", pMat->mask);
+			args.pRenderer->SetConstant1i("textureConfig", pMat->GetTextureConfig());
+			args.pRenderer->SetConstant2f("uvScale", pMat->tiling);
+			args.pRenderer->SetConstantStruct("ObjMatrices", &mats);
+		}
+		else
+		{
+			// each object should have a material assigned.
+			// if not, we just send default
+			Material::GetDefaultMaterialCBufferData();
+		}
 
-			args.pRenderer->SetRasterizerState(SceneResourceView::GetMeshRenderMode(args.pScene, pObj, id) == MeshRenderSettings::EMeshRenderMode::WIREFRAME
-				? EDefaultRasterizerState::WIREFRAME
-				: EDefaultRasterizerState::CULL_BACK);
+		args.pRenderer->SetRasterizerState(SceneResourceView::GetMeshRenderMode(args.pScene, pObj, id) == MeshRenderSettings::EMeshRenderMode::WIREFRAME
+			? EDefaultRasterizerState::WIREFRAME
+			: EDefaultRasterizerState::CULL_BACK);
 
-			args.pRenderer->SetVertexBuffer(IABuffer.first);
-			args.pRenderer->SetIndexBuffer(IABuffer.second);
-			args.pRenderer->Apply();
-			args.pRenderer->DrawIndexed();
-		};
+		args.pRenderer->SetVertexBuffer(IABuffer.first);
+		args.pRenderer->SetIndexBuffer(IABuffer.second);
+		args.pRenderer->Apply();
+		args.pRenderer->DrawIndexed();
 	};
 	//--------------------------------------------------------------------------------------------------------------------
 
@@ -135,9 +134,9 @@ void ZPrePass::RenderDepth(const RenderParams& args) const
 	// RENDER NON-INSTANCED SCENE OBJECTS
 	//
 	int numObj = 0;
-	for (const GameObject* pObj : args.sceneView.culledOpaqueList)
+	for (const DrawItem& drawItem : args.sceneView.culledOpaqueDrawItems)
 	{
-		RenderObject(pObj);
+		RenderDrawItem(drawItem);
 		++numObj;
 	}
 
@@ -227,8 +226,9 @@ void ForwardLightingPass::RenderLightingPass(const RenderParams& args) const
 	const SceneView& sceneView = args.sceneView;
 	//--------------------------------------------------------------------------------------------------------------------
 	struct InstancedGbufferObjectMaterials { SurfaceMaterial objMaterials[DRAW_INSTANCED_COUNT_ZPREPASS]; };
-	auto RenderObject = [&](const GameObject* pObj)
+	auto RenderDrawItem = [&](const DrawItem& drawItem)
 	{
+		const GameObject* pObj = drawItem.pObject;
 		const Transform& tf = pObj->GetTransform();
 		const ModelData& model = pObj->GetModelData();
 
@@ -245,55 +245,53 @@ void ForwardLightingPass::RenderLightingPass(const RenderParams& args) const
 		};
 
 		SurfaceMaterial material;
-		for (MeshID id : model.mMeshIDs)
-		{
+		const MeshID id = drawItem.meshID;
 
-			// SET MATERIAL CONSTANT BUFFER & TEXTURES
-			//
-			const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
-			if (bMeshHasMaterial)
-			{
-				const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
-				const Material* pMat = SceneResourceView::GetMaterial(args.pScene, materialID);
-
-				// #TODO: uncomment below when transparency is implemented.
-				//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
-				//	return;
-
-				material = pMat->GetCBufferData();
-				pRenderer->SetConstantStruct("surfaceMaterial", &material);
-				pRenderer->SetConstantStruct("ObjMatrices", &mats);
-
-				// #TODO: this is duplicate code, see Deferred.
-				pRenderer->SetSamplerState("sAnisoSampler", EDefaultSamplerState::ANISOTROPIC_4_WRAPPED_SAMPLER);
-				if (pMat->diffuseMap >= 0)	pRenderer->SetTexture("texDiffuseMap", pMat->diffuseMap);
-				if (pMat->normalMap >= 0)	pRenderer->SetTexture("texNormalMap", pMat->normalMap);
-				if (pMat->specularMap >= 0)	pRenderer->SetTexture("texSpecularMap", pMat->specularMap);
-				if (pMat->mask >= 0)		pRenderer->SetTexture("texAlphaMask", pMat->mask);
-				if (pMat->roughnessMap >= 0)	pRenderer->SetTexture("texRoughnessMap", pMat->roughnessMap);
-				if (pMat->metallicMap >= 0)		pRenderer->SetTexture("texMetallicMap", pMat->metallicMap);
+		// SET MATERIAL CONSTANT BUFFER & TEXTURES
+		//
+		const bool bMeshHasMaterial = model.mMaterialLookupPerMesh.find(id) != model.mMaterialLookupPerMesh.end();
+		if (bMeshHasMaterial)
+		{
+			const MaterialID materialID = model.mMaterialLookupPerMesh.at(id);
+			const Material* pMat = SceneResourceView::GetMaterial(args.pScene, materialID);
+
+			// #TODO: uncomment below when transparency is implemented.
+			//if (pMat->IsTransparent())	// avoidable branching - perhaps keeping opaque and transparent meshes on separate vectors is better.
+			//	return;
+
+			material = pMat->GetCBufferData();
+			pRenderer->SetConstantStruct("surfaceMaterial", &material);
+			pRenderer->SetConstantStruct("ObjMatrices", &mats);
+
+			// #TODO: this is duplicate code, see Deferred.
+			pRenderer->SetSamplerState("sAnisoSampler", EDefaultSamplerState::ANISOTROPIC_4_WRAPPED_SAMPLER);
+			if (pMat->diffuseMap >= 0)	pRenderer->SetTexture("texDiffuseMap", pMat->diffuseMap);
+			if (pMat->normalMap >= 0)	pRenderer->SetTexture("texNormalMap", pMat->normalMap);
+			if (pMat->specularMap >= 0)	pRenderer->SetTexture("texSpecularMap", pMat->specularMap);
+			if (pMat->mask >= 0)		pRenderer->SetTexture("texAlphaMask", pMat->mask);
+			if (pMat->roughnessMap >= 0)	pRenderer->SetTexture("texRoughnessMap", pMat->roughnessMap);
+			if (pMat->metallicMap >= 0)		pRenderer->SetTexture("texMetallicMap", pMat->metallicMap);
 #if ENABLE_PARALLAX_MAPPING
-				if (pMat->heightMap >= 0)		pRenderer->SetTexture("texHeightMap", pMat->heightMap);
+			if (pMat->heightMap >= 0)		pRenderer->SetTexture("texHeightMap", pMat->heightMap);
 #endif
-				if (pMat->emissiveMap >= 0)		pRenderer->SetTexture("texEmissiveMap", pMat->emissiveMap);
-			}
-			else
-			{
-				assert(false);// mMaterials.GetDefaultMaterial(GGX_BRDF)->SetMaterialConstants(pRenderer, EShaders::DEFERRED_GEOMETRY, sceneView.bIsDeferredRendering);
-			}
+			if (pMat->emissiveMap >= 0)		pRenderer->SetTexture("texEmissiveMap", pMat->emissiveMap);
+		}
+		else
+		{
+			assert(false);// mMaterials.GetDefaultMaterial(GGX_BRDF)->SetMaterialConstants(pRenderer, EShaders::DEFERRED_GEOMETRY, sceneView.bIsDeferredRendering);
+		}
 
-			
-			//pRenderer->SetRasterizerState(EDefaultRasterizerState::CULL_BACK);
-			pRenderer->SetRasterizerState(SceneResourceView::GetMeshRenderMode(args.pScene, pObj, id) == MeshRenderSettings::EMeshRenderMode::WIREFRAME
-				? EDefaultRasterizerState::WIREFRAME
-				: EDefaultRasterizerState::CULL_BACK);
+		
+		//pRenderer->SetRasterizerState(EDefaultRasterizerState::CULL_BACK);
+		pRenderer->SetRasterizerState(SceneResourceView::GetMeshRenderMode(args.pScene, pObj, id) == MeshRenderSettings::EMeshRenderMode::WIREFRAME
+			? EDefaultRasterizerState::WIREFRAME
+			: EDefaultRasterizerState::CULL_BACK);
 
-			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(args.pScene, id, pObj);
-			pRenderer->SetVertexBuffer(IABuffer.first);
-			pRenderer->SetIndexBuffer(IABuffer.second);
-			pRenderer->Apply();
-			pRenderer->DrawIndexed();
-		};
+		const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(args.pScene, drawItem);
+		pRenderer->SetVertexBuffer(IABuffer.first);
+		pRenderer->SetIndexBuffer(IABuffer.second);
+		pRenderer->Apply();
+		pRenderer->DrawIndexed();
 	};
 	//--------------------------------------------------------------------------------------------------------------------
 
@@ -338,9 +336,9 @@ void ForwardLightingPass::RenderLightingPass(const RenderParams& args) const
 	// RENDER NON-INSTANCED SCENE OBJECTS
 	//
 	int numObj = 0;
-	for (const auto* obj : args.sceneView.culledOpaqueList)
+	for (const DrawItem& drawItem : args.sceneView.culledOpaqueDrawItems)
 	{
-		RenderObject(obj);
+		RenderDrawItem(drawItem);
 		++numObj;
 	}
 
@@ -200,9 +200,10 @@ void ShadowMapPass::InitializeDirectionalLightShadowMap(const Settings::ShadowMa
 void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shadowView, GPUProfiler* pGPUProfiler) const
 {
 	//-----------------------------------------------------------------------------------------------
-	auto RenderDepth = [&](const GameObject* pObj, const XMMATRIX& viewProj, bool bIsCubemap = false)
+	auto RenderDepth = [&](const DrawItem& drawItem, const XMMATRIX& viewProj, bool bIsCubemap = false)
 	{
-		const ModelData& model = pObj->GetModelData();
+		const GameObject* pObj = drawItem.pObject;
+		const MeshID id = drawItem.meshID;
 		const XMMATRIX matWorld = pObj->GetTransform().WorldTransformationMatrix();
 
 		if (bIsCubemap)
@@ -215,23 +216,21 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 			const DepthOnlyPass_PerObjectMatrices objMats = DepthOnlyPass_PerObjectMatrices({ matWorld * viewProj });
 			pRenderer->SetConstantStruct("ObjMats", &objMats);
 		}
-		std::for_each(model.mMeshIDs.begin(), model.mMeshIDs.end(), [&](MeshID id)
-		{
+
 #if FORCE_NO_CULL_SPOTLIGHTS
-			const RasterizerStateID rasterizerState = EDefaultRasterizerState::CULL_BACK;
+		const RasterizerStateID rasterizerState = EDefaultRasterizerState::CULL_BACK;
 #else
-			const RasterizerStateID rasterizerState = GeometryGenerator::Is2DGeometry(static_cast<EGeometry>(id)) 
-				? EDefaultRasterizerState::CULL_NONE 
-				: EDefaultRasterizerState::CULL_FRONT;
+		const RasterizerStateID rasterizerState = GeometryGenerator::Is2DGeometry(static_cast<EGeometry>(id)) 
+			? EDefaultRasterizerState::CULL_NONE 
+			: EDefaultRasterizerState::CULL_FRONT;
 #endif
-			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(ENGINE->mpActiveScene, id, pObj);
+		const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(ENGINE->mpActiveScene, drawItem);
 
-			pRenderer->SetRasterizerState(rasterizerState);
-			pRenderer->SetVertexBuffer(IABuffer.first);
-			pRenderer->SetIndexBuffer(IABuffer.second);
-			pRenderer->Apply();
-			pRenderer->DrawIndexed();
-		});
+		pRenderer->SetRasterizerState(rasterizerState);
+		pRenderer->SetVertexBuffer(IABuffer.first);
+		pRenderer->SetIndexBuffer(IABuffer.second);
+		pRenderer->Apply();
+		pRenderer->DrawIndexed();
 	};
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
 
@@ -303,9 +302,9 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 		const XMMATRIX viewProj = shadowView.spots[i]->GetLightSpaceMatrix();
 		pRenderer->BeginEvent("Spot[" + std::to_string(i) + "]: DrawSceneZ()");
 #if _DEBUG
-		if (shadowView.shadowMapRenderListLookUp.find(shadowView.spots[i]) == shadowView.shadowMapRenderListLookUp.end())
+		if (shadowView.shadowMapDrawItemListLookUp.find(shadowView.spots[i]) == shadowView.shadowMapDrawItemListLookUp.end())
 		{
-			Log::Error("Spot light not found in shadowmap render list lookup");
+			Log::Error("Spot light not found in shadowmap draw item list lookup");
 			continue;
 		}
 #endif
@@ -323,9 +322,9 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 		pRenderer->BindDepthTarget(mDepthTargets_Spot[i]);	// only depth stencil buffer
 		//pRenderer->Apply();
 
-		for (const GameObject* pObj : shadowView.shadowMapRenderListLookUp.at(shadowView.spots[i]))
+		for (const DrawItem& drawItem : shadowView.shadowMapDrawItemListLookUp.at(shadowView.spots[i]))
 		{
-			RenderDepth(pObj, viewProj);
+			RenderDepth(drawItem, viewProj);
 		}
 		pRenderer->EndEvent();
 	}
@@ -352,9 +351,9 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 		pRenderer->BindDepthTarget(mDepthTarget_Directional);
 		pRenderer->Apply();
 		pRenderer->BeginRender(ClearCommand::Depth(1.0f));
-		for (const GameObject* pObj : shadowView.casters)
+		for (const DrawItem& drawItem : shadowView.casterDrawItems)
 		{
-			RenderDepth(pObj, viewProj);
+			RenderDepth(drawItem, viewProj);
 		}
 
 
@@ -364,38 +363,29 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 		pRenderer->BindDepthTarget(mDepthTarget_Directional);
 
 		DepthOnlyPass_InstancedObjectCBuffer cbuffer;
-		for (const RenderListLookupEntry& MeshID_RenderList : shadowView.RenderListsPerMeshType)
+		const DirectionalMeshDrawData& drawData = shadowView.casterInstancedDrawData;
+		for (const DirectionalMeshDrawData::MeshRange& meshRange : drawData.mMeshRanges)
 		{
-			const MeshID& mesh = MeshID_RenderList.first;
-			const std::vector<const GameObject*>& renderList = MeshID_RenderList.second;
+			const MeshID& mesh = meshRange.meshID;
 
 			const RasterizerStateID rasterizerState = EDefaultRasterizerState::CULL_NONE;// Is2DGeometry(mesh) ? EDefaultRasterizerState::CULL_NONE : EDefaultRasterizerState::CULL_FRONT;
-			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(ENGINE->mpActiveScene, mesh, renderList.back());
+			const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(ENGINE->mpActiveScene, mesh);
 
 			pRenderer->SetRasterizerState(rasterizerState);
 			pRenderer->SetVertexBuffer(IABuffer.first);
 			pRenderer->SetIndexBuffer(IABuffer.second);
 
-			int batchCount = 0;
-			do
+			// instance data is already laid out as the cbuffer expects: copy in chunks
+			const DepthOnlyPass_PerObjectMatrices* pInstances = drawData.GetInstances(meshRange);
+			for (int firstInstance = 0; firstInstance < meshRange.numInstances; firstInstance += MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS)
 			{
-				int instanceID = 0;
-				for (; instanceID < MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS; ++instanceID)
-				{
-					const int renderListIndex = MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS * batchCount + instanceID;
-					if (renderListIndex == renderList.size())
-						break;
-
-					cbuffer.objMatrices[instanceID] =
-					{
-						renderList[renderListIndex]->GetTransform().WorldTransformationMatrix() * viewProj
-					};
-				}
+				const int numInstances = (std::min)(MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS, meshRange.numInstances - firstInstance);
+				memcpy(cbuffer.objMatrices, pInstances + firstInstance, numInstances * sizeof(DepthOnlyPass_PerObjectMatrices));
 
 				pRenderer->SetConstantStruct("ObjMats", &cbuffer);
 				pRenderer->Apply();
-				pRenderer->DrawIndexedInstanced(instanceID);
-			} while (batchCount++ < renderList.size() / MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS);
+				pRenderer->DrawIndexedInstanced(numInstances);
+			}
 		}
 
 		pRenderer->EndEvent();
@@ -431,7 +421,7 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 
 		pRenderer->BeginEvent("Point[" + std::to_string(i) + "]: DrawSceneZ()");
 		
-		_cbLight.lightPosition_farPlane = vec4(shadowView.points[i]->mTransform._position, shadowView.points[i]->mRange);
+		_cbLight.lightPosition_farPlane = vec4(shadowView.points[i]->mTransform.GetPosition(), shadowView.points[i]->mRange);
 
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
 		DepthOnlyPass_InstancedObjectCubemapCBuffer cbuffer;
@@ -440,9 +430,11 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 		// render objects for each face
 		for (int face = 0; face < 6; ++face)
 		{
+#if !SHADOW_PASS_USE_INSTANCED_DRAW_DATA // instanced draw data has the view-projection applied in MeshDrawData::Build()
 			const XMMATRIX viewProj =
 				shadowView.points[i]->GetViewMatrix(static_cast<Texture::CubemapUtility::ECubeMapLookDirections>(face))
 				* shadowView.points[i]->GetProjectionMatrix();
+#endif
 
 			const size_t depthTargetIndex = i * 6 + face;
 			pRenderer->BindDepthTarget(mDepthTargets_Point[depthTargetIndex]);	// only depth stencil buffer
@@ -450,22 +442,11 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 			pRenderer->Apply();
 
 #if SHADOW_PASS_USE_INSTANCED_DRAW_DATA
-#if INCLUDE_OBJECT_POINTER_TO_DRAW_DATA
-			const std::vector<const XMMATRIX*>& pMatrices = shadowView.shadowCubeMapMeshDrawListLookup.at(shadowView.points[i])[face].mpTransformationMatrices;
-			for (const std::pair<const MeshID, std::vector<MeshDrawData::ObjectDrawLookupData>>& f : shadowView.shadowCubeMapMeshDrawListLookup.at(shadowView.points[i])[face].mMeshDrawDataLookup)
-#else
-			for (const std::pair<MeshID, std::vector<XMMATRIX>>& f : shadowView.shadowCubeMapMeshDrawListLookup.at(shadowView.points[i])[face].meshTransformListLookup)
-#endif
+			const MeshDrawData& drawData = shadowView.shadowCubeMapMeshDrawListLookup.at(shadowView.points[i])[face];
+			for (const MeshDrawData::MeshRange& meshRange : drawData.mMeshRanges)
 			{
-#if INCLUDE_OBJECT_POINTER_TO_DRAW_DATA
-				const std::vector< MeshDrawData::ObjectDrawLookupData>& meshInstanceData = f.second;
-				const int meshInstanceCount = static_cast<int>(meshInstanceData.size());
-#else
-				const int meshInstanceCount = static_cast<int>(f.second.size());
-#endif
-
-				const MeshID& meshID = f.first;
-				assert(meshInstanceCount > 0); // make sure no empty meshID transformation list
+				const MeshID& meshID = meshRange.meshID;
+				assert(meshRange.numInstances > 0); // make sure no empty mesh instance range
 
 #if FORCE_NO_CULL_POINTLIGHTS
 				const RasterizerStateID rasterizerState = EDefaultRasterizerState::CULL_BACK;
@@ -475,42 +456,22 @@ void ShadowMapPass::RenderShadowMaps(Renderer* pRenderer, const ShadowView& shad
 					: EDefaultRasterizerState::CULL_FRONT;
 
 #endif
-				const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(ENGINE->mpActiveScene
-					, meshID
-#if INCLUDE_OBJECT_POINTER_TO_DRAW_DATA
-					, meshInstanceData.back().pObj
-#endif
-				);
+				const auto IABuffer = SceneResourceView::GetVertexAndIndexBufferIDsOfMesh(ENGINE->mpActiveScene, meshID);
 				pRenderer->SetVertexBuffer(IABuffer.first);
 				pRenderer->SetIndexBuffer(IABuffer.second);
 				pRenderer->SetRasterizerState(rasterizerState);
 
-				int batchCount = 0;
-				do
+				// instance data is already laid out as the cbuffer expects: copy in chunks
+				const DepthOnlyPass_PerObjectMatricesCubemap* pInstances = drawData.GetInstances(meshRange);
+				for (int firstInstance = 0; firstInstance < meshRange.numInstances; firstInstance += MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS)
 				{
-					int instanceID = 0;
-					for (; instanceID < MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS; ++instanceID)
-					{
-						const int renderListIndex = MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS * batchCount + instanceID;
-						if (renderListIndex == meshInstanceCount)
-							break;
-						
-						cbuffer.objMatrices[instanceID] = DepthOnlyPass_PerObjectMatricesCubemap
-						{
-#if INCLUDE_OBJECT_POINTER_TO_DRAW_DATA
-							(*pMatrices[meshInstanceData[instanceID].martixID]),
-							(*pMatrices[meshInstanceData[instanceID].martixID]) * viewProj
-#else
-							f.second[renderListIndex],
-							f.second[renderListIndex] * viewProj
-#endif
-						};
-					}
+					const int numInstances = (std::min)(MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS, meshRange.numInstances - firstInstance);
+					memcpy(cbuffer.objMatrices, pInstances + firstInstance, numInstances * sizeof(DepthOnlyPass_PerObjectMatricesCubemap));
 
 					pRenderer->SetConstantStruct("ObjMats", &cbuffer);
 					pRenderer->Apply();
-					pRenderer->DrawIndexedInstanced(instanceID);
-				} while (batchCount++ < meshInstanceCount / MAX_DRAW_INSTANCED_COUNT__DEPTH_PASS);
+					pRenderer->DrawIndexedInstanced(numInstances);
+				}
 			}
 			
 #else
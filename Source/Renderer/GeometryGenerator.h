@@ -19,6 +19,7 @@
 #pragma once
 
 #include "Engine/Mesh.h"
+#include "MeshOptimizer.h"
 
 #include "Renderer.h"
 
@@ -33,6 +34,15 @@ namespace GeometryGenerator
 	Mesh Cylinder(float height, float topRadius, float bottomRadius, unsigned sliceCount, unsigned stackCount, int numLODLevels = 1);
 	Mesh Cone(float height, float radius, unsigned sliceCount, int numLODLevels = 1);
 
+	// CPU-side vertex & index data of the LOD levels of the meshes above, before OptimizeBuiltinMesh()
+	MeshLODData<DefaultVertexBufferData> SphereData(float radius, unsigned ringCount, unsigned sliceCount, int numLODLevels = 1);
+	MeshLODData<DefaultVertexBufferData> GridData(float width, float depth, unsigned m, unsigned n, int numLODLevels = 1);
+	MeshLODData<DefaultVertexBufferData> CylinderData(float height, float topRadius, float bottomRadius, unsigned sliceCount, unsigned stackCount, int numLODLevels = 1);
+	MeshLODData<DefaultVertexBufferData> ConeData(float height, float radius, unsigned sliceCount, int numLODLevels = 1);
+
+	// Vertex cache & vertex fetch optimization of the built-in meshes, see MeshOptimizer
+	MeshOptimizer::Report OptimizeBuiltinMesh(MeshLODData<DefaultVertexBufferData>& meshData);
+
 	bool Is2DGeometry(EGeometry meshID);
 	void CalculateTangentsAndBitangents(std::vector<DefaultVertexBufferData>& vertices, const std::vector<unsigned> indices);	// Only Tangents
 };
@@ -0,0 +1,105 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include "Engine/Mesh.h"
+#include "RenderingStructs.h"
+
+#include <vector>
+
+// Mesh Optimizer
+//
+// Reorders the triangles and vertices of indexed triangle lists for the GPU without changing the 
+// rendered result. None of the functions add or remove triangles.
+//
+//  - Vertex Cache : Tipsify (Sander, Nehab & Barczak 2007). Triangles are emitted in fans around the
+//                   vertices that are most likely to still be in a post-transform cache of the given 
+//                   size. Linear time and doesn't depend on the exact cache model of the GPU.
+//  - Overdraw     : the vertex cache ordered triangles are split into clusters which are sorted so that
+//                   the clusters facing away from the center of the mesh are drawn first. The clusters 
+//                   keep their order within, the cost on the vertex cache is bounded by @threshold.
+//  - Vertex Fetch : vertices are reordered by their first use in the index buffer, unreferenced 
+//                   vertices are removed.
+//
+namespace MeshOptimizer
+{
+	constexpr unsigned DEFAULT_CACHE_SIZE = 16;
+	constexpr float    DEFAULT_OVERDRAW_THRESHOLD = 1.05f;	// allowed ACMR increase for the overdraw sort
+
+	// post-transform vertex cache statistics from a FIFO cache simulation
+	struct VertexCacheStatistics
+	{
+		size_t numTriangles = 0;
+		size_t numVertices = 0;				// referenced by the index buffer
+		size_t numTransformedVertices = 0;	// cache misses
+
+		// Average Cache Miss Ratio: transformed vertices per triangle. 3 is the worst case, large
+		// regular meshes can get close to 0.5.
+		inline float GetACMR() const { return numTriangles ? float(numTransformedVertices) / numTriangles : 0.0f; }
+
+		// Average Transformed Vertex Ratio: transformed vertices per referenced vertex, 1 is the optimum.
+		inline float GetATVR() const { return numVertices ? float(numTransformedVertices) / numVertices : 0.0f; }
+
+		inline VertexCacheStatistics& operator+=(const VertexCacheStatistics& other)
+		{
+			numTriangles += other.numTriangles;
+			numVertices += other.numVertices;
+			numTransformedVertices += other.numTransformedVertices;
+			return *this;
+		}
+	};
+
+	struct Report
+	{
+		VertexCacheStatistics before;
+		VertexCacheStatistics after;
+	};
+
+	VertexCacheStatistics AnalyzeVertexCache(
+		  const std::vector<unsigned>& indices
+		, size_t                       numVertices
+		, unsigned                     cacheSize = DEFAULT_CACHE_SIZE
+	);
+
+	// Returns the reordered indices. @pOutClusters receives the index of the first triangle of each
+	// cluster, where a cluster ends whenever Tipsify can't continue from the vertices in the cache.
+	std::vector<unsigned> OptimizeVertexCache(
+		  const std::vector<unsigned>& indices
+		, size_t                       numVertices
+		, unsigned                     cacheSize = DEFAULT_CACHE_SIZE
+		, std::vector<unsigned>*       pOutClusters = nullptr
+	);
+
+	// Sorts the @clusters of the vertex cache optimized @indices for reduced overdraw. Clusters are
+	// split further as long as the ACMR of the resulting pieces stays within @threshold of the cluster.
+	std::vector<unsigned> OptimizeOverdraw(
+		  const std::vector<DefaultVertexBufferData>& vertices
+		, const std::vector<unsigned>&                indices
+		, const std::vector<unsigned>&                clusters
+		, unsigned                                    cacheSize = DEFAULT_CACHE_SIZE
+		, float                                       threshold = DEFAULT_OVERDRAW_THRESHOLD
+	);
+
+	// Reorders @vertices by their first reference in @indices and remaps @indices accordingly.
+	void OptimizeVertexFetch(std::vector<DefaultVertexBufferData>& vertices, std::vector<unsigned>& indices);
+
+	// Runs the vertex cache, (optionally) overdraw and vertex fetch optimizations on each LOD level.
+	// The returned statistics are the sums over the LOD levels.
+	Report Optimize(MeshLODData<DefaultVertexBufferData>& meshLODData, bool bOptimizeOverdraw);
+};
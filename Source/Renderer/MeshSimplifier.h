@@ -0,0 +1,63 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include "Engine/Mesh.h"
+#include "RenderingStructs.h"
+
+#include <vector>
+
+// Mesh Simplifier
+//
+// Generates LOD chains for indexed triangle meshes with quadric error metric edge collapses
+// (Garland & Heckbert 1997). A vertex is collapsed onto one of its neighbors, i.e. the simplified 
+// meshes reuse the vertices of the source mesh and don't need new vertex attributes.
+//
+//  - Seams   : vertices sharing a position with differently attributed (UV/normal) vertices are
+//              never collapsed, so the UV/normal seams of the source mesh are preserved.
+//  - Borders : vertices on open or non-manifold edges are never collapsed, so the simplified 
+//              mesh keeps its silhouette along the open edges.
+//  - Error   : collapse cost is the area-weighted mean squared distance to the planes of the 
+//              triangles merged into the collapsed vertices. The reported error is the square root
+//              of the largest collapse cost, in the units of the vertex positions. It's an estimate 
+//              of the surface deviation for LOD selection rather than a strict (Hausdorff) bound.
+//
+namespace MeshSimplifier
+{
+	// Collapses edges until the triangle count is at or below @targetTriangleCount, or until no 
+	// edge can be collapsed below @maxError. Returns the indices of the simplified mesh, referencing
+	// @vertices. @pOutError receives the error of the simplified mesh if provided.
+	std::vector<unsigned> Simplify(
+		  const std::vector<DefaultVertexBufferData>& vertices
+		, const std::vector<unsigned>&                indices
+		, size_t                                      targetTriangleCount
+		, float                                       maxError
+		, float*                                      pOutError = nullptr
+	);
+
+	// Returns an LOD chain where LOD[0] is the source mesh and LOD[i] has triangleRatios[i-1] of its
+	// triangles. Each level is simplified from the previous one and its vertex buffer only contains 
+	// the vertices it references. The chain stops early if a level can't be simplified any further.
+	// LODErrors of the chain are relative to the bounding sphere radius of the source mesh.
+	MeshLODData<DefaultVertexBufferData> GenerateLODChain(
+		  const std::vector<DefaultVertexBufferData>& vertices
+		, const std::vector<unsigned>&                indices
+		, const std::vector<float>&                   triangleRatios
+		, const char*                                 pMeshName
+	);
+};
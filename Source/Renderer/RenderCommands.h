@@ -101,4 +101,58 @@ struct DrawQuadOnScreenCommand
 	TextureID texture;
 	bool bIsDepthTexture;
 	int numChannels = 3;
-};
\ No newline at end of file
+};
+
+// The null Renderer backend (Renderer::InitializeNullBackend()) doesn't talk to a device: the
+// draw & state calls that would have been made are recorded into a CommandLog instead, which 
+// is cleared in Renderer::BeginFrame(). The state changes are recorded with the same 
+// redundancy checks as the device calls in Renderer::Apply().
+//
+enum ERecordedCommand
+{
+	// state changes
+	CMD_SET_SHADER = 0,
+	CMD_SET_VERTEX_BUFFER,
+	CMD_SET_INDEX_BUFFER,
+	CMD_SET_TOPOLOGY,
+	CMD_SET_VIEWPORT,
+	CMD_SET_RASTERIZER_STATE,
+	CMD_SET_BLEND_STATE,
+	CMD_SET_DEPTH_STENCIL_STATE,
+	CMD_SET_RENDER_TARGETS,
+	CMD_SET_TEXTURE,
+	CMD_SET_SAMPLER,
+
+	// CPU side writes
+	CMD_SET_CONSTANT,
+	CMD_UPDATE_BUFFER,
+
+	// work
+	CMD_CLEAR,
+	CMD_DRAW,
+	CMD_DRAW_INDEXED,
+	CMD_DRAW_INDEXED_INSTANCED,
+	CMD_DISPATCH,
+
+	RECORDED_COMMAND_COUNT
+};
+
+struct RecordedCommand
+{
+	ERecordedCommand type;
+	int arg;	// resource/state ID, vertex/index/instance count, ...
+};
+
+struct CommandLog
+{
+	static const char* GetCommandName(ERecordedCommand type);
+
+	inline void Record(ERecordedCommand type, int arg = 0) { commands.push_back({ type, arg }); ++counts[type]; }
+	void Clear();	// keeps the memory of the command list
+
+	int GetNumDrawCalls() const;	// draws & dispatches
+	int GetNumStateChanges() const;
+
+	std::vector<RecordedCommand> commands;
+	std::array<int, RECORDED_COMMAND_COUNT> counts = {};
+};
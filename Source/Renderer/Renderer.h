@@ -34,6 +34,7 @@
 #include <stack>
 #include <queue>
 #include <mutex>
+#include <atomic>
 
 class BufferObject;
 class Camera;
@@ -57,6 +58,12 @@ public:
 	//----------------------------------------------------------------------------------------------------------------
 	bool					Initialize(HWND hwnd, const Settings::Window& settings, const Settings::Rendering& rendererSettings);
 	void					Exit();
+
+	// Initializes the renderer w/o a window or a device: resources are only given IDs (buffers keep 
+	// a CPU copy of their data), shaders aren't compiled and the draw & state calls are recorded 
+	// into the CommandLog. Used for running the CPU side of the frames headless.
+	bool					InitializeNullBackend(const Settings::Window& settings, const Settings::Rendering& rendererSettings);
+	inline bool				IsNullBackend() const { return mbNullBackend; }
 	void					ReloadShaders();
 
 	//----------------------------------------------------------------------------------------------------------------
@@ -77,7 +84,9 @@ public:
 	inline TextureID		GetDepthTargetTexture(DepthTargetID DT) const { return mDepthTargets[DT].texture._id; }
 	const PipelineState&	GetPipelineState() const;
 	inline const RendererStats&	GetRenderStats() const { return mRenderStats; }
+	inline const CommandLog&	GetCommandLog() const { return mCommandLog; }	// null backend only
 	const BufferDesc		GetBufferDesc(EBufferType bufferType, BufferID bufferID) const;
+	BufferMemoryUsage		GetBufferMemoryUsage(EBufferType bufferType) const; // of the buffers created so far
 
 	const Shader*			GetShader(ShaderID shader_id) const;
 	const Texture&			GetTextureObject(TextureID) const;
@@ -161,12 +170,19 @@ public:
 	void					UnbindRenderTargets();
 	void					UnbindDepthTarget();
 
-	void					SetConstant4x4f(const char* cName, const XMMATRIX& matrix);
-	inline void				SetConstant3f(const char* cName, const vec3& float3)	{ SetConstant(cName, static_cast<const void*>(&float3.x())); }
-	inline void				SetConstant2f(const char* cName, const vec2& float2)	{ SetConstant(cName, static_cast<const void*>(&float2.x())); }
-	inline void				SetConstant1f(const char* cName, const float& data)		{ SetConstant(cName, static_cast<const void*>(&data)); }
-	inline void				SetConstant1i(const char* cName, const int& data)		{ SetConstant(cName, static_cast<const void*>(&data)); }
-	inline void				SetConstantStruct(const char * cName, const void* data) { SetConstant(cName, data); }
+	// constant names are hashed at compile time (see ConstantName) and looked up in the bound shader's hash table.
+	void					SetConstant4x4f(const ConstantName& cName, const XMMATRIX& matrix);
+	inline void				SetConstant3f(const ConstantName& cName, const vec3& float3)	{ SetConstant(cName, static_cast<const void*>(&float3.x())); }
+	inline void				SetConstant2f(const ConstantName& cName, const vec2& float2)	{ SetConstant(cName, static_cast<const void*>(&float2.x())); }
+	inline void				SetConstant1f(const ConstantName& cName, const float& data)		{ SetConstant(cName, static_cast<const void*>(&data)); }
+	inline void				SetConstant1i(const ConstantName& cName, const int& data)		{ SetConstant(cName, static_cast<const void*>(&data)); }
+	inline void				SetConstantStruct(const ConstantName& cName, const void* data) { SetConstant(cName, data); }
+
+	// precompiled constant handles: resolve once after the shader is loaded/reloaded, then
+	// set the constant w/o any lookup. The handle's shader has to be the bound shader.
+	ConstantHandle			GetConstantHandle(ShaderID shaderID, const ConstantName& cName) const;
+	void					SetConstant4x4f(ConstantHandle hConstant, const XMMATRIX& matrix);
+	void					SetConstant(ConstantHandle hConstant, const void* data);
 
 	void					BeginRender(const ClearCommand& clearCmd);	// clears the bound render targets
 
@@ -197,8 +213,9 @@ public:
 
 
 private:
-	void					SetConstant(const char* cName, const void* data);
+	void					SetConstant(const ConstantName& cName, const void* data);
 	void					SetTexture_(const char* texName, TextureID tex, unsigned slice = 0 /* only for texture arrays */ );
+	TextureID				RegisterTexture(Texture& tex);	// reuses the Release()d texture slots
 
 public:
 	//----------------------------------------------------------------------------------------------------------------
@@ -218,6 +235,7 @@ public:
 	D3DManager*						m_Direct3D;
 
 	Settings::Rendering::AntiAliasing mAntiAliasing;
+	bool							mbNullBackend = false;
 
 	static bool						sEnableBlend; //temp
 
@@ -256,6 +274,12 @@ private:
 	// PERFORMANCE COUNTERS
 	//
 	RendererStats					mRenderStats;
+	CommandLog						mCommandLog;
+
+	// VERTEX_BUFFER, INDEX_BUFFER, COMPUTE_RW_BUFFER
+	static constexpr size_t			NUM_BUFFER_CATEGORIES = 3;
+	std::atomic<size_t>				mBufferGPUBytes[NUM_BUFFER_CATEGORIES] = {};
+	std::atomic<size_t>				mBufferCPUBytes[NUM_BUFFER_CATEGORIES] = {};
 
 	// WINDOW SETTINGS
 	//
@@ -262,6 +262,23 @@ enum EBufferType : unsigned
 	BUFFER_TYPE_COUNT
 };
 
+enum EIndexFormat
+{
+	INDEX_FORMAT_UINT16 = DXGI_FORMAT_R16_UINT,
+	INDEX_FORMAT_UINT32 = DXGI_FORMAT_R32_UINT,
+};
+
+// What happens to the initial data of a buffer once it's uploaded to the GPU.
+// Dynamic (GPU_READ_CPU_WRITE) buffers are rewritten by Buffer::Update() and always discard it.
+enum ECPUDataResidency
+{
+	DISCARD_CPU_DATA = 0,		// nothing is kept on the CPU side
+	KEEP_CPU_DATA,				// Buffer::mpCPUData holds a copy of the data
+	KEEP_COMPRESSED_CPU_DATA,	// Buffer holds a compressed copy, read with Buffer::ReadCPUData()
+
+	CPU_DATA_RESIDENCY_COUNT
+};
+
 enum EMaterialType
 {
 	GGX_BRDF = 0,
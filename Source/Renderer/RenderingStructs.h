@@ -81,12 +81,21 @@ struct BufferDesc
 	unsigned     mElementCount = 0;
 	unsigned     mStride = 0;
 	unsigned     mStructureByteStride = 0;
+	ECPUDataResidency mCPUDataResidency = DISCARD_CPU_DATA;
+	EIndexFormat mIndexFormat = INDEX_FORMAT_UINT32;	// INDEX_BUFFER only, has to match mStride
+};
+
+struct BufferMemoryUsage
+{
+	size_t GPUBytes = 0;
+	size_t CPUBytes = 0;	// resident CPU copies of the buffer data
 };
 
 struct Buffer
 {
 	bool			mDirty = true;
-	void*			mpCPUData = nullptr;
+	void*			mpCPUData = nullptr;		// KEEP_CPU_DATA
+	std::vector<char> mCompressedCPUData;		// KEEP_COMPRESSED_CPU_DATA
 	ID3D11Buffer*	mpGPUData = nullptr;
 
 	bool			bInitialized = false;
@@ -97,6 +106,13 @@ struct Buffer
 	void CleanUp();
 	void Update(Renderer* pRenderer, const void* pData);
 
+	inline size_t GetSizeInBytes() const { return size_t(mDesc.mStride) * mDesc.mElementCount; }
+	size_t GetCPUDataSizeInBytes() const;	// resident, i.e. compressed size for KEEP_COMPRESSED_CPU_DATA
+
+	// copies the initial data of the buffer into @pDst (GetSizeInBytes() bytes).
+	// returns false if the CPU data was discarded after the upload.
+	bool ReadCPUData(void* pDst) const;
+
 	Buffer(const BufferDesc& desc);
 };
 
@@ -114,6 +130,22 @@ struct DefaultVertexBufferData
 	vec2 uv;
 };
 
+// Compact version of DefaultVertexBufferData: 24 bytes instead of 44. The position is kept at
+// full precision, normal & tangent are octahedral encoded into 2x16-bit SNORM and the UVs are
+// stored as half floats. Meshes convert their vertices when PACKED_VERTEX_FORMAT is enabled and
+// the vertex shaders decode them with the helpers in VertexFormat.hlsl.
+#define PACKED_VERTEX_FORMAT 0
+struct PackedVertexBufferData
+{
+	vec3     position;
+	uint32_t normal;
+	uint32_t tangent;
+	uint32_t uv;
+
+	PackedVertexBufferData() = default;
+	PackedVertexBufferData(const DefaultVertexBufferData& vertex);
+};
+
 #if 0	// TODO: abstract render target descriptor
 struct RenderTargetDesc
 {
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "RenderingEnums.h"
+#include "Utilities/utils.h"
 
 #include <d3dcompiler.h>
 
@@ -34,6 +35,7 @@
 using CPUConstantID = int;
 using GPU_ConstantBufferSlotIndex = int;
 using ConstantBufferMapping = std::pair<GPU_ConstantBufferSlotIndex, CPUConstantID>;
+using ConstantNameHash = unsigned;
 using FileTimeStamp = std::experimental::filesystem::file_time_type;
 
 //----------------------------------------------------------------------------------------------------------------
@@ -55,6 +57,31 @@ private:
 	inline bool operator==(const CPUConstant& c) const { return (((this->_data == c._data) && this->_size == c._size) && this->_name == c._name); }
 	inline bool operator!=(const CPUConstant& c) const { return ((this->_data != c._data) || this->_size != c._size || this->_name != c._name); }
 };
+
+// Name of a shader constant together with its hash. The Renderer::SetConstant*() 
+// functions take this type, so the string literals at their call sites are hashed
+// at compile time through the constexpr constructor.
+//
+struct ConstantName
+{
+	template<size_t N>
+	constexpr ConstantName(const char(&str)[N]) : name(str), hash(StrUtil::Hash32(str)) {}
+	explicit  ConstantName(const char* str)     : name(str), hash(StrUtil::Hash32(str)) {}
+
+	const char*      name;
+	ConstantNameHash hash;
+};
+
+// A shader constant resolved with Shader::GetConstantHandle(). Writing through the handle 
+// doesn't require any lookup. Handles have to be resolved again after a shader reload.
+//
+struct ConstantHandle
+{
+	ShaderID shaderID = -1;
+	int      index = -1;	// Shader::mConstantHandles index
+	inline bool IsValid() const { return index != -1; }
+};
+
 struct ConstantBufferBinding
 {	
 	EShaderStage  shaderStage;
@@ -163,6 +190,7 @@ public:
 		D3D11_SHADER_BUFFER_DESC					desc;
 		std::vector<D3D11_SHADER_VARIABLE_DESC>		variables;
 		std::vector<D3D11_SHADER_TYPE_DESC>			types;
+		std::vector<ConstantNameHash>				variableNameHashes;
 		unsigned									buffSize;
 		EShaderStage								stage;
 		unsigned									bufSlot;
@@ -196,6 +224,7 @@ public:
 	inline ShaderID    ID()   const { return mID; }
 	
 	const std::vector<ConstantBufferLayout>& GetConstantBufferLayouts() const;
+	ConstantHandle GetConstantHandle(const ConstantName& constantName) const;
 	const std::vector<ConstantBufferBinding      >& GetConstantBuffers() const;
 	
 	const TextureBinding& GetTextureBinding(const std::string& textureName) const;
@@ -259,6 +288,17 @@ private:
 	std::vector<ConstantBufferMapping> m_constants;// currently redundant
 	std::vector<CPUConstant> mCPUConstantBuffers;
 
+	// A constant name can appear in multiple cbuffers (e.g. in VS & PS): each handle 
+	// references a contiguous range of mConstantHandleMappings, which are written together.
+	struct ConstantHandleData
+	{
+		int firstMapping;
+		int numMappings;
+	};
+	std::vector<ConstantHandleData>                  mConstantHandles;
+	std::vector<ConstantBufferMapping>               mConstantHandleMappings;
+	std::unordered_map<ConstantNameHash, int>        mConstantHandleLookup;	// name hash -> mConstantHandles index
+
 	std::vector<TextureBinding> mTextureBindings;
 	std::vector<SamplerBinding> mSamplerBindings;
 	
@@ -20,6 +20,20 @@
 #include "Renderer.h"
 
 #include "Utilities/Log.h"
+#include "Utilities/Compression.h"
+
+#include <DirectXPackedVector.h>
+#include <cassert>
+#include <cmath>
+
+// size of the values the buffer data is made of, for the byte shuffling of the compressor:
+// 16 or 32-bit indices, 4-byte floats & packed attributes for the vertex data.
+static size_t GetCompressionWordSize(const BufferDesc& desc)
+{
+	if (desc.mType == INDEX_BUFFER)
+		return desc.mStride;
+	return desc.mStride % sizeof(float) == 0 ? sizeof(float) : 1;
+}
 
 Buffer::Buffer(const BufferDesc& desc)
 	: mDesc(desc)
@@ -48,14 +62,34 @@ void Buffer::Initialize(ID3D11Device* device, const void* pData /*=nullptr*/)
 		bufData.SysMemSlicePitch = 0;	// irrelevant for non-texture sub-resources
 		pBufData = &bufData;
 
-		mpCPUData = malloc(bufDesc.ByteWidth);
-		memcpy(mpCPUData, pData, bufDesc.ByteWidth);
+		// dynamic buffers are overwritten by Update(), a copy of their initial data would go stale
+		const bool bDynamic = mDesc.mUsage == GPU_READ_CPU_WRITE;
+		assert(!bDynamic || mDesc.mCPUDataResidency == DISCARD_CPU_DATA);
+
+		switch (bDynamic ? DISCARD_CPU_DATA : mDesc.mCPUDataResidency)
+		{
+		case KEEP_CPU_DATA:
+			mpCPUData = malloc(bufDesc.ByteWidth);
+			memcpy(mpCPUData, pData, bufDesc.ByteWidth);
+			break;
+		case KEEP_COMPRESSED_CPU_DATA:
+			mCompressedCPUData = Compression::Compress(pData, bufDesc.ByteWidth, GetCompressionWordSize(mDesc));
+			break;
+		case DISCARD_CPU_DATA:
+		default:
+			break;
+		}
 	}
 	else
 	{
 		int a = 5;
 	}
 
+	if (!device)
+	{	// null renderer backend: only the descriptor and the requested CPU copies are kept
+		return;
+	}
+
 	int hr = device->CreateBuffer(&bufDesc, pBufData, &this->mpGPUData);
 	if (FAILED(hr))
 	{
@@ -91,13 +125,42 @@ void Buffer::CleanUp()
 	if (mpCPUData)
 	{
 		free(mpCPUData);
+		mpCPUData = nullptr;
 		//const size_t AllocSize = mDesc.mStride * mDesc.mElementCount;
 		//mAllocator.deallocate(static_cast<char*>(mCPUDataCache), AllocSize);
 	}
+	mCompressedCPUData.clear();
+	mCompressedCPUData.shrink_to_fit();
+}
+
+size_t Buffer::GetCPUDataSizeInBytes() const
+{
+	return mpCPUData ? GetSizeInBytes() : mCompressedCPUData.size();
+}
+
+bool Buffer::ReadCPUData(void* pDst) const
+{
+	if (mpCPUData)
+	{
+		memcpy(pDst, mpCPUData, GetSizeInBytes());
+		return true;
+	}
+	if (!mCompressedCPUData.empty())
+	{
+		return Compression::Decompress(mCompressedCPUData, pDst, GetSizeInBytes());
+	}
+	return false;
 }
 
 void Buffer::Update(Renderer* pRenderer, const void* pData)
 {
+	// only dynamic buffers can be mapped for writing and they don't keep CPU copies (see Initialize())
+	assert(mDesc.mUsage == GPU_READ_CPU_WRITE);
+	assert(!mpCPUData && mCompressedCPUData.empty());
+	if (!mpGPUData)
+	{	// null renderer backend
+		return;
+	}
 	auto* ctx = pRenderer->m_deviceContext;
 
 	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
@@ -108,4 +171,38 @@ void Buffer::Update(Renderer* pRenderer, const void* pData)
 	ctx->Map(mpGPUData, Subresource, D3D11_MAP_WRITE_DISCARD, MapFlags, &mappedResource);
 	memcpy(mappedResource.pData, pData, Size);
 	ctx->Unmap(mpGPUData, Subresource);
-}
\ No newline at end of file
+}
+
+// octahedral mapping of a unit vector stored as 2x16-bit SNORM (x in the low bits).
+// the decoder is OctahedralDecode() in VertexFormat.hlsl.
+static uint32_t PackOctahedral(const vec3& v)
+{
+	const float L1 = std::abs(v.x()) + std::abs(v.y()) + std::abs(v.z());
+	if (L1 == 0.0f)
+		return 0;
+
+	float x = v.x() / L1;
+	float y = v.y() / L1;
+	if (v.z() < 0.0f)	// fold the lower hemisphere over the diagonals
+	{
+		const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		const float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	auto fnToSNORM16 = [](float f) -> uint32_t
+	{
+		const float clamped = (std::max)(-1.0f, (std::min)(1.0f, f));
+		return static_cast<uint16_t>(static_cast<int16_t>(std::round(clamped * 32767.0f)));
+	};
+	return fnToSNORM16(x) | (fnToSNORM16(y) << 16);
+}
+
+PackedVertexBufferData::PackedVertexBufferData(const DefaultVertexBufferData& vertex)
+	: position(vertex.position)
+	, normal(PackOctahedral(vertex.normal))
+	, tangent(PackOctahedral(vertex.tangent))
+	, uv( static_cast<uint32_t>(DirectX::PackedVector::XMConvertFloatToHalf(vertex.uv.x()))
+		| static_cast<uint32_t>(DirectX::PackedVector::XMConvertFloatToHalf(vertex.uv.y())) << 16)
+{}
@@ -18,6 +18,7 @@
 
 #include "GeometryGenerator.h"
 #include "Renderer.h"
+#include "MeshOptimizer.h"
 
 #include "Utilities/Log.h"
 
@@ -382,6 +383,13 @@ Mesh GeometryGenerator::Cube()
 
 
 Mesh GeometryGenerator::Sphere(float radius, unsigned ringCount, unsigned sliceCount, int numLODLevels /*= 1*/)
+{
+	MeshLODData<DefaultVertexBufferData> meshData = SphereData(radius, ringCount, sliceCount, numLODLevels);
+	OptimizeBuiltinMesh(meshData);
+	return Mesh(meshData);
+}
+
+MeshLODData<DefaultVertexBufferData> GeometryGenerator::SphereData(float radius, unsigned ringCount, unsigned sliceCount, int numLODLevels /*= 1*/)
 {
 	// Vertex & Index buffer per LOD level
 	MeshLODData< DefaultVertexBufferData> meshData(numLODLevels, "BuiltinSphere");
@@ -497,10 +505,17 @@ Mesh GeometryGenerator::Sphere(float radius, unsigned ringCount, unsigned sliceC
 	}
 	//------------------------------------------------
 
-	return Mesh(meshData);
+	return meshData;
 }
 
 Mesh GeometryGenerator::Grid(float width, float depth, unsigned horizontalTessellation, unsigned verticalTessellation, int numLODLevels /*= 1*/)
+{
+	MeshLODData<DefaultVertexBufferData> meshData = GridData(width, depth, horizontalTessellation, verticalTessellation, numLODLevels);
+	OptimizeBuiltinMesh(meshData);
+	return Mesh(meshData);
+}
+
+MeshLODData<DefaultVertexBufferData> GeometryGenerator::GridData(float width, float depth, unsigned horizontalTessellation, unsigned verticalTessellation, int numLODLevels /*= 1*/)
 {
 	MeshLODData< DefaultVertexBufferData> meshData(numLODLevels, "BuiltinGrid");
 
@@ -634,10 +649,17 @@ Mesh GeometryGenerator::Grid(float width, float depth, unsigned horizontalTessel
 		CalculateTangentsAndBitangents(Vertices, Indices);
 	}
 
-	return Mesh(meshData);
+	return meshData;
 }
 
 Mesh GeometryGenerator::Cylinder(float height, float topRadius, float bottomRadius, unsigned numSlices, unsigned numStacks, int numLODLevels /*= 1*/)
+{
+	MeshLODData<DefaultVertexBufferData> meshData = CylinderData(height, topRadius, bottomRadius, numSlices, numStacks, numLODLevels);
+	OptimizeBuiltinMesh(meshData);
+	return Mesh(meshData);
+}
+
+MeshLODData<DefaultVertexBufferData> GeometryGenerator::CylinderData(float height, float topRadius, float bottomRadius, unsigned numSlices, unsigned numStacks, int numLODLevels /*= 1*/)
 {
 	MeshLODData< DefaultVertexBufferData> meshData(numLODLevels, "BuiltinCylinder");
 
@@ -840,10 +862,17 @@ Mesh GeometryGenerator::Cylinder(float height, float topRadius, float bottomRadi
 	}
 	//------------------------------------------------
 
-	return Mesh(meshData);
+	return meshData;
 }
 
 Mesh GeometryGenerator::Cone(float height, float radius, unsigned numSlices, int numLODLevels /*= 1*/)
+{
+	MeshLODData<DefaultVertexBufferData> meshData = ConeData(height, radius, numSlices, numLODLevels);
+	OptimizeBuiltinMesh(meshData);
+	return Mesh(meshData);
+}
+
+MeshLODData<DefaultVertexBufferData> GeometryGenerator::ConeData(float height, float radius, unsigned numSlices, int numLODLevels /*= 1*/)
 {
 	MeshLODData< DefaultVertexBufferData> meshData(numLODLevels, "BuiltinCone");
 
@@ -1016,7 +1045,14 @@ Mesh GeometryGenerator::Cone(float height, float radius, unsigned numSlices, int
 		}
 	}
 
-	return Mesh(meshData);
+	return meshData;
+}
+
+// The LOD levels of the built-in meshes are closed convex shapes or flat grids: none of their triangles can
+// occlude another triangle of the same mesh, so the overdraw sort would only cost vertex cache efficiency.
+MeshOptimizer::Report GeometryGenerator::OptimizeBuiltinMesh(MeshLODData<DefaultVertexBufferData>& meshData)
+{
+	return MeshOptimizer::Optimize(meshData, false);
 }
 
 bool GeometryGenerator::Is2DGeometry(EGeometry meshID)
@@ -0,0 +1,363 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	constexpr unsigned INVALID_INDEX = 0xFFFFFFFF;
+
+	struct Vec3d { double x, y, z; };
+	inline Vec3d ToVec3d(const vec3& v) { return { v.x(), v.y(), v.z() }; }
+	inline Vec3d Add(const Vec3d& a, const Vec3d& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Vec3d Sub(const Vec3d& a, const Vec3d& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Vec3d Scale(const Vec3d& a, double s) { return { a.x * s, a.y * s, a.z * s }; }
+	inline Vec3d Cross(const Vec3d& a, const Vec3d& b) { return { a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x }; }
+	inline double Dot(const Vec3d& a, const Vec3d& b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+	// FIFO post-transform cache: a vertex is in the cache if fewer than @cacheSize vertices were 
+	// transformed since it was. Flush() evicts everything without touching the per-vertex state.
+	class FIFOCacheSimulator
+	{
+	public:
+		FIFOCacheSimulator(size_t numVertices, unsigned cacheSize)
+			: mInsertionTimes(numVertices, 0)
+			, mCacheSize(cacheSize)
+			, mTime(cacheSize + 1)
+		{}
+
+		// returns the number of vertices transformed for the triangle
+		inline unsigned ProcessTriangle(const unsigned* pTriangle)
+		{
+			unsigned numTransformed = 0;
+			for (int i = 0; i < 3; ++i)
+			{
+				const unsigned v = pTriangle[i];
+				if (mTime - mInsertionTimes[v] > mCacheSize)
+				{
+					mInsertionTimes[v] = mTime++;
+					++numTransformed;
+				}
+			}
+			return numTransformed;
+		}
+		inline void Flush() { mTime += mCacheSize + 1; }
+
+	private:
+		std::vector<size_t> mInsertionTimes;
+		size_t mCacheSize;
+		size_t mTime;
+	};
+
+	// ACMR of the triangles [firstTriangle, lastTriangle) starting with an empty cache
+	float CalculateACMR(FIFOCacheSimulator& cache, const std::vector<unsigned>& indices, size_t firstTriangle, size_t lastTriangle)
+	{
+		cache.Flush();
+		size_t numTransformed = 0;
+		for (size_t triangle = firstTriangle; triangle < lastTriangle; ++triangle)
+			numTransformed += cache.ProcessTriangle(&indices[triangle * 3]);
+		return lastTriangle > firstTriangle ? float(numTransformed) / (lastTriangle - firstTriangle) : 0.0f;
+	}
+}
+
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(
+	  const std::vector<unsigned>& indices
+	, size_t                       numVertices
+	, unsigned                     cacheSize /*= DEFAULT_CACHE_SIZE*/
+)
+{
+	VertexCacheStatistics stats;
+	stats.numTriangles = indices.size() / 3;
+
+	FIFOCacheSimulator cache(numVertices, cacheSize);
+	for (size_t triangle = 0; triangle < stats.numTriangles; ++triangle)
+		stats.numTransformedVertices += cache.ProcessTriangle(&indices[triangle * 3]);
+
+	std::vector<bool> bReferenced(numVertices, false);
+	for (unsigned v : indices)
+	{
+		stats.numVertices += bReferenced[v] ? 0 : 1;
+		bReferenced[v] = true;
+	}
+	return stats;
+}
+
+
+std::vector<unsigned> MeshOptimizer::OptimizeVertexCache(
+	  const std::vector<unsigned>& indices
+	, size_t                       numVertices
+	, unsigned                     cacheSize /*= DEFAULT_CACHE_SIZE*/
+	, std::vector<unsigned>*       pOutClusters /*= nullptr*/
+)
+{
+	const size_t numTriangles = indices.size() / 3;
+	std::vector<unsigned> result;
+	result.reserve(numTriangles * 3);
+	if (pOutClusters)
+		pOutClusters->clear();
+	if (numTriangles == 0)
+		return result;
+
+	// vertex -> triangle adjacency
+	std::vector<unsigned> liveTriangleCounts(numVertices, 0);
+	for (size_t i = 0; i < numTriangles * 3; ++i)
+		++liveTriangleCounts[indices[i]];
+
+	std::vector<unsigned> adjacencyOffsets(numVertices + 1, 0);
+	for (size_t v = 0; v < numVertices; ++v)
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangleCounts[v];
+
+	std::vector<unsigned> adjacency(numTriangles * 3);
+	{
+		std::vector<unsigned> writeOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < numTriangles * 3; ++i)
+			adjacency[writeOffsets[indices[i]]++] = static_cast<unsigned>(i / 3);
+	}
+
+	std::vector<size_t> cacheTimestamps(numVertices, 0);
+	std::vector<bool> bEmitted(numTriangles, false);
+	std::vector<unsigned> deadEndStack;
+	std::vector<unsigned> candidates;
+	size_t timestamp = cacheSize + 1;
+	size_t vertexCursor = 0;
+
+	// continues from the most recently used vertex with live triangles, or from the next one in the 
+	// input order if there are none left on the dead-end stack.
+	auto fnSkipDeadEnd = [&]() -> unsigned
+	{
+		while (!deadEndStack.empty())
+		{
+			const unsigned v = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveTriangleCounts[v] > 0)
+				return v;
+		}
+		for (; vertexCursor < numVertices; ++vertexCursor)
+		{
+			if (liveTriangleCounts[vertexCursor] > 0)
+				return static_cast<unsigned>(vertexCursor);
+		}
+		return INVALID_INDEX;
+	};
+
+	// picks the candidate that was transformed the longest time ago among the ones that will still be
+	// in the cache once their remaining triangles are emitted. Other candidates with live triangles 
+	// are only used if there's no such vertex.
+	auto fnGetNextVertex = [&]() -> unsigned
+	{
+		unsigned bestVertex = INVALID_INDEX;
+		long long bestPriority = -1;
+		for (unsigned v : candidates)
+		{
+			if (liveTriangleCounts[v] == 0)
+				continue;
+
+			long long priority = 0;
+			const size_t age = timestamp - cacheTimestamps[v];
+			if (age + 2 * liveTriangleCounts[v] <= cacheSize)
+				priority = static_cast<long long>(age);
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				bestVertex = v;
+			}
+		}
+		return bestVertex;
+	};
+
+	if (pOutClusters)
+		pOutClusters->push_back(0);
+
+	unsigned fanningVertex = fnSkipDeadEnd();
+	while (fanningVertex != INVALID_INDEX)
+	{
+		// emit the remaining triangles around the fanning vertex
+		candidates.clear();
+		for (unsigned i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; ++i)
+		{
+			const unsigned triangle = adjacency[i];
+			if (bEmitted[triangle])
+				continue;
+
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				const unsigned v = indices[triangle * 3 + corner];
+				result.push_back(v);
+				deadEndStack.push_back(v);
+				candidates.push_back(v);
+				--liveTriangleCounts[v];
+				if (timestamp - cacheTimestamps[v] > cacheSize)
+					cacheTimestamps[v] = timestamp++;
+			}
+			bEmitted[triangle] = true;
+		}
+
+		fanningVertex = fnGetNextVertex();
+		if (fanningVertex == INVALID_INDEX)
+		{
+			// dead end: the next fan doesn't share vertices with the cache contents
+			fanningVertex = fnSkipDeadEnd();
+			if (fanningVertex != INVALID_INDEX && pOutClusters)
+				pOutClusters->push_back(static_cast<unsigned>(result.size() / 3));
+		}
+	}
+
+	assert(result.size() == numTriangles * 3);
+	return result;
+}
+
+
+std::vector<unsigned> MeshOptimizer::OptimizeOverdraw(
+	  const std::vector<DefaultVertexBufferData>& vertices
+	, const std::vector<unsigned>&                indices
+	, const std::vector<unsigned>&                clusters
+	, unsigned                                    cacheSize /*= DEFAULT_CACHE_SIZE*/
+	, float                                       threshold /*= DEFAULT_OVERDRAW_THRESHOLD*/
+)
+{
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0 || clusters.empty())
+		return indices;
+
+	// split the clusters into smaller pieces: a piece ends as soon as it has amortized the cost of
+	// starting with a cold cache, i.e. when its ACMR is within @threshold of the ACMR of its cluster.
+	FIFOCacheSimulator cache(vertices.size(), cacheSize);
+	std::vector<unsigned> pieces;
+	for (size_t cluster = 0; cluster < clusters.size(); ++cluster)
+	{
+		const size_t clusterBegin = clusters[cluster];
+		const size_t clusterEnd = cluster + 1 < clusters.size() ? clusters[cluster + 1] : numTriangles;
+		const float clusterACMR = CalculateACMR(cache, indices, clusterBegin, clusterEnd);
+
+		pieces.push_back(static_cast<unsigned>(clusterBegin));
+		cache.Flush();
+		size_t pieceBegin = clusterBegin;
+		size_t numTransformed = 0;
+		for (size_t triangle = clusterBegin; triangle + 1 < clusterEnd; ++triangle)
+		{
+			numTransformed += cache.ProcessTriangle(&indices[triangle * 3]);
+			if (numTransformed <= threshold * clusterACMR * (triangle + 1 - pieceBegin))
+			{
+				pieceBegin = triangle + 1;
+				pieces.push_back(static_cast<unsigned>(pieceBegin));
+				numTransformed = 0;
+				cache.Flush();
+			}
+		}
+	}
+
+	// area weighted centroids & normals of the pieces and of the whole mesh
+	const size_t numPieces = pieces.size();
+	std::vector<Vec3d> pieceCentroids(numPieces, Vec3d{ 0, 0, 0 });
+	std::vector<Vec3d> pieceNormals(numPieces, Vec3d{ 0, 0, 0 });
+	Vec3d meshCentroid = { 0, 0, 0 };
+	double meshArea = 0.0;
+	for (size_t piece = 0; piece < numPieces; ++piece)
+	{
+		const size_t pieceEnd = piece + 1 < numPieces ? pieces[piece + 1] : numTriangles;
+		double pieceArea = 0.0;
+		for (size_t triangle = pieces[piece]; triangle < pieceEnd; ++triangle)
+		{
+			const Vec3d p0 = ToVec3d(vertices[indices[triangle * 3 + 0]].position);
+			const Vec3d p1 = ToVec3d(vertices[indices[triangle * 3 + 1]].position);
+			const Vec3d p2 = ToVec3d(vertices[indices[triangle * 3 + 2]].position);
+			const Vec3d normal = Cross(Sub(p1, p0), Sub(p2, p0));	// length is twice the area
+			const double area = 0.5 * std::sqrt(Dot(normal, normal));
+			const Vec3d centroid = Scale(Add(Add(p0, p1), p2), 1.0 / 3.0);
+
+			pieceCentroids[piece] = Add(pieceCentroids[piece], Scale(centroid, area));
+			pieceNormals[piece] = Add(pieceNormals[piece], normal);
+			pieceArea += area;
+		}
+		meshCentroid = Add(meshCentroid, pieceCentroids[piece]);
+		meshArea += pieceArea;
+		if (pieceArea > 0.0)
+			pieceCentroids[piece] = Scale(pieceCentroids[piece], 1.0 / pieceArea);
+	}
+	if (meshArea > 0.0)
+		meshCentroid = Scale(meshCentroid, 1.0 / meshArea);
+
+	// the pieces facing away from the center are more likely to occlude the rest of the mesh: draw them first
+	std::vector<double> sortKeys(numPieces, 0.0);
+	for (size_t piece = 0; piece < numPieces; ++piece)
+	{
+		const double normalLength = std::sqrt(Dot(pieceNormals[piece], pieceNormals[piece]));
+		if (normalLength > 0.0)
+			sortKeys[piece] = Dot(Sub(pieceCentroids[piece], meshCentroid), pieceNormals[piece]) / normalLength;
+	}
+	std::vector<unsigned> pieceOrder(numPieces);
+	std::iota(pieceOrder.begin(), pieceOrder.end(), 0u);
+	std::stable_sort(pieceOrder.begin(), pieceOrder.end(), [&](unsigned p0, unsigned p1) { return sortKeys[p0] > sortKeys[p1]; });
+
+	std::vector<unsigned> result;
+	result.reserve(indices.size());
+	for (unsigned piece : pieceOrder)
+	{
+		const size_t pieceEnd = piece + 1 < numPieces ? pieces[piece + 1] : numTriangles;
+		result.insert(result.end(), indices.begin() + pieces[piece] * 3, indices.begin() + pieceEnd * 3);
+	}
+	return result;
+}
+
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<DefaultVertexBufferData>& vertices, std::vector<unsigned>& indices)
+{
+	std::vector<unsigned> remap(vertices.size(), INVALID_INDEX);
+	std::vector<DefaultVertexBufferData> reorderedVertices;
+	reorderedVertices.reserve(vertices.size());
+	for (unsigned& index : indices)
+	{
+		if (remap[index] == INVALID_INDEX)
+		{
+			remap[index] = static_cast<unsigned>(reorderedVertices.size());
+			reorderedVertices.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices = std::move(reorderedVertices);
+}
+
+
+MeshOptimizer::Report MeshOptimizer::Optimize(MeshLODData<DefaultVertexBufferData>& meshLODData, bool bOptimizeOverdraw)
+{
+	Report report;
+	for (size_t LOD = 0; LOD < meshLODData.LODVertices.size(); ++LOD)
+	{
+		std::vector<DefaultVertexBufferData>& vertices = meshLODData.LODVertices[LOD];
+		std::vector<unsigned>& indices = meshLODData.LODIndices[LOD];
+		if (indices.size() < 3)
+			continue;
+
+		report.before += AnalyzeVertexCache(indices, vertices.size());
+
+		std::vector<unsigned> clusters;
+		indices = OptimizeVertexCache(indices, vertices.size(), DEFAULT_CACHE_SIZE, &clusters);
+		if (bOptimizeOverdraw)
+			indices = OptimizeOverdraw(vertices, indices, clusters);
+		OptimizeVertexFetch(vertices, indices);
+
+		report.after += AnalyzeVertexCache(indices, vertices.size());
+	}
+	return report;
+}
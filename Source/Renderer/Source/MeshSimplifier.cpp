@@ -0,0 +1,350 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	constexpr unsigned INVALID_INDEX = 0xFFFFFFFF;
+
+	struct Vec3d { double x, y, z; };
+	inline Vec3d ToVec3d(const vec3& v) { return { v.x(), v.y(), v.z() }; }
+	inline Vec3d Sub(const Vec3d& a, const Vec3d& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Vec3d Cross(const Vec3d& a, const Vec3d& b) { return { a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x }; }
+	inline double Dot(const Vec3d& a, const Vec3d& b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+	// symmetric 4x4 matrix of the plane equations, weighted by triangle area
+	struct Quadric
+	{
+		double a2, b2, c2, d2, ab, ac, ad, bc, bd, cd;
+		double weight;
+
+		static Quadric FromPlane(const Vec3d& n, double d, double weight)
+		{
+			return {
+				n.x*n.x*weight, n.y*n.y*weight, n.z*n.z*weight, d*d*weight,
+				n.x*n.y*weight, n.x*n.z*weight, n.x*d*weight,
+				n.y*n.z*weight, n.y*d*weight, n.z*d*weight,
+				weight
+			};
+		}
+
+		void operator+=(const Quadric& q)
+		{
+			a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+			ab += q.ab; ac += q.ac; ad += q.ad;
+			bc += q.bc; bd += q.bd; cd += q.cd;
+			weight += q.weight;
+		}
+
+		// mean squared distance of @p to the planes
+		double Evaluate(const Vec3d& p) const
+		{
+			const double e = a2*p.x*p.x + b2*p.y*p.y + c2*p.z*p.z + d2
+				+ 2.0 * (ab*p.x*p.y + ac*p.x*p.z + bc*p.y*p.z + ad*p.x + bd*p.y + cd*p.z);
+			return weight > 0.0 ? (std::max)(e, 0.0) / weight : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		unsigned from, to;
+		double cost;
+	};
+
+	inline uint64_t EdgeKey(unsigned a, unsigned b) { return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a; }
+
+	// vertices that share a position get the same position index (the first of them)
+	std::vector<unsigned> BuildPositionRemap(const std::vector<DefaultVertexBufferData>& vertices)
+	{
+		struct PositionHash
+		{
+			size_t operator()(const vec3& p) const 
+			{
+				uint32_t h[3]; std::memcpy(h, &p._v, sizeof(h));
+				return (h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u);
+			}
+		};
+		struct PositionEqual
+		{
+			bool operator()(const vec3& a, const vec3& b) const { return a.x() == b.x() && a.y() == b.y() && a.z() == b.z(); }
+		};
+
+		std::unordered_map<vec3, unsigned, PositionHash, PositionEqual> positionLookup;
+		positionLookup.reserve(vertices.size());
+
+		std::vector<unsigned> remap(vertices.size());
+		for (unsigned i = 0; i < vertices.size(); ++i)
+			remap[i] = positionLookup.emplace(vertices[i].position, i).first->second;
+		return remap;
+	}
+
+	// vertices on UV/normal seams, open and non-manifold edges are locked
+	std::vector<bool> FindLockedVertices(const std::vector<DefaultVertexBufferData>& vertices, const std::vector<unsigned>& indices, const std::vector<unsigned>& positionRemap)
+	{
+		std::vector<bool> bLocked(vertices.size(), false);
+
+		std::vector<unsigned> numVerticesPerPosition(vertices.size(), 0);
+		for (unsigned i = 0; i < vertices.size(); ++i)
+			++numVerticesPerPosition[positionRemap[i]];
+		for (unsigned i = 0; i < vertices.size(); ++i)
+			bLocked[i] = numVerticesPerPosition[positionRemap[i]] > 1;
+
+		// edges are counted between positions so that the seams don't look like open edges
+		std::unordered_map<uint64_t, unsigned> numTrianglesPerEdge;
+		numTrianglesPerEdge.reserve(indices.size());
+		for (size_t tri = 0; tri < indices.size(); tri += 3)
+			for (size_t e = 0; e < 3; ++e)
+				++numTrianglesPerEdge[EdgeKey(positionRemap[indices[tri + e]], positionRemap[indices[tri + (e + 1) % 3]])];
+
+		for (size_t tri = 0; tri < indices.size(); tri += 3)
+		{
+			for (size_t e = 0; e < 3; ++e)
+			{
+				const unsigned a = indices[tri + e];
+				const unsigned b = indices[tri + (e + 1) % 3];
+				if (numTrianglesPerEdge.at(EdgeKey(positionRemap[a], positionRemap[b])) != 2)
+					bLocked[a] = bLocked[b] = true;
+			}
+		}
+		return bLocked;
+	}
+
+	// collapsing @from onto @to shouldn't flip any of the remaining triangles around @from
+	bool IsCollapseValid(unsigned from, unsigned to, const std::vector<Vec3d>& positions, const std::vector<unsigned>& indices,
+		const std::vector<unsigned>& triangleOffsets, const std::vector<unsigned>& vertexTriangles)
+	{
+		for (unsigned i = triangleOffsets[from]; i < triangleOffsets[from + 1]; ++i)
+		{
+			const unsigned tri = vertexTriangles[i] * 3;
+			const unsigned i0 = indices[tri + 0], i1 = indices[tri + 1], i2 = indices[tri + 2];
+			if (i0 == to || i1 == to || i2 == to)
+				continue; // collapses into a degenerate triangle
+
+			const Vec3d& p0 = positions[i0];
+			const Vec3d& p1 = positions[i1];
+			const Vec3d& p2 = positions[i2];
+			const Vec3d n0 = Cross(Sub(p1, p0), Sub(p2, p0));
+			const Vec3d& q0 = i0 == from ? positions[to] : p0;
+			const Vec3d& q1 = i1 == from ? positions[to] : p1;
+			const Vec3d& q2 = i2 == from ? positions[to] : p2;
+			const Vec3d n1 = Cross(Sub(q1, q0), Sub(q2, q0));
+			if (Dot(n0, n1) <= 0.25 * std::sqrt(Dot(n0, n0) * Dot(n1, n1)))
+				return false; // flipped or rotated by more than ~75 degrees
+		}
+		return true;
+	}
+}
+
+
+std::vector<unsigned> MeshSimplifier::Simplify(
+	  const std::vector<DefaultVertexBufferData>& vertices
+	, const std::vector<unsigned>&                indices
+	, size_t                                      targetTriangleCount
+	, float                                       maxError
+	, float*                                      pOutError
+)
+{
+	assert(indices.size() % 3 == 0);
+	std::vector<unsigned> result = indices;
+	double resultError = 0.0;
+
+	const unsigned numVertices = static_cast<unsigned>(vertices.size());
+	std::vector<Vec3d> positions(numVertices);
+	for (unsigned i = 0; i < numVertices; ++i)
+		positions[i] = ToVec3d(vertices[i].position);
+
+	const std::vector<unsigned> positionRemap = BuildPositionRemap(vertices);
+	const std::vector<bool> bLocked = FindLockedVertices(vertices, indices, positionRemap);
+
+	// vertex quadrics
+	std::vector<Quadric> quadrics(numVertices, Quadric{});
+	for (size_t tri = 0; tri < result.size(); tri += 3)
+	{
+		const Vec3d& p0 = positions[result[tri + 0]];
+		const Vec3d  n = Cross(Sub(positions[result[tri + 1]], p0), Sub(positions[result[tri + 2]], p0));
+		const double length = std::sqrt(Dot(n, n));
+		if (length == 0.0)
+			continue;
+
+		const Vec3d normal = { n.x / length, n.y / length, n.z / length };
+		const Quadric q = Quadric::FromPlane(normal, -Dot(normal, p0), 0.5 * length);
+		for (size_t v = 0; v < 3; ++v)
+			quadrics[result[tri + v]] += q;
+	}
+
+	const double maxCost = static_cast<double>(maxError) * maxError;
+	std::vector<unsigned> triangleOffsets(numVertices + 1);
+	std::vector<unsigned> vertexTriangles;
+	std::vector<Collapse> collapses;
+	std::vector<unsigned> collapseTargets(numVertices);
+	std::vector<bool>     bTouched(numVertices);
+
+	size_t numTriangles = result.size() / 3;
+	while (numTriangles > targetTriangleCount)
+	{
+		// vertex -> triangle adjacency
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (unsigned index : result)
+			++triangleOffsets[index + 1];
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+		vertexTriangles.resize(result.size());
+		{
+			std::vector<unsigned> writeOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (unsigned i = 0; i < result.size(); ++i)
+				vertexTriangles[writeOffsets[result[i]]++] = i / 3;
+		}
+
+		// collapse candidates of the triangle edges, cheapest first
+		collapses.clear();
+		for (size_t tri = 0; tri < result.size(); tri += 3)
+		{
+			for (size_t e = 0; e < 3; ++e)
+			{
+				const unsigned a = result[tri + e];
+				const unsigned b = result[tri + (e + 1) % 3];
+				Quadric q = quadrics[a]; q += quadrics[b];
+				if (!bLocked[a]) collapses.push_back({ a, b, q.Evaluate(positions[b]) });
+				if (!bLocked[b]) collapses.push_back({ b, a, q.Evaluate(positions[a]) });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& c0, const Collapse& c1) { return c0.cost < c1.cost; });
+
+		// collapse the independent edges: the vertices of the triangles around a collapse 
+		// are not collapsed again in the same pass so that the adjacency stays valid.
+		std::iota(collapseTargets.begin(), collapseTargets.end(), 0u);
+		std::fill(bTouched.begin(), bTouched.end(), false);
+		size_t numCollapsedTriangles = 0;
+		for (const Collapse& c : collapses)
+		{
+			if (c.cost > maxCost || numTriangles - numCollapsedTriangles <= targetTriangleCount)
+				break;
+			if (bTouched[c.from] || bTouched[c.to])
+				continue;
+			if (!IsCollapseValid(c.from, c.to, positions, result, triangleOffsets, vertexTriangles))
+				continue;
+
+			for (unsigned i = triangleOffsets[c.from]; i < triangleOffsets[c.from + 1]; ++i)
+			{
+				const unsigned tri = vertexTriangles[i] * 3;
+				const bool bDegenerate = result[tri + 0] == c.to || result[tri + 1] == c.to || result[tri + 2] == c.to;
+				numCollapsedTriangles += bDegenerate ? 1 : 0;
+				for (size_t v = 0; v < 3; ++v)
+					bTouched[result[tri + v]] = true;
+			}
+			collapseTargets[c.from] = c.to;
+			quadrics[c.to] += quadrics[c.from];
+			resultError = (std::max)(resultError, c.cost);
+		}
+
+		if (numCollapsedTriangles == 0)
+			break; // nothing left to collapse under the error limit
+
+		// remap the indices & remove the degenerate triangles
+		size_t writeIndex = 0;
+		for (size_t tri = 0; tri < result.size(); tri += 3)
+		{
+			const unsigned i0 = collapseTargets[result[tri + 0]];
+			const unsigned i1 = collapseTargets[result[tri + 1]];
+			const unsigned i2 = collapseTargets[result[tri + 2]];
+			if (i0 == i1 || i1 == i2 || i0 == i2)
+				continue;
+			result[writeIndex++] = i0;
+			result[writeIndex++] = i1;
+			result[writeIndex++] = i2;
+		}
+		result.resize(writeIndex);
+		numTriangles = result.size() / 3;
+	}
+
+	if (pOutError)
+		*pOutError = static_cast<float>(std::sqrt(resultError));
+	return result;
+}
+
+
+MeshLODData<DefaultVertexBufferData> MeshSimplifier::GenerateLODChain(
+	  const std::vector<DefaultVertexBufferData>& vertices
+	, const std::vector<unsigned>&                indices
+	, const std::vector<float>&                   triangleRatios
+	, const char*                                 pMeshName
+)
+{
+	MeshLODData<DefaultVertexBufferData> meshLODData(1, pMeshName);
+	meshLODData.LODVertices[0] = vertices;
+	meshLODData.LODIndices[0] = indices;
+	meshLODData.LODErrors.push_back(0.0f);
+
+	// bounding sphere radius of the source mesh to report the relative errors
+	vec3 low(FLT_MAX), high(-FLT_MAX);
+	for (const DefaultVertexBufferData& v : vertices)
+	{
+		low  = vec3((std::min)(low.x() , v.position.x()), (std::min)(low.y() , v.position.y()), (std::min)(low.z() , v.position.z()));
+		high = vec3((std::max)(high.x(), v.position.x()), (std::max)(high.y(), v.position.y()), (std::max)(high.z(), v.position.z()));
+	}
+	const Vec3d diagonal = Sub(ToVec3d(high), ToVec3d(low));
+	const float radius = vertices.empty() ? 0.0f : static_cast<float>(0.5 * std::sqrt(Dot(diagonal, diagonal)));
+	if (radius <= 0.0f)
+		return meshLODData;
+
+	const size_t numSourceTriangles = indices.size() / 3;
+	std::vector<unsigned> levelIndices = indices;
+	std::vector<unsigned> vertexRemap(vertices.size());
+	float accumulatedError = 0.0f;
+	for (const float ratio : triangleRatios)
+	{
+		const size_t numPrevTriangles = levelIndices.size() / 3;
+		const size_t targetTriangleCount = static_cast<size_t>(ratio * numSourceTriangles);
+
+		float error = 0.0f;
+		levelIndices = Simplify(vertices, levelIndices, targetTriangleCount, FLT_MAX, &error);
+		const size_t numTriangles = levelIndices.size() / 3;
+		if (numTriangles == 0 || numTriangles * 10 > numPrevTriangles * 9)
+			break; // less than 10% reduction: locked seams & borders dominate the mesh
+
+		// each level is simplified from the previous one: their errors add up
+		accumulatedError += error;
+
+		// compact the vertex buffer of the level
+		std::vector<DefaultVertexBufferData> LODVertices;
+		std::vector<unsigned> LODIndices(levelIndices.size());
+		std::fill(vertexRemap.begin(), vertexRemap.end(), INVALID_INDEX);
+		for (size_t i = 0; i < levelIndices.size(); ++i)
+		{
+			unsigned& remapped = vertexRemap[levelIndices[i]];
+			if (remapped == INVALID_INDEX)
+			{
+				remapped = static_cast<unsigned>(LODVertices.size());
+				LODVertices.push_back(vertices[levelIndices[i]]);
+			}
+			LODIndices[i] = remapped;
+		}
+
+		meshLODData.LODVertices.push_back(std::move(LODVertices));
+		meshLODData.LODIndices.push_back(std::move(LODIndices));
+		meshLODData.LODErrors.push_back(accumulatedError / radius);
+	}
+	return meshLODData;
+}
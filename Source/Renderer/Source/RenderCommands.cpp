@@ -205,3 +205,49 @@ ClearCommand ClearCommand::Color(float r, float g, float b, float a)
 	return ClearCommand::Color({ r,g,b,a });
 }
 
+
+
+const char* CommandLog::GetCommandName(ERecordedCommand type)
+{
+	static const char* sCommandNames[RECORDED_COMMAND_COUNT] =
+	{
+		"SetShader",
+		"SetVertexBuffer",
+		"SetIndexBuffer",
+		"SetTopology",
+		"SetViewport",
+		"SetRasterizerState",
+		"SetBlendState",
+		"SetDepthStencilState",
+		"SetRenderTargets",
+		"SetTexture",
+		"SetSampler",
+		"SetConstant",
+		"UpdateBuffer",
+		"Clear",
+		"Draw",
+		"DrawIndexed",
+		"DrawIndexedInstanced",
+		"Dispatch",
+	};
+	return sCommandNames[type];
+}
+
+void CommandLog::Clear()
+{
+	commands.clear();
+	counts.fill(0);
+}
+
+int CommandLog::GetNumDrawCalls() const
+{
+	return counts[CMD_DRAW] + counts[CMD_DRAW_INDEXED] + counts[CMD_DRAW_INDEXED_INSTANCED] + counts[CMD_DISPATCH];
+}
+
+int CommandLog::GetNumStateChanges() const
+{
+	int numStateChanges = 0;
+	for (int i = CMD_SET_SHADER; i <= CMD_SET_SAMPLER; ++i)
+		numStateChanges += counts[i];
+	return numStateChanges;
+}
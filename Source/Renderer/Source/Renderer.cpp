@@ -16,7 +16,6 @@
 //
 //	Contact: volkanilbeyli@gmail.com
 
-#define LOG_SEARCH 0
 
 #include "Renderer.h"
 #include "D3DManager.h"
@@ -529,6 +528,63 @@ bool Renderer::Initialize(HWND hwnd, const Settings::Window& settings, const Set
 	return true;
 }
 
+bool Renderer::InitializeNullBackend(const Settings::Window& settings, const Settings::Rendering& rendererSettings)
+{
+	mbNullBackend = true;
+	mWindowSettings = settings;
+	mAntiAliasing = rendererSettings.antiAliasing;
+	Mesh::spRenderer = this;
+	mCommandLog.commands.reserve(64 * 1024);
+
+	// BACK BUFFER
+	//--------------------------------------------------------------------
+	RenderTarget backBufferRT;
+	backBufferRT.texture._width = settings.width;
+	backBufferRT.texture._height = settings.height;
+	backBufferRT.texture._name = "BackBuffer";
+	backBufferRT.texture._id = static_cast<int>(mTextures.size());
+	mTextures.push_back(backBufferRT.texture);
+	mRenderTargets.push_back(backBufferRT);
+	mBackBufferRenderTarget = static_cast<int>(mRenderTargets.size() - 1);
+
+	// same resolution setup as Initialize(): see the note on the swapped X/Y there.
+	const bool bAntiAliasing = rendererSettings.antiAliasing.IsAAEnabled();
+	const float& fUpscaleFactor = rendererSettings.antiAliasing.fUpscaleFactor;
+	if (bAntiAliasing)
+	{
+		RenderTargetDesc rtDesc = {};
+		rtDesc.textureDesc.width  = static_cast<int>(settings.width  * fUpscaleFactor);
+		rtDesc.textureDesc.height = static_cast<int>(settings.height * fUpscaleFactor);
+		rtDesc.textureDesc.usage = ETextureUsage::RENDER_TARGET_RW;
+		AddRenderTarget(rtDesc);
+
+		this->mAntiAliasing.resolutionX = rtDesc.textureDesc.height;
+		this->mAntiAliasing.resolutionY = rtDesc.textureDesc.width;
+	}
+	else
+	{
+		this->mAntiAliasing.resolutionX = this->WindowHeight();
+		this->mAntiAliasing.resolutionY = this->WindowWidth();
+	}
+
+	// DEFAULT DEPTH TARGET
+	//--------------------------------------------------------------------
+	{
+		DepthTargetDesc depthDesc;
+		depthDesc.format = EImageFormat::D32F;
+		depthDesc.textureDesc.width  = bAntiAliasing ? this->mAntiAliasing.resolutionY : settings.width;
+		depthDesc.textureDesc.height = bAntiAliasing ? this->mAntiAliasing.resolutionX : settings.height;
+		depthDesc.textureDesc.format = R32;
+		depthDesc.textureDesc.usage = ETextureUsage(DEPTH_TARGET | RESOURCE);
+		mDefaultDepthBufferTexture = GetDepthTargetTexture(AddDepthTarget(depthDesc)[0]);
+	}
+
+	// the default rasterizer/blend states keep the placeholders allocated in the constructor,
+	// the default depth stencil states & samplers stay null: only their IDs are used.
+	Log::Info("[RENDERER]: Initialized the null backend (%dx%d)", settings.width, settings.height);
+	return true;
+}
+
 void Renderer::Exit()
 {
 	//m_Direct3D->ReportLiveObjects("BEGIN EXIT");
@@ -540,6 +596,8 @@ void Renderer::Exit()
 		auto& refBuffer = *buffers[i];
 		std::for_each(refBuffer.begin(), refBuffer.end(), [](Buffer& b) {b.CleanUp(); });
 		refBuffer.clear();
+		mBufferGPUBytes[i] = 0;
+		mBufferCPUBytes[i] = 0;
 	}
 	
 	// Unload shaders
@@ -584,6 +642,15 @@ void Renderer::Exit()
 		}
 	}
 
+	if (mbNullBackend)
+	{	// there are no device objects, only the placeholders allocated in the constructor
+		for (RasterizerState*& rs : mRasterizerStates) { free(rs); rs = nullptr; }
+		for (BlendState& bs : mBlendStates)            { free(bs.ptr); bs.ptr = nullptr; }
+		mCommandLog.Clear();
+		Log::Info("---------------------------");
+		return;
+	}
+
 	for (RasterizerState*& rs : mRasterizerStates)
 	{
 		if (rs)
@@ -663,14 +730,34 @@ void Renderer::ReloadShaders()
 	}
 }
 
-float	 Renderer::AspectRatio()	const { return m_Direct3D->AspectRatio(); };
-unsigned Renderer::WindowHeight()	const { return m_Direct3D->WindowHeight(); };
-unsigned Renderer::WindowWidth()	const { return m_Direct3D->WindowWidth(); }
+float	 Renderer::AspectRatio()	const { return mbNullBackend ? static_cast<float>(mWindowSettings.width) / mWindowSettings.height : m_Direct3D->AspectRatio(); };
+unsigned Renderer::WindowHeight()	const { return mbNullBackend ? static_cast<unsigned>(mWindowSettings.height) : m_Direct3D->WindowHeight(); };
+unsigned Renderer::WindowWidth()	const { return mbNullBackend ? static_cast<unsigned>(mWindowSettings.width)  : m_Direct3D->WindowWidth(); }
 unsigned Renderer::FrameRenderTargetHeight() const { return mAntiAliasing.resolutionX; }
 unsigned Renderer::FrameRenderTargetWidth()	 const { return mAntiAliasing.resolutionY; }
 vec2	 Renderer::FrameRenderTargetDimensionsAsFloat2() const { return vec2(this->FrameRenderTargetWidth(), this->FrameRenderTargetHeight()); }
 vec2	 Renderer::GetWindowDimensionsAsFloat2() const { return vec2(this->WindowWidth(), this->WindowHeight()); }
-HWND	 Renderer::GetWindow()			const { return m_Direct3D->WindowHandle(); };
+HWND	 Renderer::GetWindow()			const { return mbNullBackend ? nullptr : m_Direct3D->WindowHandle(); };
+
+BufferMemoryUsage Renderer::GetBufferMemoryUsage(EBufferType bufferType) const
+{
+	const size_t category = [&]()
+	{
+		switch (bufferType)
+		{
+		case VERTEX_BUFFER:     return 0;
+		case INDEX_BUFFER:      return 1;
+		case COMPUTE_RW_BUFFER: return 2;
+		default               : assert(false); // specify a valid buffer type
+		}
+		return 0;
+	}();
+
+	BufferMemoryUsage usage;
+	usage.GPUBytes = mBufferGPUBytes[category];
+	usage.CPUBytes = mBufferCPUBytes[category];
+	return usage;
+}
 
 const BufferDesc Renderer::GetBufferDesc(EBufferType bufferType, BufferID bufferID) const
 {
@@ -707,8 +794,13 @@ const PipelineState& Renderer::GetPipelineState() const
 
 ShaderID Renderer::CreateShader(const ShaderDesc& shaderDesc)
 {
-	Shader* shader = new Shader(shaderDesc.shaderName);
-	shader->CompileShaders(m_device, shaderDesc);
+	Shader* shader = mbNullBackend 
+		? new Shader(shaderDesc)	// not compiled: no reflection data either
+		: new Shader(shaderDesc.shaderName);
+	if (!mbNullBackend)
+	{
+		shader->CompileShaders(m_device, shaderDesc);
+	}
 
 	mShaders.push_back(shader);
 	shader->mID = (static_cast<int>(mShaders.size()) - 1);
@@ -726,9 +818,12 @@ ShaderID Renderer::ReloadShader(const ShaderDesc& shaderDesc, const ShaderID sha
 	assert(shaderID >= 0 && shaderID < mShaders.size());
 	Shader* pShader = mShaders[shaderID];
 	delete pShader;
-	pShader = new Shader(shaderDesc.shaderName);
+	pShader = mbNullBackend ? new Shader(shaderDesc) : new Shader(shaderDesc.shaderName);
 
-	pShader->CompileShaders(m_device, shaderDesc);
+	if (!mbNullBackend)
+	{
+		pShader->CompileShaders(m_device, shaderDesc);
+	}
 	pShader->mID = shaderID;
 	mShaders[shaderID] = pShader;
 	return pShader->ID();
@@ -742,6 +837,9 @@ ShaderDesc Renderer::GetShaderDesc(ShaderID shaderID) const
 
 EImageFormat Renderer::GetTextureImageFormat(TextureID texID) const
 {
+	if (mbNullBackend)
+		return EImageFormat::IMAGE_FORMAT_UNKNOWN;
+
 	D3D11_TEXTURE2D_DESC desc = {};
 	mTextures[texID]._tex2D->GetDesc(&desc);
 	return static_cast<EImageFormat>(desc.Format);
@@ -758,8 +856,8 @@ RasterizerStateID Renderer::AddRasterizerState(ERasterizerCullMode cullMode, ERa
 	// todo: add params, scissors, multisample, antialiased line
 	
 
-	ID3D11RasterizerState* newRS;
-	int hr = m_device->CreateRasterizerState(&RSDesc, &newRS);
+	ID3D11RasterizerState* newRS = nullptr;
+	int hr = mbNullBackend ? S_OK : m_device->CreateRasterizerState(&RSDesc, &newRS);
 	if (!SUCCEEDED(hr))
 	{
 		Log::Error("Cannot create Rasterizer State");
@@ -800,6 +898,11 @@ TextureID Renderer::CreateTextureFromFile(const std::string& texFileName, const
 	Texture tex;
 
 	tex._name = texFileName;
+	if (mbNullBackend)
+	{	// the image isn't read, the texture is only registered by name
+		return RegisterTexture(tex);
+	}
+
 	std::wstring wpath(path.begin(), path.end());
 	std::unique_ptr<DirectX::ScratchImage> img = std::make_unique<DirectX::ScratchImage>();
 	if (SUCCEEDED(LoadFromWICFile(wpath.c_str(), WIC_FLAGS_NONE, nullptr, *img)))
@@ -881,6 +984,11 @@ TextureID Renderer::CreateTexture2D(const TextureDesc& texDesc)
 	tex._width = texDesc.width;
 	tex._height = texDesc.height;
 	tex._name = texDesc.texFileName;
+	if (mbNullBackend)
+	{
+		tex._depth = texDesc.arraySize > 1 ? texDesc.arraySize * (texDesc.bIsCubeMap ? 6 : 1) : 0;
+		return RegisterTexture(tex);
+	}
 
 
 	// check multi sampling quality level
@@ -1033,6 +1141,11 @@ TextureID Renderer::CreateTexture2D(const TextureDesc& texDesc)
 		}
 	}
 
+	return RegisterTexture(tex);
+}
+
+TextureID Renderer::RegisterTexture(Texture& tex)
+{
 	TextureID retID = -1;
 	auto itTex = std::find_if(mTextures.begin(), mTextures.end(), [](const Texture& tex1) {return tex1._id == -1; });
 	if (itTex != mTextures.end())
@@ -1053,7 +1166,15 @@ TextureID Renderer::CreateTexture2D(const TextureDesc& texDesc)
 TextureID Renderer::CreateTexture2D(D3D11_TEXTURE2D_DESC & textureDesc, bool initializeSRV)
 {
 	Texture tex;
-	tex.InitializeTexture2D(textureDesc, this, initializeSRV);
+	if (mbNullBackend)
+	{
+		tex._width = textureDesc.Width;
+		tex._height = textureDesc.Height;
+	}
+	else
+	{
+		tex.InitializeTexture2D(textureDesc, this, initializeSRV);
+	}
 	mTextures.push_back(tex);
 	mTextures.back()._id = static_cast<int>(mTextures.size() - 1);
 	return mTextures.back()._id;
@@ -1069,6 +1190,12 @@ TextureID Renderer::CreateHDRTexture(const std::string& texFileName, const std::
 	}
 
 	std::string path = fileRoot + texFileName;
+	if (mbNullBackend)
+	{	// the image isn't read, the texture is only registered by name
+		TextureDesc texDesc = {};
+		texDesc.texFileName = texFileName;
+		return CreateTexture2D(texDesc);
+	}
 	
 	int width = 0;
 	int height = 0;
@@ -1102,6 +1229,12 @@ TextureID Renderer::CreateHDRTexture(const std::string& texFileName, const std::
 
 bool Renderer::SaveTextureToDisk(TextureID texID, const std::string& filePath, bool bConverToSRGB) const
 {
+	if (mbNullBackend)
+	{
+		Log::Warning("SaveTextureToDisk(): the null renderer backend has no texture data (%s)", filePath.c_str());
+		return false;
+	}
+
 	const std::string folderPath = DirectoryUtil::GetFolderPath(filePath);
 
 	// create directory if it doesn't exist
@@ -1214,6 +1347,13 @@ bool Renderer::SaveTextureToDisk(TextureID texID, const std::string& filePath, b
 TextureID Renderer::CreateCubemapFromFaceTextures(const std::vector<std::string>& textureFiles, bool bGenerateMips, unsigned mipLevels)
 {
 	constexpr size_t FACE_COUNT = 6;
+	if (mbNullBackend)
+	{
+		TextureDesc texDesc = {};
+		texDesc.bIsCubeMap = true;
+		texDesc.mipCount = mipLevels;
+		return CreateTexture2D(texDesc);
+	}
 
 	TexMetadata meta = {};
 
@@ -1345,24 +1485,33 @@ TextureID Renderer::CreateCubemapFromFaceTextures(const std::vector<std::string>
 BufferID Renderer::CreateBuffer(const BufferDesc & bufferDesc, const void* pData /*=nullptr*/, const char* pBufferName /*= nullptr*/)
 {
 	Buffer buffer(bufferDesc);
-	buffer.Initialize(m_device, pData);
+	buffer.Initialize(m_device, pData);	// m_device is null with the null backend: no GPU buffer is created
 #if _DEBUG
-	if (pBufferName)
+	if (pBufferName && !mbNullBackend)
 	{
 		m_Direct3D->SetDebugName(buffer.mpGPUData, pBufferName);
 	}
 #endif
+	auto fnAccountMemory = [&](size_t category)
+	{
+		mBufferGPUBytes[category] += buffer.GetSizeInBytes();
+		mBufferCPUBytes[category] += buffer.GetCPUDataSizeInBytes();
+	};
 	return static_cast<int>([&]() {
 		switch (bufferDesc.mType)
 		{
 		case VERTEX_BUFFER:
-			mVertexBuffers.push_back(buffer);
+			fnAccountMemory(0);
+			mVertexBuffers.push_back(std::move(buffer));
 			return mVertexBuffers.size() - 1;
 		case INDEX_BUFFER:
-			mIndexBuffers.push_back(buffer);
+			assert(bufferDesc.mStride == (bufferDesc.mIndexFormat == INDEX_FORMAT_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t)));
+			fnAccountMemory(1);
+			mIndexBuffers.push_back(std::move(buffer));
 			return mIndexBuffers.size() - 1;
 		case COMPUTE_RW_BUFFER:
-			mUABuffers.push_back(buffer);
+			fnAccountMemory(2);
+			mUABuffers.push_back(std::move(buffer));
 			return mUABuffers.size() - 1;
 		default:
 			Log::Warning("Unknown Buffer Type");
@@ -1373,8 +1522,8 @@ BufferID Renderer::CreateBuffer(const BufferDesc & bufferDesc, const void* pData
 
 SamplerID Renderer::CreateSamplerState(D3D11_SAMPLER_DESC & samplerDesc)
 {
-	ID3D11SamplerState*	pSamplerState;
-	HRESULT hr = m_device->CreateSamplerState(&samplerDesc, &pSamplerState);
+	ID3D11SamplerState*	pSamplerState = nullptr;
+	HRESULT hr = mbNullBackend ? S_OK : m_device->CreateSamplerState(&samplerDesc, &pSamplerState);
 	if (FAILED(hr))
 	{
 		Log::Error("Cannot create sampler state\n");
@@ -1390,6 +1539,12 @@ SamplerID Renderer::CreateSamplerState(D3D11_SAMPLER_DESC & samplerDesc)
 
 DepthStencilStateID Renderer::AddDepthStencilState(bool bEnableDepth, bool bEnableStencil)
 {
+	if (mbNullBackend)
+	{
+		mDepthStencilStates.push_back(nullptr);
+		return static_cast<DepthStencilStateID>(mDepthStencilStates.size() - 1);
+	}
+
 	DepthStencilState* newDSState = (DepthStencilState*)malloc(sizeof(DepthStencilState));
 
 	HRESULT result;
@@ -1431,6 +1586,12 @@ DepthStencilStateID Renderer::AddDepthStencilState(bool bEnableDepth, bool bEnab
 
 DepthStencilStateID Renderer::AddDepthStencilState(const D3D11_DEPTH_STENCIL_DESC & dsDesc)
 {
+	if (mbNullBackend)
+	{
+		mDepthStencilStates.push_back(nullptr);
+		return static_cast<DepthStencilStateID>(mDepthStencilStates.size() - 1);
+	}
+
 	DepthStencilState* newDSState = (DepthStencilState*)malloc(sizeof(DepthStencilState));
 	HRESULT result;
 
@@ -1461,7 +1622,10 @@ BlendStateID Renderer::AddBlendState()
 	desc.RenderTarget[0] = rtBlendDesc;
 
 	BlendState blend;
-	m_device->CreateBlendState(&desc, &blend.ptr);
+	if (!mbNullBackend)
+	{
+		m_device->CreateBlendState(&desc, &blend.ptr);
+	}
 	mBlendStates.push_back(blend);
 
 	return static_cast<BlendStateID>(mBlendStates.size() - 1);
@@ -1471,6 +1635,12 @@ RenderTargetID Renderer::AddRenderTarget(const Texture& textureObj, D3D11_RENDER
 {
 	RenderTarget newRenderTarget;
 	newRenderTarget.texture = textureObj;
+	if (mbNullBackend)
+	{
+		mRenderTargets.push_back(newRenderTarget);
+		return static_cast<int>(mRenderTargets.size() - 1);
+	}
+
 	HRESULT hr = m_device->CreateRenderTargetView(newRenderTarget.texture._tex2D, &RTVDesc, &newRenderTarget.pRenderTargetView);
 	if (!SUCCEEDED(hr))
 	{
@@ -1498,6 +1668,11 @@ RenderTargetID Renderer::AddRenderTarget(const RenderTargetDesc& renderTargetDes
 	const TextureID texID = CreateTexture2D(renderTargetDesc.textureDesc);
 	Texture& textureObj = const_cast<Texture&>(GetTextureObject(texID));
 	newRenderTarget.texture = textureObj;
+	if (mbNullBackend)
+	{
+		mRenderTargets.push_back(newRenderTarget);
+		return static_cast<int>(mRenderTargets.size() - 1);
+	}
 	
 	// create the render target view
 	D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
@@ -1534,6 +1709,11 @@ std::vector<DepthTargetID> Renderer::AddDepthTarget(const DepthTargetDesc& depth
 	std::vector<DepthTarget> newDepthTargets(numTextures);
 	for (DepthTarget& newDepthTarget : newDepthTargets)
 	{
+		if (mbNullBackend)
+		{
+			newDepthTarget.pDepthStencilView = nullptr;
+			continue;
+		}
 		newDepthTarget.pDepthStencilView = (ID3D11DepthStencilView*)malloc(sizeof(*newDepthTarget.pDepthStencilView));
 		memset(newDepthTarget.pDepthStencilView, 0, sizeof(*newDepthTarget.pDepthStencilView));
 	}
@@ -1559,7 +1739,7 @@ std::vector<DepthTargetID> Renderer::AddDepthTarget(const DepthTargetDesc& depth
 			dsvDesc.Texture2DArray.ArraySize = numTextures - (face + i * faceCount);
 			dsvDesc.Texture2DArray.FirstArraySlice = face + i * faceCount;
 
-			HRESULT hr = m_device->CreateDepthStencilView(textureObj._tex2D, &dsvDesc, &newDepthTarget.pDepthStencilView);
+			HRESULT hr = mbNullBackend ? S_OK : m_device->CreateDepthStencilView(textureObj._tex2D, &dsvDesc, &newDepthTarget.pDepthStencilView);
 			if (FAILED(hr))
 			{
 				Log::Error("Depth Stencil Target View");
@@ -1567,11 +1747,14 @@ std::vector<DepthTargetID> Renderer::AddDepthTarget(const DepthTargetDesc& depth
 			}
 
 #if _DEBUG
-			const std::string SRVName = (depthTargetDesc.textureDesc.texFileName.empty()
-				? "UnnamedDepthTarget"
-				: depthTargetDesc.textureDesc.texFileName) 
-				+ "_DSV[" + std::to_string(face) + "]";
-			m_Direct3D->SetDebugName(newDepthTarget.pDepthStencilView, SRVName.c_str());
+			if (!mbNullBackend)
+			{
+				const std::string SRVName = (depthTargetDesc.textureDesc.texFileName.empty()
+					? "UnnamedDepthTarget"
+					: depthTargetDesc.textureDesc.texFileName)
+					+ "_DSV[" + std::to_string(face) + "]";
+				m_Direct3D->SetDebugName(newDepthTarget.pDepthStencilView, SRVName.c_str());
+			}
 #endif
 
 			// register
@@ -1594,11 +1777,19 @@ bool Renderer::RecycleDepthTarget(DepthTargetID depthTargetID, const DepthTarget
 	const TextureID texID = GetDepthTargetTexture(depthTargetID);
 	Texture& textureObj = const_cast<Texture&>(GetTextureObject(texID));
 	textureObj.Release();
-	mDepthTargets[depthTargetID].pDepthStencilView->Release();
-	mDepthTargets[depthTargetID].pDepthStencilView = nullptr;
+	if (mDepthTargets[depthTargetID].pDepthStencilView)
+	{
+		mDepthTargets[depthTargetID].pDepthStencilView->Release();
+		mDepthTargets[depthTargetID].pDepthStencilView = nullptr;
+	}
 
 	// CreateTexture2D will use the first Release()d Texture instead of adding a new one.
 	CreateTexture2D(newDepthTargetDesc.textureDesc);
+	if (mbNullBackend)
+	{
+		mDepthTargets[depthTargetID].texture = textureObj;
+		return true;
+	}
 
 	// create depth stencil view
 	D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
@@ -1642,6 +1833,16 @@ const TextureID Renderer::GetTexture(const std::string name) const
 void Renderer::SetShader(ShaderID id, bool bUnbindRenderTargets, bool bUnbindTextures)
 {
 	assert(id >= 0 && static_cast<unsigned>(id) < mShaders.size());
+	if (mbNullBackend)
+	{	// no resources are bound, only keep the pipeline state in sync
+		if (mPipelineState.shader != -1 && id != mPipelineState.shader && bUnbindRenderTargets)
+		{
+			UnbindRenderTargets();
+		}
+		mPipelineState.shader = id;
+		return;
+	}
+
 	if (mPipelineState.shader != -1)		// if valid shader
 	{
 		if (id != mPipelineState.shader)	// if not the same shader
@@ -1774,7 +1975,7 @@ void Renderer::SetViewport(const D3D11_VIEWPORT & viewport)
 	mPipelineState.viewPort = viewport;
 }
 
-void Renderer::SetConstant4x4f(const char* cName, const XMMATRIX& matrix)
+void Renderer::SetConstant4x4f(const ConstantName& cName, const XMMATRIX& matrix)
 {
 	// maybe read from SIMD registers?
 	XMFLOAT4X4 m;	XMStoreFloat4x4(&m, matrix);
@@ -1782,7 +1983,44 @@ void Renderer::SetConstant4x4f(const char* cName, const XMMATRIX& matrix)
 	SetConstant(cName, data);
 }
 
-void Renderer::SetConstant(const char * cName, const void * data)
+void Renderer::SetConstant4x4f(ConstantHandle hConstant, const XMMATRIX& matrix)
+{
+	XMFLOAT4X4 m;	XMStoreFloat4x4(&m, matrix);
+	float* data = &m.m[0][0];
+	SetConstant(hConstant, data);
+}
+
+ConstantHandle Renderer::GetConstantHandle(ShaderID shaderID, const ConstantName& cName) const
+{
+	if (mbNullBackend)
+		return ConstantHandle{};	// shaders aren't reflected, SetConstant() only records the command
+
+	const ConstantHandle hConstant = mShaders[shaderID]->GetConstantHandle(cName);
+	if (!hConstant.IsValid())
+	{
+		Log::ErrorRateLimited("CONSTANT NOT FOUND: %s (shader: %s)", cName.name, mShaders[shaderID]->Name().c_str());
+	}
+	return hConstant;
+}
+
+void Renderer::SetConstant(const ConstantName& cName, const void * data)
+{
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_SET_CONSTANT);
+		return;
+	}
+
+	const ConstantHandle hConstant = mShaders[mPipelineState.shader]->GetConstantHandle(cName);
+	if (!hConstant.IsValid())
+	{
+		Log::ErrorRateLimited("CONSTANT NOT FOUND: %s", cName.name);
+		return;
+	}
+	SetConstant(hConstant, data);
+}
+
+void Renderer::SetConstant(ConstantHandle hConstant, const void * data)
 {
 	// Here, we write to the CPU address of the constant buffer if the contents are updated.
 	// otherwise we don't write and flag the buffer that contains the GPU address dirty.
@@ -1792,127 +2030,38 @@ void Renderer::SetConstant(const char * cName, const void * data)
 	// Otherwise, we would have to make an API call each time we set the constants, which would be slower.
 	// Read more here: https://developer.nvidia.com/sites/default/files/akamai/gamedev/files/gdc12/Efficient_Buffer_Management_McDonald.pdf
 	//      and  here: https://developer.nvidia.com/content/constant-buffers-without-constant-pain-0
-
-	Shader* shader = mShaders[mPipelineState.shader];
-
-#if 1
-	// LINEAR LOOKUP
-	bool found = false;
-	for (const ConstantBufferMapping& bufferSlotIDPair : shader->m_constants)
-	{
-		const size_t GPUcBufferSlot = bufferSlotIDPair.first;
-		const CPUConstantID constID = bufferSlotIDPair.second;
-		CPUConstant& c = shader->mCPUConstantBuffers[constID];
-		if (strcmp(cName, c._name.c_str()) == 0)		// if name matches
-		{
-			found = true;
-			memcpy(c._data, data, c._size);
-			shader->mConstantBuffers[GPUcBufferSlot].dirty = true;
-			//break;	// ensures write on first occurrence
-		}
-	}
-	if (!found)
+	if (mbNullBackend)
 	{
-		Log::Error("CONSTANT NOT FOUND: %s", cName);
+		mCommandLog.Record(CMD_SET_CONSTANT);
+		return;
 	}
 
-#else
-	// TODO: Fix binary search algorithm...
-	// BINARY SEARCH 
-	const auto& BinarySearch = [cName, &shader]()
-	{
-		bool bKeepSearching = true;
-		size_t lowIndex  = 0;
-		size_t highIndex = shader->m_constants.size() - 1;
-		size_t currIndex = highIndex / 2;
+	assert(hConstant.IsValid());
+	assert(hConstant.shaderID == mPipelineState.shader);
 
-#if LOG_SEARCH
-		{
-			Log::Info("BinarySearch: %s", cName);
-			for (const auto& slotIndexPair : shader->m_constants)
-			{	// dump sorted buffer slot
-				const char* constantName = CPUConstant::Get(slotIndexPair.second)._name.c_str();
-				Log::Info(" GPU:%d | CPU:%d - %s", slotIndexPair.first, slotIndexPair.second, constantName);
-			}
-			Log::Info("--------------------------");
-		}
-#endif
-
-		while (bKeepSearching)
-		{
-#if LOG_SEARCH
-			Log::Info("begin: low:%d\tcur:%d\thi:%d", lowIndex, currIndex, highIndex);
-#endif
-			const ConstantBufferMapping& bufferSlotIDPair = shader->m_constants[currIndex];
-			const CPUConstantID constID = bufferSlotIDPair.second;
-			const CPUConstant& c = CPUConstant::Get(constID);
-			int res = strcmp(cName, c._name.c_str());
-#if LOG_SEARCH
-			Log::Info(" \"%s\" strcmp \"%s\" -> %d", cName, c._name.c_str(), res);
-#endif
-			if (res == 0)		
-			{	
-#if LOG_SEARCH
-				Log::Info("found: %s", c._name.c_str());
-#endif
-				return currIndex;
-			}
-
-			else if (res > 0)
-			{
-				lowIndex = currIndex;
-				currIndex = lowIndex + (highIndex - lowIndex + 1) / 2;
-#if LOG_SEARCH
-				{
-					const ConstantBufferMapping& bufferSlotIDPair = shader->m_constants[currIndex];
-					const CPUConstantID constID = bufferSlotIDPair.second;
-					const CPUConstant& c = CPUConstant::Get(constID);
-					Log::Info("looking next(%s)", c._name.c_str());
-				}
-#endif
-			}
+	Shader* shader = mShaders[hConstant.shaderID];
+	const Shader::ConstantHandleData& handleData = shader->mConstantHandles[hConstant.index];
 
-			else
-			{
-				highIndex = currIndex - 1;
-				currIndex = lowIndex + (highIndex - lowIndex) / 2;
-#if LOG_SEARCH
-				{
-					const ConstantBufferMapping& bufferSlotIDPair = shader->m_constants[currIndex];
-					const CPUConstantID constID = bufferSlotIDPair.second;
-					const CPUConstant& c = CPUConstant::Get(constID);
-					Log::Info("looking previous(%s)", c._name.c_str());
-				}
-#endif
-			}
-
-#if LOG_SEARCH
-			Log::Info("end: low:%d\tcur:%d\thi:%d\n", lowIndex, currIndex, highIndex);
-#endif
-			bKeepSearching = lowIndex < highIndex;// || ((currIndex == lowIndex) && (lowIndex == highIndex));
-		}
-
-		Log::Error("CONSTANT NOT FOUND: %s", cName);
-		return currIndex;
-	};
-
-	size_t bufferMappingIndex = BinarySearch();
-	const ConstantBufferMapping& bufferSlotIDPair = shader->m_constants[bufferMappingIndex];
-	const size_t GPUcBufferSlot = bufferSlotIDPair.first;
-	const CPUConstantID constID = bufferSlotIDPair.second;
-	CPUConstant& c = CPUConstant::Get(constID);
-	if (memcmp(c._data, data, c._size) != 0)	// copy data if its not the same
+	// the same constant can be in multiple cbuffers (VS & PS etc.): write all occurrences
+	for (int i = 0; i < handleData.numMappings; ++i)
 	{
+		const ConstantBufferMapping& bufferSlotIDPair = shader->mConstantHandleMappings[handleData.firstMapping + i];
+		const size_t GPUcBufferSlot = bufferSlotIDPair.first;
+		const CPUConstantID constID = bufferSlotIDPair.second;
+		CPUConstant& c = shader->mCPUConstantBuffers[constID];
 		memcpy(c._data, data, c._size);
 		shader->mConstantBuffers[GPUcBufferSlot].dirty = true;
 	}
-#endif
-
 }
 
 void Renderer::SetTexture_(const char* texName, TextureID tex, unsigned slice /*= 0 /* only for texture arrays */)
 {
 	assert(tex >= 0);
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_SET_TEXTURE, tex);
+		return;
+	}
 
 	const Shader* shader = mShaders[mPipelineState.shader];
 	const std::string textureName = std::string(texName);
@@ -1928,13 +2077,19 @@ void Renderer::SetTexture_(const char* texName, TextureID tex, unsigned slice /*
 #ifdef _DEBUG
 	if (!bFound)
 	{
-		Log::Error("Texture not found: \"%s\" in Shader(Id=%d) \"%s\"", texName, mPipelineState.shader, shader->Name().c_str());
+		Log::ErrorRateLimited("Texture not found: \"%s\" in Shader(Id=%d) \"%s\"", texName, mPipelineState.shader, shader->Name().c_str());
 	}
 #endif
 }
 
 void Renderer::SetTextureArray(const char* texName, const std::array<TextureID, TEXTURE_ARRAY_SIZE>& TextureIDs, unsigned numTextures)
 {
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_SET_TEXTURE, TextureIDs[0]);
+		return;
+	}
+
 	const Shader* shader = mShaders[mPipelineState.shader];
 	if (shader->HasTextureBinding(texName))
 	{
@@ -1944,7 +2099,7 @@ void Renderer::SetTextureArray(const char* texName, const std::array<TextureID,
 #ifdef _DEBUG
 	else
 	{
-		Log::Error("Texture not found: \"%s\" in Shader(Id=%d) \"%s\"", texName, mPipelineState.shader, shader->Name().c_str());
+		Log::ErrorRateLimited("Texture not found: \"%s\" in Shader(Id=%d) \"%s\"", texName, mPipelineState.shader, shader->Name().c_str());
 	}
 #endif
 }
@@ -1955,6 +2110,11 @@ void Renderer::SetTexture(const char * texName, TextureID tex) { SetTexture_(tex
 void Renderer::SetRWTexture(const char* texName, TextureID tex)
 {
 	assert(tex >= 0);
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_SET_TEXTURE, tex);
+		return;
+	}
 
 	const Shader* shader = mShaders[mPipelineState.shader];
 	const std::string textureName = std::string(texName);
@@ -1970,13 +2130,19 @@ void Renderer::SetRWTexture(const char* texName, TextureID tex)
 #ifdef _DEBUG
 	if (!bFound)
 	{
-		Log::Error("UnorderedAccessTexture not found: \"%s\" in Shader(Id=%d) \"%s\"", texName, mPipelineState.shader, shader->Name().c_str());
+		Log::ErrorRateLimited("UnorderedAccessTexture not found: \"%s\" in Shader(Id=%d) \"%s\"", texName, mPipelineState.shader, shader->Name().c_str());
 	}
 #endif
 }
 
 void Renderer::SetSamplerState(const char * samplerName, SamplerID samplerID)
 {
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_SET_SAMPLER, samplerID);
+		return;
+	}
+
 	const Shader* shader = mShaders[mPipelineState.shader];
 
 	const bool bFound = shader->HasSamplerBinding(samplerName);
@@ -1990,7 +2156,7 @@ void Renderer::SetSamplerState(const char * samplerName, SamplerID samplerID)
 #ifdef _DEBUG
 	if (!bFound)
 	{
-		Log::Error("Sampler not found: \"%s\" in Shader(Id=%d) \"%s\"\n", samplerName, mPipelineState.shader, shader->Name().c_str());
+		Log::ErrorRateLimited("Sampler not found: \"%s\" in Shader(Id=%d) \"%s\"", samplerName, mPipelineState.shader, shader->Name().c_str());
 	}
 #endif
 }
@@ -2015,6 +2181,9 @@ void Renderer::SetDepthStencilState(DepthStencilStateID depthStencilStateID)
 
 void Renderer::SetScissorsRect(int left, int right, int top, int bottom)
 {
+	if (mbNullBackend)
+		return;
+
 	D3D11_RECT rects[1];
 	rects[0].left = left;
 	rects[0].right = right;
@@ -2107,7 +2276,8 @@ void Renderer::BeginRender(const ClearCommand & clearCmd)
 	{
 		for (const RenderTargetID rtv : mPipelineState.renderTargets)
 		{
-			if (rtv >= 0)	m_deviceContext->ClearRenderTargetView(mRenderTargets[rtv].pRenderTargetView, clearCmd.clearColor.data());
+			if (rtv >= 0 && mbNullBackend) mCommandLog.Record(CMD_CLEAR, rtv);
+			else if (rtv >= 0)	m_deviceContext->ClearRenderTargetView(mRenderTargets[rtv].pRenderTargetView, clearCmd.clearColor.data());
 			else			Log::Error("Begin called with clear color command without a render target bound to pipeline!");
 		}
 	}
@@ -2127,7 +2297,8 @@ void Renderer::BeginRender(const ClearCommand & clearCmd)
 			return D3D11_CLEAR_STENCIL;
 		}();
 
-		if (dsv >= 0)	m_deviceContext->ClearDepthStencilView(mDepthTargets[dsv].pDepthStencilView, clearFlag, clearCmd.clearDepth, clearCmd.clearStencil);
+		if (dsv >= 0 && mbNullBackend) mCommandLog.Record(CMD_CLEAR, dsv);
+		else if (dsv >= 0)	m_deviceContext->ClearDepthStencilView(mDepthTargets[dsv].pDepthStencilView, clearFlag, clearCmd.clearDepth, clearCmd.clearStencil);
 		else			Log::Error("Begin called with clear depth_stencil command without a depth target bound to pipeline!");
 	}
 }
@@ -2135,10 +2306,13 @@ void Renderer::BeginRender(const ClearCommand & clearCmd)
 void Renderer::BeginFrame()
 {
 	mRenderStats = { 0, 0, 0 };
+	mCommandLog.Clear();
 }
 
 void Renderer::EndFrame()
 {
+	if (mbNullBackend)
+		return;
 	m_Direct3D->EndFrame();
 }
 
@@ -2147,6 +2321,10 @@ void Renderer::UpdateBuffer(BufferID buffer, const void * pData)
 {
 	assert(buffer >= 0 && buffer < mVertexBuffers.size());
 	mVertexBuffers[buffer].Update(this, pData);
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_UPDATE_BUFFER, buffer);
+	}
 }
 
 void Renderer::Apply()
@@ -2200,6 +2378,26 @@ void Renderer::Apply()
 		return;
 	}
 
+	if (mbNullBackend)
+	{	// record what the D3D path below would have submitted, with the same redundancy checks
+		if (mPipelineState.vertexBuffer != -1 && bVertexBufferChanged) { mCommandLog.Record(CMD_SET_VERTEX_BUFFER, mPipelineState.vertexBuffer); }
+		if (mPipelineState.indexBuffer  != -1 && bIndexBufferChanged)  { mCommandLog.Record(CMD_SET_INDEX_BUFFER, mPipelineState.indexBuffer); }
+		if (bShaderChanged)                    { mCommandLog.Record(CMD_SET_SHADER, mPipelineState.shader); }
+		if (bViewPortChanged)                  { mCommandLog.Record(CMD_SET_VIEWPORT); }
+		if (bRasterizerStateChanged)           { mCommandLog.Record(CMD_SET_RASTERIZER_STATE, mPipelineState.rasterizerState); }
+		if (sEnableBlend && bBlendStateChanged){ mCommandLog.Record(CMD_SET_BLEND_STATE, mPipelineState.blendState); }
+		if (bDepthStencilStateChanged)         { mCommandLog.Record(CMD_SET_DEPTH_STENCIL_STATE, mPipelineState.depthStencilState); }
+
+		const bool bAnyRenderTargetBound = std::any_of(RANGE(mPipelineState.renderTargets), [](RenderTargetID hRT) { return hRT >= 0; });
+		if (bAnyRenderTargetBound || bRenderTargetChanged || (mPipelineState.depthTargets != -1 && bDepthTargetChanged))
+		{
+			mCommandLog.Record(CMD_SET_RENDER_TARGETS, mPipelineState.depthTargets);
+		}
+
+		mPrevPipelineState = mPipelineState;
+		return;
+	}
+
 	// INPUT ASSEMBLY
 	// ----------------------------------------
 	const Buffer& VertexBuffer = mVertexBuffers[mPipelineState.vertexBuffer];
@@ -2211,7 +2409,7 @@ void Renderer::Apply()
 	unsigned offset = 0;
 
 	if (bVBufferValid && bVertexBufferChanged)	{ m_deviceContext->IASetVertexBuffers(0, 1, &(VertexBuffer.mpGPUData), &stride, &offset); }
-	if (bIBufferValid && bIndexBufferChanged)	{ m_deviceContext->IASetIndexBuffer(IndexBuffer.mpGPUData, DXGI_FORMAT_R32_UINT, 0); }
+	if (bIBufferValid && bIndexBufferChanged)	{ m_deviceContext->IASetIndexBuffer(IndexBuffer.mpGPUData, static_cast<DXGI_FORMAT>(IndexBuffer.mDesc.mIndexFormat), 0); }
 	
 	
 	// SHADER STAGES
@@ -2302,6 +2500,8 @@ void Renderer::Apply()
 void Renderer::BeginEvent(const std::string & marker)
 {
 #if _DEBUG
+	if (mbNullBackend)
+		return;
 	StrUtil::UnicodeString umarker(marker);
 	m_Direct3D->m_annotation->BeginEvent(umarker.GetUnicodePtr());
 #endif
@@ -2310,6 +2510,8 @@ void Renderer::BeginEvent(const std::string & marker)
 void Renderer::EndEvent()
 {
 #if _DEBUG
+	if (mbNullBackend)
+		return;
 	m_Direct3D->m_annotation->EndEvent();
 #endif
 }
@@ -2323,12 +2525,19 @@ void Renderer::DrawIndexed(EPrimitiveTopology topology)
 	const unsigned numVertices = VertexBuffer.mDesc.mElementCount;
 
 	mPipelineState.topology = topology;
-	if (mPipelineState.topology != mPrevPipelineState.topology) 
-	{ 
-		m_deviceContext->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology)); 
+	if (mbNullBackend)
+	{
+		if (mPipelineState.topology != mPrevPipelineState.topology) { mCommandLog.Record(CMD_SET_TOPOLOGY, static_cast<int>(topology)); }
+		mCommandLog.Record(CMD_DRAW_INDEXED, numIndices);
+	}
+	else
+	{
+		if (mPipelineState.topology != mPrevPipelineState.topology)
+		{
+			m_deviceContext->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology));
+		}
+		m_deviceContext->DrawIndexed(numIndices, 0, 0);
 	}
-
-	m_deviceContext->DrawIndexed(numIndices, 0, 0);
 	
 	++mRenderStats.numDrawCalls;
 	mRenderStats.numIndices += numIndices;
@@ -2345,12 +2554,19 @@ void Renderer::DrawIndexedInstanced(int instanceCount, EPrimitiveTopology topolo
 	const unsigned numVertices = VertexBuffer.mDesc.mElementCount;
 
 	mPipelineState.topology = topology;
-	if (mPipelineState.topology != mPrevPipelineState.topology)
+	if (mbNullBackend)
 	{
-		m_deviceContext->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology));
+		if (mPipelineState.topology != mPrevPipelineState.topology) { mCommandLog.Record(CMD_SET_TOPOLOGY, static_cast<int>(topology)); }
+		mCommandLog.Record(CMD_DRAW_INDEXED_INSTANCED, instanceCount);
+	}
+	else
+	{
+		if (mPipelineState.topology != mPrevPipelineState.topology)
+		{
+			m_deviceContext->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology));
+		}
+		m_deviceContext->DrawIndexedInstanced(numIndices, instanceCount, 0, 0, 0);
 	}
-
-	m_deviceContext->DrawIndexedInstanced(numIndices, instanceCount, 0, 0, 0);
 
 	++mRenderStats.numDrawCalls;
 	mRenderStats.numIndices += numIndices;
@@ -2360,8 +2576,16 @@ void Renderer::DrawIndexedInstanced(int instanceCount, EPrimitiveTopology topolo
 
 void Renderer::Draw(int vertCount, EPrimitiveTopology topology /*= EPrimitiveTopology::POINT_LIST*/)
 {
-	m_deviceContext->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology));
-	m_deviceContext->Draw(vertCount, 0);
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_SET_TOPOLOGY, static_cast<int>(topology));	// Draw() always sets the topology
+		mCommandLog.Record(CMD_DRAW, vertCount);
+	}
+	else
+	{
+		m_deviceContext->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology));
+		m_deviceContext->Draw(vertCount, 0);
+	}
 	
 	++mRenderStats.numDrawCalls;
 	mRenderStats.numVertices += vertCount;
@@ -2369,5 +2593,10 @@ void Renderer::Draw(int vertCount, EPrimitiveTopology topology /*= EPrimitiveTop
 
 void Renderer::Dispatch(int x, int y, int z)
 {
+	if (mbNullBackend)
+	{
+		mCommandLog.Record(CMD_DISPATCH, x * y * z);
+		return;
+	}
 	m_deviceContext->Dispatch(x, y, z);
 }
@@ -241,6 +241,21 @@ EShaderStage Shader::GetShaderTypeFromSourceFilePath(const std::string & shaderF
 // PUBLIC INTERFACE
 //-------------------------------------------------------------------------------------------------------------
 const std::vector<Shader::ConstantBufferLayout>& Shader::GetConstantBufferLayouts() const { return m_CBLayouts; }
+ConstantHandle Shader::GetConstantHandle(const ConstantName& constantName) const
+{
+	ConstantHandle handle;
+	auto it = mConstantHandleLookup.find(constantName.hash);
+	if (it != mConstantHandleLookup.end())
+	{
+		handle.shaderID = mID;
+		handle.index = it->second;
+#if _DEBUG
+		const ConstantBufferMapping& mapping = mConstantHandleMappings[mConstantHandles[handle.index].firstMapping];
+		assert(mCPUConstantBuffers[mapping.second]._name == constantName.name);
+#endif
+	}
+	return handle;
+}
 const std::vector<ConstantBufferBinding>& Shader::GetConstantBuffers() const { return mConstantBuffers; }
 const TextureBinding& Shader::GetTextureBinding(const std::string& textureName) const { return mTextureBindings[mShaderTextureLookup.at(textureName)]; }
 const SamplerBinding& Shader::GetSamplerBinding(const std::string& samplerName) const { return mSamplerBindings[mShaderSamplerLookup.at(samplerName)]; }
@@ -333,6 +348,9 @@ void Shader::ReleaseResources()
 
 	m_CBLayouts.clear();
 	m_constants.clear();
+	mConstantHandles.clear();
+	mConstantHandleMappings.clear();
+	mConstantHandleLookup.clear();
 	mTextureBindings.clear();
 	mSamplerBindings.clear();
 	mShaderTextureLookup.clear();
@@ -451,14 +469,18 @@ bool Shader::CompileShaders(ID3D11Device* device, const ShaderDesc& desc)
 			continue;
 
 		// stage.macros
+		std::vector<ShaderMacro> macros = stageDesc.macros;
+#if PACKED_VERTEX_FORMAT
+		macros.push_back(ShaderMacro{ "PACKED_VERTEX_FORMAT", "1" });	// see VertexFormat.hlsl
+#endif
 		const std::string sourceFilePath = std::string(Renderer::sShaderRoot + stageDesc.fileName);
 		
 		const EShaderStage stage = GetShaderTypeFromSourceFilePath(sourceFilePath);
 
 		// USE SHADER CACHE
 		//
-		const size_t ShaderHash = GeneratePreprocessorDefinitionsHash(stageDesc.macros);
-		const std::string cacheFileName = stageDesc.macros.empty()
+		const size_t ShaderHash = GeneratePreprocessorDefinitionsHash(macros);
+		const std::string cacheFileName = macros.empty()
 			? DirectoryUtil::GetFileNameFromPath(sourceFilePath) + SHADER_BINARY_EXTENSION
 			: DirectoryUtil::GetFileNameFromPath(sourceFilePath) + "_" + std::to_string(ShaderHash) + SHADER_BINARY_EXTENSION;
 		const std::string cacheFilePath = Application::s_ShaderCacheDirectory + "\\" + cacheFileName;
@@ -481,7 +503,7 @@ bool Shader::CompileShaders(ID3D11Device* device, const ShaderDesc& desc)
 		{
 			std::string errMsg;
 			ID3D10Blob* pBlob;
-			if (CompileFromSource(sourceFilePath, stage, pBlob, errMsg, stageDesc.macros))
+			if (CompileFromSource(sourceFilePath, stage, pBlob, errMsg, macros))
 			{
 				blobs.of[stage] = pBlob;
 				CacheShaderBinary(cacheFilePath, blobs.of[stage]);
@@ -608,6 +630,42 @@ bool Shader::CompileShaders(ID3D11Device* device, const ShaderDesc& desc)
 		++constantBufferSlot;
 	}
 
+	// Constant handles: group the mappings of the same constant name together
+	{
+		std::unordered_map<ConstantNameHash, std::vector<ConstantBufferMapping>> mappingsPerName;
+		std::vector<ConstantNameHash> nameHashes; // keep the order of the first occurrences
+		int mappingIndex = 0;
+		for (const ConstantBufferLayout& cbLayout : m_CBLayouts)
+		{
+			for (size_t i = 0; i < cbLayout.variables.size(); ++i)
+			{
+				const ConstantNameHash hash = cbLayout.variableNameHashes[i];
+				const ConstantBufferMapping& mapping = m_constants[mappingIndex++];
+				
+				std::vector<ConstantBufferMapping>& mappings = mappingsPerName[hash];
+				if (mappings.empty())
+				{
+					nameHashes.push_back(hash);
+				}
+				else if (mCPUConstantBuffers[mappings.front().second]._name != mCPUConstantBuffers[mapping.second]._name)
+				{
+					Log::Error("Shader %s: constant name hash collision: %s - %s", mName.c_str()
+						, mCPUConstantBuffers[mappings.front().second]._name.c_str()
+						, mCPUConstantBuffers[mapping.second]._name.c_str());
+				}
+				mappings.push_back(mapping);
+			}
+		}
+
+		for (ConstantNameHash hash : nameHashes)
+		{
+			const std::vector<ConstantBufferMapping>& mappings = mappingsPerName.at(hash);
+			mConstantHandleLookup[hash] = static_cast<int>(mConstantHandles.size());
+			mConstantHandles.push_back({ static_cast<int>(mConstantHandleMappings.size()), static_cast<int>(mappings.size()) });
+			mConstantHandleMappings.insert(mConstantHandleMappings.end(), RANGE(mappings));
+		}
+	}
+
 	// GPU CBuffers
 	D3D11_BUFFER_DESC cBufferDesc;
 	cBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
@@ -852,6 +910,8 @@ void Shader::ReflectConstantBufferLayouts(ID3D11ShaderReflection* sRefl, EShader
 			pType->GetDesc(&typeDesc);
 			bufferLayout.types.push_back(typeDesc);
 
+			bufferLayout.variableNameHashes.push_back(StrUtil::Hash32(varDesc.Name));
+
 			// accumulate buffer size
 			bufferLayout.buffSize += varDesc.Size;
 		}
@@ -55,7 +55,7 @@ void LODTestScene::Load(SerializedScene& scene)
 		// copy transform
 		pNewObject->SetTransform(pObjToCopy->GetTransform());
 		Transform& tf = pNewObject->GetTransform();
-		tf._position.y() += 75.0f;
+		tf.Translate(0.0f, 75.0f, 0.0f);
 
 
 		// generate wireframe mesh for the copied geometry
@@ -141,16 +141,15 @@ void LODTestScene::Update(float dt)
 		auto VB_IB_IDs = mMeshes[meshID].GetIABuffers(currentLODValue);
 		const BufferDesc bufDescVB = mpRenderer->GetBufferDesc(EBufferType::VERTEX_BUFFER, VB_IB_IDs.first);
 		const BufferDesc bufDescIB = mpRenderer->GetBufferDesc(EBufferType::INDEX_BUFFER , VB_IB_IDs.second);
-		const LODManager::LODSettings& lod = mLODManager.GetMeshLODSettings(pObj, meshID);
 
-		vec3 distSq = pObj->GetTransform()._position - this->GetActiveCamera().GetPositionF();
+		vec3 distSq = pObj->GetTransform().GetPosition() - this->GetActiveCamera().GetPositionF();
 		distSq = XMVector3Dot(distSq, distSq);
 		const float distance = std::sqrtf(distSq.x());
 
 		mSceneStats.objStats[currLODObject].lod = currentLODValue;
 		mSceneStats.objStats[currLODObject].numVert = bufDescVB.mElementCount;
 		mSceneStats.objStats[currLODObject].numTri = bufDescIB.mElementCount / 3;
-		mSceneStats.objStats[currLODObject].lodLevelDistanceThreshold = lod.distanceThresholds[currentLODValue];
+		mSceneStats.objStats[currLODObject].lodLevelDistanceThreshold = mLODManager.GetLODSwitchDistance(pObj, meshID);
 		mSceneStats.objStats[currLODObject].currDistance = distance;
 	}
 }
@@ -37,12 +37,14 @@ cbuffer frame
 };
 
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float3 tangent	: TANGENT0;
-	float2 texCoord : TEXCOORD0;    
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent	: TANGENT0;
+	VERTEX_UV_TYPE texCoord : TEXCOORD0;    
 };
 
 struct PSIn 
@@ -62,15 +64,15 @@ PSIn VSMain(VSIn In)
 #if INSTANCED
 	Out.position   = mul(ObjMatrices[In.instanceID].worldViewProj, pos);
 	Out.worldPos   = mul(ObjMatrices[In.instanceID].world, pos).xyz;
-	Out.normal     = normalize(mul(ObjMatrices[In.instanceID].normalMatrix, In.normal));
-	Out.tangent    = normalize(mul(ObjMatrices[In.instanceID].normalMatrix, In.tangent));
+	Out.normal     = normalize(mul(ObjMatrices[In.instanceID].normalMatrix, UnpackVertexNormal(In.normal)));
+	Out.tangent    = normalize(mul(ObjMatrices[In.instanceID].normalMatrix, UnpackVertexTangent(In.tangent)));
 	Out.instanceID = In.instanceID;
 #else
 	Out.position   = mul(ObjMatrices.worldViewProj, pos);
 	Out.worldPos   = mul(ObjMatrices.world        , pos).xyz;
-    Out.normal	   = normalize(mul(ObjMatrices.normalMatrix, In.normal));
-    Out.tangent	   = normalize(mul(ObjMatrices.normalMatrix, In.tangent));
+    Out.normal	   = normalize(mul(ObjMatrices.normalMatrix, UnpackVertexNormal(In.normal)));
+    Out.tangent	   = normalize(mul(ObjMatrices.normalMatrix, UnpackVertexTangent(In.tangent)));
 #endif
-	Out.texCoord   = In.texCoord;
+	Out.texCoord   = UnpackVertexUV(In.texCoord);
 	return Out;
 }
\ No newline at end of file
@@ -21,12 +21,14 @@ cbuffer perModel
 	matrix worldViewProj;
 }
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float3 tangent  : TANGENT0;
-	float2 texCoord : TEXCOORD0;
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent  : TANGENT0;
+	VERTEX_UV_TYPE texCoord : TEXCOORD0;
 };
 
 struct PSIn
@@ -39,6 +41,6 @@ PSIn VSMain(VSIn In)
 {
 	PSIn Out;
 	Out.position = mul(worldViewProj, float4(In.position, 1));
-	Out.uv = In.texCoord;
+	Out.uv = UnpackVertexUV(In.texCoord);
 	return Out;
 }
\ No newline at end of file
@@ -17,12 +17,14 @@
 
 // source: http://richardssoftware.net/Home/Post/25
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float3 tangent	: TANGENT0;
-	float2 texCoord : TEXCOORD0;
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent	: TANGENT0;
+	VERTEX_UV_TYPE texCoord : TEXCOORD0;
 };
 
 struct PSIn
@@ -16,12 +16,14 @@
 //
 //	Contact: volkanilbeyli@gmail.com
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float3 tangent	: TANGENT0;
-	float2 texCoord : TEXCOORD0;
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent	: TANGENT0;
+	VERTEX_UV_TYPE texCoord : TEXCOORD0;
 };
 
 struct GSIn
@@ -40,11 +42,11 @@ cbuffer perObj
 
 GSIn VSMain(VSIn In)
 {
-	const float3 B = normalize(cross(In.normal, In.tangent));
+	const float3 B = normalize(cross(UnpackVertexNormal(In.normal), UnpackVertexTangent(In.tangent)));
 
 	GSIn Out;
-	Out.T	 = normalize(mul(normalMatrix, In.tangent));
-	Out.N	 = normalize(mul(normalMatrix, In.normal));
+	Out.T	 = normalize(mul(normalMatrix, UnpackVertexTangent(In.tangent)));
+	Out.N	 = normalize(mul(normalMatrix, UnpackVertexNormal(In.normal)));
 	Out.B	 = normalize(mul(normalMatrix, B));
 	Out.WorldPosition = mul(world, float4(In.position, 1)).xyz;
 	return Out;
@@ -29,12 +29,14 @@ cbuffer perModel
 	matrix worldViewProj;
 }
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float2 texCoord : TEXCOORD0;
-	float3 tangent	: TANGENT0;
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent	: TANGENT0;
+	VERTEX_UV_TYPE texCoord : TEXCOORD0;
 };
 
 struct PSIn
@@ -49,9 +51,9 @@ PSIn VSMain(VSIn In)
 {
 	PSIn Out;
     Out.position = mul(worldViewProj, float4(In.position, 1));
-    Out.normal   = mul(normalMatrix, In.normal);
-    Out.tangent  = mul(normalMatrix, In.tangent);
-    Out.texCoord = In.texCoord;
+    Out.normal   = mul(normalMatrix, UnpackVertexNormal(In.normal));
+    Out.tangent  = mul(normalMatrix, UnpackVertexTangent(In.tangent));
+    Out.texCoord = UnpackVertexUV(In.texCoord);
 	
 	return Out;
 }
\ No newline at end of file
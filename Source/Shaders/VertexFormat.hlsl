@@ -0,0 +1,63 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#ifndef _VERTEX_FORMAT_H
+#define _VERTEX_FORMAT_H
+
+// Mesh vertex inputs are either DefaultVertexBufferData or, when the engine is built with
+// PACKED_VERTEX_FORMAT, PackedVertexBufferData (see RenderingStructs.h). The vertex shaders
+// declare their inputs with the types below and decode them with the Unpack*() overloads,
+// which makes the same shader source work with both of the vertex formats.
+#ifndef PACKED_VERTEX_FORMAT
+#define PACKED_VERTEX_FORMAT 0
+#endif
+
+#if PACKED_VERTEX_FORMAT
+#define VERTEX_NORMAL_TYPE  uint	// octahedral, 2x16-bit SNORM
+#define VERTEX_TANGENT_TYPE uint	// octahedral, 2x16-bit SNORM
+#define VERTEX_UV_TYPE      uint	// 2x half
+#else
+#define VERTEX_NORMAL_TYPE  float3
+#define VERTEX_TANGENT_TYPE float3
+#define VERTEX_UV_TYPE      float2
+#endif
+
+inline float2 UnpackSNORM2x16(uint packed)
+{
+	const int2 v = asint(uint2(packed << 16, packed)) >> 16;	// sign extend
+	return max(float2(v) / 32767.0f, -1.0f);
+}
+
+inline float3 OctahedralDecode(float2 e)
+{
+	float3 v = float3(e, 1.0f - abs(e.x) - abs(e.y));
+	const float t = saturate(-v.z);
+	v.xy += (v.xy >= 0.0f) ? -t : t;	// component-wise
+	return normalize(v);
+}
+
+inline float3 UnpackVertexNormal(float3 n) { return n; }
+inline float3 UnpackVertexNormal(uint n)   { return OctahedralDecode(UnpackSNORM2x16(n)); }
+
+inline float3 UnpackVertexTangent(float3 t) { return t; }
+inline float3 UnpackVertexTangent(uint t)   { return OctahedralDecode(UnpackSNORM2x16(t)); }
+
+inline float2 UnpackVertexUV(float2 uv)    { return uv; }
+inline float2 UnpackVertexUV(uint uv)      { return f16tof32(uint2(uv, uv >> 16)); }
+
+#endif
@@ -17,12 +17,14 @@
 //	Contact: volkanilbeyli@gmail.com
 
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float3 tangent	: TANGENT0;
-	float2 uv		: TEXCOORD0;
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent	: TANGENT0;
+	VERTEX_UV_TYPE uv		: TEXCOORD0;
 #ifdef INSTANCED
 	uint instanceID : SV_InstanceID;
 #endif
@@ -84,22 +86,22 @@ PSIn VSMain(VSIn In)
 #ifdef INSTANCED
 	Out.position	 = mul(ObjMatrices[In.instanceID].worldViewProj, pos);
 	Out.viewPosition = mul(ObjMatrices[In.instanceID].worldView, pos).xyz;
-	Out.viewNormal	 = normalize(mul(ObjMatrices[In.instanceID].normalViewMatrix, In.normal));
-	Out.viewTangent	 = normalize(mul(ObjMatrices[In.instanceID].normalViewMatrix, In.tangent));
+	Out.viewNormal	 = normalize(mul(ObjMatrices[In.instanceID].normalViewMatrix, UnpackVertexNormal(In.normal)));
+	Out.viewTangent	 = normalize(mul(ObjMatrices[In.instanceID].normalViewMatrix, UnpackVertexTangent(In.tangent)));
 	Out.instanceID	 = In.instanceID;
 #else
 	//Out.position	 = mul(ObjMatrices.worldViewProj, pos);
 	float4 clipPos   = mul(ObjMatrices.worldViewProj, pos);
 	Out.viewPosition = mul(ObjMatrices.worldView, pos).xyz;
-	Out.viewNormal	 = normalize(mul(ObjMatrices.normalViewMatrix, half4(In.normal , 0))).rgb;
-	Out.viewTangent	 = normalize(mul(ObjMatrices.normalViewMatrix, float4(In.tangent, 0))).rgb;
+	Out.viewNormal	 = normalize(mul(ObjMatrices.normalViewMatrix, half4(UnpackVertexNormal(In.normal) , 0))).rgb;
+	Out.viewTangent	 = normalize(mul(ObjMatrices.normalViewMatrix, float4(UnpackVertexTangent(In.tangent), 0))).rgb;
 
 	const float fHeightIntensity = 0.90f;
 #if ENABLE_HEIGHTMAPPING
     if(HasHeightMap(surfaceMaterial.textureConfig) != 0)
     {
-        float Height = texHeightMap.SampleLevel(sNormalSampler, In.uv, 0).r;
-		float4 bumpedPos = float4(pos + normalize(In.normal) * Height * fHeightIntensity, 1.0f);
+        float Height = texHeightMap.SampleLevel(sNormalSampler, UnpackVertexUV(In.uv), 0).r;
+		float4 bumpedPos = float4(pos + normalize(UnpackVertexNormal(In.normal)) * Height * fHeightIntensity, 1.0f);
 		Out.position = mul(ObjMatrices.worldViewProj, bumpedPos);
 		Out.viewPosition = mul(ObjMatrices.worldView, bumpedPos).xyz;
 		//Out.position.xyz = clipPos.xyz;
@@ -111,6 +113,6 @@ PSIn VSMain(VSIn In)
 		Out.position = clipPos;
 	}
 #endif
-	Out.uv				= In.uv;
+	Out.uv				= UnpackVertexUV(In.uv);
 	return Out;
 }
\ No newline at end of file
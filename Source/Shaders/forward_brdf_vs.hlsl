@@ -40,12 +40,14 @@ cbuffer frame
 };
 
 
+#include "VertexFormat.hlsl"
+
 struct VSIn
 {
 	float3 position : POSITION;
-	float3 normal	: NORMAL;
-	float3 tangent	: TANGENT0;
-	float2 texCoord : TEXCOORD0;    
+	VERTEX_NORMAL_TYPE normal	: NORMAL;
+	VERTEX_TANGENT_TYPE tangent	: TANGENT0;
+	VERTEX_UV_TYPE texCoord : TEXCOORD0;    
 #ifdef INSTANCED
 	uint instanceID : SV_InstanceID;
 #endif
@@ -91,16 +93,16 @@ PSIn VSMain(VSIn In)
 #ifdef INSTANCED
 	Out.position = mul(ObjMatrices[In.instanceID].worldViewProj, pos);
 	Out.worldPos = mul(ObjMatrices[In.instanceID].world , pos).xyz;
-    Out.normal	 = normalize(mul(ObjMatrices[In.instanceID].normal, In.normal));
-    Out.tangent	 = normalize(mul(ObjMatrices[In.instanceID].normal, In.tangent));
+    Out.normal	 = normalize(mul(ObjMatrices[In.instanceID].normal, UnpackVertexNormal(In.normal)));
+    Out.tangent	 = normalize(mul(ObjMatrices[In.instanceID].normal, UnpackVertexTangent(In.tangent)));
 	Out.instanceID = In.instanceID;
 #else
 	Out.position = mul(ObjMatrices.worldViewProj, pos);
 	Out.worldPos = mul(ObjMatrices.world , pos).xyz;
-    Out.normal	 = normalize(mul(ObjMatrices.normal, In.normal));
-    Out.tangent	 = normalize(mul(ObjMatrices.normal, In.tangent));
+    Out.normal	 = normalize(mul(ObjMatrices.normal, UnpackVertexNormal(In.normal)));
+    Out.tangent	 = normalize(mul(ObjMatrices.normal, UnpackVertexTangent(In.tangent)));
 #endif
-	Out.texCoord = In.texCoord;
+	Out.texCoord = UnpackVertexUV(In.texCoord);
 	Out.lightSpacePos = mul(lightSpaceMat, float4(Out.worldPos, 1));
 
     //float3 B = normalize(cross(Out.normal, Out.tangent));
@@ -0,0 +1,189 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark for the batch frustum culling of BatchCulling.h.
+//
+// Culls 13-1M random boxes around a camera with
+//  - the scalar path  : IsBoundingBoxVisibleFromFrustum() per box (corner point test)
+//  - the SIMD paths   : CullBoundingBoxes() (index list) & CullBoundingBoxes_VisibilityMask() (bitmask)
+// and fails if the SIMD results differ from the scalar ones. The box counts that are not a multiple
+// of the SIMD width test the padding of BoundingBoxSoA. Random sub-ranges checked with
+// CullBoundingBoxRange() test the lane masking used for the BVH leaves (SceneBVH::QueryFrustum()).
+//
+// BatchCulling.h/.cpp don't depend on DirectXMath or D3D, so the benchmark builds on its own.
+// Build & run from the repository root (drop -mavx for the 4-wide SSE path):
+//  g++ -std=c++17 -O2 -mavx -ISource/Engine Source/Utilities/Benchmarks/FrustumCullingBenchmark.cpp Source/Engine/Source/BatchCulling.cpp -o FrustumCullingBenchmark
+//  ./FrustumCullingBenchmark [numIterations]
+// or in a x64 Native Tools Command Prompt:
+//  cl /std:c++17 /O2 /EHsc /arch:AVX /ISource\Engine Source\Utilities\Benchmarks\FrustumCullingBenchmark.cpp Source\Engine\Source\BatchCulling.cpp
+//  FrustumCullingBenchmark.exe [numIterations]
+//
+#include "BatchCulling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace VQEngine;
+
+// planes of a left handed perspective projection (XMMatrixPerspectiveFovLH) for a camera at
+// the origin looking down +Z, extracted the same way as FrustumPlaneset::ExtractFromMatrix().
+static CullingPlanes MakePerspectiveFrustum(float fovY, float aspectRatio, float zNear, float zFar)
+{
+	const float yScale = 1.0f / std::tan(fovY * 0.5f);
+	const float xScale = yScale / aspectRatio;
+	const float zRange = zFar / (zFar - zNear);
+	const float m[4][4] =
+	{
+		{ xScale, 0.0f  , 0.0f           , 0.0f },
+		{ 0.0f  , yScale, 0.0f           , 0.0f },
+		{ 0.0f  , 0.0f  , zRange         , 1.0f },
+		{ 0.0f  , 0.0f  , -zNear * zRange, 0.0f },
+	};
+
+	CullingPlanes frustum;
+	for (int i = 0; i < 4; ++i)
+	{
+		frustum.abcd[0][i] = m[i][3] - m[i][0]; // right
+		frustum.abcd[1][i] = m[i][3] + m[i][0]; // left
+		frustum.abcd[2][i] = m[i][3] - m[i][1]; // top
+		frustum.abcd[3][i] = m[i][3] + m[i][1]; // bottom
+		frustum.abcd[4][i] = m[i][3] - m[i][2]; // far
+		frustum.abcd[5][i] = m[i][2];           // near
+	}
+	return frustum;
+}
+
+static BoundingBoxSoA GenerateBoxes(size_t numBoxes, float sceneExtent, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-sceneExtent, sceneExtent);
+	std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+	BoundingBoxSoA aabbs;
+	aabbs.Reserve(numBoxes);
+	for (size_t i = 0; i < numBoxes; ++i)
+	{
+		const float cx = position(rng), cy = position(rng), cz = position(rng);
+		const float ex = size(rng), ey = size(rng), ez = size(rng);
+		aabbs.AddBoundingBox(cx, cy, cz, ex, ey, ez);
+	}
+	return aabbs;
+}
+
+// best time of @numIterations runs of @fnCull in milliseconds
+template<class TFnCull>
+static double Measure(int numIterations, TFnCull&& fnCull)
+{
+	double bestMs = 1e30;
+	for (int i = 0; i < numIterations; ++i)
+	{
+		const auto begin = std::chrono::high_resolution_clock::now();
+		fnCull();
+		const auto end = std::chrono::high_resolution_clock::now();
+		const double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+		bestMs = ms < bestMs ? ms : bestMs;
+	}
+	return bestMs;
+}
+
+int main(int argc, char** argv)
+{
+	const int numIterations = argc > 1 ? std::atoi(argv[1]) : 5;
+
+	// camera at origin looking down +Z, boxes scattered around it
+	const CullingPlanes frustum = MakePerspectiveFrustum(60.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	constexpr size_t BenchmarkSizes[] = { 13, 1003, 10000, 100000, 1000000 };
+	constexpr float  SceneExtent = 800.0f;
+
+	bool bAllResultsMatch = true;
+	std::printf("Frustum culling, best of %d runs\n", numIterations);
+	for (const size_t numBoxes : BenchmarkSizes)
+	{
+		const BoundingBoxSoA aabbsSoA = GenerateBoxes(numBoxes, SceneExtent, static_cast<unsigned>(numBoxes));
+
+		std::vector<int> visibleIndicesScalar;
+		visibleIndicesScalar.reserve(numBoxes);
+		const double msScalar = Measure(numIterations, [&]()
+		{
+			visibleIndicesScalar.clear();
+			for (size_t i = 0; i < numBoxes; ++i)
+			{
+				if (IsBoundingBoxVisibleFromFrustum(frustum, aabbsSoA, i))
+					visibleIndicesScalar.push_back(static_cast<int>(i));
+			}
+		});
+
+		std::vector<int> visibleIndicesSIMD;
+		visibleIndicesSIMD.reserve(numBoxes);
+		size_t numCulled = 0;
+		const double msSIMD = Measure(numIterations, [&]() { numCulled = CullBoundingBoxes(frustum, aabbsSoA, visibleIndicesSIMD); });
+
+		std::vector<uint32_t> visibilityMask;
+		visibilityMask.reserve(numBoxes / 32 + 1);
+		size_t numVisibleMask = 0;
+		const double msSIMDMask = Measure(numIterations, [&]() { numVisibleMask = CullBoundingBoxes_VisibilityMask(frustum, aabbsSoA, visibilityMask); });
+
+		// the SIMD paths have to agree with the scalar path box by box
+		bool bResultsMatch = visibleIndicesScalar == visibleIndicesSIMD
+			&& numCulled == numBoxes - visibleIndicesScalar.size()
+			&& numVisibleMask == visibleIndicesScalar.size();
+		size_t iVisible = 0;
+		for (size_t i = 0; bResultsMatch && i < visibilityMask.size() * 32; ++i)
+		{
+			const bool bVisible = (visibilityMask[i / 32] >> (i % 32)) & 1u;
+			const bool bVisibleScalar = iVisible < visibleIndicesScalar.size() && visibleIndicesScalar[iVisible] == static_cast<int>(i);
+			bResultsMatch = bVisible == bVisibleScalar;
+			iVisible += bVisibleScalar ? 1 : 0;
+		}
+
+		// ranges of BVH leaf sizes up to a few SIMD widths, unaligned on both ends
+		std::mt19937 rng(static_cast<unsigned>(numBoxes));
+		std::vector<int> visibleIndicesRange;
+		for (int iRange = 0; bResultsMatch && iRange < 1000; ++iRange)
+		{
+			const size_t first = rng() % numBoxes;
+			const size_t count = (std::min)(static_cast<size_t>(rng() % 20), numBoxes - first);
+			visibleIndicesRange.clear();
+			const size_t numVisibleRange = CullBoundingBoxRange(frustum, aabbsSoA, first, count, visibleIndicesRange);
+
+			const auto itBegin = std::lower_bound(visibleIndicesScalar.begin(), visibleIndicesScalar.end(), static_cast<int>(first));
+			const auto itEnd   = std::lower_bound(visibleIndicesScalar.begin(), visibleIndicesScalar.end(), static_cast<int>(first + count));
+			bResultsMatch = numVisibleRange == visibleIndicesRange.size()
+				&& std::equal(itBegin, itEnd, visibleIndicesRange.begin(), visibleIndicesRange.end());
+		}
+		bAllResultsMatch = bAllResultsMatch && bResultsMatch;
+
+		std::printf("%7zu boxes | visible: %7zu | scalar: %8.3f ms | SIMD (indices): %8.3f ms (x%.1f) | SIMD (bitmask): %8.3f ms (x%.1f) | %s\n"
+			, numBoxes
+			, visibleIndicesScalar.size()
+			, msScalar
+			, msSIMD, msScalar / (msSIMD > 1e-6 ? msSIMD : 1e-6)
+			, msSIMDMask, msScalar / (msSIMDMask > 1e-6 ? msSIMDMask : 1e-6)
+			, bResultsMatch ? "match" : "DIFFER"
+		);
+	}
+
+	std::printf("Results %s\n", bAllResultsMatch ? "match" : "DIFFER");
+	return bAllResultsMatch ? 0 : 1;
+}
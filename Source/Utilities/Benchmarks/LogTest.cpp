@@ -0,0 +1,161 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+
+// Test for the log thread of Utilities/Log.h.
+//
+// Captures the console output of the log and checks that
+//  - std::string messages longer than LEN_MSG_BUFFER come out complete, before Initialize(), while 
+//    the log thread runs (from several threads, including messages longer than the thread buffers)
+//    and after Exit()
+//  - the messages of a thread keep their order around the long messages written on the calling thread
+//  - the messages logged by other threads while Exit() stops the log thread aren't lost
+//
+// Log.cpp uses the workspace directory of the Application for the log file, hence the test links the
+// static libraries of the solution. Build & run from the repository root in a x64 Native Tools Command
+// Prompt after building the solution in Release|x64:
+//  cl /std:c++17 /O2 /EHsc /ISource /ISource\Renderer Source\Utilities\Benchmarks\LogTest.cpp /link /LIBPATH:Build\Engine\x64\Release /LIBPATH:Build\Renderer\x64\Release /LIBPATH:Build\Application\x64\Release /LIBPATH:Build\Utilities\x64\Release /LIBPATH:Source\3rdParty\DirectXTex\DirectXTex\Bin\Desktop_2015\x64\Release Engine.lib Renderer.lib Application.lib Utilities.lib DirectXTex.lib user32.lib
+//  LogTest.exe
+//
+#include "Utilities/Log.h"
+#include "Engine/Settings.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int sNumFailedChecks = 0;
+#define CHECK(expr) do { if (!(expr)) { std::printf("  FAILED: %s (line %d)\n", #expr, __LINE__); ++sNumFailedChecks; } } while (0)
+
+// "<tag>:" followed by @length characters and a closing '|', so that a cut off message doesn't match
+static std::string MakeLongMessage(const std::string& tag, size_t length)
+{
+	std::string msg = tag + ":";
+	for (size_t i = 0; i < length; ++i)
+		msg += static_cast<char>('a' + i % 26);
+	return msg + "|";
+}
+
+static size_t CountOccurrences(const std::string& output, const std::string& str)
+{
+	size_t count = 0;
+	for (size_t pos = output.find(str); pos != std::string::npos; pos = output.find(str, pos + str.size()))
+		++count;
+	return count;
+}
+
+int main()
+{
+	std::ostringstream output;
+	std::streambuf* pConsoleBuffer = std::cout.rdbuf(output.rdbuf());
+
+	const std::string beforeInit = MakeLongMessage("BeforeInitialize", 5000);
+	Log::Info(beforeInit);
+
+	const Settings::Logger settings = { false, false };
+	Log::Initialize(settings);
+
+	// the long messages of a thread between its short ones, some longer than the thread buffers
+	const std::vector<size_t> LENGTHS = { Log::LEN_MSG_BUFFER + 1, 10000, Log::MAX_BUFFERED_MSG_LENGTH + 1, 3 * Log::THREAD_BUFFER_SIZE };
+	constexpr int NUM_THREADS = 4;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NUM_THREADS; ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (size_t i = 0; i < LENGTHS.size(); ++i)
+			{
+				Log::Info("Thread%d Before%zu", t, i);
+				Log::Warning(MakeLongMessage("Thread" + std::to_string(t) + "Long" + std::to_string(i), LENGTHS[i]));
+				Log::Info("Thread%d After%zu", t, i);
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	// messages logged while the log thread stops
+	std::atomic<bool> bStop { false };
+	std::atomic<int> numExitMessages { 0 };
+	std::thread exitLogger([&]()
+	{
+		for (int i = 0; !bStop; ++i, ++numExitMessages)
+		{
+			Log::Info("Exit%d|", i);
+			if (i % 16 == 0)	// stay under the throughput of the log thread so that the buffer doesn't fill up
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	Log::Exit();
+	bStop = true;
+	exitLogger.join();
+
+	const std::string afterExit = MakeLongMessage("AfterExit", 5000);
+	Log::Error(afterExit);
+
+	std::cout.rdbuf(pConsoleBuffer);
+	const std::string log = output.str();
+
+	// CHECKS
+	//
+	CHECK(CountOccurrences(log, beforeInit) == 1);
+	CHECK(CountOccurrences(log, afterExit) == 1);
+	for (int t = 0; t < NUM_THREADS; ++t)
+	{
+		size_t prevPosition = 0;
+		for (size_t i = 0; i < LENGTHS.size(); ++i)
+		{
+			const std::string tag = "Thread" + std::to_string(t);
+			const size_t before = log.find(tag + " Before" + std::to_string(i));
+			const size_t message = log.find(MakeLongMessage(tag + "Long" + std::to_string(i), LENGTHS[i]));
+			const size_t after = log.find(tag + " After" + std::to_string(i));
+			CHECK(message != std::string::npos);
+			CHECK(before != std::string::npos && after != std::string::npos);
+			CHECK(prevPosition <= before && before < message && message < after);
+			prevPosition = after;
+		}
+	}
+
+	// the messages that weren't dropped for a full thread buffer are all there, each once
+	std::vector<int> exitMessageCounts(numExitMessages, 0);
+	for (size_t pos = log.find("]:Exit"); pos != std::string::npos; pos = log.find("]:Exit", pos + 1))
+	{
+		const int i = std::atoi(log.c_str() + pos + 6);
+		if (i >= 0 && i < numExitMessages)
+			++exitMessageCounts[i];
+	}
+	int numExitMessagesFound = 0;
+	for (const int count : exitMessageCounts)
+	{
+		CHECK(count <= 1);
+		numExitMessagesFound += count == 1 ? 1 : 0;
+	}
+	const size_t numDropped = CountOccurrences(log, "messages dropped");
+	CHECK(numExitMessagesFound == numExitMessages || numDropped > 0);
+	std::printf("%zu bytes logged, %d / %d messages logged during Exit() found\n", log.size(), numExitMessagesFound, numExitMessages.load());
+
+	std::printf("%s\n", sNumFailedChecks == 0 ? "All checks passed" : "FAILED");
+	return sNumFailedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+// CPU-only vertex cache simulation of the built-in meshes and of sponza (MeshOptimizer.h).
+//
+// Generates the LOD levels of the built-in meshes with the parameters of Scene::InitializeBuiltinMeshes()
+// and optimizes them the way the engine does (GeometryGenerator::OptimizeBuiltinMesh()). Reports the ACMR
+// & ATVR of a FIFO post-transform cache before and after the optimization, and checks that
+//  - the ACMR doesn't get worse
+//  - every LOD level keeps the same triangles with the same winding
+//  - the vertices are ordered by their first reference in the index buffer
+//
+// The sponza meshes are read from the cooked model file (ModelCache.h) the engine writes to
+// %LOCALAPPDATA%\VQEngine\ModelCache\ when it loads the sponza scene, so neither Assimp nor the model
+// source is needed. The cooked buffers are already optimized by the import (Model.cpp: ProcessMesh()),
+// hence the triangles of each LOD level are shuffled first and then optimized the way the import does,
+// with the overdraw sort. The same checks run per mesh except the ACMR & ATVR, which are checked on the
+// totals of the model as the overdraw sort may trade a little vertex cache efficiency on small meshes.
+// The sponza case is skipped when no cooked model file is passed.
+//
+// GeometryGenerator lives in the Renderer, hence the test links the static libraries of the solution.
+// No graphics device is created: only the CPU-side mesh data is generated. Build & run from the repository
+// root in a x64 Native Tools Command Prompt after building the solution in Release|x64:
+//  cl /std:c++17 /O2 /EHsc /ISource /ISource\Renderer Source\Utilities\Benchmarks\MeshOptimizerTest.cpp /link /LIBPATH:Build\Engine\x64\Release /LIBPATH:Build\Renderer\x64\Release /LIBPATH:Build\Application\x64\Release /LIBPATH:Build\Utilities\x64\Release /LIBPATH:Source\3rdParty\DirectXTex\DirectXTex\Bin\Desktop_2015\x64\Release Engine.lib Renderer.lib Application.lib Utilities.lib DirectXTex.lib
+//  MeshOptimizerTest.exe [%LOCALAPPDATA%\VQEngine\ModelCache\sponza_<hash>.vqmodel]
+//
+#include "Renderer/GeometryGenerator.h"
+#include "Renderer/MeshOptimizer.h"
+#include "Engine/ModelCache.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <vector>
+
+static int sNumFailedChecks = 0;
+#define CHECK(expr) do { if (!(expr)) { std::printf("  FAILED: %s (line %d)\n", #expr, __LINE__); ++sNumFailedChecks; } } while (0)
+
+using MeshData = MeshLODData<DefaultVertexBufferData>;
+
+// the triangles of a mesh by their corner positions, each rotated to start with its smallest corner
+// so that the winding is kept while the index & vertex order doesn't matter.
+using TriangleKey = std::array<float, 9>;
+static std::map<TriangleKey, int> GetTriangles(const std::vector<DefaultVertexBufferData>& vertices, const std::vector<unsigned>& indices)
+{
+	std::map<TriangleKey, int> triangles;
+	for (size_t tri = 0; tri < indices.size(); tri += 3)
+	{
+		std::array<std::array<float, 3>, 3> corners;
+		for (int i = 0; i < 3; ++i)
+		{
+			const vec3& p = vertices[indices[tri + i]].position;
+			corners[i] = { p.x(), p.y(), p.z() };
+		}
+		const int first = static_cast<int>(std::min_element(corners.begin(), corners.end()) - corners.begin());
+
+		TriangleKey key;
+		for (int i = 0; i < 3; ++i)
+			std::copy(corners[(first + i) % 3].begin(), corners[(first + i) % 3].end(), key.begin() + i * 3);
+		++triangles[key];
+	}
+	return triangles;
+}
+
+static bool IsVertexFetchOrdered(const std::vector<DefaultVertexBufferData>& vertices, const std::vector<unsigned>& indices)
+{
+	unsigned nextVertex = 0;
+	for (unsigned index : indices)
+	{
+		if (index > nextVertex)
+			return false;
+		nextVertex += index == nextVertex ? 1 : 0;
+	}
+	return nextVertex == vertices.size();
+}
+
+// optimizes @meshData with @fnOptimize(meshData) and checks the triangles & the vertex order of each LOD level
+template<class TFnOptimize>
+static MeshOptimizer::Report OptimizeAndCheck(MeshData& meshData, TFnOptimize&& fnOptimize)
+{
+	std::vector<std::map<TriangleKey, int>> sourceTriangles;
+	std::vector<size_t> sourceIndexCounts;
+	for (size_t lod = 0; lod < meshData.LODIndices.size(); ++lod)
+	{
+		sourceTriangles.push_back(GetTriangles(meshData.LODVertices[lod], meshData.LODIndices[lod]));
+		sourceIndexCounts.push_back(meshData.LODIndices[lod].size());
+	}
+
+	const MeshOptimizer::Report report = fnOptimize(meshData);
+
+	CHECK(report.after.numTriangles == report.before.numTriangles);
+	for (size_t lod = 0; lod < meshData.LODIndices.size(); ++lod)
+	{
+		const std::vector<DefaultVertexBufferData>& vertices = meshData.LODVertices[lod];
+		const std::vector<unsigned>& indices = meshData.LODIndices[lod];
+		CHECK(indices.size() == sourceIndexCounts[lod]);
+		CHECK(GetTriangles(vertices, indices) == sourceTriangles[lod]);
+		if (indices.size() >= 3) // Optimize() skips the empty levels
+			CHECK(IsVertexFetchOrdered(vertices, indices));
+	}
+	return report;
+}
+
+static void PrintReport(const char* pName, size_t numMeshes, size_t numLODs, const MeshOptimizer::Report& report, double ms)
+{
+	std::printf("%-16s %4zu meshes %4zu LODs %7zu triangles | ACMR %.3f -> %.3f | ATVR %.3f -> %.3f | %.2f ms\n"
+		, pName, numMeshes, numLODs, report.before.numTriangles
+		, report.before.GetACMR(), report.after.GetACMR()
+		, report.before.GetATVR(), report.after.GetATVR()
+		, ms);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+static void Run(const char* pName, MeshData meshData)
+{
+	const auto begin = std::chrono::high_resolution_clock::now();
+	const MeshOptimizer::Report report = OptimizeAndCheck(meshData, [](MeshData& data) { return GeometryGenerator::OptimizeBuiltinMesh(data); });
+	const auto end = std::chrono::high_resolution_clock::now();
+	PrintReport(pName, 1, meshData.LODIndices.size(), report, std::chrono::duration<double, std::milli>(end - begin).count());
+
+	CHECK(report.after.GetACMR() <= report.before.GetACMR());
+	CHECK(report.after.GetATVR() <= report.before.GetATVR());
+}
+
+//----------------------------------------------------------------------------------------------------------------
+static void ShuffleTriangles(std::vector<unsigned>& indices, std::mt19937& rng)
+{
+	std::vector<std::array<unsigned, 3>> triangles(indices.size() / 3);
+	std::memcpy(triangles.data(), indices.data(), triangles.size() * sizeof(triangles[0]));
+	std::shuffle(triangles.begin(), triangles.end(), rng);
+	std::memcpy(indices.data(), triangles.data(), triangles.size() * sizeof(triangles[0]));
+}
+
+static void RunCookedModel(const char* pName, const char* pCookedModelPath)
+{
+	std::ifstream file(pCookedModelPath, std::ios::binary | std::ios::ate);
+	CHECK(file.good());
+	if (!file)
+	{
+		std::printf("%-16s cannot open %s\n", pName, pCookedModelPath);
+		return;
+	}
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(data.data(), data.size());
+
+	// the import settings hash is private to Model.cpp: accept the settings the file was cooked with,
+	// Initialize() still validates the layout and the index ranges.
+	ModelCache::FileHeader header = {};
+	std::memcpy(&header, data.data(), (std::min)(data.size(), sizeof(header)));
+	ModelCache::CookedModel cookedModel;
+	const bool bValidCookedModel = cookedModel.Initialize(data.data(), data.size(), header.importSettingsHash);
+	CHECK(bValidCookedModel);
+	if (!bValidCookedModel)
+		return;
+
+	std::mt19937 rng(12345);
+	MeshOptimizer::Report total;
+	MeshOptimizer::VertexCacheStatistics cooked;
+	size_t numLODs = 0;
+	double ms = 0.0;
+	for (size_t mesh = 0; mesh < cookedModel.GetNumMeshes(); ++mesh)
+	{
+		const ModelCache::MeshRecord& meshRecord = cookedModel.GetMesh(mesh);
+		MeshData meshData(meshRecord.numLODs, pName);
+		for (uint32_t lod = 0; lod < meshRecord.numLODs; ++lod)
+		{
+			const LODLevelData level = cookedModel.GetMeshLOD(mesh, lod);
+			const DefaultVertexBufferData* pVertices = static_cast<const DefaultVertexBufferData*>(level.pVertices);
+			const unsigned* pIndices = static_cast<const unsigned*>(level.pIndices);
+			meshData.LODVertices[lod].assign(pVertices, pVertices + level.numVertices);
+			meshData.LODIndices[lod].assign(pIndices, pIndices + level.numIndices);
+
+			cooked += MeshOptimizer::AnalyzeVertexCache(meshData.LODIndices[lod], level.numVertices);
+			ShuffleTriangles(meshData.LODIndices[lod], rng);
+		}
+		numLODs += meshRecord.numLODs;
+
+		const auto begin = std::chrono::high_resolution_clock::now();
+		const MeshOptimizer::Report report = OptimizeAndCheck(meshData, [](MeshData& data) { return MeshOptimizer::Optimize(data, true); }); // OPTIMIZE_OVERDRAW_FOR_IMPORTED_MESHES
+		const auto end = std::chrono::high_resolution_clock::now();
+		ms += std::chrono::duration<double, std::milli>(end - begin).count();
+		total.before += report.before;
+		total.after += report.after;
+	}
+	PrintReport(pName, cookedModel.GetNumMeshes(), numLODs, total, ms);
+	std::printf("%-16s as cooked: ACMR %.3f | ATVR %.3f\n", "", cooked.GetACMR(), cooked.GetATVR());
+
+	CHECK(total.after.GetACMR() <= total.before.GetACMR());
+	CHECK(total.after.GetATVR() <= total.before.GetATVR());
+	CHECK(cooked.GetACMR() <= total.before.GetACMR()); // the import optimized the cooked buffers
+}
+
+int main(int argc, char** argv)
+{
+	// Scene::InitializeBuiltinMeshes()
+	Run("BuiltinCylinder", GeometryGenerator::CylinderData(3.1415f, 1.0f, 1.0f, 70, 20, 6));
+	Run("BuiltinSphere"  , GeometryGenerator::SphereData(2.0f, 70, 70, 5));
+	Run("BuiltinGrid"    , GeometryGenerator::GridData(1.0f, 1.0f, 90, 90, 7));
+	Run("BuiltinCone"    , GeometryGenerator::ConeData(3.0f, 1.0f, 120, 6));
+	Run("BuiltinLightCue", GeometryGenerator::ConeData(1.0f, 1.0f, 30));
+
+	if (argc > 1)
+		RunCookedModel("Sponza", argv[1]);
+	else
+		std::printf("Sponza           skipped: pass the cooked sponza model file to include it\n");
+
+	std::printf("%s\n", sNumFailedChecks == 0 ? "All checks passed" : "FAILED");
+	return sNumFailedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+// CPU-only test for the LOD chain generation of the model loader (MeshSimplifier.h).
+//
+// Simplifies a UV sphere and a flat grid without a graphics device and checks
+//  - the triangle count of each LOD level against the requested ratio of the source mesh
+//  - the reported error: increases with the LOD level and bounds the measured deviation from the sphere
+//  - the maxError limit of Simplify() and the preserved UV seam & open borders
+//  - the compacted vertex buffers of the simplified levels (no unreferenced vertices)
+//
+// The simplifier uses the engine's vector types (DirectXMath), hence it links the static libraries
+// of the solution. Build & run from the repository root in a x64 Native Tools Command Prompt after
+// building the solution in Release|x64:
+//  cl /std:c++17 /O2 /EHsc /ISource /ISource\Renderer Source\Utilities\Benchmarks\MeshSimplifierTest.cpp /link /LIBPATH:Build\Renderer\x64\Release /LIBPATH:Build\Utilities\x64\Release Renderer.lib Utilities.lib
+//  MeshSimplifierTest.exe
+//
+#include "Renderer/MeshSimplifier.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int sNumFailedChecks = 0;
+#define CHECK(expr) do { if (!(expr)) { std::printf("  FAILED: %s (line %d)\n", #expr, __LINE__); ++sNumFailedChecks; } } while (0)
+
+using Vertices = std::vector<DefaultVertexBufferData>;
+using Indices  = std::vector<unsigned>;
+
+// UV sphere with a duplicated column of vertices on the UV seam (u = 0 & u = 1)
+static void GenerateSphere(float radius, unsigned numRings, unsigned numSlices, Vertices& vertices, Indices& indices)
+{
+	const float PI_F = 3.14159265f;
+	for (unsigned ring = 0; ring <= numRings; ++ring)
+	{
+		for (unsigned slice = 0; slice <= numSlices; ++slice)
+		{
+			const float phi   = PI_F * ring / numRings;
+			const float theta = 2.0f * PI_F * slice / numSlices;
+			DefaultVertexBufferData v = {};
+			v.position = vec3(radius * sinf(phi) * cosf(theta), radius * cosf(phi), radius * sinf(phi) * sinf(theta));
+			v.normal   = vec3(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+			v.uv       = vec2(float(slice) / numSlices, float(ring) / numRings);
+			vertices.push_back(v);
+		}
+	}
+	for (unsigned ring = 0; ring < numRings; ++ring)
+	{
+		for (unsigned slice = 0; slice < numSlices; ++slice)
+		{
+			const unsigned i0 = ring * (numSlices + 1) + slice;
+			const unsigned i1 = i0 + 1;
+			const unsigned i2 = i0 + numSlices + 1;
+			const unsigned i3 = i2 + 1;
+			if (ring != 0)             indices.insert(indices.end(), { i0, i1, i2 }); // no degenerate triangles at the poles
+			if (ring != numRings - 1)  indices.insert(indices.end(), { i1, i3, i2 });
+		}
+	}
+}
+
+// flat grid of n x n quads on the XZ plane
+static void GenerateGrid(unsigned n, Vertices& vertices, Indices& indices)
+{
+	for (unsigned i = 0; i <= n; ++i)
+	{
+		for (unsigned j = 0; j <= n; ++j)
+		{
+			DefaultVertexBufferData v = {};
+			v.position = vec3(float(j), 0.0f, float(i));
+			v.normal   = vec3(0.0f, 1.0f, 0.0f);
+			v.uv       = vec2(float(j) / n, float(i) / n);
+			vertices.push_back(v);
+		}
+	}
+	for (unsigned i = 0; i < n; ++i)
+	{
+		for (unsigned j = 0; j < n; ++j)
+		{
+			const unsigned i0 = i * (n + 1) + j;
+			const unsigned i1 = i0 + 1;
+			const unsigned i2 = i0 + n + 1;
+			const unsigned i3 = i2 + 1;
+			indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+		}
+	}
+}
+
+// largest distance of the triangle centroids and edge midpoints from the sphere surface
+static double GetMaxDeviationFromSphere(const Vertices& vertices, const Indices& indices, double radius)
+{
+	double maxDeviation = 0.0;
+	for (size_t tri = 0; tri < indices.size(); tri += 3)
+	{
+		const vec3& p0 = vertices[indices[tri + 0]].position;
+		const vec3& p1 = vertices[indices[tri + 1]].position;
+		const vec3& p2 = vertices[indices[tri + 2]].position;
+		const float weights[4][3] = { { 1/3.0f, 1/3.0f, 1/3.0f }, { 0.5f, 0.5f, 0.0f }, { 0.0f, 0.5f, 0.5f }, { 0.5f, 0.0f, 0.5f } };
+		for (const float* w : weights)
+		{
+			const double x = w[0] * p0.x() + w[1] * p1.x() + w[2] * p2.x();
+			const double y = w[0] * p0.y() + w[1] * p1.y() + w[2] * p2.y();
+			const double z = w[0] * p0.z() + w[1] * p1.z() + w[2] * p2.z();
+			maxDeviation = (std::max)(maxDeviation, std::fabs(radius - std::sqrt(x * x + y * y + z * z)));
+		}
+	}
+	return maxDeviation;
+}
+
+static bool AreAllVerticesReferenced(const Vertices& vertices, const Indices& indices)
+{
+	std::vector<bool> bReferenced(vertices.size(), false);
+	for (unsigned index : indices)
+	{
+		if (index >= vertices.size())
+			return false;
+		bReferenced[index] = true;
+	}
+	return std::find(bReferenced.begin(), bReferenced.end(), false) == bReferenced.end();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+static void TestSphereLODChain()
+{
+	const float    RADIUS = 2.0f;
+	const unsigned NUM_RINGS = 100;
+	const unsigned NUM_SLICES = 100;
+	const std::vector<float> TRIANGLE_RATIOS = { 0.5f, 0.25f, 0.125f };
+
+	Vertices vertices; Indices indices;
+	GenerateSphere(RADIUS, NUM_RINGS, NUM_SLICES, vertices, indices);
+	const size_t numSourceTriangles = indices.size() / 3;
+
+	const auto begin = std::chrono::high_resolution_clock::now();
+	const MeshLODData<DefaultVertexBufferData> lodData = MeshSimplifier::GenerateLODChain(vertices, indices, TRIANGLE_RATIOS, "TestSphere");
+	const auto end = std::chrono::high_resolution_clock::now();
+	std::printf("Sphere: %zu triangles, LOD chain in %.1f ms\n", numSourceTriangles, std::chrono::duration<double, std::milli>(end - begin).count());
+
+	CHECK(lodData.LODIndices.size() == TRIANGLE_RATIOS.size() + 1);
+	CHECK(lodData.LODVertices.size() == lodData.LODIndices.size());
+	CHECK(lodData.LODErrors.size() == lodData.LODIndices.size());
+	if (lodData.LODErrors.size() != lodData.LODIndices.size())
+		return;
+
+	// LODErrors are relative to the bounding sphere radius of the source mesh, i.e. the half diagonal of its bounding box
+	const double boundingRadius = RADIUS * std::sqrt(3.0);
+	const double sourceDeviation = GetMaxDeviationFromSphere(vertices, indices, RADIUS); // tessellation of the source mesh
+	for (size_t lod = 0; lod < lodData.LODIndices.size(); ++lod)
+	{
+		const Vertices& lodVertices = lodData.LODVertices[lod];
+		const Indices&  lodIndices  = lodData.LODIndices[lod];
+		const size_t numTriangles = lodIndices.size() / 3;
+		const size_t numTargetTriangles = lod == 0 ? numSourceTriangles : static_cast<size_t>(TRIANGLE_RATIOS[lod - 1] * numSourceTriangles);
+		const double error = lodData.LODErrors[lod] * boundingRadius;
+		const double deviation = GetMaxDeviationFromSphere(lodVertices, lodIndices, RADIUS);
+		std::printf("  LOD%zu: %6zu triangles (target %6zu) %6zu vertices | error %.5f | measured deviation %.5f\n"
+			, lod, numTriangles, numTargetTriangles, lodVertices.size(), error, deviation);
+
+		CHECK(lodIndices.size() % 3 == 0);
+		CHECK(numTriangles <= numTargetTriangles);
+		CHECK(numTriangles >= numTargetTriangles * 9 / 10); // the sphere is not limited by its locked seam
+		if (lod == 0)
+		{
+			CHECK(lodData.LODErrors[lod] == 0.0f);
+			continue;
+		}
+
+		CHECK(AreAllVerticesReferenced(lodVertices, lodIndices));
+		CHECK(lodData.LODErrors[lod] > lodData.LODErrors[lod - 1]);
+		CHECK(deviation <= sourceDeviation + 2.0 * error); // the error is an estimate of the surface deviation, not a strict bound
+
+		// the vertices on the UV seam are locked: the seam keeps all of its vertices except the poles
+		size_t numSeamVertices = 0;
+		for (const DefaultVertexBufferData& v : lodVertices)
+		{
+			const bool bSeam = v.uv.x() == 0.0f || v.uv.x() == 1.0f;
+			const bool bPole = v.uv.y() == 0.0f || v.uv.y() == 1.0f;
+			numSeamVertices += bSeam && !bPole ? 1 : 0;
+		}
+		CHECK(numSeamVertices == 2 * (NUM_RINGS - 1));
+	}
+}
+
+static void TestErrorLimit()
+{
+	// flat grid: the interior collapses without error while the open borders are locked
+	{
+		const unsigned N = 64;
+		Vertices vertices; Indices indices;
+		GenerateGrid(N, vertices, indices);
+
+		float error = -1.0f;
+		const Indices simplified = MeshSimplifier::Simplify(vertices, indices, 0, 1e-4f, &error);
+		std::printf("Grid: %zu -> %zu triangles, error %.6f\n", indices.size() / 3, simplified.size() / 3, error);
+		CHECK(error >= 0.0f && error <= 1e-4f);
+		CHECK(simplified.size() * 4 < indices.size());
+
+		std::vector<bool> bReferenced(vertices.size(), false);
+		for (unsigned index : simplified)
+			bReferenced[index] = true;
+		bool bBorderKept = true;
+		for (unsigned i = 0; i <= N; ++i)
+		{
+			bBorderKept = bBorderKept && bReferenced[i] && bReferenced[N * (N + 1) + i];   // bottom & top rows
+			bBorderKept = bBorderKept && bReferenced[i * (N + 1)] && bReferenced[i * (N + 1) + N]; // left & right columns
+		}
+		CHECK(bBorderKept);
+	}
+
+	// curved mesh: simplification stops at the error limit before reaching the target
+	{
+		const float MAX_ERROR = 0.002f;
+		Vertices vertices; Indices indices;
+		GenerateSphere(1.0f, 60, 60, vertices, indices);
+
+		float error = -1.0f;
+		const Indices simplified = MeshSimplifier::Simplify(vertices, indices, 0, MAX_ERROR, &error);
+		std::printf("Sphere, max error %.4f: %zu -> %zu triangles, error %.5f\n", MAX_ERROR, indices.size() / 3, simplified.size() / 3, error);
+		CHECK(error >= 0.0f && error <= MAX_ERROR);
+		CHECK(simplified.size() < indices.size());
+		CHECK(!simplified.empty());
+	}
+}
+
+int main()
+{
+	TestSphereLODChain();
+	TestErrorLimit();
+
+	std::printf("%s\n", sNumFailedChecks == 0 ? "All checks passed" : "FAILED");
+	return sNumFailedChecks == 0 ? 0 : 1;
+}
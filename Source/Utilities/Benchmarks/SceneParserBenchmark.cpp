@@ -0,0 +1,249 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+// Linux benchmark for the scene file tokenizer (Tokenizer.h) used by Parser::ReadScene().
+//
+// Generates a synthetic scene with 100k objects and parses it with
+//  - the previous pipeline: std::getline, StrUtil::split into std::strings, if/else command chain, std::stof
+//  - the current pipeline : mmap, Tokenizer::LineReader, hashed command dispatch, Tokenizer::ParseFloat
+// into a plain copy of the scene data; the engine types (SerializedScene, Renderer) are Windows only.
+//
+// Build & run from the repository root:
+//  g++ -std=c++17 -O2 -ISource/Utilities Source/Utilities/Benchmarks/SceneParserBenchmark.cpp Source/Utilities/Source/Tokenizer.cpp -o SceneParserBenchmark
+//  ./SceneParserBenchmark [numObjects] [numIterations]
+//
+#include "Tokenizer.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::atomic<size_t> sNumHeapAllocations { 0 };
+void* operator new(size_t sizeInBytes)
+{
+	sNumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pMemory = std::malloc(sizeInBytes ? sizeInBytes : 1))
+		return pMemory;
+	throw std::bad_alloc();
+}
+void operator delete(void* pMemory) noexcept         { std::free(pMemory); }
+void operator delete(void* pMemory, size_t) noexcept { std::free(pMemory); }
+
+struct Object
+{
+	float transform[9] = { 0, 0, 0, 0, 0, 0, 1, 1, 1 };
+	int   mesh = -1;
+	float diffuse[3] = { 1, 1, 1 };
+	float roughness = 0.5f;
+	float metalness = 0.0f;
+};
+
+struct Scene
+{
+	std::vector<Object> objects;
+	float camera[8] = {};
+	size_t numErrors = 0;
+};
+
+static int GetMesh(std::string_view name)
+{
+	static constexpr std::string_view sMeshes[] = { "triangle", "quad", "cube", "sphere", "grid", "cylinder", "cone" };
+	for (int i = 0; i < 7; ++i)
+		if (Tokenizer::EqualsIgnoreCase(name, sMeshes[i]))
+			return i;
+	return -1;
+}
+
+static void GenerateScene(const char* pFilePath, int numObjects)
+{
+	static const char* sMeshes[] = { "cube", "sphere", "cylinder", "grid", "cone" };
+	std::FILE* pFile = std::fopen(pFilePath, "wb");
+	std::fprintf(pFile, "// synthetic scene: %d objects\ncamera 0.1 1500 75  0 50 -190  0 15\n\n", numObjects);
+	std::srand(42);
+	auto Random = [](float lo, float hi) { return lo + (hi - lo) * (std::rand() / float(RAND_MAX)); };
+	for (int i = 0; i < numObjects; ++i)
+	{
+		std::fprintf(pFile, "object begin\n");
+		std::fprintf(pFile, "\ttransform %.3f %.3f %.3f  %.1f %.1f %.1f  %.2f\n", Random(-500, 500), Random(0, 100), Random(-500, 500), Random(0, 360), Random(0, 360), 0.0f, Random(0.5f, 5.0f));
+		std::fprintf(pFile, "\tmesh %s\n", sMeshes[i % 5]);
+		std::fprintf(pFile, "\tbrdf\n\t\tdiffuse %.3f %.3f %.3f\n\t\troughness %.2f\n\t\tmetalness %.2f\n\tbrdf\n", Random(0, 1), Random(0, 1), Random(0, 1), Random(0, 1), Random(0, 1));
+		std::fprintf(pFile, "object end\n\n");
+	}
+	std::fclose(pFile);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// PREVIOUS PIPELINE
+//----------------------------------------------------------------------------------------------------------------
+static std::vector<std::string> Split(const std::string& str)
+{
+	std::vector<std::string> result;
+	const char* s = str.c_str();
+	do
+	{
+		const char* begin = s;
+		if (*begin == ' ' || *begin == '\t' || *begin == '\0')
+			continue;
+		while (*s != ' ' && *s != '\t' && *s)
+			s++;
+		result.push_back(std::string(begin, s));
+	} while (*s++ != '\0');
+	return result;
+}
+
+static void ParseSceneSplit(const char* pFilePath, Scene& scene)
+{
+	std::ifstream sceneFile(pFilePath);
+	std::string line;
+	Object* pObject = nullptr;
+	while (std::getline(sceneFile, line))
+	{
+		if (line[0] == '/' || line[0] == '#' || line[0] == '\0')
+			continue;
+		const std::vector<std::string> command = Split(line);
+		if (command.empty() || command[0][0] == '/')
+			continue;
+
+		const std::string& cmd = command[0];
+		if (cmd == "camera")            { for (int i = 0; i < 8; ++i) scene.camera[i] = std::stof(command[i + 1]); }
+		else if (cmd == "object")       { if (command[1] == "begin") { scene.objects.emplace_back(); pObject = &scene.objects.back(); } else pObject = nullptr; }
+		else if (cmd == "transform")    { for (int i = 0; i < 7; ++i) pObject->transform[i] = std::stof(command[i + 1]); }
+		else if (cmd == "mesh")         { pObject->mesh = GetMesh(command[1]); }
+		else if (cmd == "brdf")         {}
+		else if (cmd == "diffuse")      { for (int i = 0; i < 3; ++i) pObject->diffuse[i] = std::stof(command[i + 1]); }
+		else if (cmd == "roughness")    { pObject->roughness = std::stof(command[1]); }
+		else if (cmd == "metalness")    { pObject->metalness = std::stof(command[1]); }
+		else                            { ++scene.numErrors; }
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// CURRENT PIPELINE
+//----------------------------------------------------------------------------------------------------------------
+static bool ReadFloats(const Tokenizer::Line& line, size_t count, float* pOut)
+{
+	if (line.size() <= count)
+		return false;
+	for (size_t i = 0; i < count; ++i)
+		if (!Tokenizer::ParseFloat(line[i + 1].text, pOut[i]))
+			return false;
+	return true;
+}
+
+static void ParseSceneTokenizer(const char* pFilePath, Scene& scene)
+{
+	using Tokenizer::Hash;
+
+	const int fd = open(pFilePath, O_RDONLY);
+	struct stat fileStat;
+	fstat(fd, &fileStat);
+	const size_t fileSize = static_cast<size_t>(fileStat.st_size);
+	void* pData = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	madvise(pData, fileSize, MADV_SEQUENTIAL);
+
+	Tokenizer::LineReader reader(static_cast<const char*>(pData), fileSize);
+	Tokenizer::Line line;
+	Object* pObject = nullptr;
+	while (reader.ReadLine(line))
+	{
+		const std::string_view cmd = line[0].text;
+		bool bValid = false;
+		switch (Hash(cmd))
+		{
+		case Hash("camera"):    bValid = cmd == "camera" && ReadFloats(line, 8, scene.camera); break;
+		case Hash("object"):
+			if (cmd != "object" || line.size() < 2) break;
+			bValid = true;
+			if (Tokenizer::EqualsIgnoreCase(line[1].text, "begin")) { scene.objects.emplace_back(); pObject = &scene.objects.back(); }
+			else pObject = nullptr;
+			break;
+		case Hash("transform"): bValid = cmd == "transform" && pObject && ReadFloats(line, 7, pObject->transform); break;
+		case Hash("mesh"):      bValid = cmd == "mesh" && pObject && line.size() > 1 && (pObject->mesh = GetMesh(line[1].text)) >= 0; break;
+		case Hash("brdf"):      bValid = cmd == "brdf"; break;
+		case Hash("diffuse"):   bValid = cmd == "diffuse" && pObject && ReadFloats(line, 3, pObject->diffuse); break;
+		case Hash("roughness"): bValid = cmd == "roughness" && pObject && ReadFloats(line, 1, &pObject->roughness); break;
+		case Hash("metalness"): bValid = cmd == "metalness" && pObject && ReadFloats(line, 1, &pObject->metalness); break;
+		}
+		if (!bValid)
+			++scene.numErrors;
+	}
+	munmap(pData, fileSize);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+template<class ParseFn>
+static void Run(const char* pName, ParseFn Parse, const char* pFilePath, size_t fileSize, int numIterations, Scene& scene)
+{
+	double bestMs = 1e30;
+	size_t numAllocations = 0;
+	for (int i = 0; i < numIterations; ++i)
+	{
+		scene = Scene();
+		const size_t numAllocationsBefore = sNumHeapAllocations.load();
+		const auto begin = std::chrono::high_resolution_clock::now();
+		Parse(pFilePath, scene);
+		const auto end = std::chrono::high_resolution_clock::now();
+		numAllocations = sNumHeapAllocations.load() - numAllocationsBefore;
+		const double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+		bestMs = ms < bestMs ? ms : bestMs;
+	}
+	std::printf("%-22s %9.2f ms  %8.1f MB/s  %9zu heap allocations  (%zu objects, %zu errors)\n", pName, bestMs
+		, (fileSize / (1024.0 * 1024.0)) / (bestMs / 1000.0), numAllocations, scene.objects.size(), scene.numErrors);
+}
+
+int main(int argc, char** argv)
+{
+	const int numObjects    = argc > 1 ? std::atoi(argv[1]) : 100000;
+	const int numIterations = argc > 2 ? std::atoi(argv[2]) : 5;
+	const char* pFilePath   = "SceneParserBenchmark.scn";
+
+	GenerateScene(pFilePath, numObjects);
+	struct stat fileStat;
+	stat(pFilePath, &fileStat);
+	std::printf("Scene: %d objects, %.2f MB, best of %d runs\n", numObjects, fileStat.st_size / (1024.0 * 1024.0), numIterations);
+
+	Scene sceneSplit, sceneTokenizer;
+	Run("getline+split+stof", ParseSceneSplit, pFilePath, fileStat.st_size, numIterations, sceneSplit);
+	Run("mmap+Tokenizer", ParseSceneTokenizer, pFilePath, fileStat.st_size, numIterations, sceneTokenizer);
+
+	// both parsers have to produce the same scene
+	bool bMatch = sceneSplit.objects.size() == sceneTokenizer.objects.size();
+	for (size_t i = 0; bMatch && i < sceneSplit.objects.size(); ++i)
+	{
+		const Object& a = sceneSplit.objects[i];
+		const Object& b = sceneTokenizer.objects[i];
+		for (int j = 0; j < 9; ++j) bMatch = bMatch && a.transform[j] == b.transform[j];
+		for (int j = 0; j < 3; ++j) bMatch = bMatch && a.diffuse[j] == b.diffuse[j];
+		bMatch = bMatch && a.mesh == b.mesh && a.roughness == b.roughness && a.metalness == b.metalness;
+	}
+	std::printf("Results %s\n", bMatch ? "match" : "DIFFER");
+
+	std::remove(pFilePath);
+	return bMatch ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+
+// Test for the job system of Application/ThreadPool.h.
+//
+// Checks the results of
+//  - AddTask()     : background tasks summing known data, returned through std::future<>
+//  - ParallelFor() : every index visited exactly once & the sum of the range, nested ParallelFor() in jobs
+//  - Run()/Wait()  : jobs of the main thread stolen by the workers, jobs of a worker stolen by the
+//                    main thread & the other workers, the Pop()/Steal() race on the last job of a deque,
+//                    submitting more jobs than the job slots of a thread & submitting from an unregistered thread
+//
+// ThreadPool.cpp uses the CPU profiler, which depends on the Renderer, hence the test links the static
+// libraries of the solution. Build & run from the repository root in a x64 Native Tools Command Prompt
+// after building the solution in Release|x64:
+//  cl /std:c++17 /O2 /EHsc /ISource /ISource\Renderer Source\Utilities\Benchmarks\ThreadPoolTest.cpp /link /LIBPATH:Build\Engine\x64\Release /LIBPATH:Build\Renderer\x64\Release /LIBPATH:Build\Application\x64\Release /LIBPATH:Build\Utilities\x64\Release /LIBPATH:Source\3rdParty\DirectXTex\DirectXTex\Bin\Desktop_2015\x64\Release Engine.lib Renderer.lib Application.lib Utilities.lib DirectXTex.lib
+//  ThreadPoolTest.exe [numWorkers]
+//
+#include "Application/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static int sNumFailedChecks = 0;
+#define CHECK(expr) do { if (!(expr)) { std::printf("  FAILED: %s (line %d)\n", #expr, __LINE__); ++sNumFailedChecks; } } while (0)
+
+using namespace VQEngine;
+
+// keeps the executing thread busy for a while so that the idle threads get a chance to steal
+static void Spin(int microseconds)
+{
+	const auto end = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(microseconds);
+	while (std::chrono::high_resolution_clock::now() < end)
+		;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+static void TestBackgroundTasks(ThreadPool& threadPool)
+{
+	constexpr long long NUM_ELEMENTS = 4000000;
+	constexpr int NUM_TASKS = 16;
+
+	// task i sums (j % (i+2)) for j in [0, NUM_ELEMENTS)
+	std::vector<std::future<unsigned long long>> futures;
+	for (int i = 0; i < NUM_TASKS; ++i)
+	{
+		const long long mod = i + 2;
+		futures.push_back(threadPool.AddTask([=]()
+		{
+			std::vector<long long> nums(NUM_ELEMENTS, 0);
+			for (long long j = 0; j < NUM_ELEMENTS; ++j)
+				nums[j] = j % mod;
+			unsigned long long result = 0;
+			for (long long j = 0; j < NUM_ELEMENTS; ++j)
+				result += nums[j];
+			return result;
+		}));
+	}
+
+	for (int i = 0; i < NUM_TASKS; ++i)
+	{
+		const unsigned long long mod = i + 2;
+		const unsigned long long numFullPeriods = NUM_ELEMENTS / mod;
+		const unsigned long long remainder = NUM_ELEMENTS % mod;
+		const unsigned long long expected = numFullPeriods * (mod * (mod - 1) / 2) + remainder * (remainder - 1) / 2;
+		CHECK(futures[i].get() == expected);
+	}
+	std::printf("AddTask: %d tasks done\n", NUM_TASKS);
+}
+
+static void TestParallelFor(ThreadPool& threadPool)
+{
+	constexpr size_t NUM_ELEMENTS = 10000000;
+
+	std::vector<long long> nums(NUM_ELEMENTS, 0);
+	std::vector<int> numVisits(NUM_ELEMENTS, 0);
+	threadPool.ParallelFor(0, nums.size(), 4096, [&](size_t i) { nums[i] = static_cast<long long>(i); ++numVisits[i]; });
+	CHECK(std::all_of(numVisits.begin(), numVisits.end(), [](int n) { return n == 1; }));
+
+	std::atomic<long long> parallelSum { 0 };
+	threadPool.ParallelFor(0, nums.size(), 4096 * 16, [&](size_t i) { parallelSum.fetch_add(nums[i], std::memory_order_relaxed); });
+	const long long expectedSum = (static_cast<long long>(NUM_ELEMENTS) - 1) * static_cast<long long>(NUM_ELEMENTS) / 2;
+	CHECK(parallelSum.load() == expectedSum);
+	std::printf("ParallelFor: sum = %lld (expected %lld)\n", parallelSum.load(), expectedSum);
+
+	// ranges smaller than the grain, empty ranges & a grain of 0
+	std::atomic<int> numCalls { 0 };
+	threadPool.ParallelFor(5, 8, 1000, [&](size_t) { ++numCalls; });
+	threadPool.ParallelFor(8, 8, 1000, [&](size_t) { ++numCalls; });
+	threadPool.ParallelFor(0, 10, 0, [&](size_t) { ++numCalls; });
+	CHECK(numCalls == 13);
+
+	// nested ParallelFor(): the outer jobs wait on their inner jobs
+	constexpr int NUM_OUTER_JOBS = 32;
+	constexpr size_t NUM_INNER_ELEMENTS = 10000;
+	std::atomic<long long> nestedSum { 0 };
+	JobCounter counter;
+	for (int i = 0; i < NUM_OUTER_JOBS; ++i)
+	{
+		threadPool.Run([&]()
+		{
+			std::atomic<long long> innerSum { 0 };
+			threadPool.ParallelFor(0, NUM_INNER_ELEMENTS, 100, [&](size_t j) { innerSum.fetch_add(static_cast<long long>(j), std::memory_order_relaxed); });
+			nestedSum += innerSum;
+		}, &counter);
+	}
+	threadPool.Wait(counter);
+	CHECK(counter.IsDone());
+	CHECK(nestedSum.load() == NUM_OUTER_JOBS * static_cast<long long>(NUM_INNER_ELEMENTS - 1) * NUM_INNER_ELEMENTS / 2);
+}
+
+static void TestWorkStealing(ThreadPool& threadPool)
+{
+	const std::thread::id mainThreadID = std::this_thread::get_id();
+
+	// the jobs of the main thread can only reach the workers by being stolen from the main thread's deque
+	{
+		constexpr int NUM_JOBS = 256;
+		std::vector<std::thread::id> executingThreads(NUM_JOBS);
+		JobCounter counter;
+		for (int i = 0; i < NUM_JOBS; ++i)
+		{
+			threadPool.Run([&, i]() { Spin(50); executingThreads[i] = std::this_thread::get_id(); }, &counter);
+		}
+		threadPool.Wait(counter);
+
+		const int numStolen = static_cast<int>(std::count_if(executingThreads.begin(), executingThreads.end(), [&](std::thread::id id) { return id != mainThreadID; }));
+		CHECK(numStolen > 0);
+		std::printf("Steal from the main thread: %d / %d jobs executed by the workers\n", numStolen, NUM_JOBS);
+	}
+
+	// a worker submits jobs to its own deque and doesn't execute them: the main thread (in Wait())
+	// and the other workers have to steal all of them.
+	{
+		constexpr int NUM_JOBS = 256;
+		std::vector<std::thread::id> executingThreads(NUM_JOBS);
+		JobCounter counter;
+		std::atomic<bool> bSubmitted { false };
+		std::thread::id submittingThreadID;
+		std::future<void> submission = threadPool.AddTask([&]()
+		{
+			submittingThreadID = std::this_thread::get_id();
+			for (int i = 0; i < NUM_JOBS; ++i)
+			{
+				threadPool.Run([&, i]() { Spin(50); executingThreads[i] = std::this_thread::get_id(); }, &counter);
+			}
+			bSubmitted = true;
+			while (!counter.IsDone())
+				std::this_thread::yield();
+		});
+		while (!bSubmitted)
+			std::this_thread::yield();
+		threadPool.Wait(counter);
+		submission.get();
+
+		const int numExecutedByMainThread = static_cast<int>(std::count(executingThreads.begin(), executingThreads.end(), mainThreadID));
+		CHECK(std::count(executingThreads.begin(), executingThreads.end(), submittingThreadID) == 0);
+		CHECK(std::count(executingThreads.begin(), executingThreads.end(), std::thread::id()) == 0);
+		std::printf("Steal from a worker: %d / %d jobs executed by the main thread\n", numExecutedByMainThread, NUM_JOBS);
+	}
+
+	// single jobs: the main thread pops the last job of its deque while the workers try to steal it
+	{
+		constexpr int NUM_ROUNDS = 100000;
+		std::atomic<int> numExecuted { 0 };
+		for (int round = 0; round < NUM_ROUNDS; ++round)
+		{
+			JobCounter counter;
+			threadPool.Run([&]() { ++numExecuted; }, &counter);
+			threadPool.Wait(counter);
+		}
+		CHECK(numExecuted == NUM_ROUNDS);
+	}
+}
+
+static void TestJobSubmission(ThreadPool& threadPool)
+{
+	// more jobs than the job slots of a thread: the jobs that don't get a slot run inline
+	{
+		constexpr int NUM_JOBS = 5000;
+		std::atomic<int> numExecuted { 0 };
+		JobCounter counter;
+		for (int i = 0; i < NUM_JOBS; ++i)
+		{
+			threadPool.Run([&]() { Spin(1); ++numExecuted; }, &counter);
+		}
+		threadPool.Wait(counter);
+		CHECK(numExecuted == NUM_JOBS);
+	}
+
+	// jobs submitted from a thread that isn't registered with the pool run inline
+	{
+		std::thread::id executingThreadID;
+		std::thread::id submittingThreadID;
+		JobCounter counter;
+		std::thread unregisteredThread([&]()
+		{
+			submittingThreadID = std::this_thread::get_id();
+			threadPool.Run([&]() { executingThreadID = std::this_thread::get_id(); }, &counter);
+		});
+		unregisteredThread.join();
+		CHECK(counter.IsDone());
+		CHECK(executingThreadID == submittingThreadID);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t numWorkers = argc > 1
+		? static_cast<size_t>(std::atoi(argv[1]))
+		: (std::max)(ThreadPool::sHardwareThreadCount, size_t(2)) - 1;
+	std::printf("ThreadPool with %zu workers\n", numWorkers);
+	if (numWorkers == 0)
+	{
+		std::printf("At least 1 worker is required to test the work stealing\n");
+		return 1;
+	}
+
+	ThreadPool threadPool(numWorkers);
+	TestBackgroundTasks(threadPool);
+	TestParallelFor(threadPool);
+	TestWorkStealing(threadPool);
+	TestJobSubmission(threadPool);
+
+	std::printf("%s\n", sNumFailedChecks == 0 ? "All checks passed" : "FAILED");
+	return sNumFailedChecks == 0 ? 0 : 1;
+}
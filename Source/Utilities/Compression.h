@@ -0,0 +1,39 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Lossless compression for the CPU copies of GPU buffers.
+//
+// The input is byte-shuffled first: the n-th bytes of the @wordSize-byte words are grouped 
+// together, so the slowly changing high bytes of floats & indices form long repetitive runs. 
+// The shuffled bytes are then compressed with a byte oriented LZ77 coder (LZ4-like sequences 
+// of literals & matches with 16-bit offsets), which favors decompression speed over ratio.
+//
+namespace Compression
+{
+	std::vector<char> Compress(const void* pData, size_t sizeInBytes, size_t wordSize = 4);
+
+	// returns the size of the data @compressed decompresses to, 0 if the stream is invalid
+	size_t GetDecompressedSize(const std::vector<char>& compressed);
+
+	// @dstSizeInBytes should be GetDecompressedSize(). Returns false if the stream is invalid.
+	bool Decompress(const std::vector<char>& compressed, void* pDst, size_t dstSizeInBytes);
+}
@@ -18,14 +18,16 @@
 
 #pragma once
 
-#include <vector>
 #include <string>
 
 #include "Engine/Scene.h"
 
 namespace Settings { struct Rendering; }
 
-
+// Reads EngineSettings.ini and the scene files (*.scn) from memory mapped files. Each line is 
+// tokenized in place (see Tokenizer.h) and dispatched on the hash of its command; errors are
+// logged with the file, line and column of the offending token and the command is skipped.
+//
 class Parser
 {
 public:
@@ -33,10 +35,13 @@ public:
 	~Parser();
 
 	static Settings::Engine ReadSettings(const std::string& settingsFileName);
-	static void ParseSetting(const std::vector<std::string>& line, Settings::Engine& settings);
-
 	static SerializedScene ReadScene(Renderer* pRenderer, const std::string& sceneFileName);
 
+private:
+	struct ParseContext;	// per-file state: current line & open object/light/material blocks
+
+	static void ParseSetting(ParseContext& context, Settings::Engine& settings);
+
 	// Object initializations
 	// ---------------------------------------------------------------------------------------------------------------
 	// Transform	: pos(3), rot(3:euler), scale(1:uniform|3:xyz)
@@ -45,8 +50,5 @@ public:
 	// BRDF			:
 	// Phong		:
 	// Object		: transform, brdf/phong, mesh
-	static void ParseScene(Renderer* pRenderer, const std::vector<std::string>& command, SerializedScene& scene);
-private:
-
+	static void ParseScene(ParseContext& context, SerializedScene& scene);
 };
-
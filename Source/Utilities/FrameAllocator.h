@@ -0,0 +1,153 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+// Replaces the global operator new/delete to count the heap allocations of the process, for profiling 
+// only: it bypasses the debug heap and adds an atomic increment to every allocation. Define it as 1 in
+// the preprocessor definitions of the build to enable it.
+#ifndef COUNT_HEAP_ALLOCATIONS
+#define COUNT_HEAP_ALLOCATIONS 0
+#endif
+
+// Thread-safe linear (bump) allocator over a single contiguous block of memory.
+//
+// Allocate() is a compare-and-swap on the offset: individual allocations are never 
+// freed, the whole block is recycled with Reset(). Requests that don't fit into the 
+// block fall back to the heap and are released on the next Reset(), which also grows 
+// the block to the high-water mark of the previous use so that the overflow doesn't 
+// happen again, i.e. the allocator stops touching the heap once it's warmed up.
+//
+class LinearAllocator
+{
+public:
+	static constexpr size_t BLOCK_ALIGNMENT = 64; // cache line
+
+	LinearAllocator() = default;
+	~LinearAllocator() { Exit(); }
+	LinearAllocator(const LinearAllocator&) = delete;
+	LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+	void Initialize(size_t capacityInBytes);
+	void Exit();
+
+	void* Allocate(size_t sizeInBytes, size_t alignment);
+
+	// Invalidates all the memory handed out since the last Reset().
+	// Must not be called while other threads are allocating.
+	void Reset();
+
+	inline size_t GetCapacity() const           { return mCapacity; }
+	inline size_t GetUsedBytes() const          { return mOffset.load(std::memory_order_relaxed) + mOverflowBytes.load(std::memory_order_relaxed); }
+	inline int    GetNumHeapAllocations() const { return mNumHeapAllocations.load(std::memory_order_relaxed); } // since the last Reset()
+
+private:
+	void* AllocateOverflow(size_t sizeInBytes, size_t alignment);
+
+	char*               mpMemory = nullptr;
+	size_t              mCapacity = 0;
+	std::atomic<size_t> mOffset { 0 };
+
+	std::mutex          mOverflowMutex;
+	std::vector<void*>  mOverflowAllocations;
+	std::atomic<size_t> mOverflowBytes { 0 };
+	std::atomic<int>    mNumHeapAllocations { 0 };
+};
+
+
+// Double-buffered LinearAllocator for the per-frame temporary data.
+//
+// BeginFrame() switches to the other buffer and resets it: the memory handed out 
+// in frame N stays valid throughout frame N+1, so the data produced for a frame 
+// can still be consumed while the next one is being prepared.
+//
+class FrameAllocator
+{
+public:
+	static constexpr size_t NUM_BUFFERS = 2;
+
+	void Initialize(size_t capacityPerFrameInBytes);
+	void Exit();
+
+	void BeginFrame();
+
+	inline LinearAllocator&       GetCurrent()       { return mBuffers[mCurrentBuffer]; }
+	inline const LinearAllocator& GetCurrent() const { return mBuffers[mCurrentBuffer]; }
+	inline void* Allocate(size_t sizeInBytes, size_t alignment) { return GetCurrent().Allocate(sizeInBytes, alignment); }
+
+private:
+	std::array<LinearAllocator, NUM_BUFFERS> mBuffers;
+	size_t mCurrentBuffer = 0;
+};
+
+
+// STL allocator interface for the containers of the per-frame data.
+//
+// Memory comes from the bound LinearAllocator and is never freed individually. 
+// A default constructed (unbound) allocator falls back to the heap, hence the 
+// containers stay usable outside of a frame. The allocator propagates on container
+// assignment and swap: a container is rebound to the current frame's memory by 
+// assigning it a new empty container, e.g. renderList = RenderList(pFrameMemory),
+// which must be done each frame before its memory is recycled.
+//
+template<class T>
+struct FrameSTLAllocator
+{
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap            = std::true_type;
+	using is_always_equal                        = std::false_type;
+
+	FrameSTLAllocator() = default;
+	FrameSTLAllocator(LinearAllocator* pAllocator_) : pAllocator(pAllocator_) {}
+	template<class U> FrameSTLAllocator(const FrameSTLAllocator<U>& other) : pAllocator(other.pAllocator) {}
+
+	T* allocate(size_t n)
+	{
+		if (!pAllocator) 
+			return std::allocator<T>().allocate(n);
+		return static_cast<T*>(pAllocator->Allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T* p, size_t n)
+	{
+		if (!pAllocator)
+			std::allocator<T>().deallocate(p, n);
+	}
+
+	LinearAllocator* pAllocator = nullptr;
+};
+template<class T, class U> inline bool operator==(const FrameSTLAllocator<T>& a, const FrameSTLAllocator<U>& b) { return a.pAllocator == b.pAllocator; }
+template<class T, class U> inline bool operator!=(const FrameSTLAllocator<T>& a, const FrameSTLAllocator<U>& b) { return a.pAllocator != b.pAllocator; }
+
+template<class T>
+using FrameVector = std::vector<T, FrameSTLAllocator<T>>;
+
+template<class TKey, class TValue, class THash = std::hash<TKey>>
+using FrameUnorderedMap = std::unordered_map<TKey, TValue, THash, std::equal_to<TKey>, FrameSTLAllocator<std::pair<const TKey, TValue>>>;
+
+
+// Number of heap allocations made by the process so far (0 if COUNT_HEAP_ALLOCATIONS is disabled).
+// Sample it before and after a block of code to count the allocations made in between.
+//
+size_t GetHeapAllocationCount();
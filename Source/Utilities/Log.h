@@ -19,18 +19,30 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 
 namespace Settings { struct Logger; }
 
-#define VARIADIC_LOG_FN(FN_NAME)\
+#define VARIADIC_LOG_FN(FN_NAME, LEVEL, FLAGS)\
 template<class... Args>\
 void FN_NAME(const char* format, Args&&... args)\
 {\
 	char msg[LEN_MSG_BUFFER];\
-	sprintf_s(msg, format, args...);\
-	##FN_NAME(std::string(msg));\
+	const int len = sprintf_s(msg, format, args...);\
+	Write(LEVEL, FLAGS, msg, len > 0 ? static_cast<size_t>(len) : 0);\
 }
 
+// Log
+//
+// The log functions don't do any I/O on the calling thread: the message is copied into a lock-free
+// ring buffer of the thread with a monotonic timestamp, and the log thread started in Initialize()
+// merges the buffers of all threads in timestamp order and writes them to the Visual Studio output
+// window, the console and the log file. Messages are dropped when the buffer of a thread is full, 
+// the log thread reports how many. Before Initialize() and after Exit() the messages are written
+// synchronously, and so are the messages longer than MAX_BUFFERED_MSG_LENGTH, after the messages 
+// already in the buffers. The formatted (variadic) functions truncate at LEN_MSG_BUFFER, the 
+// std::string versions don't truncate.
+//
 namespace Log
 {
 	enum Mode : unsigned	// unused.
@@ -42,20 +54,43 @@ namespace Log
 		CONSOLE_AND_FILE	= CONSOLE | FILE,	// Both Console Window & Log File
 	};
 
+	enum ELevel : uint8_t
+	{
+		LEVEL_INFO = 0,
+		LEVEL_WARNING,
+		LEVEL_ERROR,	// wakes up the log thread right away
+	};
+
+	enum EFlags : uint8_t
+	{
+		FLAG_NONE = 0,
+		FLAG_RATE_LIMITED = 1 << 0,	// repeats of the message within RATE_LIMIT_INTERVAL_SECONDS are counted instead of written
+	};
+
 	//---------------------------------------------------------------------------------------------
 
-	constexpr size_t LEN_MSG_BUFFER = 2048;
+	constexpr size_t LEN_MSG_BUFFER = 2048;				// formatted messages
+	constexpr size_t THREAD_BUFFER_SIZE = 64 * 1024;	// per thread, power of 2
+	constexpr size_t MAX_BUFFERED_MSG_LENGTH = THREAD_BUFFER_SIZE / 4;	// longer messages are written on the calling thread
+	constexpr size_t MAX_THREAD_BUFFERS = 64;			// threads logging at the same time, further threads' messages are dropped
+	constexpr double RATE_LIMIT_INTERVAL_SECONDS = 5.0;
 
 	//---------------------------------------------------------------------------------------------
 
 	void Initialize(const Settings::Logger& settings);
 	void Exit();
 
+	void Write(ELevel level, unsigned flags, const char* msg, size_t length);
+
 	void Info(const std::string& s);
 	void Error(const std::string& s);
 	void Warning(const std::string& s);
 	
-	VARIADIC_LOG_FN(Error)
-	VARIADIC_LOG_FN(Warning)
-	VARIADIC_LOG_FN(Info)
+	VARIADIC_LOG_FN(Error, LEVEL_ERROR, FLAG_NONE)
+	VARIADIC_LOG_FN(Warning, LEVEL_WARNING, FLAG_NONE)
+	VARIADIC_LOG_FN(Info, LEVEL_INFO, FLAG_NONE)
+
+	// for messages that can repeat every frame, e.g. a missing shader constant
+	VARIADIC_LOG_FN(ErrorRateLimited, LEVEL_ERROR, FLAG_RATE_LIMITED)
+	VARIADIC_LOG_FN(WarningRateLimited, LEVEL_WARNING, FLAG_RATE_LIMITED)
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <string>
+
+// Read-only memory mapping of a whole file. The mapped memory stays valid until
+// Close() is called or the object is destroyed.
+//
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile() = default;
+	~MemoryMappedFile() { Close(); }
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	inline bool        IsOpen() const { return mpData != nullptr; }
+	inline const void* GetData() const { return mpData; }
+	inline size_t      GetSize() const { return mSize; }
+
+private:
+	void*  mhFile = nullptr;
+	void*  mhMapping = nullptr;
+	void*  mpData = nullptr;
+	size_t mSize = 0;
+};
@@ -4,6 +4,10 @@
 #include <string>
 #include <unordered_map>
 #include <stack>
+#include <deque>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
 #include <thread>
 #include <limits>
 #include <array>
@@ -65,22 +69,63 @@ public:
 	virtual vec2 GetEntryAreaBounds(const vec2& screenSizeInPixels) const = 0;
 };
 
+// The Begin/End events are recorded into per-thread event buffers shared by the process, hence there
+// can be only one CPUProfiler at a time. Its profiling thread is the thread calling BeginProfile() and
+// EndProfile(), e.g. the engine's single instance is driven by the loading screen's render thread
+// while a scene loads and by the main thread afterwards, never by both at once.
+//
 class CPUProfiler : public Profiler
 {
 
 public:
-	CPUProfiler(ProfilerSettings settings = ProfilerSettings()) : 	mSettings(settings) {}
+	using EntryID = uint32_t;
+	static constexpr EntryID INVALID_ENTRY_ID = 0xFFFFFFFF;
 
-	// Resets the mPerfEntryTable - must be called at the beginning and end of each frame. 
+	// Returns the ID of the entry with @tag, registering the tag on the first call. 
+	// Registration takes a lock: look the ID up once and keep it, e.g. with the 
+	// PROFILER_ENTRY(tag) / PROFILE_SCOPE(tag) macros defined below.
+	//
+	static EntryID RegisterEntry(const std::string& tag);
+	static std::string GetEntryTag(EntryID id);
+
+	// Records the Begin/End timestamps of an entry into the event buffer of the calling thread.
+	// Can be called from any thread without locking or allocating, except the first call on a 
+	// thread which registers its event buffer. Events are resolved into the entry hierarchy in 
+	// EndProfile(): the parent of an entry is the entry open on the same thread at its beginning, 
+	// or for the outermost entries of other threads (ThreadPool jobs), the innermost entry that 
+	// was open on the profiling thread at that time.
+	//
+	static void BeginScope(EntryID id);
+	static void EndScope(EntryID id);
+
+	struct ScopedEntry
+	{
+		inline ScopedEntry(EntryID id_) : id(id_) { BeginScope(id); }
+		inline ~ScopedEntry() { EndScope(id); }
+		ScopedEntry(const ScopedEntry&) = delete;
+		ScopedEntry& operator=(const ScopedEntry&) = delete;
+		const EntryID id;
+	};
+
+	CPUProfiler(ProfilerSettings settings = ProfilerSettings());
+	~CPUProfiler();
+	CPUProfiler(const CPUProfiler&) = delete;
+	CPUProfiler& operator=(const CPUProfiler&) = delete;
+
+	// Defines a profiling frame - must be called at the beginning and end of each frame on the profiling thread. 
+	// EndProfile() resolves the events recorded by all the threads since the last EndProfile() and adds a 
+	// sample to each entry recorded in the frame.
 	//
 	void BeginProfile(const unsigned long long FRAME_NUMBER = 0) override;
 	void EndProfile(const unsigned long long FRAME_NUMBER = 0) override;
 
-	// Adds PerfEntry to the PerfEntryTable if it doesn't already exist AND Starts the time sampling for the PerfEntry.
-	// BeginEntry()/EndEntry() must be called between BeginProfile() and EndProfile()
+	// Same as BeginScope()/EndScope(), for the entries of the calling thread. 
+	// The string version registers the tag on each call, prefer the EntryID version 
+	// for the entries that are recorded every frame: BeginEntry(PROFILER_ENTRY("Tag"));
 	// *Assumes PerfEntry has a unique name. There won't be duplicate entries.*
 	//
 	void BeginEntry(const std::string& entryName) override;
+	void BeginEntry(EntryID id);
 	void EndEntry() override;
 
 	float GetEntryAvg(const std::string& tag) const override;
@@ -92,7 +137,26 @@ public:
 
 	// DERIVED INTERFACE -------------------------------------------
 
-	inline bool AreThereAnyOpenEntries() const { return !mState.EntryNameStack.empty(); }
+	// Returns the sample (in seconds) added to the entry by the last EndProfile(), 
+	// or -1 if the entry doesn't exist or wasn't recorded in that frame.
+	//
+	float GetEntryLastSample(const std::string& tag) const;
+
+	// Records the Begin/End events of all the threads, along with the frames, for the next @numFrames 
+	// EndProfile() calls (or until EndCapture() if @numFrames <= 0) and writes them into @filePath as 
+	// Chrome Trace Event JSON, which can be opened in chrome://tracing or ui.perfetto.dev.
+	//
+	void BeginCapture(int numFrames, const std::string& filePath);
+	void EndCapture();
+	inline bool IsCaptureInProgress() const { return mState.bCaptureInProgress; }
+
+	// Names the calling thread in the captures
+	//
+	static void SetThreadName(const std::string& name);
+
+	// returns true if the calling thread has entries that haven't ended yet
+	//
+	bool AreThereAnyOpenEntries() const;
 
 	// performs checks for state consistency (are there any open entries? etc.)
 	//
@@ -102,52 +166,127 @@ public:
 	//
 	void PrintStats() const;	// todo: impl
 
+private:	// Internal Structs
+	struct PerfEntry
+	{
+		std::string			tag;
+		EntryID				id = INVALID_ENTRY_ID;
+		EntryID				parentID = INVALID_ENTRY_ID;
+		std::vector<EntryID> children;
 
-	//void Capture()
+		size_t				currSampleIndex = 0; // [0, samples.size())
+		std::vector<float>	samples;
+		float				frameDuration = 0.0f;	// sum of the durations resolved in the current frame
+		bool				bRecordedThisFrame = false;
+		int64_t				lastSampleTime = 0;
+
+		void AddSample(float duration);
+		void PrintEntryInfo(bool bPrintAllEntries = false);
+		inline float GetAvg() const;
+		bool operator<(const PerfEntry& other) const;
+		bool IsStale() const;
+	};
 
-private:	// Internal Structs
-	struct PerfEntry;
 	struct State
 	{
 		bool					bIsProfiling = false;
-		bool					bCaptureInProgress = false;
-		std::stack<std::string> EntryNameStack;
-		TreeNode<PerfEntry>*	pLastEntryNode = nullptr;	// used for setting up the hierarchy
-		inline void Clear()
+		std::atomic<bool>		bCaptureInProgress { false };
+		bool					bHierarchyChanged = false;	// the tree is rebuilt when entries are added
+	};
+
+	// Begin/End timestamps of an entry on a thread
+	struct ScopeInterval
+	{
+		int64_t begin;
+		int64_t end;
+		EntryID id;
+	};
+
+	struct Capture
+	{
+		struct Event
+		{
+			int64_t		timestamp;
+			EntryID		id;
+			uint32_t	bBegin;
+			uint32_t	threadIndex;
+		};
+		struct Frame
 		{
-			bIsProfiling = false;
-			pLastEntryNode = nullptr;
-			while (!EntryNameStack.empty()) EntryNameStack.pop();
-		}
+			int64_t				begin;
+			int64_t				end;
+			unsigned long long	frameNumber;
+			uint32_t			threadIndex;
+		};
+
+		std::string				filePath;
+		int						numFramesLeft = 0;	// <= 0: until EndCapture()
+		std::vector<Event>		events;
+		std::vector<Frame>		frames;
+		std::unordered_map<uint32_t, std::string> threadNames;
 	};
-	using PerfEntryTable = std::unordered_map<std::string, PerfEntry>;
 
+	struct ThreadEventBuffer;			// see Profiler.cpp
+	struct ThreadEventBufferRegistry;
+	static ThreadEventBuffer& GetThreadEventBuffer();
+	static ThreadEventBufferRegistry& GetThreadEventBufferRegistry();
+
+	void ResolveEvents(ThreadEventBuffer& buffer, bool bIsProfilingThread);
+	void CaptureEvents(const ThreadEventBuffer& buffer, uint64_t readIndex, uint64_t writeIndex);
+	static void WriteCapture(const Capture& capture);
+	EntryID FindProfilingThreadScope(int64_t timestamp) const;
+	PerfEntry& AddEntry(EntryID id, EntryID parentID);
+	inline bool HasEntry(EntryID id) const { return id < mPerfEntryLookup.size() && mPerfEntryLookup[id] != nullptr; }
+	void AddChildNodes(TreeNode<PerfEntry>& node);
 
 private:
-	PerfEntryTable		mPerfEntries;		// where data lives (with entry name as unique keys)
-	Tree<PerfEntry>		mPerfEntryTree;
+	std::deque<PerfEntry>	mPerfEntries;		// where data lives (stable addresses for the tree)
+	std::vector<PerfEntry*>	mPerfEntryLookup;	// indexed by EntryID, nullptr if the entry wasn't recorded yet
+	EntryID					mRootEntryID = INVALID_ENTRY_ID;
+	Tree<PerfEntry>			mPerfEntryTree;
+
+	std::vector<ScopeInterval> mProfilingThreadScopes;	// scopes of the profiling thread resolved in the current EndProfile()
 	
 	ProfilerSettings	mSettings;
 	State				mState;
 
-	//------------------------------------------------------
+	Capture				mCapture;			// guarded by the thread event buffer registry lock
+	int64_t				mFrameBeginTime = 0;
 
-	struct PerfEntry
-	{
-		std::string			tag;
-		size_t				currSampleIndex; // [0, samples.size())
-		std::vector<float>	samples;
-		PerfTimer			timer;
-
-		void UpdateSampleBegin();
-		void UpdateSampleEnd();
-		void PrintEntryInfo(bool bPrintAllEntries = false);
-		inline float GetAvg() const;
-		bool operator<(const PerfEntry& other) const;
-		bool IsStale() const;
-	};
+	static int64_t		sLastResolveTime;	// timestamp of the last EndProfile()
+	static std::atomic<const CPUProfiler*> spInstance;	// the owner of the thread event buffers
 };
 
+// Returns the EntryID of @tag, which is registered once per call site. @tag has to be a constant.
+//
+#define PROFILER_ENTRY(tag) ([]() { static const CPUProfiler::EntryID sProfilerEntryID = CPUProfiler::RegisterEntry(tag); return sProfilerEntryID; }())
+
+// Profiles the enclosing scope on the calling thread: 
+//
+//	pThreadPool->ParallelFor(0, numLights, 1, [&](size_t i)
+//	{
+//		PROFILE_SCOPE("CullLight");
+//		...
+//	});
+//
+#define PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_(a, b)
+#define PROFILE_SCOPE(tag) const CPUProfiler::ScopedEntry PROFILE_SCOPE_CONCAT(profileScope_, __LINE__)(PROFILER_ENTRY(tag))
+
+// Locks @mutex, recording the time spent waiting for it as @waitEntry when it's contended.
+//
+template<class TMutex>
+inline std::unique_lock<TMutex> LockAndProfileWait(TMutex& mutex, CPUProfiler::EntryID waitEntry)
+{
+	std::unique_lock<TMutex> lock(mutex, std::try_to_lock);
+	if (!lock.owns_lock())
+	{
+		const CPUProfiler::ScopedEntry waitScope(waitEntry);
+		lock.lock();
+	}
+	return lock;
+}
+
 
 
 
@@ -0,0 +1,196 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Compression.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace Compression
+{
+	struct StreamHeader
+	{
+		uint64_t sizeInBytes;
+		uint32_t wordSize;
+		uint32_t padding;
+	};
+
+	constexpr size_t MIN_MATCH       = 4;
+	constexpr size_t MAX_OFFSET      = 0xFFFF;
+	constexpr int    HASH_BITS       = 14;
+	constexpr size_t LAST_LITERALS   = 8; // the last bytes are always emitted as literals so the match search doesn't read past the end
+
+	static inline uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+	static inline uint32_t Hash(uint32_t v) { return (v * 2654435761u) >> (32 - HASH_BITS); }
+
+	// lengths >= 15 are continued with bytes of 255 and a final byte < 255
+	static void WriteLength(std::vector<char>& out, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+			out.push_back(static_cast<char>(255));
+		out.push_back(static_cast<char>(length));
+	}
+
+	static void WriteSequence(std::vector<char>& out, const uint8_t* pLiterals, size_t numLiterals, size_t offset, size_t matchLength)
+	{
+		const size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+		out.push_back(static_cast<char>(((numLiterals < 15 ? numLiterals : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+		if (numLiterals >= 15)
+			WriteLength(out, numLiterals - 15);
+		out.insert(out.end(), reinterpret_cast<const char*>(pLiterals), reinterpret_cast<const char*>(pLiterals) + numLiterals);
+		if (matchLength == 0)
+			return; // last sequence
+
+		out.push_back(static_cast<char>(offset & 0xFF));
+		out.push_back(static_cast<char>(offset >> 8));
+		if (matchCode >= 15)
+			WriteLength(out, matchCode - 15);
+	}
+
+	static bool ReadLength(const uint8_t*& p, const uint8_t* pEnd, size_t& length)
+	{
+		uint8_t byte = 255;
+		while (byte == 255)
+		{
+			if (p >= pEnd) return false;
+			byte = *p++;
+			length += byte;
+		}
+		return true;
+	}
+
+
+	std::vector<char> Compress(const void* pData, size_t sizeInBytes, size_t wordSize /*= 4*/)
+	{
+		if (wordSize == 0 || sizeInBytes % wordSize != 0)
+			wordSize = 1;
+
+		// byte shuffle
+		const uint8_t* pSrc = static_cast<const uint8_t*>(pData);
+		std::vector<uint8_t> shuffled(sizeInBytes);
+		const size_t numWords = sizeInBytes / wordSize;
+		for (size_t b = 0; b < wordSize; ++b)
+			for (size_t w = 0; w < numWords; ++w)
+				shuffled[b * numWords + w] = pSrc[w * wordSize + b];
+
+		std::vector<char> out(sizeof(StreamHeader));
+		out.reserve(sizeof(StreamHeader) + sizeInBytes / 2);
+		const StreamHeader header = { sizeInBytes, static_cast<uint32_t>(wordSize), 0 };
+		std::memcpy(out.data(), &header, sizeof(header));
+
+		// LZ77: greedy matching against the last position with the same hash
+		const uint8_t* pBegin = shuffled.data();
+		const uint8_t* pEnd = pBegin + sizeInBytes;
+		const uint8_t* pLiterals = pBegin;
+		if (sizeInBytes > LAST_LITERALS + MIN_MATCH)
+		{
+			std::vector<uint32_t> hashTable(size_t(1) << HASH_BITS, 0);
+			const uint8_t* pMatchLimit = pEnd - LAST_LITERALS;
+			const uint8_t* p = pBegin + 1;
+			while (p + MIN_MATCH <= pMatchLimit)
+			{
+				const uint32_t h = Hash(Read32(p));
+				const uint8_t* pCandidate = pBegin + hashTable[h];
+				hashTable[h] = static_cast<uint32_t>(p - pBegin);
+				if (p - pCandidate > MAX_OFFSET || pCandidate >= p || Read32(pCandidate) != Read32(p))
+				{
+					++p;
+					continue;
+				}
+
+				size_t matchLength = MIN_MATCH;
+				while (p + matchLength < pMatchLimit && pCandidate[matchLength] == p[matchLength])
+					++matchLength;
+
+				WriteSequence(out, pLiterals, p - pLiterals, p - pCandidate, matchLength);
+				p += matchLength;
+				pLiterals = p;
+			}
+		}
+		WriteSequence(out, pLiterals, pEnd - pLiterals, 0, 0);
+		out.shrink_to_fit();
+		return out;
+	}
+
+	size_t GetDecompressedSize(const std::vector<char>& compressed)
+	{
+		if (compressed.size() < sizeof(StreamHeader))
+			return 0;
+		StreamHeader header;
+		std::memcpy(&header, compressed.data(), sizeof(header));
+		return static_cast<size_t>(header.sizeInBytes);
+	}
+
+	bool Decompress(const std::vector<char>& compressed, void* pDst, size_t dstSizeInBytes)
+	{
+		if (compressed.size() < sizeof(StreamHeader))
+			return false;
+		StreamHeader header;
+		std::memcpy(&header, compressed.data(), sizeof(header));
+		const size_t wordSize = header.wordSize;
+		if (header.sizeInBytes != dstSizeInBytes || wordSize == 0 || dstSizeInBytes % wordSize != 0)
+			return false;
+
+		// LZ77
+		std::vector<uint8_t> shuffled(dstSizeInBytes);
+		uint8_t* pOut = shuffled.data();
+		uint8_t* const pOutEnd = pOut + dstSizeInBytes;
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(compressed.data()) + sizeof(StreamHeader);
+		const uint8_t* const pEnd = reinterpret_cast<const uint8_t*>(compressed.data()) + compressed.size();
+		while (p < pEnd)
+		{
+			const uint8_t token = *p++;
+			size_t numLiterals = token >> 4;
+			if (numLiterals == 15 && !ReadLength(p, pEnd, numLiterals))
+				return false;
+			if (numLiterals > size_t(pEnd - p) || numLiterals > size_t(pOutEnd - pOut))
+				return false;
+			if (numLiterals)
+				std::memcpy(pOut, p, numLiterals);
+			pOut += numLiterals;
+			p += numLiterals;
+			if (p == pEnd)
+				break; // last sequence
+
+			if (pEnd - p < 2)
+				return false;
+			const size_t offset = p[0] | (size_t(p[1]) << 8);
+			p += 2;
+			size_t matchLength = token & 0xF;
+			if (matchLength == 15 && !ReadLength(p, pEnd, matchLength))
+				return false;
+			matchLength += MIN_MATCH;
+			if (offset == 0 || offset > size_t(pOut - shuffled.data()) || matchLength > size_t(pOutEnd - pOut))
+				return false;
+
+			const uint8_t* pMatch = pOut - offset;
+			for (size_t i = 0; i < matchLength; ++i) // overlapping copy
+				pOut[i] = pMatch[i];
+			pOut += matchLength;
+		}
+		if (pOut != pOutEnd)
+			return false;
+
+		// un-shuffle
+		uint8_t* pDstBytes = static_cast<uint8_t*>(pDst);
+		const size_t numWords = dstSizeInBytes / wordSize;
+		for (size_t b = 0; b < wordSize; ++b)
+			for (size_t w = 0; w < numWords; ++w)
+				pDstBytes[w * wordSize + b] = shuffled[b * numWords + w];
+		return true;
+	}
+}
@@ -17,47 +17,152 @@
 //	Contact: volkanilbeyli@gmail.com
 
 #include "CustomParser.h"
+#include "Tokenizer.h"
+#include "MemoryMappedFile.h"
 #include "utils.h"
 #include "Log.h"
 #include "Color.h"
 
 #include "Renderer/Renderer.h"
 
-#include <fstream>
 #include <unordered_map>
 #include <algorithm>
 
+using Tokenizer::Hash;
+using Tokenizer::EqualsIgnoreCase;
 
 const std::string file_root		= "Data\\";
 const std::string scene_root	= "Data\\SceneFiles\\";
 
-const std::unordered_map<std::string, bool> sBoolTypeReflection
+
+std::string GetLowercased(const std::string& str)
 {
-	{"true", true},		{"false", false},
-	{"yes", true},		{"no", false},
-	{"1", true},		{"0", false}
-};
+	std::string lowercase(str);
+	std::transform(str.begin(), str.end(), lowercase.begin(), ::tolower);
+	return lowercase;
+}
 
 
-const std::unordered_map<std::string, Settings::Rendering::AntiAliasing::EAntiAliasingTechnique> sAATypeReflection
+enum EPBRTextures
 {
-	{"0" , Settings::Rendering::AntiAliasing::EAntiAliasingTechnique::NO_ANTI_ALIASING }
-	, {"none", Settings::Rendering::AntiAliasing::EAntiAliasingTechnique::NO_ANTI_ALIASING  }
+	COLOR_MAP = 0,
+	ALBEDO_MAP = COLOR_MAP,
+	DIFFUSE_MAP = COLOR_MAP,
+
+	NORMAL_MAP,
+
+	//AO_MAP,
+
+	HEIGHT_MAP,
+
+	METALLIC_MAP,
 
-	, {"ssaa", Settings::Rendering::AntiAliasing::EAntiAliasingTechnique::SSAA }
-	, {"SSAA", Settings::Rendering::AntiAliasing::EAntiAliasingTechnique::SSAA }
+	ROUGHNESS_MAP,
 
-	// , {"MSAA", Settings::Rendering::AntiAliasing::EAntiAliasingTechnique::MSAA } // TODO:
-	// , {"FXAA", Settings::Rendering::AntiAliasing::EAntiAliasingTechnique::FXAA } // TODO:
+	EMISSIVE_MAP,
+
+	NUM_PBR_TEXTURE_INPUTS = 6
 };
+// 0: colorMap
+// 1: normalMap
+// 2: heightMap
+// 3: metallicMap
+// 4: roughnessMap
+/// 2: aoMap
+using TextureSet = std::array<TextureID, NUM_PBR_TEXTURE_INPUTS>;
 
+enum MaterialType { UNKNOWN, BRDF, PHONG };
 
-std::string GetLowercased(const std::string& str)
+
+// Parser state of a single file: the line being parsed for error reporting 
+// and the blocks (object/light/material) that are open in a scene file.
+//
+struct Parser::ParseContext
 {
-	std::string lowercase(str);
-	std::transform(str.begin(), str.end(), lowercase.begin(), ::tolower);
-	return lowercase;
-}
+	const char*            pFileName = "";
+	const Tokenizer::Line* pLine = nullptr;
+	Renderer*              pRenderer = nullptr;
+
+	// state tracking
+	bool         bIsReadingGameObject = false;
+	bool         bIsReadingLight = false;
+	bool         bIsReadingMaterial = false;
+	MaterialType materialType = MaterialType::UNKNOWN;
+	Material*    pMaterial = nullptr;
+	GameObject*  pObject = nullptr;
+	Light        light;
+	TextureSet   textureSet;
+
+	inline const Tokenizer::Token& Token(size_t i) const { return (*pLine)[i]; }
+
+	template<class... Args> void Error(const Tokenizer::Token& token, const char* format, Args&&... args) const
+	{
+		char msg[Log::LEN_MSG_BUFFER];
+		sprintf_s(msg, format, args...);
+		Log::Error("%s(%u:%u): %s", pFileName, pLine->number, token.column, msg);
+	}
+	template<class... Args> void Warning(const Tokenizer::Token& token, const char* format, Args&&... args) const
+	{
+		char msg[Log::LEN_MSG_BUFFER];
+		sprintf_s(msg, format, args...);
+		Log::Warning("%s(%u:%u): %s", pFileName, pLine->number, token.column, msg);
+	}
+
+	// returns false if the line should be skipped
+	bool BeginLine(const Tokenizer::Line& line)
+	{
+		pLine = &line;
+		if (line.bTruncated)
+		{
+			Error(line[0], "Line has more than %d tokens, skipping \"%.*s\"", static_cast<int>(Tokenizer::MAX_TOKENS_PER_LINE), static_cast<int>(line[0].text.size()), line[0].text.data());
+			return false;
+		}
+		return true;
+	}
+
+	bool RequireParameters(size_t numParameters) const
+	{
+		const size_t numGiven = pLine->size() - 1;
+		if (numGiven >= numParameters)
+			return true;
+		Error(Token(0), "\"%.*s\" expects %d parameter(s), got %d", static_cast<int>(Token(0).text.size()), Token(0).text.data(), static_cast<int>(numParameters), static_cast<int>(numGiven));
+		return false;
+	}
+
+	bool ReadFloat(size_t i, float& out) const
+	{
+		if (Tokenizer::ParseFloat(Token(i).text, out))
+			return true;
+		Error(Token(i), "Expected a number, got \"%.*s\"", static_cast<int>(Token(i).text.size()), Token(i).text.data());
+		return false;
+	}
+	bool ReadFloats(size_t first, size_t count, float* pOut) const
+	{
+		for (size_t i = 0; i < count; ++i)
+			if (!ReadFloat(first + i, pOut[i]))
+				return false;
+		return true;
+	}
+	bool ReadInt(size_t i, int& out) const
+	{
+		if (Tokenizer::ParseInt(Token(i).text, out))
+			return true;
+		Error(Token(i), "Expected an integer, got \"%.*s\"", static_cast<int>(Token(i).text.size()), Token(i).text.data());
+		return false;
+	}
+	bool ReadBool(size_t i, bool& out) const
+	{
+		if (Tokenizer::ParseBool(Token(i).text, out))
+			return true;
+		Error(Token(i), "Expected true/false, got \"%.*s\"", static_cast<int>(Token(i).text.size()), Token(i).text.data());
+		return false;
+	}
+
+	// optional parameters keep @out when they're not specified
+	bool ReadOptionalFloat(size_t i, float& out) const { return i >= pLine->size() || ReadFloat(i, out); }
+	bool ReadOptionalInt(size_t i, int& out) const     { return i >= pLine->size() || ReadInt(i, out); }
+	bool ReadOptionalBool(size_t i, bool& out) const   { return i >= pLine->size() || ReadBool(i, out); }
+};
 
 
 Parser::Parser(){}
@@ -69,18 +174,18 @@ Settings::Engine Parser::ReadSettings(const std::string& settingsFileName)
 	const std::string filePath = settingsFileName;
 	Settings::Engine setting;
 
-	std::ifstream settingsFile(filePath.c_str());
-	if (settingsFile.is_open())
+	MemoryMappedFile settingsFile;
+	if (settingsFile.Open(filePath))
 	{
-		std::string	line;
-		while (getline(settingsFile, line))
-		{
-			if (line.empty()) continue;
-			if (line[0] == '/' || line[0] == '#')					// skip comments
-				continue;
+		ParseContext context;
+		context.pFileName = filePath.c_str();
 
-			std::vector<std::string> command = StrUtil::split(line, ' ');	// ignore whitespace
-			ParseSetting(command, setting);							// process command
+		Tokenizer::LineReader reader(static_cast<const char*>(settingsFile.GetData()), settingsFile.GetSize());
+		Tokenizer::Line line;
+		while (reader.ReadLine(line))
+		{
+			if (context.BeginLine(line))
+				ParseSetting(context, setting);	// process command
 		}
 		Log::Info("Initialized engine settings.");
 	}
@@ -92,150 +197,285 @@ Settings::Engine Parser::ReadSettings(const std::string& settingsFileName)
 	return setting;
 }
 
-void Parser::ParseSetting(const std::vector<std::string>& line, Settings::Engine& settings)
+void Parser::ParseSetting(ParseContext& context, Settings::Engine& settings)
 {
-	if (line.empty())
+	const Tokenizer::Line& line = *context.pLine;
+	const std::string_view cmd = line[0].text;
+	switch (Hash(cmd))
 	{
-		Log::Error("Empty Command in ParseSettings().");
-		return;
-	}
-
-	const std::string& cmd = line[0];
-	if (cmd == "window")
+	case Hash("window"):
 	{
+		if (cmd != "window") break;
 		// Parameters
 		//---------------------------------------------------------------
 		// | Window Width	|  Window Height	| Fullscreen?	| VSYNC?
 		//---------------------------------------------------------------
-		settings.window.width      = stoi(line[1]);
-		settings.window.height     = stoi(line[2]);
-		settings.window.fullscreen = stoi(line[3]);
-		settings.window.vsync      = stoi(line[4]);
+		int values[4];
+		if (!context.RequireParameters(4)) return;
+		for (size_t i = 0; i < 4; ++i) 
+			if (!context.ReadInt(i + 1, values[i])) return;
+		settings.window.width      = values[0];
+		settings.window.height     = values[1];
+		settings.window.fullscreen = values[2];
+		settings.window.vsync      = values[3];
+		return;
 	}
-	else if (cmd == "logger" || cmd == "logging" || cmd == "log")
+	case Hash("logger"): case Hash("logging"): case Hash("log"):
 	{
+		if (cmd != "logger" && cmd != "logging" && cmd != "log") break;
 		// Parameters
 		//---------------------------------------------------------------
 		// | Logger	|  Use Console Window	| Use File in AppData\VQEngine
 		//---------------------------------------------------------------
-		settings.logger.bConsole = sBoolTypeReflection.at(line[1]);
-		settings.logger.bFile    = sBoolTypeReflection.at(line[2]);
+		bool bConsole, bFile;
+		if (!context.RequireParameters(2) || !context.ReadBool(1, bConsole) || !context.ReadBool(2, bFile)) return;
+		settings.logger.bConsole = bConsole;
+		settings.logger.bFile    = bFile;
+		return;
+	}
+	case Hash("profilerCapture"):
+	{
+		if (cmd != "profilerCapture") break;
+		// Parameters
+		//---------------------------------------------------------------
+		// | Frame Count	| Capture Loading? (optional)
+		//---------------------------------------------------------------
+		int frameCount;
+		bool bCaptureLoading = settings.profiler.bCaptureLoading;
+		if (!context.RequireParameters(1) || !context.ReadInt(1, frameCount) || !context.ReadOptionalBool(2, bCaptureLoading)) return;
+		settings.profiler.captureFrameCount = frameCount;
+		settings.profiler.bCaptureLoading   = bCaptureLoading;
+		return;
+	}
+	case Hash("benchmark"):
+	{
+		if (cmd != "benchmark") break;
+		using ECameraPath = Settings::Benchmark::ECameraPath;
+		// Parameters
+		//---------------------------------------------------------------
+		// | Frame Count (per scene)	| Time Step (ms)	| spline/recorded
+		//---------------------------------------------------------------
+		int frameCount;
+		float timeStepMs;
+		if (!context.RequireParameters(3) || !context.ReadInt(1, frameCount) || !context.ReadFloat(2, timeStepMs)) return;
+
+		const std::string_view cameraPath = line[3].text;
+		ECameraPath eCameraPath;
+		if      (EqualsIgnoreCase(cameraPath, "spline"))   eCameraPath = ECameraPath::SPLINE;
+		else if (EqualsIgnoreCase(cameraPath, "recorded")) eCameraPath = ECameraPath::RECORDED;
+		else
+		{
+			context.Error(line[3], "Unknown benchmark camera path: %.*s", static_cast<int>(cameraPath.size()), cameraPath.data());
+			return;
+		}
+		settings.benchmark.numFrames  = frameCount;
+		settings.benchmark.timeStep   = timeStepMs / 1000.0f;
+		settings.benchmark.cameraPath = eCameraPath;
+		return;
+	}
+	case Hash("benchmarkThresholds"):
+	{
+		if (cmd != "benchmarkThresholds") break;
+		// Parameters
+		//---------------------------------------------------------------
+		// | Frame Time %	| Stage Time %	| Counts % (draw calls, culling, ...)
+		//---------------------------------------------------------------
+		float frameTime, stageTime, counts;
+		if (!context.RequireParameters(3) || !context.ReadFloat(1, frameTime) || !context.ReadFloat(2, stageTime) || !context.ReadFloat(3, counts)) return;
+		settings.benchmark.frameTimeThreshold = frameTime;
+		settings.benchmark.stageTimeThreshold = stageTime;
+		settings.benchmark.countThreshold     = counts;
+		return;
 	}
-	else if (cmd == "shadowMap")
+	case Hash("benchmarkBaseline"):
 	{
+		if (cmd != "benchmarkBaseline") break;
+		// Parameters
+		//---------------------------------------------------------------
+		// | Baseline file path (relative to the working directory)
+		//---------------------------------------------------------------
+		if (!context.RequireParameters(1)) return;
+		settings.benchmark.baselineFile = std::string(line[1].text);
+		return;
+	}
+	case Hash("benchmarkScenes"):
+	{
+		if (cmd != "benchmarkScenes") break;
+		for (size_t i = 1; i < line.size(); ++i)
+		{
+			// separated with commas like the levels, e.g. "benchmarkScenes Sponza.scn, StressTest.scn"
+			std::string_view sceneName = line[i].text;
+			if (sceneName.back() == ',')
+				sceneName.remove_suffix(1);
+			if (!sceneName.empty())
+				settings.benchmark.sceneNames.emplace_back(sceneName);
+		}
+		return;
+	}
+	case Hash("shadowMap"):
+	{
+		if (cmd != "shadowMap") break;
 		// Parameters
 		//---------------------------------------------------------------
 		// | Shadow Map dimension
 		//---------------------------------------------------------------
-		settings.rendering.shadowMap.spotShadowMapDimensions = stoi(line[1]);
-		settings.rendering.shadowMap.directionalShadowMapDimensions = stoi(line[2]);
-		settings.rendering.shadowMap.pointShadowMapDimensions = stoi(line[3]);
+		int spot, directional, point;
+		if (!context.RequireParameters(3) || !context.ReadInt(1, spot) || !context.ReadInt(2, directional) || !context.ReadInt(3, point)) return;
+		settings.rendering.shadowMap.spotShadowMapDimensions = spot;
+		settings.rendering.shadowMap.directionalShadowMapDimensions = directional;
+		settings.rendering.shadowMap.pointShadowMapDimensions = point;
+		return;
 	}
-	else if (cmd == "lightingModel")
+	case Hash("lightingModel"):
 	{
+		if (cmd != "lightingModel") break;
 		// Parameters
 		//---------------------------------------------------------------
 		// | phong/brdf
 		//---------------------------------------------------------------
-		const std::string lightingModel = GetLowercased(line[1]);
-		settings.rendering.bUseBRDFLighting =  lightingModel == "brdf";
+		if (!context.RequireParameters(1)) return;
+		settings.rendering.bUseBRDFLighting = EqualsIgnoreCase(line[1].text, "brdf");
+		return;
 	}
-	else if (cmd == "deferredRendering")
+	case Hash("deferredRendering"):
 	{
-		settings.rendering.bUseDeferredRendering = sBoolTypeReflection.at(line[1]);
+		if (cmd != "deferredRendering") break;
+		bool bEnabled;
+		if (!context.RequireParameters(1) || !context.ReadBool(1, bEnabled)) return;
+		settings.rendering.bUseDeferredRendering = bEnabled;
+		return;
 	}
-	else if (cmd == "ambientOcclusion")
+	case Hash("ambientOcclusion"):
 	{
-		settings.rendering.bAmbientOcclusion= sBoolTypeReflection.at(line[1]);
+		if (cmd != "ambientOcclusion") break;
+		bool bEnabled;
+		if (!context.RequireParameters(1) || !context.ReadBool(1, bEnabled)) return;
+		settings.rendering.bAmbientOcclusion = bEnabled;
+		return;
 	}
-	else if (cmd == "tonemapping")
+	case Hash("tonemapping"):
 	{
+		if (cmd != "tonemapping") break;
 		// Parameters
 		//---------------------------------------------------------------
 		// | Exposure
 		//---------------------------------------------------------------
-		settings.rendering.postProcess.toneMapping.exposure = stof(line[1]);
+		float exposure;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, exposure)) return;
+		settings.rendering.postProcess.toneMapping.exposure = exposure;
+		return;
 	}
-	else if (cmd == "environmentMapping")
+	case Hash("environmentMapping"):
 	{
+		if (cmd != "environmentMapping") break;
 		// Parameters
 		//---------------------------------------------------------------
-		// | Environment Mapping enabled?
+		// | Environment Mapping enabled? | Preload? | Cache on disk? (optional)
 		//---------------------------------------------------------------
-		settings.rendering.bEnableEnvironmentLighting = sBoolTypeReflection.at(GetLowercased(line[1]));
-		settings.rendering.bPreLoadEnvironmentMaps	  = sBoolTypeReflection.at(GetLowercased(line[2]));
-		if(line.size() > 3)
-			settings.bCacheEnvironmentMapsOnDisk          = sBoolTypeReflection.at(GetLowercased(line[3]));
+		bool bEnabled, bPreload, bCacheOnDisk = settings.bCacheEnvironmentMapsOnDisk;
+		if (!context.RequireParameters(2) || !context.ReadBool(1, bEnabled) || !context.ReadBool(2, bPreload) || !context.ReadOptionalBool(3, bCacheOnDisk)) return;
+		settings.rendering.bEnableEnvironmentLighting = bEnabled;
+		settings.rendering.bPreLoadEnvironmentMaps	  = bPreload;
+		settings.bCacheEnvironmentMapsOnDisk          = bCacheOnDisk;
 #if _DEBUG
 		settings.rendering.bPreLoadEnvironmentMaps = false;
 #endif
+		return;
 	}
-	else if (cmd == "HDR")
+	case Hash("HDR"):
 	{
+		if (cmd != "HDR") break;
 		// Parameters
 		//---------------------------------------------------------------
 		// | Enabled?
 		//---------------------------------------------------------------
-		settings.rendering.postProcess.HDREnabled = sBoolTypeReflection.at(GetLowercased(line[1]));
+		bool bEnabled;
+		if (!context.RequireParameters(1) || !context.ReadBool(1, bEnabled)) return;
+		settings.rendering.postProcess.HDREnabled = bEnabled;
+		return;
 	}
-	else if (cmd == "levels")
+	case Hash("levels"):
 	{
-		const size_t countScenes = line.size() - 1;
-		for (size_t i = 0; i < countScenes; ++i)
+		if (cmd != "levels") break;
+		for (size_t i = 1; i < line.size(); ++i)
 		{
-			// all lines except the las one will contain a ',' in the end, e.g. "Objects.scn,"
-			// the following will remove the commas except for the last scene in the line[] array
-			settings.sceneNames.push_back(i == countScenes - 1
-				? line[i + 1]
-				: StrUtil::split(line[i + 1], ',')[0]	
-			);
+			// scene names are separated with commas, e.g. "levels Objects.scn, SSAOTest.scn"
+			std::string_view sceneName = line[i].text;
+			if (sceneName.back() == ',')
+				sceneName.remove_suffix(1);
+			if (!sceneName.empty())
+				settings.sceneNames.emplace_back(sceneName);
 		}
+		return;
 	}
-	else if (cmd == "level")
+	case Hash("level"):
 	{
+		if (cmd != "level") break;
 		// Parameters
 		//---------------------------------------------------------------
-		// | Enabled?
+		// | Level index (1-based)
 		//---------------------------------------------------------------
-		settings.levelToLoad = stoi(line[1]) - 1;	// input file assumes 1 as first index
+		int level;
+		if (!context.RequireParameters(1) || !context.ReadInt(1, level)) return;
+		settings.levelToLoad = level - 1;	// input file assumes 1 as first index
 		if (settings.levelToLoad == -1) settings.levelToLoad = 0;
+		return;
 	}
-	else if (cmd == "antialiasing" || cmd == "antiAliasing")
+	case Hash("antialiasing"): case Hash("antiAliasing"):
 	{
-		assert(line.size() >= 3);
-		settings.rendering.antiAliasing.eAntiAliasingTechnique = sAATypeReflection.at(line[1]);
-		settings.rendering.antiAliasing.fUpscaleFactor = std::stof(line[2]);
-	}
-	else
-	{
-		Log::Error("Setting Parser: Unknown command: %s", cmd);
+		if (cmd != "antialiasing" && cmd != "antiAliasing") break;
+		using EAntiAliasingTechnique = Settings::Rendering::AntiAliasing::EAntiAliasingTechnique;
+		// Parameters
+		//---------------------------------------------------------------
+		// | none/ssaa | Upscale Factor
+		//---------------------------------------------------------------
+		float upscaleFactor;
+		if (!context.RequireParameters(2)) return;
+
+		const std::string_view technique = line[1].text;
+		EAntiAliasingTechnique eTechnique;
+		if      (technique == "0" || EqualsIgnoreCase(technique, "none")) eTechnique = EAntiAliasingTechnique::NO_ANTI_ALIASING;
+		else if (EqualsIgnoreCase(technique, "ssaa"))                     eTechnique = EAntiAliasingTechnique::SSAA;
+		// TODO: MSAA, FXAA
+		else
+		{
+			context.Error(line[1], "Unknown anti-aliasing technique: %.*s", static_cast<int>(technique.size()), technique.data());
+			return;
+		}
+
+		if (!context.ReadFloat(2, upscaleFactor)) return;
+		settings.rendering.antiAliasing.eAntiAliasingTechnique = eTechnique;
+		settings.rendering.antiAliasing.fUpscaleFactor = upscaleFactor;
 		return;
 	}
+	}
+
+	context.Error(line[0], "Setting Parser: Unknown command: %.*s", static_cast<int>(cmd.size()), cmd.data());
 }
 
 SerializedScene Parser::ReadScene(Renderer* pRenderer, const std::string& sceneFileName)
 {
 	SerializedScene scene;
 	std::string filePath = scene_root + sceneFileName;
-	std::ifstream sceneFile(filePath.c_str());
 
 	scene.materials.Clear();
 	scene.materials.Initialize(4096);
 	scene.directionalLight.mbEnabled = false;
 
-	if (sceneFile.is_open())
+	MemoryMappedFile sceneFile;
+	if (sceneFile.Open(filePath))
 	{
-		std::string	line;
-		while (getline(sceneFile, line))
+		ParseContext context;
+		context.pFileName = filePath.c_str();
+		context.pRenderer = pRenderer;
+		context.textureSet.fill(INVALID_TEXTURE_ID);
+
+		Tokenizer::LineReader reader(static_cast<const char*>(sceneFile.GetData()), sceneFile.GetSize());
+		Tokenizer::Line line;
+		while (reader.ReadLine(line))
 		{
-			if (line[0] == '/' || line[0] == '#' || line[0] == '\0')	// skip comments
-				continue;
-			
-			std::vector<std::string> command = StrUtil::split(line, ' ', '\t');	// ignore whitespace
-			if (command.size() > 0 && (command.front()[0] == command.front()[1]) && command.front()[0] == '/')
-				continue;
-
-			ParseScene(pRenderer, command, scene);						// process command
+			if (context.BeginLine(line))
+				ParseScene(context, scene);	// process command
 		}
 		scene.loadSuccess = '1';
 	}
@@ -245,7 +485,6 @@ SerializedScene Parser::ReadScene(Renderer* pRenderer, const std::string& sceneF
 		scene.loadSuccess = '0';
 	}
 
-	sceneFile.close();
 	return scene;
 }
 
@@ -265,111 +504,104 @@ SerializedScene Parser::ReadScene(Renderer* pRenderer, const std::string& sceneF
 // Object		: transform, brdf/phong, mesh
 // ---------------------------------------------------------------------------------------------------------------
 
-// state tracking
-static bool bIsReadingGameObject = false;
-static bool bIsReadingLight = false;
-static bool bIsReadingMaterial = false;
-
-enum MaterialType { UNKNOWN, BRDF, PHONG };
-static MaterialType materialType = MaterialType::UNKNOWN;
-static Material* pMaterial = nullptr;
-static GameObject* pObject = nullptr;
-
-Light sLight = Light();
-
-enum EPBRTextures
+static bool GetLightType(std::string_view str, Light::ELightType& out)
 {
-	COLOR_MAP = 0,
-	ALBEDO_MAP = COLOR_MAP,
-	DIFFUSE_MAP = COLOR_MAP,
-
-	NORMAL_MAP,
-
-	//AO_MAP,
-
-	HEIGHT_MAP,
-
-	METALLIC_MAP,
-
-	ROUGHNESS_MAP,
-
-	EMISSIVE_MAP,
-
-	NUM_PBR_TEXTURE_INPUTS = 6
-};
-// 0: colorMap
-// 1: normalMap
-// 2: heightMap
-// 3: metallicMap
-// 4: roughnessMap
-/// 2: aoMap
-static std::array<TextureID, NUM_PBR_TEXTURE_INPUTS> sTextureSet;
-
-using ParseFunctionType = void(__cdecl *)(const std::vector<std::string>&);
-using ParseFunctionLookup = std::unordered_map<std::string, ParseFunctionType>;
-
-static const std::unordered_map<std::string, Light::ELightType>	sLightTypeLookup
-{ 
-	{"s", Light::ELightType::SPOT },
-	{"p", Light::ELightType::POINT},
-	{"d", Light::ELightType::DIRECTIONAL},
-
-	{"spot", Light::ELightType::SPOT },
-	{"point", Light::ELightType::POINT},
-	{"directional", Light::ELightType::DIRECTIONAL},
-};
+	switch (Tokenizer::HashLowercase(str))
+	{
+	case Hash("s"): case Hash("spot"):
+		if (!EqualsIgnoreCase(str, "s") && !EqualsIgnoreCase(str, "spot")) return false;
+		out = Light::ELightType::SPOT;
+		return true;
+	case Hash("p"): case Hash("point"):
+		if (!EqualsIgnoreCase(str, "p") && !EqualsIgnoreCase(str, "point")) return false;
+		out = Light::ELightType::POINT;
+		return true;
+	case Hash("d"): case Hash("directional"):
+		if (!EqualsIgnoreCase(str, "d") && !EqualsIgnoreCase(str, "directional")) return false;
+		out = Light::ELightType::DIRECTIONAL;
+		return true;
+	}
+	return false;
+}
 
-static const std::unordered_map<std::string, const LinearColor&>		sColorLookup
+static bool GetPaletteColor(std::string_view str, LinearColor& out)
 {
-	{"orange"    , LinearColor::s_palette[ static_cast<int>(EColorValue::ORANGE     )]},
-	{"black"     , LinearColor::s_palette[ static_cast<int>(EColorValue::BLACK      )]},
-	{"white"     , LinearColor::s_palette[ static_cast<int>(EColorValue::WHITE      )]},
-	{"red"       , LinearColor::s_palette[ static_cast<int>(EColorValue::RED        )]},
-	{"green"     , LinearColor::s_palette[ static_cast<int>(EColorValue::GREEN      )]},
-	{"blue"      , LinearColor::s_palette[ static_cast<int>(EColorValue::BLUE       )]},
-	{"yellow"    , LinearColor::s_palette[ static_cast<int>(EColorValue::YELLOW     )]},
-	{"magenta"   , LinearColor::s_palette[ static_cast<int>(EColorValue::MAGENTA    )]},
-	{"cyan"      , LinearColor::s_palette[ static_cast<int>(EColorValue::CYAN       )]},
-	{"gray"      , LinearColor::s_palette[ static_cast<int>(EColorValue::GRAY       )]},
-	{"light_gray", LinearColor::s_palette[ static_cast<int>(EColorValue::LIGHT_GRAY )]},
-	{"orange"    , LinearColor::s_palette[ static_cast<int>(EColorValue::ORANGE     )]},
-	{"purple"    , LinearColor::s_palette[ static_cast<int>(EColorValue::PURPLE     )]},
-	{"sun"       , LinearColor::s_palette[ static_cast<int>(EColorValue::SUN        )]}
-};
-
-// todo: get rid of else ifs for cmd == "" comparison... 
-// perhaps use a function lookup?
-// or define static functions in corresponding objects?
-// might as well use some preprocessor magic... 
-
-//static const ParseFunctionLookup sParseCommandFn =
-//{	
-//	{"camera", [](const std::vector<std::string>& cmds) -> void 
-//	{
-//		const auto& cmd = cmds[0];
-//		
-//	}
-//	}
-//};
-
-
+	struct NamedColor { std::string_view name; EColorValue value; };
+	static constexpr NamedColor sColors[] =
+	{
+		{ "orange"    , EColorValue::ORANGE     },
+		{ "black"     , EColorValue::BLACK      },
+		{ "white"     , EColorValue::WHITE      },
+		{ "red"       , EColorValue::RED        },
+		{ "green"     , EColorValue::GREEN      },
+		{ "blue"      , EColorValue::BLUE       },
+		{ "yellow"    , EColorValue::YELLOW     },
+		{ "magenta"   , EColorValue::MAGENTA    },
+		{ "cyan"      , EColorValue::CYAN       },
+		{ "gray"      , EColorValue::GRAY       },
+		{ "light_gray", EColorValue::LIGHT_GRAY },
+		{ "purple"    , EColorValue::PURPLE     },
+		{ "sun"       , EColorValue::SUN        },
+	};
+	for (const NamedColor& color : sColors)
+	{
+		if (EqualsIgnoreCase(str, color.name))
+		{
+			out = LinearColor::s_palette[static_cast<int>(color.value)];
+			return true;
+		}
+	}
+	return false;
+}
 
+static bool GetBuiltinMesh(std::string_view str, EGeometry& out)
+{
+	struct NamedMesh { std::string_view name; EGeometry value; };
+	static constexpr NamedMesh sMeshes[] =
+	{
+		{ "triangle" , EGeometry::TRIANGLE },
+		{ "quad"     , EGeometry::QUAD     },
+		{ "cube"     , EGeometry::CUBE     },
+		{ "sphere"   , EGeometry::SPHERE   },
+		{ "grid"     , EGeometry::GRID     },
+		{ "cylinder" , EGeometry::CYLINDER },
+		{ "cone"     , EGeometry::CONE     },
+		// todo: assimp mesh
+	};
+	for (const NamedMesh& mesh : sMeshes)
+	{
+		if (EqualsIgnoreCase(str, mesh.name))
+		{
+			out = mesh.value;
+			return true;
+		}
+	}
+	return false;
+}
 
-static std::unordered_map<std::string, int> TEXTURE_MAP_CMD_INDEX_LOOKUP =
+static int GetTextureMapIndex(std::string_view cmd)
 {
-	  { "colorMap", 0 }
-	, { "diffuseMap", 0 }
-	, { "albedoMap", 0 }
-	, { "normalMap", 1 }
-	, { "heightMap", 2 }
-	, { "metallicMap", 3 }
-	, { "roughnessMap", 4 }
-	, { "emissiveMap", 5 }
-};
+	struct NamedTextureMap { std::string_view name; int index; };
+	static constexpr NamedTextureMap sTextureMaps[] =
+	{
+		  { "colorMap"    , COLOR_MAP     }
+		, { "diffuseMap"  , DIFFUSE_MAP   }
+		, { "albedoMap"   , ALBEDO_MAP    }
+		, { "normalMap"   , NORMAL_MAP    }
+		, { "heightMap"   , HEIGHT_MAP    }
+		, { "metallicMap" , METALLIC_MAP  }
+		, { "roughnessMap", ROUGHNESS_MAP }
+		, { "emissiveMap" , EMISSIVE_MAP  }
+	};
+	for (const NamedTextureMap& textureMap : sTextureMaps)
+		if (cmd == textureMap.name)
+			return textureMap.index;
+	return -1;
+}
 
-static std::array<TextureID, NUM_PBR_TEXTURE_INPUTS> LoadPBRPreset(Renderer* pRenderer, const std::string& presetPath)
+static TextureSet LoadPBRPreset(Renderer* pRenderer, const std::string& presetPath)
 {
-	std::array<TextureID, NUM_PBR_TEXTURE_INPUTS> textureSet;
+	TextureSet textureSet;
 	for (int i = 0; i < NUM_PBR_TEXTURE_INPUTS; ++i) textureSet[i] = INVALID_TEXTURE_ID;
 
 	static std::unordered_map<std::string, int> CG_BOOKCASE_TEXTURE_TYPE_LOOKUP = 
@@ -452,8 +684,8 @@ static std::array<TextureID, NUM_PBR_TEXTURE_INPUTS> LoadPBRPreset(Renderer* pRe
 	return textureSet;
 }
 
-static void ResetPresets(std::array<TextureID, NUM_PBR_TEXTURE_INPUTS>& textureSet) { for (int i = 0; i < NUM_PBR_TEXTURE_INPUTS; ++i) textureSet[i] = -1; }
-static void AssignPresets(BRDF_Material*& pMat, const std::array<TextureID, NUM_PBR_TEXTURE_INPUTS>& textureSet)
+static void ResetPresets(TextureSet& textureSet) { for (int i = 0; i < NUM_PBR_TEXTURE_INPUTS; ++i) textureSet[i] = -1; }
+static void AssignPresets(BRDF_Material*& pMat, const TextureSet& textureSet)
 {
 	pMat->diffuseMap = textureSet[COLOR_MAP];
 	pMat->normalMap = textureSet[NORMAL_MAP];
@@ -466,269 +698,303 @@ static void AssignPresets(BRDF_Material*& pMat, const std::array<TextureID, NUM_
 
 static void LoadPBRPreset(Renderer* pRenderer, const std::string& presetPath, BRDF_Material*& pMaterial)
 {
-	std::array<TextureID, NUM_PBR_TEXTURE_INPUTS> textureSet = LoadPBRPreset(pRenderer, presetPath);
+	TextureSet textureSet = LoadPBRPreset(pRenderer, presetPath);
 	AssignPresets(pMaterial, textureSet);
 }
 
-void Parser::ParseScene(Renderer* pRenderer, const std::vector<std::string>& command, SerializedScene& scene)
+void Parser::ParseScene(ParseContext& context, SerializedScene& scene)
 {
-	if (command.empty()){return;}
-	const std::string& cmd = command[0];	// shorthand
-	if (cmd == "camera") // there's a lot of else's... :( (todo: use a map of function pointers...)
+	const Tokenizer::Line& command = *context.pLine;
+	const std::string_view cmd = command[0].text;	// shorthand
+	const int cmdLength = static_cast<int>(cmd.size());
+	switch (Hash(cmd))
 	{
-		if (command.size() != 9)
-		{
-			Log::Info("camera input parameter count != 4");
-			assert(command.size() == 9);
-		}
-		// #Parameters: 3
+	case Hash("camera"):
+	{
+		if (cmd != "camera") break;
+		// #Parameters: 8
 		//--------------------------------------------------------------
 		// |  Near Plane	| Far Plane	|	Field of View	| Position | Rotation
 		//--------------------------------------------------------------
+		float values[8];
+		if (!context.RequireParameters(8) || !context.ReadFloats(1, 8, values)) return;
 		Settings::Camera camSettings;
-		camSettings.nearPlane	= stof(command[1]);
-		camSettings.farPlane	= stof(command[2]);
-		camSettings.fovV		= stof(command[3]);
-		camSettings.x           = stof(command[4]);
-		camSettings.y           = stof(command[5]);
-		camSettings.z           = stof(command[6]);
-		camSettings.yaw         = stof(command[7]);
-		camSettings.pitch       = stof(command[8]);
+		camSettings.nearPlane	= values[0];
+		camSettings.farPlane	= values[1];
+		camSettings.fovV		= values[2];
+		camSettings.x           = values[3];
+		camSettings.y           = values[4];
+		camSettings.z           = values[5];
+		camSettings.yaw         = values[6];
+		camSettings.pitch       = values[7];
 		scene.cameras.push_back(camSettings);
+		return;
 	}
-	else if (cmd == "light")
+	case Hash("light"):
 	{
-		// #Parameters: 2
+		if (cmd != "light") break;
+		// #Parameters: 1
 		//--------------------------------------------------------------
 		// begin/end
 		//--------------------------------------------------------------
-		const std::string objCmd = GetLowercased(command[1]);
-		if (objCmd == "begin")
+		if (!context.RequireParameters(1)) return;
+		const std::string_view objCmd = command[1].text;
+		if (EqualsIgnoreCase(objCmd, "begin"))
 		{
-			if (bIsReadingLight)
+			if (context.bIsReadingLight)
 			{
-				Log::Error(" expecting \"light end\" before starting a new light definition");
+				context.Error(command[1], "Expecting \"light end\" before starting a new light definition");
 				return;
 			}
-			bIsReadingLight = true; 
-			sLight = Light();
+			context.bIsReadingLight = true; 
+			context.light = Light();
 		}
-
-		if (objCmd == "end")
+		else if (EqualsIgnoreCase(objCmd, "end"))
 		{
-			if (!bIsReadingLight)
+			if (!context.bIsReadingLight)
 			{
-				Log::Error(" expecting \"light begin\" before ending a light definition");
+				context.Error(command[1], "Expecting \"light begin\" before ending a light definition");
 				return;
 			}
-			bIsReadingLight = false;
+			context.bIsReadingLight = false;
 			
-			if (sLight.mType == Light::ELightType::DIRECTIONAL)
-				scene.directionalLight = sLight;
+			if (context.light.mType == Light::ELightType::DIRECTIONAL)
+				scene.directionalLight = context.light;
 			else
-				scene.lights.push_back(sLight);
+				scene.lights.push_back(context.light);
 		}
+		else
+		{
+			context.Error(command[1], "Expecting \"begin\" or \"end\", got \"%.*s\"", static_cast<int>(objCmd.size()), objCmd.data());
+		}
+		return;
 	}
-
-	else if (cmd == "object")
+	case Hash("object"):
 	{
-		// #Parameters: 2
+		if (cmd != "object") break;
+		// #Parameters: 1
 		//--------------------------------------------------------------
 		// begin/end
 		//--------------------------------------------------------------
-		const std::string objCmd = GetLowercased(command[1]);
-		if (objCmd == "begin")
+		if (!context.RequireParameters(1)) return;
+		const std::string_view objCmd = command[1].text;
+		if (EqualsIgnoreCase(objCmd, "begin"))
 		{
-			if (bIsReadingGameObject)
+			if (context.bIsReadingGameObject)
 			{
-				Log::Error(" expecting \"object end\" before starting a new object definition");
+				context.Error(command[1], "Expecting \"object end\" before starting a new object definition");
 				return;
 			}
-			bIsReadingGameObject = true;
-			pObject = scene.CreateNewGameObject();
+			context.bIsReadingGameObject = true;
+			context.pObject = scene.CreateNewGameObject();
 		}
-
-		if (objCmd == "end")
+		else if (EqualsIgnoreCase(objCmd, "end"))
 		{
-			if (!bIsReadingGameObject)
+			if (!context.bIsReadingGameObject)
 			{
-				Log::Error(" expecting \"object begin\" before ending an object definition");
+				context.Error(command[1], "Expecting \"object begin\" before ending an object definition");
 				return;
 			}
-			bIsReadingGameObject = false;
-			pObject = nullptr;
+			context.bIsReadingGameObject = false;
+			context.pObject = nullptr;
+		}
+		else
+		{
+			context.Error(command[1], "Expecting \"begin\" or \"end\", got \"%.*s\"", static_cast<int>(objCmd.size()), objCmd.data());
 		}
+		return;
 	}
 
 
 	// material
-	else if (cmd == "pbr")
+	case Hash("pbr"):
 	{
-		if (!bIsReadingGameObject)
+		if (cmd != "pbr") break;
+		if (!context.bIsReadingGameObject)
 		{
-			Log::Error(" Creating BRDF Material without defining a game object (missing cmd: \"%s\"", "object begin");
+			context.Error(command[0], "Creating BRDF Material without defining a game object (missing cmd: \"%s\")", "object begin");
 			return;
 		}
+		if (!context.RequireParameters(1)) return;
 
-		const std::string pbrCmd = GetLowercased(command[1]);
+		const std::string_view pbrCmd = command[1].text;
 
 		// PBR BEGIN/END BLOCK 
 		// for custom texture specification per PBR input
 		//
-		if (pbrCmd == "begin")
+		if (EqualsIgnoreCase(pbrCmd, "begin"))
 		{
-			bIsReadingMaterial = true;
-			materialType = BRDF;
-			pMaterial = scene.materials.CreateAndGetMaterial(GGX_BRDF);
-			pObject->AddMaterial(pMaterial);
-			ResetPresets(sTextureSet);
+			context.bIsReadingMaterial = true;
+			context.materialType = BRDF;
+			context.pMaterial = scene.materials.CreateAndGetMaterial(GGX_BRDF);
+			context.pObject->AddMaterial(context.pMaterial);
+			ResetPresets(context.textureSet);
 			return;
 		}
 
 
-		if (pbrCmd == "end")
+		if (EqualsIgnoreCase(pbrCmd, "end"))
 		{
-			materialType = UNKNOWN;
-			bIsReadingMaterial = false;
-			BRDF_Material* pMat = static_cast<BRDF_Material*>(pMaterial);
-			AssignPresets(pMat, sTextureSet);
-			ResetPresets(sTextureSet);
+			context.materialType = UNKNOWN;
+			context.bIsReadingMaterial = false;
+			BRDF_Material* pMat = static_cast<BRDF_Material*>(context.pMaterial);
+			AssignPresets(pMat, context.textureSet);
+			ResetPresets(context.textureSet);
 			return;
 		}
 
 		// PBR PRESET LOADING
 		// pbrCmd := path to preset folder
 		//
-		pMaterial = scene.materials.CreateAndGetMaterial(GGX_BRDF);
-		pObject->AddMaterial(pMaterial);
-		BRDF_Material* pMat = static_cast<BRDF_Material*>(pMaterial);
-		LoadPBRPreset(pRenderer, pbrCmd, pMat);
-		bIsReadingMaterial = false;
-		ResetPresets(sTextureSet);
+		context.pMaterial = scene.materials.CreateAndGetMaterial(GGX_BRDF);
+		context.pObject->AddMaterial(context.pMaterial);
+		BRDF_Material* pMat = static_cast<BRDF_Material*>(context.pMaterial);
+		LoadPBRPreset(context.pRenderer, GetLowercased(std::string(pbrCmd)), pMat);
+		context.bIsReadingMaterial = false;
+		ResetPresets(context.textureSet);
 		return;
 	}
-	else if (std::string(cmd).find("Map") != std::string::npos && cmd.size() >= 5)
+	case Hash("colorMap"):    case Hash("diffuseMap"):   case Hash("albedoMap"): 
+	case Hash("normalMap"):   case Hash("heightMap"):    case Hash("metallicMap"): 
+	case Hash("roughnessMap"): case Hash("emissiveMap"):
 	{	
-		BRDF_Material* pMat = static_cast<BRDF_Material*>(pMaterial);
-		if (TEXTURE_MAP_CMD_INDEX_LOOKUP.find(cmd) == TEXTURE_MAP_CMD_INDEX_LOOKUP.end())
-		{
-			Log::Error("CustomParser: Texture command not found: %s", cmd.c_str());
-			return;
-		}
-
-		int textureMapIndex = TEXTURE_MAP_CMD_INDEX_LOOKUP.at(cmd);
+		const int textureMapIndex = GetTextureMapIndex(cmd);
+		if (textureMapIndex < 0) break;
+		if (!context.RequireParameters(1)) return;
 #if !ENABLE_PARALLAX_MAPPING
 		if(textureMapIndex == HEIGHT_MAP)
 			return;
 #endif
 
-		const std::vector<std::string> tokens = StrUtil::split(command[1], '/');
-		const std::string fileName = tokens.back();
+		// path: [.../]<library>/<preset>/<file>, the texture is loaded from PBR_ROOT/<library>/<preset>/
+		// collect the last 4 components of the path, back to front, skipping the empty ones.
+		const std::string_view path = command[1].text;
+		std::string_view components[4];
+		size_t numComponents = 0;
+		for (size_t end = path.size(); end > 0 && numComponents < 4;)
+		{
+			const size_t separator = path.rfind('/', end - 1);
+			const size_t begin = separator == std::string_view::npos ? 0 : separator + 1;
+			if (begin < end)
+				components[numComponents++] = path.substr(begin, end - begin);
+			end = separator == std::string_view::npos ? 0 : separator;
+		}
+		if (numComponents == 0)
+		{
+			context.Error(command[1], "Invalid texture path: %.*s", static_cast<int>(path.size()), path.data());
+			return;
+		}
 
-		const bool bHasFolder = tokens.size() > 3;
-		const std::string folderPath = bHasFolder
-			? tokens[tokens.size() - 3] + "/" + tokens[tokens.size() - 2] + "/"
-			: (tokens.size() >= 2 ? tokens[tokens.size() - 2] + "/" : "");
+		const std::string fileName(components[0]);
+		std::string folderPath;
+		if (numComponents > 3)	// has folder
+			folderPath.append(components[2]).append("/").append(components[1]).append("/");
+		else if (numComponents >= 2)
+			folderPath.append(components[1]).append("/");
 		
 		const std::string PBR_ROOT = Renderer::sTextureRoot + std::string("PBR/");
 		const bool bGenerateMips = true;
-		sTextureSet[textureMapIndex] = pRenderer->CreateTextureFromFile(fileName, PBR_ROOT + folderPath, bGenerateMips);
+		context.textureSet[textureMapIndex] = context.pRenderer->CreateTextureFromFile(fileName, PBR_ROOT + folderPath, bGenerateMips);
+		return;
 	}
-	else if (cmd == "mesh")
+	case Hash("mesh"):
 	{
+		if (cmd != "mesh") break;
 		// #Parameters: 1
 		//--------------------------------------------------------------
 		// Mesh Name: Cube/Quad/Sphere/Grid/...
 		//--------------------------------------------------------------
-		if (!bIsReadingGameObject)
+		if (!context.bIsReadingGameObject)
 		{
-			Log::Error(" Creating mesh without defining a game object (missing cmd: \"%s\"", "object begin");
+			context.Error(command[0], "Creating mesh without defining a game object (missing cmd: \"%s\")", "object begin");
 			return;
 		}
-		static const std::unordered_map<std::string, EGeometry>		sMeshLookup
-		{
-			{"triangle" , EGeometry::TRIANGLE	},
-			{"quad"     , EGeometry::QUAD		},
-			{"cube"     , EGeometry::CUBE		},
-			{"sphere"   , EGeometry::SPHERE		},
-			{"grid"     , EGeometry::GRID		},
-			{"cylinder" , EGeometry::CYLINDER	},
-			{"cone"     , EGeometry::CONE		}
-			// todo: assimp mesh
-		};
-		const std::string mesh = GetLowercased(command[1]);
+		if (!context.RequireParameters(1)) return;
 
+		EGeometry mesh;
+		if (!GetBuiltinMesh(command[1].text, mesh))
+		{
+			context.Error(command[1], "Unknown mesh: %.*s", static_cast<int>(command[1].text.size()), command[1].text.data());
+			return;
+		}
 		
-		pObject->AddMesh(sMeshLookup.at(mesh));
-		pObject->mModel.mbLoaded = true; // assume model is already loaded as we're using a builtin mesh.
-		//obj.mModel.mMeshID = sMeshLookup.at(mesh);
+		context.pObject->AddMesh(mesh);
+		context.pObject->mModel.mbLoaded = true; // assume model is already loaded as we're using a builtin mesh.
+		return;
 	}
-	else if (cmd == "brdf")
+	case Hash("brdf"):
 	{
+		if (cmd != "brdf") break;
 		// #Parameters: 0
 		//--------------------------------------------------------------
-		if (!bIsReadingGameObject)
+		if (!context.bIsReadingGameObject)
 		{
-			Log::Error(" Creating BRDF Material without defining a game object (missing cmd: \"%s\"", "object begin");
+			context.Error(command[0], "Creating BRDF Material without defining a game object (missing cmd: \"%s\")", "object begin");
 			return;
 		}
-		if (bIsReadingMaterial)
+		if (context.bIsReadingMaterial)
 		{
-			if (materialType != BRDF)
+			if (context.materialType != BRDF)
 			{
-				Log::Error(" Syntax Error: Already defining a Phong material!");
+				context.Error(command[0], "Syntax Error: Already defining a Phong material!");
 				return;
 			}
 
-			materialType = UNKNOWN;
-			bIsReadingMaterial = false;
-			BRDF_Material* pMat = static_cast<BRDF_Material*>(pMaterial);
-			AssignPresets(pMat, sTextureSet);
-			ResetPresets(sTextureSet);
+			context.materialType = UNKNOWN;
+			context.bIsReadingMaterial = false;
+			BRDF_Material* pMat = static_cast<BRDF_Material*>(context.pMaterial);
+			AssignPresets(pMat, context.textureSet);
+			ResetPresets(context.textureSet);
 			return;
 		}
 
-		bIsReadingMaterial = true;
-		materialType = BRDF;
-		pMaterial = scene.materials.CreateAndGetMaterial(GGX_BRDF);
-		pObject->AddMaterial(pMaterial);
-		ResetPresets(sTextureSet);
+		context.bIsReadingMaterial = true;
+		context.materialType = BRDF;
+		context.pMaterial = scene.materials.CreateAndGetMaterial(GGX_BRDF);
+		context.pObject->AddMaterial(context.pMaterial);
+		ResetPresets(context.textureSet);
+		return;
 	}
-	else if (cmd == "blinnphong" || cmd == "phong")
+	case Hash("blinnphong"): case Hash("phong"):
 	{
+		if (cmd != "blinnphong" && cmd != "phong") break;
 		Log::Info("Todo: blinnphong mat");
 		return;
+#if 0
 		// #Parameters: 0
 		//--------------------------------------------------------------
-		if (!bIsReadingGameObject)
+		if (!context.bIsReadingGameObject)
 		{
-			Log::Error(" Creating BlinnPhong Material without defining a game object (missing cmd: \"%s\"", "object begin");
+			context.Error(command[0], "Creating BlinnPhong Material without defining a game object (missing cmd: \"%s\")", "object begin");
 			return;
 		}
-		if (bIsReadingMaterial)
+		if (context.bIsReadingMaterial)
 		{
-			if (materialType != PHONG)
+			if (context.materialType != PHONG)
 			{
-				Log::Error(" Syntax Error: Already defining a brdf material!");
+				context.Error(command[0], "Syntax Error: Already defining a brdf material!");
 				return;
 			}
 
-			materialType = UNKNOWN;
-			bIsReadingMaterial = false;
+			context.materialType = UNKNOWN;
+			context.bIsReadingMaterial = false;
 			return;
 		}
 
-		bIsReadingMaterial = true;
-		materialType = PHONG;
-		pMaterial = scene.materials.CreateAndGetMaterial(BLINN_PHONG);
-		pObject->AddMaterial(pMaterial);
+		context.bIsReadingMaterial = true;
+		context.materialType = PHONG;
+		context.pMaterial = scene.materials.CreateAndGetMaterial(BLINN_PHONG);
+		context.pObject->AddMaterial(context.pMaterial);
+		return;
+#endif
 	}
 
-	else if (cmd == "diffuse" || cmd == "albedo")
+	case Hash("diffuse"): case Hash("albedo"):
 	{
-		if (!bIsReadingMaterial)
+		if (cmd != "diffuse" && cmd != "albedo") break;
+		if (!context.bIsReadingMaterial)
 		{
-			Log::Error(" Cannot define Material Property: %s", cmd.c_str());
+			context.Error(command[0], "Cannot define Material Property: %.*s", cmdLength, cmd.data());
 			return;
 		}
 
@@ -736,36 +1002,28 @@ void Parser::ParseScene(Renderer* pRenderer, const std::vector<std::string>& com
 		//--------------------------------------------------------------
 		// r g b a
 		//--------------------------------------------------------------
-		const std::string firstParam = GetLowercased(command[1]);
+		if (!context.RequireParameters(1)) return;
+		const std::string firstParam = GetLowercased(std::string(command[1].text));
 		if (DirectoryUtil::IsImageName(firstParam))
 		{
-			const TextureID texDiffuse = pRenderer->CreateTextureFromFile(firstParam);
-			pMaterial->diffuseMap = texDiffuse;
+			const TextureID texDiffuse = context.pRenderer->CreateTextureFromFile(firstParam);
+			context.pMaterial->diffuseMap = texDiffuse;
 		}
 		else
 		{
-			assert(command.size() >= 4); // albedo r g b a(optional)
-			const float r = stof(command[1]);
-			const float g = stof(command[2]);
-			const float b = stof(command[3]);
-			
-			if (command.size() == 5)
-			{
-				const float a = stof(command[4]);
-				pMaterial->diffuse = LinearColor(r, g, b);
-				pMaterial->alpha = a;
-			}
-			else
-			{
-				pMaterial->diffuse = LinearColor(r, g, b);
-			}
+			float rgba[4] = { 0.0f, 0.0f, 0.0f, context.pMaterial->alpha };	// albedo r g b a(optional)
+			if (!context.RequireParameters(3) || !context.ReadFloats(1, 3, rgba) || !context.ReadOptionalFloat(4, rgba[3])) return;
+			context.pMaterial->diffuse = LinearColor(rgba[0], rgba[1], rgba[2]);
+			context.pMaterial->alpha = rgba[3];
 		}
+		return;
 	}
-	else if (cmd == "tiling")
+	case Hash("tiling"):
 	{
-		if (!bIsReadingMaterial)
+		if (cmd != "tiling") break;
+		if (!context.bIsReadingMaterial)
 		{
-			Log::Error(" Cannot define Material Property: %s", cmd.c_str());
+			context.Error(command[0], "Cannot define Material Property: %.*s", cmdLength, cmd.data());
 			return;
 		}
 
@@ -773,82 +1031,87 @@ void Parser::ParseScene(Renderer* pRenderer, const std::vector<std::string>& com
 		//--------------------------------------------------------------
 		// tiling(@parm1, @param1) | OR | tiling(@param1, @param2)
 		//--------------------------------------------------------------
-		const float tiling1 = stof(command[1]);
-		const float tiling2 = command.size() > 2 ? stof(command[2]) : tiling1;
-		pMaterial->tiling = vec2(tiling1, tiling2);
+		float tiling1, tiling2;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, tiling1)) return;
+		tiling2 = tiling1;
+		if (!context.ReadOptionalFloat(2, tiling2)) return;
+		context.pMaterial->tiling = vec2(tiling1, tiling2);
+		return;
 	}
-	else if (cmd == "roughness")
+	case Hash("roughness"): case Hash("metalness"):
 	{
-		if (!bIsReadingMaterial || materialType != BRDF)
+		if (cmd != "roughness" && cmd != "metalness") break;
+		if (!context.bIsReadingMaterial || context.materialType != BRDF)
 		{
-			Log::Error(" Cannot define Material Property: roughness ");
+			context.Error(command[0], "Cannot define Material Property: %.*s", cmdLength, cmd.data());
 			return;
 		}
 		// #Parameters: 1
 		//--------------------------------------------------------------
-		// roughness [0.0f, 1.0f]
+		// roughness/metalness [0.0f, 1.0f]
 		//--------------------------------------------------------------
-		static_cast<BRDF_Material*>(pMaterial)->roughness = stof(command[1]);
+		float value;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, value)) return;
+		BRDF_Material* pMat = static_cast<BRDF_Material*>(context.pMaterial);
+		(cmd == "roughness" ? pMat->roughness : pMat->metalness) = value;
+		return;
 	}
-	else if (cmd == "metalness")
+	case Hash("emissive"): case Hash("emissiveColor"):
 	{
-		if (!bIsReadingMaterial || materialType != BRDF)
+		if (cmd != "emissive" && cmd != "emissiveColor") break;
+		if (!context.bIsReadingMaterial)
 		{
-			Log::Error(" Cannot define Material Property: metalness ");
+			context.Error(command[0], "Cannot define Material Property: emissive color");
 			return;
 		}
-		// #Parameters: 1
+
+		// #Parameters: 4 (1 optional)
 		//--------------------------------------------------------------
-		// metalness [0.0f, 1.0f]
+		// r g b intensity(optional)
 		//--------------------------------------------------------------
-		static_cast<BRDF_Material*>(pMaterial)->metalness = stof(command[1]);
-	}
-	else if (cmd == "emissive" || cmd == "emissiveColor")
-	{
-		if (!bIsReadingMaterial)
-		{
-			Log::Error(" Cannot define Material Property: emissive color ");
-			return;
-		}
-
-		assert(command.size() >= 4); // albedo r g b a(optional)
-		const float r = stof(command[1]);
-		const float g = stof(command[2]);
-		const float b = stof(command[3]);
-		pMaterial->emissiveColor = vec3(r, g, b);
-		if (command.size() > 4)
-		{
-			pMaterial->emissiveIntensity = stof(command[4]);
-		}
+		float rgb[3];
+		float intensity = context.pMaterial->emissiveIntensity;
+		if (!context.RequireParameters(3) || !context.ReadFloats(1, 3, rgb) || !context.ReadOptionalFloat(4, intensity)) return;
+		context.pMaterial->emissiveColor = vec3(rgb[0], rgb[1], rgb[2]);
+		context.pMaterial->emissiveIntensity = intensity;
+		return;
  	}
-	else if (cmd == "emissiveIntensity" || cmd == "emissiveColorIntensity")
+	case Hash("emissiveIntensity"): case Hash("emissiveColorIntensity"):
 	{
-		if (!bIsReadingMaterial)
+		if (cmd != "emissiveIntensity" && cmd != "emissiveColorIntensity") break;
+		if (!context.bIsReadingMaterial)
 		{
-			Log::Error(" Cannot define Material Property: emissiveIntensity ");
+			context.Error(command[0], "Cannot define Material Property: emissiveIntensity");
 			return;
 		}
-		pMaterial->emissiveIntensity = stof(command[1]);
-
+		float intensity;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, intensity)) return;
+		context.pMaterial->emissiveIntensity = intensity;
+		return;
 	}
-	else if (cmd == "shininess")
+	case Hash("shininess"):
 	{
-		if (!bIsReadingMaterial || materialType != PHONG)
+		if (cmd != "shininess") break;
+		if (!context.bIsReadingMaterial || context.materialType != PHONG)
 		{
-			Log::Error(" Cannot define Material Property: shininess ");
+			context.Error(command[0], "Cannot define Material Property: shininess");
 			return;
 		}
 		// #Parameters: 1
 		//--------------------------------------------------------------
 		// shininess [0.04 - inf]
 		//--------------------------------------------------------------
-		static_cast<BlinnPhong_Material*>(pMaterial)->shininess = stof(command[1]);
+		float shininess;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, shininess)) return;
+		static_cast<BlinnPhong_Material*>(context.pMaterial)->shininess = shininess;
+		return;
 	}
-	else if (cmd == "textures")
+	case Hash("textures"):
 	{
-		if (!bIsReadingMaterial)
+		if (cmd != "textures") break;
+		if (!context.bIsReadingMaterial)
 		{
-			Log::Error(" Cannot define Material Property: textures ");
+			context.Error(command[0], "Cannot define Material Property: textures");
 			return;
 		}
 
@@ -856,173 +1119,211 @@ void Parser::ParseScene(Renderer* pRenderer, const std::vector<std::string>& com
 		//--------------------------------------------------------------
 		// albedoMap normalMap
 		//--------------------------------------------------------------
-		if (command[1] != "\"\"")
+		if (!context.RequireParameters(1)) return;
+		if (command[1].text != "\"\"")
 		{
-			const TextureID texDiffuse = pRenderer->CreateTextureFromFile(command[1]);
+			const TextureID texDiffuse = context.pRenderer->CreateTextureFromFile(std::string(command[1].text));
 			//pMaterial->diffuseMap = texDiffuse;// assigned when material is finalized
-			sTextureSet[DIFFUSE_MAP] = texDiffuse;
+			context.textureSet[DIFFUSE_MAP] = texDiffuse;
 		}
 
 		if (command.size() > 2)
 		{
-			const TextureID texNormal = pRenderer->CreateTextureFromFile(command[2]);
+			const TextureID texNormal = context.pRenderer->CreateTextureFromFile(std::string(command[2].text));
 			//pMaterial->normalMap= texNormal; // assigned when material is finalized
-			sTextureSet[NORMAL_MAP] = texNormal;
+			context.textureSet[NORMAL_MAP] = texNormal;
 		}
 
 		if (command.size() > 3)
 		{
 			// add various maps (specular etc)
 		}
+		return;
 	}
 
 	// light
-	else if (cmd == "type")
+	case Hash("type"):
 	{
-		std::string lowercaseTypeValue = command[1];
-		std::transform(RANGE(lowercaseTypeValue), lowercaseTypeValue.begin(), ::tolower);
-		if (sLightTypeLookup.find(lowercaseTypeValue) == sLightTypeLookup.end())
-		{
-			Log::Warning("Invalid light type: %s", command[1]);
-		}
-		else
-		{
-			sLight.mType = sLightTypeLookup.at(lowercaseTypeValue);
-		}
+		if (cmd != "type") break;
+		if (!context.RequireParameters(1)) return;
+		if (!GetLightType(command[1].text, context.light.mType))
+			context.Warning(command[1], "Invalid light type: %.*s", static_cast<int>(command[1].text.size()), command[1].text.data());
+		return;
 	}
-	else if (cmd == "color")
+	case Hash("color"):
 	{
-		std::string lowercaseTypeValue = command[1];
-		std::transform(RANGE(lowercaseTypeValue), lowercaseTypeValue.begin(), ::tolower);
-		if (sColorLookup.find(lowercaseTypeValue) == sColorLookup.end())
-		{
-			Log::Warning("Unknown color: %s", command[1]);
-		}
-		else
-		{
-			sLight.mColor = sColorLookup.at(lowercaseTypeValue);
-		}
+		if (cmd != "color") break;
+		if (!context.RequireParameters(1)) return;
+		if (!GetPaletteColor(command[1].text, context.light.mColor))
+			context.Warning(command[1], "Unknown color: %.*s", static_cast<int>(command[1].text.size()), command[1].text.data());
+		return;
 	}
-	else if (cmd == "brightness")
+	case Hash("brightness"):
 	{
-		sLight.mBrightness = stof(command[1]);
+		if (cmd != "brightness") break;
+		float brightness;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, brightness)) return;
+		context.light.mBrightness = brightness;
+		return;
 	}
-	else if (cmd == "shadows")
+	case Hash("shadows"):
 	{
-		sLight.mbCastingShadows = sBoolTypeReflection.at(command[1]);
-		sLight.mDepthBias = command.size() > 2 ? stof(command[2]) : 0.15f;
-		sLight.mNearPlaneDistance = command.size() > 3 ? stof(command[3]) : 0.01f;
-		sLight.mFarPlaneDistance  = command.size() > 4 ? stof(command[4]) : 1000.0f;
+		if (cmd != "shadows") break;
+		// #Parameters: 4 (3 optional)
+		//--------------------------------------------------------------
+		// shadowing? depthBias nearPlane farPlane
+		//--------------------------------------------------------------
+		bool bCastingShadows;
+		float depthBias = 0.15f;
+		float nearPlane = 0.01f;
+		float farPlane = 1000.0f;
+		if (!context.RequireParameters(1) || !context.ReadBool(1, bCastingShadows)
+			|| !context.ReadOptionalFloat(2, depthBias) || !context.ReadOptionalFloat(3, nearPlane) || !context.ReadOptionalFloat(4, farPlane))
+			return;
+		context.light.mbCastingShadows = bCastingShadows;
+		context.light.mDepthBias = depthBias;
+		context.light.mNearPlaneDistance = nearPlane;
+		context.light.mFarPlaneDistance  = farPlane;
+		return;
 	}
-	else if (cmd == "range")
+	case Hash("range"):
 	{
-		sLight.mRange = stof(command[1]);
+		if (cmd != "range") break;
+		float range;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, range)) return;
+		context.light.mRange = range;
+		return;
 	}
-	else if (cmd == "spot")
+	case Hash("spot"):
 	{
-		sLight.mSpotOuterConeAngleDegrees = stof(command[1]);
-		sLight.mSpotInnerConeAngleDegrees= stof(command[2]);
+		if (cmd != "spot") break;
+		float angles[2];	// outer, inner
+		if (!context.RequireParameters(2) || !context.ReadFloats(1, 2, angles)) return;
+		context.light.mSpotOuterConeAngleDegrees = angles[0];
+		context.light.mSpotInnerConeAngleDegrees = angles[1];
+		return;
 	}
-	else if (cmd == "directional")
+	case Hash("directional"):
 	{
-		sLight.mViewportX = sLight.mViewportY = stof(command[1]);
-		sLight.mDistanceFromOrigin = stof(command[2]);
+		if (cmd != "directional") break;
+		float values[2];	// viewport size, distance from origin
+		if (!context.RequireParameters(2) || !context.ReadFloats(1, 2, values)) return;
+		context.light.mViewportX = context.light.mViewportY = values[0];
+		context.light.mDistanceFromOrigin = values[1];
+		return;
 	}
-	else if (cmd == "attenuation")
+	case Hash("attenuation"):
 	{
-		sLight.mAttenuationConstant = stof(command[1]);
-		if (command.size() > 2) sLight.mAttenuationLinear = stof(command[2]);
-		if (command.size() > 3) sLight.mAttenuationQuadratic = stof(command[3]);
+		if (cmd != "attenuation") break;
+		float constant;
+		float linear = context.light.mAttenuationLinear;
+		float quadratic = context.light.mAttenuationQuadratic;
+		if (!context.RequireParameters(1) || !context.ReadFloat(1, constant) || !context.ReadOptionalFloat(2, linear) || !context.ReadOptionalFloat(3, quadratic)) return;
+		context.light.mAttenuationConstant = constant;
+		context.light.mAttenuationLinear = linear;
+		context.light.mAttenuationQuadratic = quadratic;
+		return;
 	}
-	else if (cmd == "transform")
+	case Hash("transform"):
 	{
+		if (cmd != "transform") break;
 		// #Parameters: 7-9
 		//--------------------------------------------------------------
 		// Position(3), Rotation(3), UniformScale(1)/Scale(3)
 		//--------------------------------------------------------------
-		if (!bIsReadingGameObject && !bIsReadingLight)
+		if (!context.bIsReadingGameObject && !context.bIsReadingLight)
 		{
-			Log::Error(" Creating Transform without defining a game object (missing cmd: \"%s\"), or a light (missing cmd: \"light begin\")", "object begin");
+			context.Error(command[0], "Creating Transform without defining a game object (missing cmd: \"%s\"), or a light (missing cmd: \"light begin\")", "object begin");
 			return;
 		}
 		
+		const bool bUniformScale = command.size() < 10;
+		float values[9];
+		if (!context.RequireParameters(7) || !context.ReadFloats(1, bUniformScale ? 7 : 9, values)) return;
+
 		Transform tf;
-		float x	= stof(command[1]);
-		float y = stof(command[2]);
-		float z = stof(command[3]);
-		tf.SetPosition(x, y, z);
-
-		float rotX = stof(command[4]);
-		float rotY = stof(command[5]);
-		float rotZ = stof(command[6]);
-		tf.RotateAroundGlobalXAxisDegrees(rotX);
-		tf.RotateAroundGlobalYAxisDegrees(rotY);
-		tf.RotateAroundGlobalZAxisDegrees(rotZ);
-
-		float sclX = stof(command[7]);
-		if (command.size() <= 8)
-		{
-			tf.SetUniformScale(sclX);
-		}
+		tf.SetPosition(values[0], values[1], values[2]);
+		tf.RotateAroundGlobalXAxisDegrees(values[3]);
+		tf.RotateAroundGlobalYAxisDegrees(values[4]);
+		tf.RotateAroundGlobalZAxisDegrees(values[5]);
+		if (bUniformScale)
+			tf.SetUniformScale(values[6]);
 		else
-		{
-			float sclY = stof(command[8]);
-			float sclZ = stof(command[9]);
-			tf.SetScale(sclX, sclY, sclZ);
-		}
+			tf.SetScale(values[6], values[7], values[8]);
 
-		if(bIsReadingGameObject)
-			pObject->SetTransform(tf);
+		if(context.bIsReadingGameObject)
+			context.pObject->SetTransform(tf);
 
-		if (bIsReadingLight)
-			sLight.mTransform = tf;
+		if (context.bIsReadingLight)
+			context.light.mTransform = tf;
+		return;
 	}
-	else if (cmd == "model")
+	case Hash("model"):
 	{
-		if (!bIsReadingGameObject)
+		if (cmd != "model") break;
+		if (!context.bIsReadingGameObject)
 		{
-			Log::Error(" Creating Transform without defining a game object (missing cmd: \"%s\"", "object begin");
+			context.Error(command[0], "Creating Model without defining a game object (missing cmd: \"%s\")", "object begin");
 			return;
 		}
+		if (!context.RequireParameters(1)) return;
 
 		Model m;
 		m.mbLoaded = false;
 		m.mModelDirectory = "";
-		m.mModelName = command[1];
-		pObject->SetModel(m);
+		m.mModelName = std::string(command[1].text);
+		context.pObject->SetModel(m);
+		return;
 	}
-	else if (cmd == "ao")
+	case Hash("ao"):
 	{
+		if (cmd != "ao") break;
 		Settings::SSAO& ssao = scene.settings.ssao;
-		ssao.bEnabled		= sBoolTypeReflection.at(command[1]); 
-		ssao.ambientFactor	= stof(command[2]);
-		ssao.radius			= command.size() > 3 ? stof(command[3]) : 7.0f;	// 7 units - arbitrary.
-		ssao.intensity		= command.size() > 4 ? stof(command[4]) : 1.0f;
+		bool bEnabled;
+		float ambientFactor;
+		float radius = 7.0f;	// 7 units - arbitrary.
+		float intensity = 1.0f;
+		if (!context.RequireParameters(2) || !context.ReadBool(1, bEnabled) || !context.ReadFloat(2, ambientFactor)
+			|| !context.ReadOptionalFloat(3, radius) || !context.ReadOptionalFloat(4, intensity))
+			return;
+		ssao.bEnabled		= bEnabled; 
+		ssao.ambientFactor	= ambientFactor;
+		ssao.radius			= radius;
+		ssao.intensity		= intensity;
+		return;
 	}
-	else if (cmd == "skylight")
+	case Hash("skylight"):
 	{
-		scene.settings.bSkylightEnabled= sBoolTypeReflection.at(command[1]);
+		if (cmd != "skylight") break;
+		bool bEnabled;
+		if (!context.RequireParameters(1) || !context.ReadBool(1, bEnabled)) return;
+		scene.settings.bSkylightEnabled = bEnabled;
+		return;
 	}
-	else if (cmd == "bloom")
+	case Hash("bloom"):
 	{
+		if (cmd != "bloom") break;
 		// Parameters
 		//---------------------------------------------------------------
-		// | Bloom Threshold | BlurPassCount
+		// | Enabled? | Bloom Threshold | Blur Strength
 		//---------------------------------------------------------------
 		Settings::Bloom& bloom = scene.settings.bloom;
-	
-		bloom.bEnabled = sBoolTypeReflection.at(GetLowercased(command[1]));
-		bloom.brightnessThreshold = command.size() > 2 ? stof(command[2]) : 1.5f;
-		bloom.blurStrength = command.size() > 3 ? stoi(command[3]) : 3;	// 3 default blur stregth;
+		bool bEnabled;
+		float brightnessThreshold = 1.5f;
+		int blurStrength = 3;	// 3 default blur stregth;
+		if (!context.RequireParameters(1) || !context.ReadBool(1, bEnabled)
+			|| !context.ReadOptionalFloat(2, brightnessThreshold) || !context.ReadOptionalInt(3, blurStrength))
+			return;
+		bloom.bEnabled = bEnabled;
+		bloom.brightnessThreshold = brightnessThreshold;
+		bloom.blurStrength = blurStrength;
 		// bloom.blurPassCount = stoi(command[3]);	// in case bloom settings should be more flexible
+		return;
 	}
-	else
-	{
-		auto tokens = StrUtil::split(cmd, ' ', '\t');
-		std::string strCmd = std::string(cmd);
-		if (strCmd.find("//") == 0)
-			;
-		else
-			Log::Error("Parser: Unknown command \"%s\"", cmd.c_str());
 	}
+
+	if (cmd.find("Map") != std::string_view::npos && cmd.size() >= 5)
+		context.Error(command[0], "Texture command not found: %.*s", cmdLength, cmd.data());
+	else
+		context.Error(command[0], "Unknown command \"%.*s\"", cmdLength, cmd.data());
 }
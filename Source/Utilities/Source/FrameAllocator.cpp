@@ -0,0 +1,157 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "FrameAllocator.h"
+#include "Log.h"
+
+#include <malloc.h>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+static inline size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+//----------------------------------------------------------------------------------------------------------------
+// LINEAR ALLOCATOR
+//----------------------------------------------------------------------------------------------------------------
+void LinearAllocator::Initialize(size_t capacityInBytes)
+{
+	Exit();
+	mCapacity = AlignUp((std::max)(capacityInBytes, BLOCK_ALIGNMENT), BLOCK_ALIGNMENT);
+	mpMemory = static_cast<char*>(_aligned_malloc(mCapacity, BLOCK_ALIGNMENT));
+	assert(mpMemory);
+	mOffset.store(0);
+}
+
+void LinearAllocator::Exit()
+{
+	for (void* pMemory : mOverflowAllocations)
+		_aligned_free(pMemory);
+	mOverflowAllocations.clear();
+	mOverflowBytes.store(0);
+	if (mpMemory)
+	{
+		_aligned_free(mpMemory);
+		mpMemory = nullptr;
+	}
+	mCapacity = 0;
+	mOffset.store(0);
+	mNumHeapAllocations.store(0);
+}
+
+void* LinearAllocator::Allocate(size_t sizeInBytes, size_t alignment)
+{
+	assert(alignment <= BLOCK_ALIGNMENT && (alignment & (alignment - 1)) == 0);
+	if (sizeInBytes == 0)
+		sizeInBytes = 1;
+
+	size_t offset = mOffset.load(std::memory_order_relaxed);
+	size_t alignedOffset = 0;
+	do
+	{
+		alignedOffset = AlignUp(offset, alignment);
+		if (alignedOffset + sizeInBytes > mCapacity)
+			return AllocateOverflow(sizeInBytes, alignment);
+	} while (!mOffset.compare_exchange_weak(offset, alignedOffset + sizeInBytes, std::memory_order_relaxed));
+
+	return mpMemory + alignedOffset;
+}
+
+void* LinearAllocator::AllocateOverflow(size_t sizeInBytes, size_t alignment)
+{
+	void* pMemory = _aligned_malloc(sizeInBytes, (std::max)(alignment, sizeof(void*)));
+	assert(pMemory);
+	{
+		std::unique_lock<std::mutex> lock(mOverflowMutex);
+		mOverflowAllocations.push_back(pMemory);
+	}
+	mOverflowBytes.fetch_add(AlignUp(sizeInBytes, alignment), std::memory_order_relaxed);
+	mNumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	return pMemory;
+}
+
+void LinearAllocator::Reset()
+{
+	const size_t overflowBytes = mOverflowBytes.load();
+	for (void* pMemory : mOverflowAllocations)
+		_aligned_free(pMemory);
+	mOverflowAllocations.clear();
+	mOverflowBytes.store(0);
+	mNumHeapAllocations.store(0);
+
+	// grow the block to fit everything allocated since the last reset, with some headroom
+	if (overflowBytes > 0 && mpMemory)
+	{
+		const size_t requiredBytes = mOffset.load() + overflowBytes;
+		const size_t newCapacity = AlignUp(requiredBytes + requiredBytes / 2, BLOCK_ALIGNMENT);
+		Log::Info("LinearAllocator: growing the block from %.2f KB to %.2f KB", mCapacity / 1024.0f, newCapacity / 1024.0f);
+
+		_aligned_free(mpMemory);
+		mpMemory = static_cast<char*>(_aligned_malloc(newCapacity, BLOCK_ALIGNMENT));
+		assert(mpMemory);
+		mCapacity = newCapacity;
+		mNumHeapAllocations.store(1);
+	}
+
+	mOffset.store(0);
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+// FRAME ALLOCATOR
+//----------------------------------------------------------------------------------------------------------------
+void FrameAllocator::Initialize(size_t capacityPerFrameInBytes)
+{
+	for (LinearAllocator& buffer : mBuffers)
+		buffer.Initialize(capacityPerFrameInBytes);
+	mCurrentBuffer = 0;
+}
+
+void FrameAllocator::Exit()
+{
+	for (LinearAllocator& buffer : mBuffers)
+		buffer.Exit();
+}
+
+void FrameAllocator::BeginFrame()
+{
+	mCurrentBuffer = (mCurrentBuffer + 1) % NUM_BUFFERS;
+	mBuffers[mCurrentBuffer].Reset();
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+// HEAP ALLOCATION COUNTER
+//----------------------------------------------------------------------------------------------------------------
+#if COUNT_HEAP_ALLOCATIONS
+static std::atomic<size_t> sNumHeapAllocations { 0 };
+
+// the array and nothrow versions of the default operator new call into this one.
+void* operator new(size_t sizeInBytes)
+{
+	sNumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pMemory = std::malloc(sizeInBytes ? sizeInBytes : 1))
+		return pMemory;
+	throw std::bad_alloc();
+}
+void operator delete(void* pMemory) noexcept              { std::free(pMemory); }
+void operator delete(void* pMemory, size_t) noexcept      { std::free(pMemory); }
+
+size_t GetHeapAllocationCount() { return sNumHeapAllocations.load(std::memory_order_relaxed); }
+#else
+size_t GetHeapAllocationCount() { return 0; }
+#endif
@@ -24,6 +24,16 @@
 
 #include <fstream>
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 
 #include <fcntl.h>
 #include <io.h>
@@ -40,7 +50,315 @@ namespace Log
 
 static const WORD MAX_CONSOLE_LINES = 500;
 
+//---------------------------------------------------------------------------------------------
+// LOG BUFFERS
+//---------------------------------------------------------------------------------------------
+using Clock = std::chrono::steady_clock;
+static_assert((THREAD_BUFFER_SIZE & (THREAD_BUFFER_SIZE - 1)) == 0, "THREAD_BUFFER_SIZE has to be a power of 2");
 
+struct RecordHeader
+{
+	int64_t  timestamp;	// Clock ticks, formatted on the log thread
+	uint32_t length;	// message bytes following the header
+	uint8_t  level;
+	uint8_t  flags;
+	uint16_t padding;
+};
+static inline size_t GetRecordSize(size_t msgLength) { return (sizeof(RecordHeader) + msgLength + 7) & ~size_t(7); }
+
+// Ring of records written by the owning thread and read by the log thread. The positions only
+// grow, the byte offset into the ring is position % THREAD_BUFFER_SIZE.
+struct ThreadBuffer
+{
+	alignas(64) std::atomic<size_t> writePosition { 0 };	// owning thread
+	alignas(64) std::atomic<size_t> readPosition { 0 };		// log thread
+	std::atomic<uint32_t> numDroppedMessages { 0 };
+	std::atomic<bool>     bThreadExited { false };		// the log thread frees the buffer once it's drained
+	char data[THREAD_BUFFER_SIZE];
+
+	void Write(size_t position, const void* pSrc, size_t size)
+	{
+		const size_t offset = position & (THREAD_BUFFER_SIZE - 1);
+		const size_t firstPart = (std::min)(size, THREAD_BUFFER_SIZE - offset);
+		memcpy(data + offset, pSrc, firstPart);
+		memcpy(data, static_cast<const char*>(pSrc) + firstPart, size - firstPart);
+	}
+	void Read(size_t position, void* pDst, size_t size) const
+	{
+		const size_t offset = position & (THREAD_BUFFER_SIZE - 1);
+		const size_t firstPart = (std::min)(size, THREAD_BUFFER_SIZE - offset);
+		memcpy(pDst, data + offset, firstPart);
+		memcpy(static_cast<char*>(pDst) + firstPart, data, size - firstPart);
+	}
+};
+
+struct ThreadBufferHandle
+{
+	ThreadBuffer* pBuffer = nullptr;
+	uint32_t failedRegistrationGeneration = 0;	// retried when sThreadBufferGeneration changes
+	~ThreadBufferHandle() { if (pBuffer) pBuffer->bThreadExited.store(true, std::memory_order_release); }
+};
+static thread_local ThreadBufferHandle tThreadBuffer;
+
+static std::mutex                 sThreadBuffersMutex;
+static std::vector<ThreadBuffer*> sThreadBuffers;
+static std::atomic<uint32_t>      sNumMessagesWithoutBuffer { 0 };	// dropped: MAX_THREAD_BUFFERS reached
+static std::atomic<uint32_t>      sThreadBufferGeneration { 1 };	// incremented when thread buffers are freed
+static std::atomic<uint32_t>      sNumWritingThreads { 0 };		// threads writing into their buffers
+
+static std::thread             sLogThread;
+static std::atomic<bool>       sbLogThreadRunning { false };
+static std::atomic<bool>       sbStopLogThread { false };
+static std::mutex              sLogThreadMutex;
+static std::condition_variable sLogThreadSignal;
+constexpr auto                 FLUSH_INTERVAL = std::chrono::milliseconds(10);
+
+// output state: the log files & streams and the rate limits. the log thread owns it while
+// running, the synchronous logging before Initialize() and after Exit() locks the mutex.
+static std::mutex sOutputMutex;
+
+static ThreadBuffer* GetThreadBuffer()
+{
+	ThreadBufferHandle& handle = tThreadBuffer;
+	if (handle.pBuffer || handle.failedRegistrationGeneration == sThreadBufferGeneration.load(std::memory_order_relaxed))
+		return handle.pBuffer;
+
+	std::unique_lock<std::mutex> lock(sThreadBuffersMutex);
+	if (sThreadBuffers.size() >= MAX_THREAD_BUFFERS)
+	{	// no retries until a buffer is freed
+		handle.failedRegistrationGeneration = sThreadBufferGeneration.load(std::memory_order_relaxed);
+		return nullptr;
+	}
+	handle.failedRegistrationGeneration = 0;
+	handle.pBuffer = new ThreadBuffer();
+	sThreadBuffers.push_back(handle.pBuffer);
+	return handle.pBuffer;
+}
+
+
+//---------------------------------------------------------------------------------------------
+// FORMATTING (log thread)
+//---------------------------------------------------------------------------------------------
+struct PendingRecord
+{
+	int64_t  timestamp;
+	uint8_t  level;
+	uint8_t  flags;
+	size_t   textOffset;	// into sPendingText
+	uint32_t length;
+};
+struct RateLimit
+{
+	int64_t     lastWrittenTimestamp;
+	uint32_t    numSuppressed;
+	std::string text;	// for the summary in Exit()
+};
+
+static const std::chrono::system_clock::time_point sStartWallTime = std::chrono::system_clock::now();
+static const Clock::time_point                     sStartTime = Clock::now();
+
+static std::vector<PendingRecord>              sPendingRecords;
+static std::string                             sPendingText;
+static std::string                             sOutput;
+static std::unordered_map<uint64_t, RateLimit> sRateLimits;
+constexpr size_t                               MAX_RATE_LIMITED_MESSAGES = 4096;
+
+static const char* LEVEL_TAGS[] = { "[INFO]:", "[WARNING]: ", "[ERROR]: " };
+
+static void AppendTimestamp(int64_t timestamp, std::string& out)
+{	// [YYYY_MM_DD-HH_MM_SS.mmm], same as GetCurrentTimeAsStringWithBrackets() with milliseconds
+	using namespace std::chrono;
+	const system_clock::time_point wallTime = sStartWallTime + duration_cast<system_clock::duration>(Clock::duration(timestamp) - sStartTime.time_since_epoch());
+	const std::time_t seconds = system_clock::to_time_t(wallTime);
+	const int milliseconds = static_cast<int>(duration_cast<std::chrono::milliseconds>(wallTime.time_since_epoch()).count() % 1000);
+
+	// localtime is relatively slow, cache the formatted second
+	static std::time_t sCachedSeconds = -1;
+	static char sCachedString[48];
+	if (seconds != sCachedSeconds)
+	{
+		std::tm tmNow;
+		localtime_s(&tmNow, &seconds);
+		snprintf(sCachedString, sizeof(sCachedString), "[%04d_%02d_%02d-%02d_%02d_%02d"
+			, tmNow.tm_year + 1900, tmNow.tm_mon + 1, tmNow.tm_mday, tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+		sCachedSeconds = seconds;
+	}
+
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%s.%03d]", sCachedString, milliseconds);
+	out += buffer;
+}
+
+static uint64_t HashMessage(uint8_t level, const char* pText, size_t length)
+{	// FNV-1a
+	uint64_t hash = 14695981039346656037ull ^ level;
+	for (size_t i = 0; i < length; ++i)
+		hash = (hash ^ static_cast<uint8_t>(pText[i])) * 1099511628211ull;
+	return hash;
+}
+
+// appends the formatted line to sOutput, unless a rate limit suppresses it
+static void FormatRecord(int64_t timestamp, uint8_t level, uint8_t flags, const char* pText, size_t length)
+{
+	uint32_t numSuppressed = 0;
+	if (flags & FLAG_RATE_LIMITED)
+	{
+		const int64_t interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(RATE_LIMIT_INTERVAL_SECONDS)).count();
+		const uint64_t hash = HashMessage(level, pText, length);
+		auto it = sRateLimits.find(hash);
+		if (it != sRateLimits.end() && timestamp - it->second.lastWrittenTimestamp < interval)
+		{
+			++it->second.numSuppressed;
+			return;
+		}
+		if (it == sRateLimits.end())
+		{
+			if (sRateLimits.size() >= MAX_RATE_LIMITED_MESSAGES)
+				sRateLimits.clear();
+			it = sRateLimits.emplace(hash, RateLimit{ timestamp, 0, std::string(pText, length) }).first;
+		}
+		numSuppressed = it->second.numSuppressed;
+		it->second.lastWrittenTimestamp = timestamp;
+		it->second.numSuppressed = 0;
+	}
+
+	AppendTimestamp(timestamp, sOutput);
+	sOutput += LEVEL_TAGS[level];
+	sOutput.append(pText, length);
+	if (numSuppressed > 0)
+	{
+		char buffer[96];
+		snprintf(buffer, sizeof(buffer), " (repeated %u times in the last %.0fs)", numSuppressed, RATE_LIMIT_INTERVAL_SECONDS);
+		sOutput += buffer;
+	}
+	sOutput += '\n';
+}
+
+static void WriteOutput()
+{
+	if (sOutput.empty())
+		return;
+	OutputDebugString(sOutput.c_str());	// vs
+	if (sOutFile.is_open())
+	{
+		sOutFile.write(sOutput.data(), sOutput.size());	// file
+		sOutFile.flush();
+	}
+	cout.write(sOutput.data(), sOutput.size());		// console
+	cout.flush();
+	sOutput.clear();
+}
+
+static void AddDroppedMessagesRecord(uint32_t numDropped, const char* pReason)
+{
+	char msg[128];
+	const int length = snprintf(msg, sizeof(msg), "[Log] %u messages dropped: %s", numDropped, pReason);
+	sPendingRecords.push_back({ Clock::now().time_since_epoch().count(), LEVEL_WARNING, FLAG_NONE, sPendingText.size(), static_cast<uint32_t>(length) });
+	sPendingText.append(msg, length);
+}
+
+// Drains the thread buffers and writes their records in timestamp order, sOutputMutex is locked
+static void FlushLocked()
+{
+	{
+		std::unique_lock<std::mutex> lock(sThreadBuffersMutex);
+		for (auto it = sThreadBuffers.begin(); it != sThreadBuffers.end();)
+		{
+			ThreadBuffer* pBuffer = *it;
+			const bool bThreadExited = pBuffer->bThreadExited.load(std::memory_order_acquire);	// before draining: no writes after the flag
+
+			const size_t writePosition = pBuffer->writePosition.load(std::memory_order_acquire);
+			size_t readPosition = pBuffer->readPosition.load(std::memory_order_relaxed);
+			while (readPosition < writePosition)
+			{
+				RecordHeader header;
+				pBuffer->Read(readPosition, &header, sizeof(header));
+				sPendingRecords.push_back({ header.timestamp, header.level, header.flags, sPendingText.size(), header.length });
+				sPendingText.resize(sPendingText.size() + header.length);
+				pBuffer->Read(readPosition + sizeof(header), &sPendingText[sPendingText.size() - header.length], header.length);
+				readPosition += GetRecordSize(header.length);
+			}
+			pBuffer->readPosition.store(readPosition, std::memory_order_release);
+
+			if (const uint32_t numDropped = pBuffer->numDroppedMessages.exchange(0, std::memory_order_relaxed))
+				AddDroppedMessagesRecord(numDropped, "the log buffer of a thread was full");
+
+			if (bThreadExited)
+			{
+				delete pBuffer;
+				it = sThreadBuffers.erase(it);
+				sThreadBufferGeneration.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+				++it;
+		}
+	}
+	if (const uint32_t numDropped = sNumMessagesWithoutBuffer.exchange(0, std::memory_order_relaxed))
+		AddDroppedMessagesRecord(numDropped, "too many threads are logging");
+
+	if (sPendingRecords.empty())
+		return;
+
+	// each buffer is in order already, the merge keeps the order of equal timestamps
+	std::stable_sort(sPendingRecords.begin(), sPendingRecords.end(), [](const PendingRecord& a, const PendingRecord& b) { return a.timestamp < b.timestamp; });
+	for (const PendingRecord& record : sPendingRecords)
+		FormatRecord(record.timestamp, record.level, record.flags, sPendingText.data() + record.textOffset, record.length);
+	sPendingRecords.clear();
+	sPendingText.clear();
+
+	WriteOutput();
+}
+
+static void Flush()
+{
+	std::unique_lock<std::mutex> outputLock(sOutputMutex);
+	FlushLocked();
+}
+
+static void LogThread()
+{
+	while (!sbStopLogThread.load())
+	{
+		{
+			std::unique_lock<std::mutex> lock(sLogThreadMutex);
+			sLogThreadSignal.wait_for(lock, FLUSH_INTERVAL);
+		}
+		Flush();
+	}
+	Flush();
+}
+
+static void StartLogThread()
+{
+	if (sbLogThreadRunning.load())
+		return;
+	sbStopLogThread.store(false);
+	sLogThread = std::thread(LogThread);
+	sbLogThreadRunning.store(true);
+}
+
+static void StopLogThread()
+{
+	if (!sbLogThreadRunning.load())
+		return;
+	sbStopLogThread.store(true);	// the log thread flushes once more after the stop flag
+	sLogThreadSignal.notify_one();
+	sLogThread.join();
+
+	// new messages are written synchronously from here on, after the ones left in the buffers: they wait
+	// for the output lock. The threads that saw the log thread running can still be writing into their 
+	// buffers, the last flush waits for them.
+	std::unique_lock<std::mutex> outputLock(sOutputMutex);
+	sbLogThreadRunning.store(false);
+	while (sNumWritingThreads.load() > 0)
+		std::this_thread::yield();
+	FlushLocked();
+}
+
+
+//---------------------------------------------------------------------------------------------
+// INITIALIZATION
+//---------------------------------------------------------------------------------------------
 void InitLogFile()
 {
 	const std::string LogFileDir = Application::s_WorkspaceDirectory + "\\Logs";
@@ -57,7 +375,7 @@ void InitLogFile()
 			if (sOutFile)
 			{
 				std::string msg = GetCurrentTimeAsStringWithBrackets() + "[Log] " + "Logging initialized: " + filePath;
-				sOutFile << msg;
+				sOutFile << msg << "\n";
 				cout << msg << endl;
 			}
 			else
@@ -129,10 +447,29 @@ void Initialize(const Settings::Logger& settings)
 {
 	if (settings.bConsole) InitConsole();
 	if (settings.bFile)    InitLogFile();
+	StartLogThread();
 }
 
 void Exit()
 {
+	StopLogThread();
+
+	std::unique_lock<std::mutex> lock(sOutputMutex);
+	const int64_t now = Clock::now().time_since_epoch().count();
+	for (const auto& it : sRateLimits)
+	{
+		const RateLimit& rateLimit = it.second;
+		if (rateLimit.numSuppressed == 0)
+			continue;
+		char msg[64];
+		const int length = snprintf(msg, sizeof(msg), "[Log] %u more times: ", rateLimit.numSuppressed);
+		std::string text(msg, length);
+		text += rateLimit.text;
+		FormatRecord(now, LEVEL_INFO, FLAG_NONE, text.data(), text.size());
+	}
+	sRateLimits.clear();
+	WriteOutput();
+
 	std::string msg = GetCurrentTimeAsStringWithBrackets() + "[Log] Exit()";
 	if (sOutFile.is_open())
 	{
@@ -143,36 +480,58 @@ void Exit()
 	OutputDebugString(msg.c_str());
 }
 
-void Error(const std::string & s)
+static void WriteToThreadBuffer(int64_t timestamp, ELevel level, unsigned flags, const char* msg, size_t length)
 {
-	std::string err = GetCurrentTimeAsStringWithBrackets() + "[ERROR]: ";
-	err += s + "\n";
-	
-	OutputDebugString(err.c_str());		// vs
-	if (sOutFile.is_open()) 
-		sOutFile << err;				// file
-	cout << err;						// console
-}
+	ThreadBuffer* pBuffer = GetThreadBuffer();
+	if (!pBuffer)
+	{
+		sNumMessagesWithoutBuffer.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
 
-void Warning(const std::string & s)
-{
-	std::string warn = GetCurrentTimeAsStringWithBrackets() + "[WARNING]: ";
-	warn += s + "\n";
-	
-	OutputDebugString(warn.c_str());
-	if (sOutFile.is_open()) 
-		sOutFile << warn;
-	cout << warn;
+	const size_t recordSize = GetRecordSize(length);
+	const size_t writePosition = pBuffer->writePosition.load(std::memory_order_relaxed);
+	const size_t usedSize = writePosition - pBuffer->readPosition.load(std::memory_order_acquire);
+	if (usedSize + recordSize > THREAD_BUFFER_SIZE)
+	{	// the log thread is behind: drop the message instead of blocking the caller
+		if (pBuffer->numDroppedMessages.fetch_add(1, std::memory_order_relaxed) == 0)
+			sLogThreadSignal.notify_one();
+		return;
+	}
+
+	const RecordHeader header = { timestamp, static_cast<uint32_t>(length), level, static_cast<uint8_t>(flags), 0 };
+	pBuffer->Write(writePosition, &header, sizeof(header));
+	pBuffer->Write(writePosition + sizeof(header), msg, length);
+	pBuffer->writePosition.store(writePosition + recordSize, std::memory_order_release);
+
+	if (level == LEVEL_ERROR || usedSize + recordSize > THREAD_BUFFER_SIZE / 2)
+		sLogThreadSignal.notify_one();
 }
 
-void Info(const std::string & s)
+void Write(ELevel level, unsigned flags, const char* msg, size_t length)
 {
-	std::string info = GetCurrentTimeAsStringWithBrackets() + "[INFO]:" + s + "\n";
-	OutputDebugString(info.c_str());
-	
-	if (sOutFile.is_open()) 
-		sOutFile << info;
-	cout << info;
+	const int64_t timestamp = Clock::now().time_since_epoch().count();
+
+	// StopLogThread() either sees this thread writing or this thread sees the log thread stopped
+	sNumWritingThreads.fetch_add(1);
+	if (sbLogThreadRunning.load() && length <= MAX_BUFFERED_MSG_LENGTH)
+	{
+		WriteToThreadBuffer(timestamp, level, flags, msg, length);
+		sNumWritingThreads.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+	sNumWritingThreads.fetch_sub(1);	// before the output lock, which StopLogThread() holds while waiting for the writers
+
+	// not initialized, exited or too long for the thread buffers: write on the calling thread,
+	// after the messages in the buffers to keep the order of the messages of this thread.
+	std::unique_lock<std::mutex> lock(sOutputMutex);
+	FlushLocked();
+	FormatRecord(timestamp, level, static_cast<uint8_t>(flags), msg, length);
+	WriteOutput();
 }
 
+void Error(const std::string & s)	{ Write(LEVEL_ERROR  , FLAG_NONE, s.c_str(), s.size()); }
+void Warning(const std::string & s)	{ Write(LEVEL_WARNING, FLAG_NONE, s.c_str(), s.size()); }
+void Info(const std::string & s)	{ Write(LEVEL_INFO   , FLAG_NONE, s.c_str(), s.size()); }
+
 }	// namespace Log
\ No newline at end of file
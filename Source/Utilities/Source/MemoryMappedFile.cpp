@@ -0,0 +1,73 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "MemoryMappedFile.h"
+#include "Log.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+bool MemoryMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		Log::Error("MemoryMappedFile: Cannot open file: %s", filePath.c_str());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+	{	// empty files can't be mapped
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!hMapping)
+	{
+		Log::Error("MemoryMappedFile: Cannot create file mapping: %s", filePath.c_str());
+		CloseHandle(hFile);
+		return false;
+	}
+
+	void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!pData)
+	{
+		Log::Error("MemoryMappedFile: Cannot map view of file: %s", filePath.c_str());
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	mhFile = hFile;
+	mhMapping = hMapping;
+	mpData = pData;
+	mSize = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if (mpData)    UnmapViewOfFile(mpData);
+	if (mhMapping) CloseHandle(static_cast<HANDLE>(mhMapping));
+	if (mhFile)    CloseHandle(static_cast<HANDLE>(mhFile));
+	mpData = mhMapping = mhFile = nullptr;
+	mSize = 0;
+}
@@ -5,6 +5,13 @@
 #include <numeric>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
 
 #define DISABLE_CPU_PROFILER 0
 #define DISABLE_GPU_PROFILER 0
@@ -21,118 +28,456 @@
 #define GPU_PROFILER_ENABLE_CHECK
 #endif
 
+// the profiler isn't initialized with the null renderer backend (headless mode)
+#define GPU_PROFILER_INIT_CHECK if (!mpContext) return;
+
+//---------------------------------------------------------------------------------------------------------------------------
+// CPU PROFILER EVENTS
+//---------------------------------------------------------------------------------------------------------------------------
+static inline int64_t GetTimestamp() { return std::chrono::steady_clock::now().time_since_epoch().count(); }
+static inline float TimestampToSeconds(int64_t duration) { return std::chrono::duration<float>(std::chrono::steady_clock::duration(duration)).count(); }
+static inline double TimestampToMicroseconds(int64_t duration) { return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(duration)).count(); }
+
+int64_t CPUProfiler::sLastResolveTime = 0;
+std::atomic<const CPUProfiler*> CPUProfiler::spInstance { nullptr };
+
+namespace
+{
+	struct EntryRegistry
+	{
+		std::mutex										mutex;
+		std::unordered_map<std::string, CPUProfiler::EntryID>	lookup;
+		std::vector<std::string>						tags;
+	};
+	EntryRegistry& GetEntryRegistry()
+	{	// never destroyed: entries can be recorded by threads that outlive the static objects
+		static EntryRegistry* pRegistry = new EntryRegistry();
+		return *pRegistry;
+	}
+}
+
+// Ring buffer of the Begin/End events of a thread. The owner thread is the only producer
+// and EndProfile() is the only consumer, so the events are written without locking.
+// If the buffer fills up before EndProfile() reads it, new events are dropped.
+//
+struct CPUProfiler::ThreadEventBuffer
+{
+	struct Event
+	{
+		int64_t		timestamp;
+		EntryID		id;
+		uint32_t	bBegin;
+	};
+	static constexpr uint64_t CAPACITY = 1 << 14;	// must be a power of 2
+	static constexpr int MAX_OPEN_ENTRIES = 64;
+
+	// owner thread data
+	alignas(64) std::atomic<uint64_t> writeIndex { 0 };
+	uint64_t				cachedReadIndex = 0;
+	int						numOpenEntries = 0;
+	EntryID					openEntries[MAX_OPEN_ENTRIES];	// used by EndEntry() which doesn't take an EntryID
+	std::atomic<uint64_t>	numDroppedEvents { 0 };
+	std::atomic<bool>		bThreadExited { false };
+
+	// EndProfile() data
+	alignas(64) std::atomic<uint64_t> readIndex { 0 };
+	std::vector<ScopeInterval> openScopes;	// begun scopes waiting for their End event
+	std::thread::id			threadID;
+	uint32_t				threadIndex = 0;	// unique per thread, buffers are reused
+	std::string				threadName;			// guarded by the registry lock
+
+	Event					events[CAPACITY];
+
+	inline void Write(EntryID id, bool bBegin)
+	{
+		const uint64_t index = writeIndex.load(std::memory_order_relaxed);
+		if (index - cachedReadIndex >= CAPACITY)
+		{
+			cachedReadIndex = readIndex.load(std::memory_order_acquire);
+			if (index - cachedReadIndex >= CAPACITY)
+			{
+				numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		Event& event = events[index & (CAPACITY - 1)];
+		event.timestamp = GetTimestamp();
+		event.id = id;
+		event.bBegin = bBegin ? 1 : 0;
+		writeIndex.store(index + 1, std::memory_order_release);
+	}
+};
+
+struct CPUProfiler::ThreadEventBufferRegistry
+{
+	std::mutex										mutex;
+	std::vector<std::unique_ptr<ThreadEventBuffer>>	buffers;
+	uint32_t										numRegisteredThreads = 0;
+};
+
+CPUProfiler::ThreadEventBufferRegistry& CPUProfiler::GetThreadEventBufferRegistry()
+{	// never destroyed: the thread_local handles below can be destroyed after the static objects
+	static ThreadEventBufferRegistry* pRegistry = new ThreadEventBufferRegistry();
+	return *pRegistry;
+}
+
+CPUProfiler::ThreadEventBuffer& CPUProfiler::GetThreadEventBuffer()
+{
+	// marks the buffer as reusable when its thread exits
+	struct ThreadEventBufferHandle
+	{
+		ThreadEventBuffer* pBuffer = nullptr;
+		~ThreadEventBufferHandle() { if (pBuffer) pBuffer->bThreadExited.store(true, std::memory_order_release); }
+	};
+	thread_local ThreadEventBufferHandle handle;
+	if (handle.pBuffer)
+		return *handle.pBuffer;
+
+	// first event of the thread: register a buffer, reusing the buffer of an exited thread if its events are resolved
+	ThreadEventBufferRegistry& registry = GetThreadEventBufferRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+	for (std::unique_ptr<ThreadEventBuffer>& pBuffer : registry.buffers)
+	{
+		if (pBuffer->bThreadExited.load(std::memory_order_acquire) && pBuffer->readIndex.load() == pBuffer->writeIndex.load())
+		{
+			handle.pBuffer = pBuffer.get();
+			break;
+		}
+	}
+	if (!handle.pBuffer)
+	{
+		registry.buffers.push_back(std::make_unique<ThreadEventBuffer>());
+		handle.pBuffer = registry.buffers.back().get();
+	}
+
+	ThreadEventBuffer& buffer = *handle.pBuffer;
+	buffer.cachedReadIndex = buffer.readIndex.load();
+	buffer.numOpenEntries = 0;
+	buffer.openScopes.clear();
+	buffer.threadID = std::this_thread::get_id();
+	buffer.threadIndex = registry.numRegisteredThreads++;
+	buffer.threadName = "Thread " + std::to_string(buffer.threadIndex);
+	buffer.bThreadExited.store(false);
+	return buffer;
+}
+
+void CPUProfiler::SetThreadName(const std::string& name)
+{
+	ThreadEventBuffer& buffer = GetThreadEventBuffer();
+	ThreadEventBufferRegistry& registry = GetThreadEventBufferRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+	buffer.threadName = name;
+}
+
+CPUProfiler::EntryID CPUProfiler::RegisterEntry(const std::string& tag)
+{
+	EntryRegistry& registry = GetEntryRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+
+	auto it = registry.lookup.find(tag);
+	if (it != registry.lookup.end())
+		return it->second;
+
+	const EntryID id = static_cast<EntryID>(registry.tags.size());
+	registry.tags.push_back(tag);
+	registry.lookup.emplace(tag, id);
+	return id;
+}
+
+std::string CPUProfiler::GetEntryTag(EntryID id)
+{
+	EntryRegistry& registry = GetEntryRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+	return id < registry.tags.size() ? registry.tags[id] : std::string("UNKNOWN");
+}
+
+void CPUProfiler::BeginScope(EntryID id)
+{
+	CPU_PROFILER_ENABLE_CHECK
+	ThreadEventBuffer& buffer = GetThreadEventBuffer();
+	if (buffer.numOpenEntries < ThreadEventBuffer::MAX_OPEN_ENTRIES)
+	{
+		buffer.openEntries[buffer.numOpenEntries] = id;
+	}
+	++buffer.numOpenEntries;
+	buffer.Write(id, true);
+}
+
+void CPUProfiler::EndScope(EntryID id)
+{
+	CPU_PROFILER_ENABLE_CHECK
+	ThreadEventBuffer& buffer = GetThreadEventBuffer();
+	if (buffer.numOpenEntries > 0)
+	{
+		--buffer.numOpenEntries;
+	}
+	buffer.Write(id, false);
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------------
 // CPU PROFILER
 //---------------------------------------------------------------------------------------------------------------------------
+CPUProfiler::CPUProfiler(ProfilerSettings settings) : mSettings(settings)
+{
+	// a second instance would resolve, and consume, the events of the first one
+	const CPUProfiler* pExpected = nullptr;
+	const bool bOnlyInstance = spInstance.compare_exchange_strong(pExpected, this);
+	assert(bOnlyInstance);
+	if (!bOnlyInstance)
+	{
+		Log::Error("[CPUProfiler]: Only one CPUProfiler can exist at a time, the thread event buffers are shared.");
+	}
+}
+
+CPUProfiler::~CPUProfiler()
+{
+	const CPUProfiler* pExpected = this;
+	spInstance.compare_exchange_strong(pExpected, nullptr);
+}
+
 void CPUProfiler::BeginProfile(const unsigned long long FRAME_NUMBER)
 {
 	CPU_PROFILER_ENABLE_CHECK
-	auto& entryStack = mState.EntryNameStack;
-
 	if (mState.bIsProfiling)
 	{
-		Log::Warning("Already began profiling! Current profiling entry: %s", entryStack.empty() ? "EMPTY" : entryStack.top().c_str());
+		Log::Warning("Already began profiling!");
 	}
 
-
 	mState.bIsProfiling = true;
-	mPerfEntries.clear();
+	mFrameBeginTime = GetTimestamp();
 }
 
 void CPUProfiler::EndProfile(const unsigned long long FRAME_NUMBER)
 {
 	CPU_PROFILER_ENABLE_CHECK
-	auto& entryStack = mState.EntryNameStack;
-
 	if (!mState.bIsProfiling)
 	{
 		Log::Warning("Haven't started profiling!");
 	}
 
-	if (!entryStack.empty())
+	ThreadEventBuffer& profilingThreadBuffer = GetThreadEventBuffer();
+	if (profilingThreadBuffer.numOpenEntries > 0)
+	{
+		const int lastEntry = (std::min)(profilingThreadBuffer.numOpenEntries, ThreadEventBuffer::MAX_OPEN_ENTRIES) - 1;
+		Log::Warning("Begin/End Entry mismatch! Last profiling entry: %s", GetEntryTag(profilingThreadBuffer.openEntries[lastEntry]).c_str());
+		profilingThreadBuffer.numOpenEntries = 0;
+	}
+
+	sLastResolveTime = GetTimestamp();
+	Capture completedCapture;
+	{
+		ThreadEventBufferRegistry& registry = GetThreadEventBufferRegistry();
+		std::unique_lock<std::mutex> lock(registry.mutex);
+
+		// resolve the profiling thread first: the scopes of the other threads are parented under its scopes
+		mProfilingThreadScopes.clear();
+		ResolveEvents(profilingThreadBuffer, true);
+		for (const ScopeInterval& scope : profilingThreadBuffer.openScopes)
+		{
+			mProfilingThreadScopes.push_back({ scope.begin, (std::numeric_limits<int64_t>::max)(), scope.id });
+		}
+
+		for (std::unique_ptr<ThreadEventBuffer>& pBuffer : registry.buffers)
+		{
+			if (pBuffer.get() != &profilingThreadBuffer)
+				ResolveEvents(*pBuffer, false);
+		}
+
+		if (mState.bCaptureInProgress)
+		{
+			mCapture.frames.push_back({ mFrameBeginTime, sLastResolveTime, FRAME_NUMBER, profilingThreadBuffer.threadIndex });
+			mCapture.threadNames[profilingThreadBuffer.threadIndex] = profilingThreadBuffer.threadName;
+			if (mCapture.numFramesLeft > 0 && --mCapture.numFramesLeft == 0)
+			{
+				completedCapture = std::move(mCapture);
+				mCapture = Capture();
+				mState.bCaptureInProgress = false;
+			}
+		}
+	}
+
+	if (!completedCapture.filePath.empty())
+	{
+		WriteCapture(completedCapture);
+	}
+
+	// add the frame's samples
+	for (PerfEntry& entry : mPerfEntries)
 	{
-		Log::Warning("Begin/End Entry mismatch! Last profiling entry: %s", entryStack.top());
-		while (!entryStack.empty()) entryStack.pop();
+		if (!entry.bRecordedThisFrame)
+			continue;
+
+		entry.AddSample(entry.frameDuration);
+		entry.lastSampleTime = sLastResolveTime;
+		entry.frameDuration = 0.0f;
+		entry.bRecordedThisFrame = false;
 	}
 
+	// rebuild the tree only if there are new entries
+	if (mState.bHierarchyChanged)
+	{
+		mPerfEntryTree.Clear();
+		if (mRootEntryID != INVALID_ENTRY_ID)
+		{
+			mPerfEntryTree.root.pData = mPerfEntryLookup[mRootEntryID];
+			AddChildNodes(mPerfEntryTree.root);
+		}
+		mState.bHierarchyChanged = false;
+	}
 
 	mState.bIsProfiling = false;
-	mPerfEntryTree.Clear();
 }
 
+void CPUProfiler::ResolveEvents(ThreadEventBuffer& buffer, bool bIsProfilingThread)
+{
+	std::vector<ScopeInterval>& openScopes = buffer.openScopes;
+	const uint64_t writeIndex = buffer.writeIndex.load(std::memory_order_acquire);
+	uint64_t readIndex = buffer.readIndex.load(std::memory_order_relaxed);
+	if (mState.bCaptureInProgress)
+	{
+		CaptureEvents(buffer, readIndex, writeIndex);
+	}
 
+	for (; readIndex != writeIndex; ++readIndex)
+	{
+		const ThreadEventBuffer::Event& event = buffer.events[readIndex & (ThreadEventBuffer::CAPACITY - 1)];
+		if (event.bBegin)
+		{
+			if (!HasEntry(event.id))
+			{	// parent: the open scope on the same thread, or the scope of the profiling thread at the time
+				const EntryID parentID = !openScopes.empty() ? openScopes.back().id
+					: (bIsProfilingThread ? INVALID_ENTRY_ID : FindProfilingThreadScope(event.timestamp));
+				AddEntry(event.id, parentID);
+			}
+			openScopes.push_back({ event.timestamp, 0, event.id });
+			continue;
+		}
 
-void CPUProfiler::BeginEntry(const std::string & entryName)
+		// find the matching Begin event: events can be dropped if the buffer fills up.
+		// unmatched scopes opened after the Begin event are discarded.
+		auto itScope = std::find_if(openScopes.rbegin(), openScopes.rend(), [&](const ScopeInterval& scope) { return scope.id == event.id; });
+		if (itScope == openScopes.rend())
+			continue;
+
+		ScopeInterval scope = *itScope;
+		scope.end = event.timestamp;
+		openScopes.erase(std::next(itScope).base(), openScopes.end());
+
+		if (!HasEntry(scope.id))	// cleared while the scope was open
+			continue;
+
+		PerfEntry& entry = *mPerfEntryLookup[scope.id];
+		entry.frameDuration += TimestampToSeconds(scope.end - scope.begin);
+		entry.bRecordedThisFrame = true;
+		if (bIsProfilingThread)
+		{
+			mProfilingThreadScopes.push_back(scope);
+		}
+	}
+	buffer.readIndex.store(readIndex, std::memory_order_release);
+
+	const uint64_t numDroppedEvents = buffer.numDroppedEvents.exchange(0, std::memory_order_relaxed);
+	if (numDroppedEvents > 0)
+	{
+		Log::Warning("[CPUProfiler]: Dropped %llu events, the event buffer of a thread is full.", numDroppedEvents);
+	}
+}
+
+CPUProfiler::EntryID CPUProfiler::FindProfilingThreadScope(int64_t timestamp) const
 {
-	CPU_PROFILER_ENABLE_CHECK
-	if (!mState.bIsProfiling)
+	// the innermost scope containing the timestamp is the one that began last
+	EntryID scopeID = INVALID_ENTRY_ID;
+	int64_t scopeBegin = (std::numeric_limits<int64_t>::min)();
+	for (const ScopeInterval& scope : mProfilingThreadScopes)
 	{
-		Log::Error("Profiler::BeginProfile() hasn't been called.");
-		return;
+		if (scope.begin <= timestamp && timestamp < scope.end && scope.begin >= scopeBegin)
+		{
+			scopeID = scope.id;
+			scopeBegin = scope.begin;
+		}
 	}
-		
-	const bool bEntryExists = mPerfEntries.find(entryName) != mPerfEntries.end();
-	
-	// hierarchy variables
-	const PerfEntry* pParentPerfEntry = mState.EntryNameStack.empty() ? nullptr : &mPerfEntries.at(mState.EntryNameStack.top());
+	return scopeID;
+}
 
-	// update state
-	mState.EntryNameStack.push(entryName);
+CPUProfiler::PerfEntry& CPUProfiler::AddEntry(EntryID id, EntryID parentID)
+{
+	if (id >= mPerfEntryLookup.size())
+	{
+		mPerfEntryLookup.resize(id + 1, nullptr);
+	}
 
-	// setup the entry settings/data and update hierarchy if entry didn't exist
-	PerfEntry& entry = mPerfEntries[entryName];
-	const PerfEntry* pCurrentPerfEntry = &mPerfEntries.at(entryName);
-	if (!bEntryExists)
+	mPerfEntries.emplace_back();
+	PerfEntry& entry = mPerfEntries.back();
+	entry.tag = GetEntryTag(id);
+	entry.id = id;
+	entry.samples.resize(mSettings.sampleCount, 0.0f);
+	mPerfEntryLookup[id] = &entry;
+
+	// the first top level entry becomes the root, the rest of the top level entries are added under it
+	if (parentID == id || !HasEntry(parentID))
 	{
-		// setup entry settings / aux data
-		entry.samples.resize(mSettings.sampleCount, 0.0f);
-		entry.tag = entryName;
+		parentID = mRootEntryID;
+	}
 
-		// update hierarchy
-		if (mPerfEntryTree.root.pData == nullptr)
-		{	// first node
-			mPerfEntryTree.root.pData = pCurrentPerfEntry;
-			mState.pLastEntryNode = &mPerfEntryTree.root;
-			assert(mState.pLastEntryNode);
-		}
-		else
-		{	// rest of the nodes
-			assert(mState.pLastEntryNode);
-			mState.pLastEntryNode = mPerfEntryTree.AddChild(*mState.pLastEntryNode, pCurrentPerfEntry);
-		}
+	if (parentID == INVALID_ENTRY_ID)
+	{
+		mRootEntryID = id;
+	}
+	else
+	{
+		entry.parentID = parentID;
+		mPerfEntryLookup[parentID]->children.push_back(id);
 	}
 
-	// start the timer of the entry 
-	entry.UpdateSampleBegin();
+	mState.bHierarchyChanged = true;
+	return entry;
 }
 
-void CPUProfiler::EndEntry()
+void CPUProfiler::AddChildNodes(TreeNode<PerfEntry>& node)
 {
-	CPU_PROFILER_ENABLE_CHECK
-	if (!mState.bIsProfiling)
+	node.children.reserve(node.pData->children.size());	// AddChild() returns pointers to the children
+	for (EntryID childID : node.pData->children)
 	{
-		Log::Error("Profiler::BeginProfile() hasn't been called.");
-		return;
+		mPerfEntryTree.AddChild(node, mPerfEntryLookup[childID]);
+	}
+	for (TreeNode<PerfEntry>& child : node.children)
+	{
+		AddChildNodes(child);
 	}
+}
+
+
 
-	if (mState.EntryNameStack.empty())
+void CPUProfiler::BeginEntry(const std::string & entryName)
+{
+	BeginScope(RegisterEntry(entryName));
+}
+
+void CPUProfiler::BeginEntry(EntryID id)
+{
+	BeginScope(id);
+}
+
+void CPUProfiler::EndEntry()
+{
+	CPU_PROFILER_ENABLE_CHECK
+	const ThreadEventBuffer& buffer = GetThreadEventBuffer();
+	if (buffer.numOpenEntries == 0)
 	{
 		Log::Error("Profiler::EndEntry() called without BeginEntry().");
 		return;
 	}
 
-	std::string entryName = mState.EntryNameStack.top();
-	mState.EntryNameStack.pop();
-
-	// stop the timer of the entry
-	PerfEntry& entry = mPerfEntries.at(entryName);
-	entry.UpdateSampleEnd();
-	
-	// update last entry node with the parent of it
-	if(mState.pLastEntryNode && mState.pLastEntryNode->pParent) mState.pLastEntryNode = mState.pLastEntryNode->pParent;
+	const bool bEntryTracked = buffer.numOpenEntries <= ThreadEventBuffer::MAX_OPEN_ENTRIES;
+	EndScope(bEntryTracked ? buffer.openEntries[buffer.numOpenEntries - 1] : INVALID_ENTRY_ID);
 }
 
-
+bool CPUProfiler::AreThereAnyOpenEntries() const
+{
+	return GetThreadEventBuffer().numOpenEntries > 0;
+}
 
 bool CPUProfiler::StateCheck() const
 {
@@ -149,25 +494,215 @@ bool CPUProfiler::StateCheck() const
 
 float CPUProfiler::GetEntryAvg(const std::string & entryName) const
 {
-	if (mPerfEntries.find(entryName) == mPerfEntries.end())
+	auto it = std::find_if(mPerfEntries.begin(), mPerfEntries.end(), [&](const PerfEntry& entry) { return entry.tag == entryName; });
+	if (it == mPerfEntries.end())
 		return -1.0f;
-	return mPerfEntries.at(entryName).GetAvg();
+	return it->GetAvg();
+}
+
+float CPUProfiler::GetEntryLastSample(const std::string & entryName) const
+{
+	auto it = std::find_if(mPerfEntries.begin(), mPerfEntries.end(), [&](const PerfEntry& entry) { return entry.tag == entryName; });
+	if (it == mPerfEntries.end() || it->currSampleIndex == 0 || it->lastSampleTime != sLastResolveTime)
+		return -1.0f;
+	return it->samples[(it->currSampleIndex - 1) % it->samples.size()];
 }
 
 float CPUProfiler::GetRootEntryAvg() const
 {
-	if (mPerfEntries.empty() || mPerfEntryTree.root.pData == nullptr)
+	if (mRootEntryID == INVALID_ENTRY_ID || mPerfEntryTree.root.pData == nullptr)
 		return -1.0f;
 	return mPerfEntryTree.root.pData->GetAvg();
 }
 
 void CPUProfiler::Clear()
 {
-	mPerfEntries.clear();
+	{	// discard the events that aren't resolved yet
+		ThreadEventBufferRegistry& registry = GetThreadEventBufferRegistry();
+		std::unique_lock<std::mutex> lock(registry.mutex);
+		for (std::unique_ptr<ThreadEventBuffer>& pBuffer : registry.buffers)
+		{
+			const uint64_t writeIndex = pBuffer->writeIndex.load(std::memory_order_acquire);
+			if (mState.bCaptureInProgress)
+			{
+				CaptureEvents(*pBuffer, pBuffer->readIndex.load(std::memory_order_relaxed), writeIndex);
+			}
+			pBuffer->readIndex.store(writeIndex, std::memory_order_release);
+			pBuffer->openScopes.clear();
+		}
+	}
+
 	mPerfEntryTree.Clear();
-	bool bIsProfiling = mState.bIsProfiling;
-	mState.Clear();
-	mState.bIsProfiling = bIsProfiling;
+	mPerfEntries.clear();
+	mPerfEntryLookup.clear();
+	mProfilingThreadScopes.clear();
+	mRootEntryID = INVALID_ENTRY_ID;
+	mState.bHierarchyChanged = false;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------------
+// CPU PROFILER CAPTURE
+//---------------------------------------------------------------------------------------------------------------------------
+void CPUProfiler::BeginCapture(int numFrames, const std::string& filePath)
+{
+	CPU_PROFILER_ENABLE_CHECK
+	ThreadEventBufferRegistry& registry = GetThreadEventBufferRegistry();
+	std::unique_lock<std::mutex> lock(registry.mutex);
+	if (mState.bCaptureInProgress)
+	{
+		Log::Warning("[CPUProfiler]: Capture is already in progress: %s", mCapture.filePath.c_str());
+		return;
+	}
+
+	mCapture = Capture();
+	mCapture.filePath = filePath;
+	mCapture.numFramesLeft = numFrames;
+	mCapture.events.reserve(1 << 16);
+	mState.bCaptureInProgress = true;
+	if (numFrames > 0)
+		Log::Info("[CPUProfiler]: Capturing %d frames...", numFrames);
+	else
+		Log::Info("[CPUProfiler]: Capturing...");
+}
+
+void CPUProfiler::EndCapture()
+{
+	CPU_PROFILER_ENABLE_CHECK
+	Capture capture;
+	{
+		ThreadEventBufferRegistry& registry = GetThreadEventBufferRegistry();
+		std::unique_lock<std::mutex> lock(registry.mutex);
+		if (!mState.bCaptureInProgress)
+			return;
+
+		// capture the events that aren't resolved yet as well, they're left in the buffers for EndProfile()
+		for (std::unique_ptr<ThreadEventBuffer>& pBuffer : registry.buffers)
+		{
+			CaptureEvents(*pBuffer, pBuffer->readIndex.load(std::memory_order_relaxed), pBuffer->writeIndex.load(std::memory_order_acquire));
+		}
+
+		capture = std::move(mCapture);
+		mCapture = Capture();
+		mState.bCaptureInProgress = false;
+	}
+	WriteCapture(capture);
+}
+
+void CPUProfiler::CaptureEvents(const ThreadEventBuffer& buffer, uint64_t readIndex, uint64_t writeIndex)
+{
+	if (readIndex == writeIndex)
+		return;
+
+	for (; readIndex != writeIndex; ++readIndex)
+	{
+		const ThreadEventBuffer::Event& event = buffer.events[readIndex & (ThreadEventBuffer::CAPACITY - 1)];
+		mCapture.events.push_back({ event.timestamp, event.id, event.bBegin, buffer.threadIndex });
+	}
+	mCapture.threadNames[buffer.threadIndex] = buffer.threadName;
+}
+
+static std::string EscapeJSONString(const std::string& str)
+{
+	std::string escaped;
+	escaped.reserve(str.size());
+	for (const char c : str)
+	{
+		switch (c)
+		{
+		case '"':  escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n";  break;
+		case '\t': escaped += "\\t";  break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char hex[8];
+				snprintf(hex, sizeof(hex), "\\u%04x", c);
+				escaped += hex;
+			}
+			else
+			{
+				escaped += c;
+			}
+			break;
+		}
+	}
+	return escaped;
+}
+
+// Chrome Trace Event Format: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+//
+void CPUProfiler::WriteCapture(const Capture& capture)
+{
+	std::ofstream file(capture.filePath);
+	if (!file)
+	{
+		Log::Error("[CPUProfiler]: Cannot open %s for writing the capture.", capture.filePath.c_str());
+		return;
+	}
+
+	// timestamps are written in microseconds, relative to the beginning of the capture
+	int64_t captureBeginTime = (std::numeric_limits<int64_t>::max)();
+	for (const Capture::Event& event : capture.events) captureBeginTime = (std::min)(captureBeginTime, event.timestamp);
+	for (const Capture::Frame& frame : capture.frames) captureBeginTime = (std::min)(captureBeginTime, frame.begin);
+
+	std::vector<std::string> tags;	// escaped, indexed by EntryID
+	auto fnGetTag = [&](EntryID id) -> const std::string&
+	{
+		static const std::string UNKNOWN_TAG = "UNKNOWN";
+		if (id == INVALID_ENTRY_ID)
+			return UNKNOWN_TAG;
+		if (id >= tags.size())
+			tags.resize(id + 1);
+		if (tags[id].empty())
+			tags[id] = EscapeJSONString(GetEntryTag(id));
+		return tags[id];
+	};
+
+	std::string json;
+	json.reserve(128 * 1024 + capture.events.size() * 64);
+	json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"VQEngine\"}}";
+
+	char buffer[256];
+	for (const auto& thread : capture.threadNames)
+	{
+		snprintf(buffer, sizeof(buffer), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"", thread.first);
+		json += buffer;
+		json += EscapeJSONString(thread.second);
+		json += "\"}}";
+	}
+
+	for (const Capture::Frame& frame : capture.frames)
+	{
+		snprintf(buffer, sizeof(buffer), ",\n{\"name\":\"Frame %llu\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}"
+			, frame.frameNumber
+			, frame.threadIndex
+			, TimestampToMicroseconds(frame.begin - captureBeginTime)
+			, TimestampToMicroseconds(frame.end - frame.begin)
+		);
+		json += buffer;
+	}
+
+	for (const Capture::Event& event : capture.events)
+	{
+		if (event.bBegin)
+		{
+			json += ",\n{\"name\":\"";
+			json += fnGetTag(event.id);
+			snprintf(buffer, sizeof(buffer), "\",\"ph\":\"B\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", event.threadIndex, TimestampToMicroseconds(event.timestamp - captureBeginTime));
+		}
+		else
+		{
+			snprintf(buffer, sizeof(buffer), ",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", event.threadIndex, TimestampToMicroseconds(event.timestamp - captureBeginTime));
+		}
+		json += buffer;
+	}
+	json += "\n]}\n";
+
+	file.write(json.data(), json.size());
+	Log::Info("[CPUProfiler]: Captured %zu frames (%zu events) into %s", capture.frames.size(), capture.events.size(), capture.filePath.c_str());
 }
 
 
@@ -178,17 +713,9 @@ void CPUProfiler::Clear()
 //---------------------------------------------------------------------------------------------------------------------------
 // PERF ENTRY
 //---------------------------------------------------------------------------------------------------------------------------
-void CPUProfiler::PerfEntry::UpdateSampleEnd()
-{
-	timer.Stop();
-	float dt = timer.DeltaTime();
-
-	samples[currSampleIndex++ % samples.size()] = dt;
-}
-void CPUProfiler::PerfEntry::UpdateSampleBegin()
+void CPUProfiler::PerfEntry::AddSample(float duration)
 {
-	timer.Reset();
-	timer.Start();
+	samples[currSampleIndex++ % samples.size()] = duration;
 }
 
 // returns the index (i-1) in a ring-buffer fashion
@@ -215,7 +742,11 @@ void CPUProfiler::PerfEntry::PrintEntryInfo(bool bPrintAllEntries)
 }
 inline float CPUProfiler::PerfEntry::GetAvg() const
 {
-	return std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();	
+	// average of the samples taken so far
+	const size_t numSamples = (std::min)(currSampleIndex, samples.size());
+	if (numSamples == 0)
+		return 0.0f;
+	return std::accumulate(samples.begin(), samples.begin() + numSamples, 0.0f) / numSamples;
 }
 bool CPUProfiler::PerfEntry::operator<(const PerfEntry & other) const
 {
@@ -224,7 +755,7 @@ bool CPUProfiler::PerfEntry::operator<(const PerfEntry & other) const
 
 bool CPUProfiler::PerfEntry::IsStale() const
 {
-	return timer.GetStopDuration() > 5.0f;	// 5 second upper limit
+	return TimestampToSeconds(CPUProfiler::sLastResolveTime - lastSampleTime) > 5.0f;	// 5 second upper limit
 }
 
 #if 0
@@ -264,6 +795,7 @@ void GPUProfiler::Init(ID3D11DeviceContext* pContext, ID3D11Device* pDevice)
 void GPUProfiler::Exit()
 {
 	GPU_PROFILER_ENABLE_CHECK
+	GPU_PROFILER_INIT_CHECK
 	for (auto it = mFrameQueries.begin(); it != mFrameQueries.end(); ++it)
 	{
 		for (size_t bufferIndex = 0; bufferIndex < FRAME_HISTORY; ++bufferIndex)
@@ -279,6 +811,7 @@ void GPUProfiler::Exit()
 void GPUProfiler::BeginProfile(const unsigned long long FRAME_NUMBER)
 {
 	GPU_PROFILER_ENABLE_CHECK
+	GPU_PROFILER_INIT_CHECK
 	sCurrFrameNumber = FRAME_NUMBER;
 	mpContext->Begin(pDisjointQuery[FRAME_NUMBER % FRAME_HISTORY]);
 }
@@ -286,6 +819,7 @@ void GPUProfiler::BeginProfile(const unsigned long long FRAME_NUMBER)
 void GPUProfiler::EndProfile(const unsigned long long FRAME_NUMBER)
 {
 	GPU_PROFILER_ENABLE_CHECK
+	GPU_PROFILER_INIT_CHECK
 	const unsigned long long PREV_FRAME_NUMBER = (FRAME_NUMBER - (FRAME_HISTORY-1));
 
 	mpContext->End(pDisjointQuery[FRAME_NUMBER % FRAME_HISTORY]);
@@ -371,6 +905,7 @@ bool GPUProfiler::GetQueryResultsOfFrame(const unsigned long long frameNumber, I
 void GPUProfiler::BeginEntry(const std::string & tag)
 {
 	GPU_PROFILER_ENABLE_CHECK
+	GPU_PROFILER_INIT_CHECK
 	const size_t frameQueryIndex = sCurrFrameNumber % FRAME_HISTORY;
 
 	const bool bEntryExists = mFrameQueries.find(tag) != mFrameQueries.end();
@@ -424,6 +959,7 @@ void GPUProfiler::BeginEntry(const std::string & tag)
 void GPUProfiler::EndEntry()
 {
 	GPU_PROFILER_ENABLE_CHECK
+	GPU_PROFILER_INIT_CHECK
 	const size_t bufferIndex = sCurrFrameNumber % FRAME_HISTORY;
 
 	std::string tag = mState.EntryNameStack.top();
@@ -0,0 +1,212 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "Tokenizer.h"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+
+namespace Tokenizer
+{
+	static inline bool IsWhitespace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+	static inline bool IsDigit(char c)      { return c >= '0' && c <= '9'; }
+	static inline char ToLower(char c)      { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+	bool LineReader::ReadLine(Line& line)
+	{
+		while (mpCurrent < mpEnd)
+		{
+			const char* pLineEnd = static_cast<const char*>(std::memchr(mpCurrent, '\n', mpEnd - mpCurrent));
+			if (!pLineEnd) 
+				pLineEnd = mpEnd;
+
+			const char* pLineBegin = mpCurrent;
+			const char* p = pLineBegin;
+			mpCurrent = pLineEnd < mpEnd ? pLineEnd + 1 : mpEnd;
+			if (++mLineNumber == 1 && pLineEnd - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+				p += 3;	// UTF-8 BOM
+
+			line.numTokens = 0;
+			line.number = mLineNumber;
+			line.bTruncated = false;
+			for (;;)
+			{
+				while (p < pLineEnd && IsWhitespace(*p)) 
+					++p;
+				if (p == pLineEnd)
+					break;
+				if (*p == '/' && p + 1 < pLineEnd && p[1] == '/')
+					break;	// comment till the end of the line
+				if (*p == '#' && line.numTokens == 0)
+					break;	// comment line
+				if (line.numTokens == MAX_TOKENS_PER_LINE)
+				{
+					line.bTruncated = true;
+					break;
+				}
+
+				const char* pTokenBegin = p;
+				while (p < pLineEnd && !IsWhitespace(*p)) 
+					++p;
+
+				Token& token = line.tokens[line.numTokens++];
+				token.text = std::string_view(pTokenBegin, p - pTokenBegin);
+				token.column = static_cast<unsigned>(pTokenBegin - pLineBegin) + 1;
+			}
+
+			if (line.numTokens > 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+			if (ToLower(a[i]) != ToLower(b[i]))
+				return false;
+		return true;
+	}
+
+#if !defined(__cpp_lib_to_chars)
+	// The standard library of the v141 toolset only implements the integer overloads of from_chars.
+	// The decimal mantissa is accumulated in an integer and scaled by an exact power of ten in double 
+	// precision, which keeps the result within 1 ulp of the correctly rounded float.
+	static bool ParseDecimal(const char* p, const char* pEnd, float& out)
+	{
+		static const double POWERS_OF_TEN[] = 
+		{
+			1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		constexpr uint64_t MAX_MANTISSA = 10000000000000000ull;
+		constexpr int      MAX_EXACT_POWER = 22;
+
+		const bool bNegative = p < pEnd && *p == '-';
+		if (bNegative) 
+			++p;
+
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		bool bHasDigits = false;
+		for (; p < pEnd && IsDigit(*p); ++p, bHasDigits = true)
+		{
+			if (mantissa < MAX_MANTISSA) mantissa = mantissa * 10 + (*p - '0');
+			else                         ++exponent;
+		}
+		if (p < pEnd && *p == '.')
+		{
+			for (++p; p < pEnd && IsDigit(*p); ++p, bHasDigits = true)
+			{
+				if (mantissa < MAX_MANTISSA) { mantissa = mantissa * 10 + (*p - '0'); --exponent; }
+			}
+		}
+		if (!bHasDigits)
+			return false;
+
+		if (p < pEnd && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			const bool bNegativeExponent = p < pEnd && *p == '-';
+			if (p < pEnd && (*p == '-' || *p == '+')) 
+				++p;
+			if (p == pEnd || !IsDigit(*p))
+				return false;
+
+			int exponentValue = 0;
+			for (; p < pEnd && IsDigit(*p); ++p)
+				exponentValue = (std::min)(exponentValue * 10 + (*p - '0'), 100000);
+			exponent += bNegativeExponent ? -exponentValue : exponentValue;
+		}
+		if (p != pEnd)
+			return false;
+
+		double value = static_cast<double>(mantissa);
+		if (mantissa != 0)
+		{
+			if      (exponent >= 0 && exponent <= MAX_EXACT_POWER)  value *= POWERS_OF_TEN[exponent];
+			else if (exponent < 0 && -exponent <= MAX_EXACT_POWER) value /= POWERS_OF_TEN[-exponent];
+			else                                                    value *= std::pow(10.0, exponent);
+		}
+		out = static_cast<float>(bNegative ? -value : value);
+		return true;
+	}
+#endif
+
+	bool ParseFloat(std::string_view str, float& out)
+	{
+		const char* p = str.data();
+		const char* pEnd = p + str.size();
+		if (p < pEnd && *p == '+' && (p + 1 == pEnd || p[1] != '-'))
+			++p;	// from_chars doesn't accept the plus sign
+		if (pEnd - p > 1 && (pEnd[-1] == 'f' || pEnd[-1] == 'F') && (IsDigit(pEnd[-2]) || pEnd[-2] == '.'))
+			--pEnd;	// C style float literals, e.g. 0.95f
+		if (p == pEnd)
+			return false;
+
+#if defined(__cpp_lib_to_chars)
+		float value = 0.0f;
+		const std::from_chars_result result = std::from_chars(p, pEnd, value);
+		if (result.ec != std::errc() || result.ptr != pEnd)
+			return false;
+		out = value;
+		return true;
+#else
+		return ParseDecimal(p, pEnd, out);
+#endif
+	}
+
+	bool ParseInt(std::string_view str, int& out)
+	{
+		const char* p = str.data();
+		const char* pEnd = p + str.size();
+		if (p < pEnd && *p == '+' && (p + 1 == pEnd || p[1] != '-'))
+			++p;
+		if (p == pEnd)
+			return false;
+
+		int value = 0;
+		const std::from_chars_result result = std::from_chars(p, pEnd, value);
+		if (result.ec != std::errc() || result.ptr != pEnd)
+			return false;
+		out = value;
+		return true;
+	}
+
+	bool ParseBool(std::string_view str, bool& out)
+	{
+		switch (HashLowercase(str))
+		{
+		case Hash("true"): case Hash("yes"): case Hash("1"):
+			if (!EqualsIgnoreCase(str, "true") && !EqualsIgnoreCase(str, "yes") && str != "1") 
+				return false;
+			out = true;
+			return true;
+		case Hash("false"): case Hash("no"): case Hash("0"):
+			if (!EqualsIgnoreCase(str, "false") && !EqualsIgnoreCase(str, "no") && str != "0") 
+				return false;
+			out = false;
+			return true;
+		}
+		return false;
+	}
+}
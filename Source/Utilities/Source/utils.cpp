@@ -259,6 +259,14 @@ namespace DirectoryUtil
 
 namespace MathUtil
 {
+	static thread_local std::mt19937_64 sGenerator(std::random_device{}());
+
+	void SeedRandom(unsigned seed)
+	{
+		srand(seed);
+		sGenerator.seed(seed);
+	}
+
 	float RandF(float l, float h)
 	{
 		if (l > h)
@@ -267,9 +275,8 @@ namespace MathUtil
 			l = h;
 			h = tmp;
 		}
-		thread_local std::mt19937_64 generator(std::random_device{}());
 		std::uniform_real_distribution<float> distribution(l, h);
-		return distribution(generator);
+		return distribution(sGenerator);
 	}
 
 	// [)
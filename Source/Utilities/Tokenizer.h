@@ -0,0 +1,103 @@
+//	VQEngine | DirectX11 Renderer
+//	Copyright(C) 2018  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Zero-copy line tokenizer for the text formats of the engine (scene files, EngineSettings.ini).
+//
+// LineReader walks over a buffer (usually a MemoryMappedFile) and splits each line into 
+// whitespace separated tokens that point back into the buffer, so reading a file doesn't 
+// allocate. Blank lines and comment lines ('//' or '#') are skipped and a token starting 
+// with '//' ends the line. Tokens remember their column for error messages.
+//
+namespace Tokenizer
+{
+	constexpr size_t MAX_TOKENS_PER_LINE = 32;
+
+	struct Token
+	{
+		std::string_view text;
+		unsigned column = 0;	// 1-based
+
+		inline bool operator==(std::string_view str) const { return text == str; }
+		inline bool operator!=(std::string_view str) const { return text != str; }
+	};
+
+	struct Line
+	{
+		Token    tokens[MAX_TOKENS_PER_LINE];
+		size_t   numTokens = 0;
+		unsigned number = 0;		// 1-based
+		bool     bTruncated = false;	// the line had more than MAX_TOKENS_PER_LINE tokens
+
+		inline size_t size() const { return numTokens; }
+		inline const Token& operator[](size_t i) const { return tokens[i]; }
+	};
+
+	class LineReader
+	{
+	public:
+		LineReader(const char* pData, size_t sizeInBytes) : mpCurrent(pData), mpEnd(pData + sizeInBytes) {}
+
+		// returns false when the end of the buffer is reached
+		bool ReadLine(Line& line);
+
+	private:
+		const char* mpCurrent;
+		const char* mpEnd;
+		unsigned    mLineNumber = 0;
+	};
+
+	// FNV-1a, used for switch based keyword dispatch: switch (Hash(token)) { case Hash("camera"): ... }
+	// Colliding keywords fail to compile as duplicate case labels, a matched case should still 
+	// compare the token as unknown words can hash to a keyword.
+	constexpr uint32_t Hash(const char* pStr, size_t length)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < length; ++i)
+			hash = (hash ^ static_cast<uint8_t>(pStr[i])) * 16777619u;
+		return hash;
+	}
+	constexpr uint32_t HashLowercase(const char* pStr, size_t length)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < length; ++i)
+		{
+			const char c = pStr[i];
+			hash = (hash ^ static_cast<uint8_t>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c)) * 16777619u;
+		}
+		return hash;
+	}
+	template<size_t N> constexpr uint32_t Hash(const char (&str)[N]) { return Hash(str, N - 1); }
+	inline uint32_t Hash(std::string_view str)          { return Hash(str.data(), str.size()); }
+	inline uint32_t HashLowercase(std::string_view str) { return HashLowercase(str.data(), str.size()); }
+
+	bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+
+	// Number parsing: the whole token has to be consumed, otherwise false is returned and @out is untouched.
+	// Floats may have an 'f' suffix.
+	bool ParseFloat(std::string_view str, float& out);
+	bool ParseInt(std::string_view str, int& out);
+
+	// true/false, yes/no, 1/0 (case insensitive)
+	bool ParseBool(std::string_view str, bool& out);
+}
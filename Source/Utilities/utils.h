@@ -44,6 +44,19 @@ namespace StrUtil
 
 	std::string CommaSeparatedNumber(const std::string& num);
 
+	// 32-bit FNV-1a hash. constexpr so that string literals can be hashed at compile time.
+	//
+	constexpr unsigned Hash32(const char* str)
+	{
+		unsigned hash = 2166136261u;
+		while (*str)
+		{
+			hash ^= static_cast<unsigned char>(*str++);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
 	struct UnicodeString
 	{
 	public:
@@ -132,6 +145,8 @@ namespace MathUtil
 		return _val;
 	}
 
+	// seeds rand() and the RandF() generator of the calling thread, for reproducible runs
+	void	SeedRandom(unsigned seed);
 	float	RandF(float l, float h);
 	int		RandI(int l, int h);
 	size_t	RandU(size_t l, size_t h);